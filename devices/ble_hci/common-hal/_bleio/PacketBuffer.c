@@ -75,6 +75,16 @@ STATIC uint32_t queue_next_write(bleio_packet_buffer_obj_t *self) {
     return 0;
 }
 
+STATIC bleio_packet_send_result_t packet_buffer_send_queued(void *context, const uint8_t *data, size_t len) {
+    bleio_packet_buffer_obj_t *self = context;
+    mp_buffer_info_t bufinfo = {
+        .buf = (uint8_t *) data,
+        .len = len,
+    };
+    common_hal_bleio_characteristic_set_value(self->characteristic, &bufinfo);
+    return BLEIO_PACKET_SENT;
+}
+
 void bleio_packet_buffer_update(bleio_packet_buffer_obj_t *self, mp_buffer_info_t *bufinfo) {
     write_to_ringbuf(self, bufinfo->buf, bufinfo->len);
 }
@@ -106,6 +116,9 @@ void common_hal_bleio_packet_buffer_construct(
         }
     }
 
+    bleio_packet_queue_init(&self->queue);
+    self->queue_packets = buffer_size;
+
     if (outgoing) {
         self->packet_queued = false;
         self->pending_index = 0;
@@ -192,6 +205,36 @@ mp_int_t common_hal_bleio_packet_buffer_write(bleio_packet_buffer_obj_t *self, u
     return num_bytes_written;
 }
 
+mp_int_t common_hal_bleio_packet_buffer_queue(bleio_packet_buffer_obj_t *self, uint8_t *data, size_t len, uint8_t* header, size_t header_len) {
+    if (self->outgoing[0] == NULL) {
+        mp_raise_bleio_BluetoothError(translate("Writes not supported on Characteristic"));
+    }
+    if (self->conn_handle == BLE_CONN_HANDLE_INVALID) {
+        return -1;
+    }
+    if (len + header_len > (size_t) common_hal_bleio_packet_buffer_get_outgoing_packet_length(self)) {
+        // Supplied data will not fit in a single BLE packet.
+        mp_raise_ValueError(translate("Total data to write is larger than outgoing_packet_length"));
+    }
+    if (!bleio_packet_queue_allocated(&self->queue) &&
+        !bleio_packet_queue_alloc(&self->queue, self->queue_packets, self->characteristic->max_length)) {
+        mp_raise_ValueError(translate("Buffer too large and unable to allocate"));
+    }
+
+    // Values are sent as soon as they are set, so send anything pending first to keep the
+    // writes in order, and then the queue never holds more than this packet.
+    queue_next_write(self);
+    bleio_packet_queue_put(&self->queue, header, header_len, data, len);
+    bleio_packet_queue_flush(&self->queue, packet_buffer_send_queued, self);
+    return header_len + len;
+}
+
+void common_hal_bleio_packet_buffer_get_write_stats(bleio_packet_buffer_obj_t *self, uint32_t *queued, uint32_t *sent, uint32_t *dropped) {
+    *queued = self->queue.queued;
+    *sent = self->queue.sent;
+    *dropped = self->queue.dropped;
+}
+
 mp_int_t common_hal_bleio_packet_buffer_get_incoming_packet_length(bleio_packet_buffer_obj_t *self) {
     // If this PacketBuffer is coming from a remote service via NOTIFY or INDICATE
     // the maximum size is what can be sent in one
@@ -97,6 +97,200 @@ STATIC mp_obj_t mp_vfs_proxy_call(mp_vfs_mount_t *vfs, qstr meth_name, size_t n_
     return mp_call_method_n_kw(n_args, 0, meth);
 }
 
+#if MICROPY_VFS_IMPORT_CACHE
+// Resolving an import probes foo.py, foo.mpy and foo/ in every sys.path entry,
+// which used to cost a stat (and on FAT a directory scan) per probe.  Instead
+// the first probe in a directory lists it once into a dict mapping each name
+// to its MP_IMPORT_STAT_xxx type and later probes in that directory are
+// answered from the dict.  Names are heap strs, not qstrs, so a listing is
+// freed with the cache rather than growing the qstr pool for good.  FAT
+// matches names case-insensitively, so there both the listing and the probes
+// are lower-cased.  The cache is keyed by the directory as given to
+// mp_vfs_import_stat, so anything that may add or remove a file, or change
+// which VFS a path resolves to, drops the whole cache.  Files the mpy cache
+// writes only drop the listing of its own directory.
+
+// Stored for entries that are neither a regular file nor a directory (e.g. a
+// symlink); probes for those fall back to a real stat.
+#define IMPORT_CACHE_UNKNOWN (-1)
+
+// Longer names aren't cached; probes for them fall back to a real stat.
+#define IMPORT_CACHE_NAME_MAX (255)
+
+void mp_vfs_import_cache_invalidate(void) {
+    MP_STATE_VM(vfs_import_cache) = NULL;
+}
+
+STATIC bool import_cache_folds_case(mp_vfs_mount_t *vfs) {
+    #if MICROPY_VFS_FAT
+    return mp_obj_get_type(vfs->obj) == &mp_fat_vfs_type;
+    #else
+    (void)vfs;
+    return false;
+    #endif
+}
+
+// Copies name to buf, lower-cased.  Returns false for names with non-ASCII
+// characters, which FAT may fold in ways this doesn't.
+STATIC bool import_cache_lower(char *buf, const char *name, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = name[i];
+        if (c >= 0x80) {
+            return false;
+        }
+        buf[i] = unichar_tolower(c);
+    }
+    return true;
+}
+
+// Looks up a str key without allocating one.
+STATIC mp_map_elem_t *import_cache_find(mp_obj_t dict, const char *str, size_t len) {
+    mp_obj_str_t key = {{&mp_type_str}, qstr_compute_hash((const byte*)str, len), len, (const byte*)str};
+    return mp_map_lookup(&((mp_obj_dict_t*)MP_OBJ_TO_PTR(dict))->map, MP_OBJ_FROM_PTR(&key), MP_MAP_LOOKUP);
+}
+
+// Returns a dict of the names in dir, or None if the directory can't be listed
+// and every probe in it needs a stat.
+STATIC mp_obj_t import_cache_list_dir(mp_vfs_mount_t *vfs, const char *dir, size_t dir_len) {
+    bool fold_case = import_cache_folds_case(vfs);
+    char lower[IMPORT_CACHE_NAME_MAX];
+    mp_obj_t listing = mp_obj_new_dict(0);
+    mp_obj_t dir_o = MP_OBJ_NEW_QSTR(MP_QSTR__dot_);
+    if (dir_len > 0) {
+        dir_o = mp_obj_new_str(dir, dir_len);
+    }
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_obj_t iter = mp_vfs_proxy_call(vfs, MP_QSTR_ilistdir, 1, &dir_o);
+        mp_obj_t next;
+        while ((next = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+            mp_obj_t *items;
+            size_t n_items;
+            mp_obj_get_array(next, &n_items, &items);
+            size_t name_len;
+            const char *name = mp_obj_str_get_data(items[0], &name_len);
+            if (name_len > IMPORT_CACHE_NAME_MAX) {
+                continue;
+            }
+            if (fold_case) {
+                if (!import_cache_lower(lower, name, name_len)) {
+                    // probes for it fall back to a stat
+                    continue;
+                }
+                name = lower;
+            }
+            mp_int_t type = IMPORT_CACHE_UNKNOWN;
+            if (n_items > 1) {
+                mp_int_t mode = mp_obj_get_int(items[1]);
+                if (mode == MP_S_IFDIR) {
+                    type = MP_IMPORT_STAT_DIR;
+                } else if (mode == MP_S_IFREG) {
+                    type = MP_IMPORT_STAT_FILE;
+                }
+            }
+            mp_obj_dict_store(listing, mp_obj_new_str(name, name_len), MP_OBJ_NEW_SMALL_INT(type));
+        }
+        nlr_pop();
+    } else {
+        // A missing directory holds nothing.  Any other failure (the VFS has
+        // no ilistdir, a permission error) means we can't trust a listing.
+        mp_obj_t exc = MP_OBJ_FROM_PTR(nlr.ret_val);
+        if (!mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(mp_obj_get_type(exc)), MP_OBJ_FROM_PTR(&mp_type_OSError))) {
+            return mp_const_none;
+        }
+        mp_obj_t errno_o = mp_obj_exception_get_value(exc);
+        if (errno_o != MP_OBJ_NEW_SMALL_INT(MP_ENOENT) && errno_o != MP_OBJ_NEW_SMALL_INT(MP_ENOTDIR)) {
+            return mp_const_none;
+        }
+        listing = mp_obj_new_dict(0);
+    }
+    return listing;
+}
+
+// Returns the cached type of path, or IMPORT_CACHE_UNKNOWN if it must be stat'd.
+STATIC mp_int_t import_cache_lookup(mp_vfs_mount_t *vfs, const char *path, const char *path_out) {
+    const char *name = strrchr(path, '/');
+    size_t dir_len;
+    if (name == NULL) {
+        name = path;
+        dir_len = 0;
+    } else {
+        // keep the slash when the directory is the root
+        dir_len = name == path ? 1 : (size_t)(name - path);
+        name += 1;
+    }
+    size_t name_len = strlen(name);
+    size_t path_out_len = strlen(path_out);
+    if (name_len == 0 || name_len > IMPORT_CACHE_NAME_MAX
+        || path_out_len < name_len || strcmp(path_out + path_out_len - name_len, name) != 0) {
+        // path names a mount point, or something the cache can't hold
+        return IMPORT_CACHE_UNKNOWN;
+    }
+
+    // Read the cache pointer once: if it's invalidated while a directory is
+    // being listed, the listing goes into the discarded dict.
+    mp_obj_dict_t *cache = MP_STATE_VM(vfs_import_cache);
+    if (cache == NULL) {
+        cache = MP_OBJ_TO_PTR(mp_obj_new_dict(0));
+        MP_STATE_VM(vfs_import_cache) = cache;
+    }
+    mp_map_elem_t *elem = import_cache_find(MP_OBJ_FROM_PTR(cache), path, dir_len);
+    mp_obj_t listing;
+    if (elem != NULL) {
+        listing = elem->value;
+    } else {
+        // list the same directory within the VFS, dropping the trailing slash
+        size_t vfs_dir_len = path_out_len - name_len;
+        if (vfs_dir_len > 1) {
+            vfs_dir_len -= 1;
+        }
+        listing = import_cache_list_dir(vfs, path_out, vfs_dir_len);
+        mp_obj_dict_store(MP_OBJ_FROM_PTR(cache), mp_obj_new_str(path, dir_len), listing);
+        MP_STATE_VM(vfs_import_cache_dirs) += 1;
+    }
+    if (listing == mp_const_none) {
+        return IMPORT_CACHE_UNKNOWN;
+    }
+
+    char lower[IMPORT_CACHE_NAME_MAX];
+    if (import_cache_folds_case(vfs)) {
+        if (!import_cache_lower(lower, name, name_len)) {
+            return IMPORT_CACHE_UNKNOWN;
+        }
+        name = lower;
+    }
+    elem = import_cache_find(listing, name, name_len);
+    if (elem == NULL) {
+        return MP_IMPORT_STAT_NO_EXIST;
+    }
+    return MP_OBJ_SMALL_INT_VALUE(elem->value);
+}
+
+// Drops what creating or removing the file at path may have made stale.  The
+// mpy cache writes files for every module it compiles, so for a file directly
+// in MICROPY_MODULE_MPY_CACHE_DIR only that directory's listing is dropped.
+STATIC void import_cache_invalidate_file(mp_obj_t path_in) {
+    #if MICROPY_MODULE_MPY_CACHE
+    const char *path = mp_obj_str_get_str(path_in);
+    size_t dir_len = sizeof(MICROPY_MODULE_MPY_CACHE_DIR) - 1;
+    mp_obj_dict_t *cache = MP_STATE_VM(vfs_import_cache);
+    if (cache != NULL && strncmp(path, MICROPY_MODULE_MPY_CACHE_DIR "/", dir_len + 1) == 0
+        && strchr(path + dir_len + 1, '/') == NULL) {
+        mp_obj_str_t key = {{&mp_type_str}, qstr_compute_hash((const byte*)path, dir_len), dir_len, (const byte*)path};
+        mp_map_lookup(&cache->map, MP_OBJ_FROM_PTR(&key), MP_MAP_LOOKUP_REMOVE_IF_FOUND);
+        return;
+    }
+    #else
+    (void)path_in;
+    #endif
+    mp_vfs_import_cache_invalidate();
+}
+#else
+STATIC void import_cache_invalidate_file(mp_obj_t path_in) {
+    (void)path_in;
+}
+#endif
+
 mp_import_stat_t mp_vfs_import_stat(const char *path) {
     const char *path_out;
     mp_vfs_mount_t *vfs = mp_vfs_lookup_path(path, &path_out);
@@ -104,6 +298,15 @@ mp_import_stat_t mp_vfs_import_stat(const char *path) {
         return MP_IMPORT_STAT_NO_EXIST;
     }
 
+    #if MICROPY_VFS_IMPORT_CACHE
+    mp_int_t cached = import_cache_lookup(vfs, path, path_out);
+    if (cached != IMPORT_CACHE_UNKNOWN) {
+        MP_STATE_VM(vfs_import_cache_hits) += 1;
+        return cached;
+    }
+    MP_STATE_VM(vfs_import_cache_misses) += 1;
+    #endif
+
     // If the mounted object has the VFS protocol, call its import_stat helper
     const mp_vfs_proto_t *proto = (mp_vfs_proto_t*)mp_proto_get(MP_QSTR_protocol_vfs, vfs->obj);
     if (proto != NULL) {
@@ -192,6 +395,7 @@ mp_obj_t mp_vfs_mount(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args
         vfsp = &(*vfsp)->next;
     }
     *vfsp = vfs;
+    mp_vfs_import_cache_invalidate();
 
     return mp_const_none;
 }
@@ -221,6 +425,7 @@ mp_obj_t mp_vfs_umount(mp_obj_t mnt_in) {
     if (MP_STATE_VM(vfs_cur) == vfs) {
         MP_STATE_VM(vfs_cur) = MP_VFS_ROOT;
     }
+    mp_vfs_import_cache_invalidate();
 
     // call the underlying object to do any unmounting operation
     mp_vfs_proxy_call(vfs, MP_QSTR_umount, 0, NULL);
@@ -243,8 +448,14 @@ mp_obj_t mp_vfs_open(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args)
     mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
     mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
-    mp_vfs_mount_t *vfs = lookup_path(args[ARG_file].u_obj, &args[ARG_file].u_obj);
-    return mp_vfs_proxy_call(vfs, MP_QSTR_open, 2, (mp_obj_t*)&args);
+    mp_obj_t path_in = args[ARG_file].u_obj;
+    mp_vfs_mount_t *vfs = lookup_path(path_in, &args[ARG_file].u_obj);
+    mp_obj_t file = mp_vfs_proxy_call(vfs, MP_QSTR_open, 2, (mp_obj_t*)&args);
+    // any mode but reading may have created the file
+    if (strpbrk(mp_obj_str_get_str(args[ARG_mode].u_obj), "wax+") != NULL) {
+        import_cache_invalidate_file(path_in);
+    }
+    return file;
 }
 MP_DEFINE_CONST_FUN_OBJ_KW(mp_vfs_open_obj, 0, mp_vfs_open);
 
@@ -252,6 +463,7 @@ mp_obj_t mp_vfs_chdir(mp_obj_t path_in) {
     mp_obj_t path_out;
     mp_vfs_mount_t *vfs = lookup_path(path_in, &path_out);
     MP_STATE_VM(vfs_cur) = vfs;
+    mp_vfs_import_cache_invalidate();
     if (vfs == MP_VFS_ROOT) {
         // If we change to the root dir and a VFS is mounted at the root then
         // we must change that VFS's current dir to the root dir so that any
@@ -364,6 +576,7 @@ mp_obj_t mp_vfs_mkdir(mp_obj_t path_in) {
     if (vfs == MP_VFS_ROOT || (vfs != MP_VFS_NONE && !strcmp(mp_obj_str_get_str(path_out), "/"))) {
         mp_raise_OSError(MP_EEXIST);
     }
+    mp_vfs_import_cache_invalidate();
     return mp_vfs_proxy_call(vfs, MP_QSTR_mkdir, 1, &path_out);
 }
 MP_DEFINE_CONST_FUN_OBJ_1(mp_vfs_mkdir_obj, mp_vfs_mkdir);
@@ -371,6 +584,7 @@ MP_DEFINE_CONST_FUN_OBJ_1(mp_vfs_mkdir_obj, mp_vfs_mkdir);
 mp_obj_t mp_vfs_remove(mp_obj_t path_in) {
     mp_obj_t path_out;
     mp_vfs_mount_t *vfs = lookup_path(path_in, &path_out);
+    import_cache_invalidate_file(path_in);
     return mp_vfs_proxy_call(vfs, MP_QSTR_remove, 1, &path_out);
 }
 MP_DEFINE_CONST_FUN_OBJ_1(mp_vfs_remove_obj, mp_vfs_remove);
@@ -383,6 +597,8 @@ mp_obj_t mp_vfs_rename(mp_obj_t old_path_in, mp_obj_t new_path_in) {
         // can't rename across filesystems
         mp_raise_OSError(MP_EPERM);
     }
+    import_cache_invalidate_file(old_path_in);
+    import_cache_invalidate_file(new_path_in);
     return mp_vfs_proxy_call(old_vfs, MP_QSTR_rename, 2, args);
 }
 MP_DEFINE_CONST_FUN_OBJ_2(mp_vfs_rename_obj, mp_vfs_rename);
@@ -390,6 +606,7 @@ MP_DEFINE_CONST_FUN_OBJ_2(mp_vfs_rename_obj, mp_vfs_rename);
 mp_obj_t mp_vfs_rmdir(mp_obj_t path_in) {
     mp_obj_t path_out;
     mp_vfs_mount_t *vfs = lookup_path(path_in, &path_out);
+    mp_vfs_import_cache_invalidate();
     return mp_vfs_proxy_call(vfs, MP_QSTR_rmdir, 1, &path_out);
 }
 MP_DEFINE_CONST_FUN_OBJ_1(mp_vfs_rmdir_obj, mp_vfs_rmdir);
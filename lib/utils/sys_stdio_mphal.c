@@ -60,12 +60,13 @@ void stdio_obj_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t
 STATIC mp_uint_t stdio_read(mp_obj_t self_in, void *buf, mp_uint_t size, int *errcode) {
     sys_stdio_obj_t *self = MP_OBJ_TO_PTR(self_in);
     if (self->fd == STDIO_FD_IN) {
+        // Returns as soon as there is some input. The stream layer calls
+        // again for the rest.
+        size = mp_hal_stdin_rx_into(buf, size);
         for (uint i = 0; i < size; i++) {
-            int c = mp_hal_stdin_rx_chr();
-            if (c == '\r') {
-                c = '\n';
+            if (((byte*)buf)[i] == '\r') {
+                ((byte*)buf)[i] = '\n';
             }
-            ((byte*)buf)[i] = c;
         }
         return size;
     } else {
@@ -147,10 +148,7 @@ const sys_stdio_obj_t mp_sys_stderr_obj = {{&stdio_obj_type}, .fd = STDIO_FD_ERR
 
 #if MICROPY_PY_SYS_STDIO_BUFFER
 STATIC mp_uint_t stdio_buffer_read(mp_obj_t self_in, void *buf, mp_uint_t size, int *errcode) {
-    for (uint i = 0; i < size; i++) {
-        ((byte*)buf)[i] = mp_hal_stdin_rx_chr();
-    }
-    return size;
+    return mp_hal_stdin_rx_into(buf, size);
 }
 
 STATIC mp_uint_t stdio_buffer_write(mp_obj_t self_in, const void *buf, mp_uint_t size, int *errcode) {
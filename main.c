@@ -38,6 +38,7 @@
 #include "py/runtime.h"
 #include "py/repl.h"
 #include "py/gc.h"
+#include "py/profiler.h"
 #include "py/stackctrl.h"
 
 #include "lib/mp-readline/readline.h"
@@ -68,6 +69,10 @@
 #include "shared-module/memorymonitor/__init__.h"
 #endif
 
+#if CIRCUITPY_TELEMETRY
+#include "shared-module/telemetry/__init__.h"
+#endif
+
 #if CIRCUITPY_NETWORK
 #include "shared-module/network/__init__.h"
 #endif
@@ -225,6 +230,12 @@ void cleanup_after_vm(supervisor_allocation* heap) {
     #if CIRCUITPY_MEMORYMONITOR
     memorymonitor_reset();
     #endif
+    #if CIRCUITPY_TELEMETRY
+    telemetry_reset();
+    #endif
+    #if MICROPY_PY_PROFILER
+    mp_profiler_reset();
+    #endif
     filesystem_flush();
     stop_mp();
     free_memory(heap);
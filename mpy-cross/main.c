@@ -7,12 +7,20 @@
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
 
 #include "py/compile.h"
 #include "py/persistentcode.h"
 #include "py/runtime.h"
 #include "py/gc.h"
 #include "py/stackctrl.h"
+#include "extmod/crypto-algorithms/sha256.h"
+#include "genhdr/mpversion.h"
 #ifdef _WIN32
 #include "fmode.h"
 #endif
@@ -21,6 +29,12 @@
 STATIC uint emit_opt = MP_EMIT_OPT_NONE;
 mp_uint_t mp_verbose_flag = 0;
 
+// Batch mode options: worker processes, content-hash cache directory and
+// dependency manifest file
+STATIC int batch_jobs = 1;
+STATIC const char *batch_cache_dir = NULL;
+STATIC const char *batch_deps_file = NULL;
+
 // Heap size of GC heap (if enabled)
 // Make it larger on a 64 bit machine, because pointers are larger.
 long heap_size = 1024*1024 * (sizeof(mp_uint_t) / 4);
@@ -75,19 +89,409 @@ STATIC int compile_and_save(const char *file, const char *output_file, const cha
     }
 }
 
+// Batch mode: compile a list of inputs, each to <input>.mpy, optionally in
+// several worker processes that share one work counter.  Outputs are keyed in
+// the cache by a SHA-256 of the compiler identity, the options that affect
+// code generation, the embedded source name and the source text.
+
+typedef struct _batch_input_t {
+    char *file;
+    // name to embed in the .mpy; NULL to use the file name
+    char *source_name;
+} batch_input_t;
+
+typedef struct _batch_stats_t {
+    size_t next;
+    size_t compiled;
+    size_t cached;
+    size_t failed;
+} batch_stats_t;
+
+STATIC batch_input_t *batch_inputs = NULL;
+STATIC size_t batch_len = 0;
+STATIC size_t batch_alloc = 0;
+STATIC char batch_compiler_id[128];
+
+STATIC char *batch_path_join(const char *dir, const char *name, const char *suffix) {
+    size_t dir_len = strlen(dir);
+    char *path = malloc(dir_len + strlen(name) + strlen(suffix) + 2);
+    strcpy(path, dir);
+    if (dir_len > 0 && dir[dir_len - 1] != '/') {
+        strcat(path, "/");
+    }
+    strcat(path, name);
+    strcat(path, suffix);
+    return path;
+}
+
+STATIC bool batch_ends_with_py(const char *name) {
+    size_t len = strlen(name);
+    return len > 3 && strcmp(name + len - 3, ".py") == 0;
+}
+
+STATIC void batch_add(char *file, char *source_name) {
+    if (batch_len == batch_alloc) {
+        batch_alloc = batch_alloc == 0 ? 64 : batch_alloc * 2;
+        batch_inputs = realloc(batch_inputs, batch_alloc * sizeof(batch_input_t));
+    }
+    batch_inputs[batch_len].file = file;
+    batch_inputs[batch_len].source_name = source_name;
+    batch_len++;
+}
+
+STATIC int batch_compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Add every .py file below dir, in sorted order; source names are relative to
+// the directory originally given on the command line.
+STATIC void batch_add_dir(const char *dir, const char *rel) {
+    DIR *d = opendir(*dir ? dir : ".");
+    if (d == NULL) {
+        mp_printf(&mp_stderr_print, "can't open directory %s\n", dir);
+        exit(1);
+    }
+    char **names = NULL;
+    size_t n = 0, alloc = 0;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) {
+            continue;
+        }
+        if (n == alloc) {
+            alloc = alloc == 0 ? 16 : alloc * 2;
+            names = realloc(names, alloc * sizeof(char *));
+        }
+        names[n++] = strdup(de->d_name);
+    }
+    closedir(d);
+    qsort(names, n, sizeof(char *), batch_compare_names);
+    for (size_t i = 0; i < n; i++) {
+        char *full = batch_path_join(dir, names[i], "");
+        char *name = rel == NULL ? strdup(names[i]) : batch_path_join(rel, names[i], "");
+        struct stat st;
+        // stat, not lstat: follow symlinks like find -L
+        if (stat(full, &st) == 0) {
+            if (S_ISDIR(st.st_mode)) {
+                batch_add_dir(full, name);
+            } else if (S_ISREG(st.st_mode) && batch_ends_with_py(names[i])) {
+                batch_add(full, name);
+                full = name = NULL;
+            }
+        }
+        free(full);
+        free(name);
+        free(names[i]);
+    }
+    free(names);
+}
+
+STATIC void batch_add_path(const char *path) {
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        // Name the files in "." without a ./ prefix, as find | sed did
+        batch_add_dir(strcmp(path, ".") == 0 ? "" : path, NULL);
+    } else {
+        batch_add(strdup(path), NULL);
+    }
+}
+
+// Add the inputs named in a list file, one per line; "-" reads stdin.
+STATIC void batch_add_list(const char *list) {
+    FILE *f = strcmp(list, "-") == 0 ? stdin : fopen(list, "r");
+    if (f == NULL) {
+        mp_printf(&mp_stderr_print, "can't open list file %s\n", list);
+        exit(1);
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        size_t len = strcspn(line, "\r\n");
+        line[len] = '\0';
+        if (len > 0) {
+            batch_add_path(line);
+        }
+    }
+    if (f != stdin) {
+        fclose(f);
+    }
+}
+
+STATIC char *batch_output_path(const char *file) {
+    size_t len = strlen(file);
+    if (batch_ends_with_py(file)) {
+        len -= 3;
+    }
+    char *path = malloc(len + sizeof(".mpy"));
+    memcpy(path, file, len);
+    strcpy(path + len, ".mpy");
+    return path;
+}
+
+// Anything that changes the generated code must go into the cache key.  A
+// rebuilt compiler binary changes its size or mtime, which invalidates
+// entries made by an older build of the same commit.  Returns false if the
+// binary can't be found, in which case the cache can't be trusted.
+STATIC bool batch_init_compiler_id(const char *argv0) {
+    struct stat st;
+    // argv[0] is only a path to the binary when it has a directory in it;
+    // otherwise it was found through PATH.
+    if (stat("/proc/self/exe", &st) != 0
+        && (strpbrk(argv0, "/\\") == NULL || stat(argv0, &st) != 0)) {
+        return false;
+    }
+    // snprintf is the runtime's, which has no %ll
+    snprintf(batch_compiler_id, sizeof(batch_compiler_id), "%s %u %u %d %d %d %d %u %u",
+        MICROPY_GIT_HASH, (uint)st.st_size, (uint)st.st_mtime,
+        mp_dynamic_compiler.small_int_bits,
+        mp_dynamic_compiler.opt_cache_map_lookup_in_bytecode,
+        mp_dynamic_compiler.py_builtins_str_unicode,
+        mp_dynamic_compiler.mpy_compress_bits,
+        emit_opt, (uint)MP_STATE_VM(mp_optimise_value));
+    return true;
+}
+
+// The input path is part of the key as well as the embedded name because both
+// are interned while compiling, and qstr numbering shows up in the output.
+STATIC bool batch_cache_key(const char *file, const char *source_name, char *key) {
+    FILE *f = fopen(file, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    CRYAL_SHA256_CTX ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, (const BYTE *)batch_compiler_id, strlen(batch_compiler_id) + 1);
+    sha256_update(&ctx, (const BYTE *)file, strlen(file) + 1);
+    sha256_update(&ctx, (const BYTE *)source_name, strlen(source_name) + 1);
+    BYTE buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        sha256_update(&ctx, buf, n);
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    BYTE hash[SHA256_BLOCK_SIZE];
+    sha256_final(&ctx, hash);
+    for (int i = 0; i < SHA256_BLOCK_SIZE; i++) {
+        sprintf(key + 2 * i, "%02x", hash[i]);
+    }
+    return ok;
+}
+
+STATIC bool batch_copy_file(const char *from, const char *to) {
+    FILE *in = fopen(from, "rb");
+    if (in == NULL) {
+        return false;
+    }
+    FILE *out = fopen(to, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    bool ok = true;
+    while (ok && (n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        ok = fwrite(buf, 1, n, out) == n;
+    }
+    ok = ok && !ferror(in);
+    fclose(in);
+    return (fclose(out) == 0) && ok;
+}
+
+STATIC int batch_compile(const batch_input_t *in, const char *output_file, const char *source_file, batch_stats_t *stats) {
+    char *output = output_file != NULL ? strdup(output_file) : batch_output_path(in->file);
+    if (source_file == NULL) {
+        source_file = in->source_name != NULL ? in->source_name : in->file;
+    }
+    char *cached = NULL;
+    if (batch_cache_dir != NULL) {
+        char key[2 * SHA256_BLOCK_SIZE + 1];
+        if (batch_cache_key(in->file, source_file, key)) {
+            cached = batch_path_join(batch_cache_dir, key, ".mpy");
+            if (batch_copy_file(cached, output)) {
+                __atomic_fetch_add(&stats->cached, 1, __ATOMIC_RELAXED);
+                free(cached);
+                free(output);
+                return 0;
+            }
+        }
+    }
+    int ret = compile_and_save(in->file, output, source_file);
+    if (ret == 0 && cached != NULL) {
+        // Write under a private name and rename, so other workers (or other
+        // builds sharing the cache) never see a partial entry.
+        char suffix[24];
+        snprintf(suffix, sizeof(suffix), ".%d", (int)getpid());
+        char *tmp = malloc(strlen(cached) + sizeof(suffix));
+        strcpy(tmp, cached);
+        strcat(tmp, suffix);
+        if (!batch_copy_file(output, tmp) || rename(tmp, cached) != 0) {
+            remove(tmp);
+        }
+        free(tmp);
+    }
+    __atomic_fetch_add(ret == 0 ? &stats->compiled : &stats->failed, 1, __ATOMIC_RELAXED);
+    free(cached);
+    free(output);
+    return ret;
+}
+
+STATIC int batch_worker(const char *output_file, const char *source_file, batch_stats_t *stats) {
+    // Nothing survives the compilation of one input, so drop the qstrs it
+    // interned before starting on the next.  This keeps the pools (which are
+    // searched linearly) short and lets the GC reclaim their data.
+    qstr_pool_t *pool = MP_STATE_VM(last_pool);
+    int ret = 0;
+    for (;;) {
+        size_t i = __atomic_fetch_add(&stats->next, 1, __ATOMIC_RELAXED);
+        if (i >= batch_len) {
+            break;
+        }
+        ret |= batch_compile(&batch_inputs[i], output_file, source_file, stats);
+        MP_STATE_VM(last_pool) = pool;
+        MP_STATE_VM(qstr_last_chunk) = NULL;
+        MP_STATE_VM(qstr_last_alloc) = 0;
+        MP_STATE_VM(qstr_last_used) = 0;
+        gc_collect();
+    }
+    return ret;
+}
+
+STATIC void batch_print_make_path(FILE *f, const char *path) {
+    for (; *path; path++) {
+        if (*path == ' ' || *path == '#') {
+            fputc('\\', f);
+        } else if (*path == '$') {
+            fputc('$', f);
+        }
+        fputc(*path, f);
+    }
+}
+
+// Write a make-style dependency manifest: one rule per output, plus an empty
+// rule per source so that deleting a source doesn't break the build.
+STATIC int batch_write_deps(const char *output_file) {
+    FILE *f = fopen(batch_deps_file, "w");
+    if (f == NULL) {
+        mp_printf(&mp_stderr_print, "can't write dependency file %s\n", batch_deps_file);
+        return 1;
+    }
+    for (size_t i = 0; i < batch_len; i++) {
+        char *output = output_file != NULL ? strdup(output_file) : batch_output_path(batch_inputs[i].file);
+        batch_print_make_path(f, output);
+        fputs(": ", f);
+        batch_print_make_path(f, batch_inputs[i].file);
+        fputs("\n", f);
+        free(output);
+    }
+    for (size_t i = 0; i < batch_len; i++) {
+        fputs("\n", f);
+        batch_print_make_path(f, batch_inputs[i].file);
+        fputs(":\n", f);
+    }
+    return fclose(f) == 0 ? 0 : 1;
+}
+
+STATIC int batch_run(const char *output_file, const char *source_file) {
+    if (batch_cache_dir != NULL) {
+        #ifdef _WIN32
+        mkdir(batch_cache_dir);
+        #else
+        mkdir(batch_cache_dir, 0777);
+        #endif
+    }
+
+    int jobs = batch_jobs;
+    #ifndef _WIN32
+    if (jobs <= 0) {
+        jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    #endif
+    if (jobs <= 0) {
+        jobs = 1;
+    }
+    if ((size_t)jobs > batch_len) {
+        jobs = batch_len;
+    }
+
+    batch_stats_t local_stats = {0};
+    batch_stats_t *stats = &local_stats;
+    int ret = 0;
+
+    #ifndef _WIN32
+    if (jobs > 1) {
+        // The work counter and statistics are shared with the workers.
+        stats = mmap(NULL, sizeof(batch_stats_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (stats == MAP_FAILED) {
+            stats = &local_stats;
+            jobs = 1;
+        }
+        memset(stats, 0, sizeof(batch_stats_t));
+        fflush(stdout);
+        // This process is one of the workers, so fork one fewer.
+        for (int i = 1; i < jobs; i++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                int status = batch_worker(output_file, source_file, stats);
+                fflush(stdout);
+                _exit(status);
+            } else if (pid < 0) {
+                break;
+            }
+        }
+    }
+    #endif
+
+    ret = batch_worker(output_file, source_file, stats);
+
+    #ifndef _WIN32
+    if (jobs > 1) {
+        int status;
+        while (wait(&status) > 0) {
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                ret = 1;
+            }
+        }
+    }
+    #endif
+
+    if (mp_verbose_flag) {
+        printf("%d compiled, %d from cache, %d failed, %d jobs\n",
+            (int)stats->compiled, (int)stats->cached, (int)stats->failed, jobs);
+    }
+
+    if (batch_deps_file != NULL) {
+        ret |= batch_write_deps(output_file);
+    }
+
+    #ifndef _WIN32
+    if (stats != &local_stats) {
+        munmap(stats, sizeof(batch_stats_t));
+    }
+    #endif
+
+    return ret;
+}
+
 STATIC int usage(char **argv) {
     printf(
-"usage: %s [<opts>] [-X <implopt>] <input filename>\n"
+"usage: %s [<opts>] [-X <implopt>] <input>...\n"
+"Each input is a .py file, a directory (compiled recursively) or @<list>, a\n"
+"file naming one input per line (@- reads stdin).\n"
 "Options:\n"
 "-o : output file for compiled bytecode (defaults to input with .mpy extension)\n"
 "-s : source filename to embed in the compiled bytecode (defaults to input file)\n"
 "-v : verbose (trace various operations); can be multiple\n"
 "-O[N] : apply bytecode optimizations of level N\n"
+"-j N : compile in N worker processes (0 for one per CPU)\n"
+"-C <dir> : reuse compiled outputs cached in <dir> by content hash\n"
+"-M <file> : write a make-style dependency manifest to <file>\n"
 "\n"
 "Target specific options:\n"
 "-msmall-int-bits=number : set the maximum bits used to encode a small-int\n"
 "-mno-unicode : don't support unicode in compiled strings\n"
 "-mcache-lookup-bc : cache map lookups in the bytecode\n"
+"-mcompress[=bits] : compress the .mpy with a window of 2**bits bytes (8-12, default 10)\n"
 "\n"
 "Implementation specific options:\n", argv[0]
 );
@@ -172,8 +576,8 @@ MP_NOINLINE int main_(int argc, char **argv) {
     mp_dynamic_compiler.small_int_bits = 31;
     mp_dynamic_compiler.opt_cache_map_lookup_in_bytecode = 0;
     mp_dynamic_compiler.py_builtins_str_unicode = 1;
+    mp_dynamic_compiler.mpy_compress_bits = 0;
 
-    const char *input_file = NULL;
     const char *output_file = NULL;
     const char *source_file = NULL;
 
@@ -203,6 +607,31 @@ MP_NOINLINE int main_(int argc, char **argv) {
                 }
                 a += 1;
                 source_file = argv[a];
+            } else if (strncmp(argv[a], "-j", 2) == 0) {
+                const char *arg = argv[a] + 2;
+                if (*arg == '\0') {
+                    if (a + 1 >= argc) {
+                        exit(usage(argv));
+                    }
+                    arg = argv[++a];
+                }
+                char *end;
+                batch_jobs = strtol(arg, &end, 0);
+                if (*end) {
+                    return usage(argv);
+                }
+            } else if (strcmp(argv[a], "-C") == 0) {
+                if (a + 1 >= argc) {
+                    exit(usage(argv));
+                }
+                a += 1;
+                batch_cache_dir = argv[a];
+            } else if (strcmp(argv[a], "-M") == 0) {
+                if (a + 1 >= argc) {
+                    exit(usage(argv));
+                }
+                a += 1;
+                batch_deps_file = argv[a];
             } else if (strncmp(argv[a], "-msmall-int-bits=", sizeof("-msmall-int-bits=") - 1) == 0) {
                 char *end;
                 mp_dynamic_compiler.small_int_bits =
@@ -219,24 +648,42 @@ MP_NOINLINE int main_(int argc, char **argv) {
                 mp_dynamic_compiler.py_builtins_str_unicode = 0;
             } else if (strcmp(argv[a], "-municode") == 0) {
                 mp_dynamic_compiler.py_builtins_str_unicode = 1;
+            } else if (strcmp(argv[a], "-mcompress") == 0) {
+                mp_dynamic_compiler.mpy_compress_bits = 10;
+            } else if (strncmp(argv[a], "-mcompress=", sizeof("-mcompress=") - 1) == 0) {
+                char *end;
+                long bits = strtol(argv[a] + sizeof("-mcompress=") - 1, &end, 0);
+                if (*end || bits < 8 || bits > 12) {
+                    return usage(argv);
+                }
+                mp_dynamic_compiler.mpy_compress_bits = bits;
+            } else if (strcmp(argv[a], "-mno-compress") == 0) {
+                mp_dynamic_compiler.mpy_compress_bits = 0;
             } else {
                 return usage(argv);
             }
+        } else if (argv[a][0] == '@') {
+            batch_add_list(argv[a] + 1);
         } else {
-            if (input_file != NULL) {
-                mp_printf(&mp_stderr_print, "multiple input files\n");
-                exit(1);
-            }
-            input_file = argv[a];
+            batch_add_path(argv[a]);
         }
     }
 
-    if (input_file == NULL) {
+    if (batch_len == 0) {
         mp_printf(&mp_stderr_print, "no input file\n");
         exit(1);
     }
 
-    int ret = compile_and_save(input_file, output_file, source_file);
+    if (batch_len > 1 && (output_file != NULL || source_file != NULL)) {
+        mp_printf(&mp_stderr_print, "multiple input files\n");
+        exit(1);
+    }
+
+    if (!batch_init_compiler_id(argv[0]) && batch_cache_dir != NULL) {
+        mp_printf(&mp_stderr_print, "can't find the mpy-cross binary, not using the cache\n");
+        batch_cache_dir = NULL;
+    }
+    int ret = batch_run(output_file, source_file);
 
     #if MICROPY_PY_MICROPYTHON_MEM_INFO
     if (mp_verbose_flag) {
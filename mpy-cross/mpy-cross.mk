@@ -71,7 +71,8 @@ SRC_C += \
 	gccollect.c \
 	supervisor/stub/safe_mode.c \
 	supervisor/stub/stack.c \
-	supervisor/shared/translate.c
+	supervisor/shared/translate.c \
+	extmod/crypto-algorithms/sha256.c
 
 # Add fmode when compiling with mingw gcc
 COMPILER_TARGET := $(shell $(CC) -dumpmachine)
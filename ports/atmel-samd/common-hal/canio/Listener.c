@@ -290,6 +290,13 @@ void set_filters(canio_listener_obj_t *self, size_t nmatch, canio_match_obj_t **
 }
 
 
+// True if the other FIFO's listener has the global accept for standard or
+// extended ids
+STATIC bool other_fifo_accepts_all(canio_can_obj_t *can, int fifo_idx) {
+    return can->hw->GFC.bit.ANFS == CAN_GFC_ANFS_RXF1_Val - fifo_idx ||
+           can->hw->GFC.bit.ANFE == CAN_GFC_ANFE_RXF1_Val - fifo_idx;
+}
+
 void common_hal_canio_listener_construct(canio_listener_obj_t *self, canio_can_obj_t *can, size_t nmatch, canio_match_obj_t **matches, float timeout) {
     if (!can->fifo0_in_use) {
         self->fifo_idx = 0;
@@ -307,26 +314,26 @@ void common_hal_canio_listener_construct(canio_listener_obj_t *self, canio_can_o
         mp_raise_ValueError(translate("All RX FIFOs in use"));
     }
 
-    if (!nmatch) {
-        if (can->hw->GFC.bit.ANFS == CAN_GFC_ANFS_RXF1_Val - self->fifo_idx) {
-            mp_raise_ValueError(translate("Already have all-matches listener"));
-        }
-        if (can->hw->GFC.bit.ANFE == CAN_GFC_ANFE_RXF1_Val - self->fifo_idx) {
-            mp_raise_ValueError(translate("Already have all-matches listener"));
-        }
-    }
-
-    if (num_filters_needed(nmatch, matches, false) > num_filters_available(can, false)) {
-        mp_raise_ValueError(translate("Filters too complex"));
+    if (!nmatch && other_fifo_accepts_all(can, self->fifo_idx)) {
+        mp_raise_ValueError(translate("Already have all-matches listener"));
     }
 
-    if (num_filters_needed(nmatch, matches, true) > num_filters_available(can, true)) {
-        mp_raise_ValueError(translate("Filters too complex"));
+    // When the filter elements cannot hold every match, accept everything in
+    // hardware and match in software instead.
+    canio_filter_t *filter = NULL;
+    if (num_filters_needed(nmatch, matches, false) > num_filters_available(can, false) ||
+        num_filters_needed(nmatch, matches, true) > num_filters_available(can, true)) {
+        if (other_fifo_accepts_all(can, self->fifo_idx)) {
+            mp_raise_ValueError(translate("Filters too complex"));
+        }
+        filter = canio_filter_new(nmatch, matches);
     }
 
     // Nothing can fail now so it's safe to assign self->can
     self->can = can;
-    set_filters(self, nmatch, matches);
+    self->filter = filter;
+    self->overruns = 0;
+    set_filters(self, filter ? 0 : nmatch, matches);
     common_hal_canio_listener_set_timeout(self, timeout);
 }
 
@@ -349,32 +356,74 @@ int common_hal_canio_listener_in_waiting(canio_listener_obj_t *self) {
     return self->hw->RXFS.bit.F0FL;
 }
 
-mp_obj_t common_hal_canio_listener_receive(canio_listener_obj_t *self) {
-    if (!common_hal_canio_listener_in_waiting(self)) {
-        uint64_t deadline = supervisor_ticks_ms64() + self->timeout_ms;
-        do {
-            if (supervisor_ticks_ms64() > deadline) {
-                return NULL;
-            }
-        } while (!common_hal_canio_listener_in_waiting(self));
+uint32_t common_hal_canio_listener_get_overruns(canio_listener_obj_t *self) {
+    return self->overruns;
+}
+
+// Takes the next frame that passes the software filter out of the FIFO.
+// Returns false once the FIFO is empty.
+STATIC bool read_frame(canio_listener_obj_t *self, canio_frame_t *frame) {
+    while (true) {
+        if (self->hw->RXFS.bit.RF0L) {
+            self->overruns++;
+            // RXFnS.RFnL mirrors IR.RFnL and is cleared with it
+            self->can->hw->IR.reg = self->fifo_idx ? CAN_IR_RF1L : CAN_IR_RF0L;
+        }
+        if (!self->hw->RXFS.bit.F0FL) {
+            return false;
+        }
+
+        int index = self->hw->RXFS.bit.F0GI;
+        canio_can_rx_fifo_t *hw_message = &self->fifo[index];
+        bool extended = hw_message->rxf0.bit.XTD;
+        bool rtr = hw_message->rxf0.bit.RTR;
+        if (extended) {
+            frame->id = hw_message->rxf0.bit.ID;
+        } else {
+            frame->id = hw_message->rxf0.bit.ID >> 18; // short ids are left-justified
+        }
+        frame->flags = (extended ? CANIO_FRAME_EXTENDED : 0) | (rtr ? CANIO_FRAME_RTR : 0);
+        frame->dlc = hw_message->rxf1.bit.DLC;
+        frame->reserved = 0;
+        memset(frame->data, 0, sizeof(frame->data));
+        if (!rtr) {
+            memcpy(frame->data, hw_message->data, frame->dlc);
+        }
+        self->hw->RXFA.bit.F0AI = index;
+
+        if (canio_filter_matches(self->filter, frame->id, extended)) {
+            frame->timestamp = supervisor_ticks_ms32();
+            return true;
+        }
     }
-    int index = self->hw->RXFS.bit.F0GI;
-    canio_can_rx_fifo_t *hw_message = &self->fifo[index];
-    bool rtr = hw_message->rxf0.bit.RTR;
-    canio_message_obj_t *message = m_new_obj(canio_message_obj_t);
-    message->base.type = rtr ? &canio_remote_transmission_request_type : &canio_message_type;
-    message->extended = hw_message->rxf0.bit.XTD;
-    if (message->extended) {
-        message->id = hw_message->rxf0.bit.ID;
-    } else {
-        message->id = hw_message->rxf0.bit.ID >> 18; // short ids are left-justified
+}
+
+size_t common_hal_canio_listener_receive_into(canio_listener_obj_t *self, void *frames, size_t max_frames) {
+    canio_frame_t frame;
+    uint64_t deadline = supervisor_ticks_ms64() + self->timeout_ms;
+    while (!read_frame(self, &frame)) {
+        if (supervisor_ticks_ms64() > deadline) {
+            return 0;
+        }
     }
-    message->size = hw_message->rxf1.bit.DLC;
-    if (!rtr) {
-        memcpy(message->data, hw_message->data, message->size);
+
+    // Once the first frame is in, drain whatever else is waiting
+    uint8_t *dest = frames;
+    size_t count = 0;
+    do {
+        memcpy(dest, &frame, sizeof(frame));
+        dest += sizeof(frame);
+        count++;
+    } while (count < max_frames && read_frame(self, &frame));
+    return count;
+}
+
+mp_obj_t common_hal_canio_listener_receive(canio_listener_obj_t *self) {
+    canio_frame_t frame;
+    if (!common_hal_canio_listener_receive_into(self, &frame, 1)) {
+        return NULL;
     }
-    self->hw->RXFA.bit.F0AI = index;
-    return message;
+    return canio_message_new_from_frame(&frame);
 }
 
 void common_hal_canio_listener_deinit(canio_listener_obj_t *self) {
@@ -390,5 +439,6 @@ void common_hal_canio_listener_deinit(canio_listener_obj_t *self) {
     self->fifo_idx = -1;
     self->fifo = NULL;
     self->can = NULL;
+    self->filter = NULL;
     self->hw = NULL;
 }
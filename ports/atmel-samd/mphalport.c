@@ -68,6 +68,21 @@ void mp_hal_delay_us(mp_uint_t delay) {
     }
 }
 
+#if MICROPY_PY_BENCHMARK && defined(SAM_D5X_E5X)
+mp_uint_t mp_hal_ticks_cpu(void) {
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    return DWT->CYCCNT;
+}
+
+mp_uint_t mp_hal_ticks_cpu_hz(void) {
+    return common_hal_mcu_processor_get_frequency();
+}
+#endif
+
 void mp_hal_disable_all_interrupts(void) {
     common_hal_mcu_disable_interrupts();
 }
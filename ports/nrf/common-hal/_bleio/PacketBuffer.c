@@ -62,36 +62,58 @@ STATIC void write_to_ringbuf(bleio_packet_buffer_obj_t *self, uint8_t *data, uin
     sd_nvic_critical_region_exit(is_nested_critical_region);
 }
 
+STATIC uint32_t packet_buffer_send(bleio_packet_buffer_obj_t *self, uint8_t *data, uint16_t len) {
+    uint16_t conn_handle = self->conn_handle;
+    if (self->client) {
+        ble_gattc_write_params_t write_params = {
+            .write_op = self->write_type,
+            .handle = self->characteristic->handle,
+            .p_value = data,
+            .len = len,
+        };
+
+        return sd_ble_gattc_write(conn_handle, &write_params);
+    }
+    uint16_t hvx_len = len;
+
+    ble_gatts_hvx_params_t hvx_params = {
+        .handle = self->characteristic->handle,
+        .type = self->write_type,
+        .offset = 0,
+        .p_len = &hvx_len,
+        .p_data = data,
+    };
+    return sd_ble_gatts_hvx(conn_handle, &hvx_params);
+}
+
+STATIC bleio_packet_send_result_t packet_buffer_send_queued(void *context, const uint8_t *data, size_t len) {
+    switch (packet_buffer_send(context, (uint8_t *) data, len)) {
+        case NRF_SUCCESS:
+            return BLEIO_PACKET_SENT;
+        case NRF_ERROR_RESOURCES:
+        case NRF_ERROR_BUSY:
+            return BLEIO_PACKET_BUSY;
+        default:
+            return BLEIO_PACKET_FAILED;
+    }
+}
+
 STATIC uint32_t queue_next_write(bleio_packet_buffer_obj_t *self) {
     // Queue up the next outgoing buffer. We use two, one that has been passed to the SD for
     // transmission (when packet_queued is true) and the other is `pending` and can still be
     // modified. By primarily appending to the `pending` buffer we can reduce the protocol overhead
     // of the lower level link and ATT layers.
     self->packet_queued = false;
+    // Packets from write_packets() are older than the pending buffer. Give the SD as many as it
+    // has TX buffers for, so they all go out in the next connection event.
+    if (bleio_packet_queue_flush(&self->queue, packet_buffer_send_queued, self) > 0) {
+        self->packet_queued = true;
+    }
+    if (!bleio_packet_queue_is_empty(&self->queue)) {
+        return NRF_ERROR_RESOURCES;
+    }
     if (self->pending_size > 0) {
-        uint16_t conn_handle = self->conn_handle;
-        uint32_t err_code;
-        if (self->client) {
-            ble_gattc_write_params_t write_params = {
-                .write_op = self->write_type,
-                .handle = self->characteristic->handle,
-                .p_value = self->outgoing[self->pending_index],
-                .len = self->pending_size,
-            };
-
-            err_code = sd_ble_gattc_write(conn_handle, &write_params);
-        } else {
-            uint16_t hvx_len = self->pending_size;
-
-            ble_gatts_hvx_params_t hvx_params = {
-                .handle = self->characteristic->handle,
-                .type = self->write_type,
-                .offset = 0,
-                .p_len = &hvx_len,
-                .p_data = self->outgoing[self->pending_index],
-            };
-            err_code = sd_ble_gatts_hvx(conn_handle, &hvx_params);
-        }
+        uint32_t err_code = packet_buffer_send(self, self->outgoing[self->pending_index], self->pending_size);
         if (err_code != NRF_SUCCESS) {
             // On error, simply skip updating the pending buffers so that the next HVC or WRITE
             // complete event triggers another attempt.
@@ -172,6 +194,7 @@ STATIC bool packet_buffer_on_ble_server_evt(ble_evt_t *ble_evt, void *param) {
         case BLE_GAP_EVT_DISCONNECTED:
             if (self->conn_handle == ble_evt->evt.gap_evt.conn_handle) {
                 self->conn_handle = BLE_CONN_HANDLE_INVALID;
+                bleio_packet_queue_clear(&self->queue);
             }
             break;
         case BLE_GATTS_EVT_HVN_TX_COMPLETE:
@@ -209,6 +232,9 @@ void common_hal_bleio_packet_buffer_construct(
         }
     }
 
+    bleio_packet_queue_init(&self->queue);
+    self->queue_packets = buffer_size;
+
     if (outgoing) {
         self->packet_queued = false;
         self->pending_index = 0;
@@ -295,6 +321,11 @@ mp_int_t common_hal_bleio_packet_buffer_write(bleio_packet_buffer_obj_t *self, u
         mp_raise_ValueError(translate("Total data to write is larger than outgoing_packet_length"));
     }
 
+    if (!bleio_packet_queue_is_empty(&self->queue)) {
+        // Stay behind the packets already queued by write_packets().
+        return common_hal_bleio_packet_buffer_queue(self, data, len, header, header_len);
+    }
+
     if (len + self->pending_size > outgoing_packet_length) {
         // No room to append len bytes to packet. Wait until we get a free buffer,
         // and keep checking that we haven't been disconnected.
@@ -331,6 +362,54 @@ mp_int_t common_hal_bleio_packet_buffer_write(bleio_packet_buffer_obj_t *self, u
     return num_bytes_written;
 }
 
+mp_int_t common_hal_bleio_packet_buffer_queue(bleio_packet_buffer_obj_t *self, uint8_t *data, size_t len, uint8_t* header, size_t header_len) {
+    if (self->outgoing[0] == NULL) {
+        mp_raise_bleio_BluetoothError(translate("Writes not supported on Characteristic"));
+    }
+    if (self->conn_handle == BLE_CONN_HANDLE_INVALID) {
+        return -1;
+    }
+    if (len + header_len > (size_t) common_hal_bleio_packet_buffer_get_outgoing_packet_length(self)) {
+        // Supplied data will not fit in a single BLE packet.
+        mp_raise_ValueError(translate("Total data to write is larger than outgoing_packet_length"));
+    }
+    if (!bleio_packet_queue_allocated(&self->queue) &&
+        !bleio_packet_queue_alloc(&self->queue, self->queue_packets, self->characteristic->max_length)) {
+        mp_raise_ValueError(translate("Buffer too large and unable to allocate"));
+    }
+
+    while (true) {
+        uint8_t is_nested_critical_region;
+        sd_nvic_critical_region_enter(&is_nested_critical_region);
+        // Queue the pending buffer first to keep the writes in order.
+        if (self->pending_size > 0 &&
+            bleio_packet_queue_put(&self->queue, NULL, 0, self->outgoing[self->pending_index], self->pending_size)) {
+            self->pending_size = 0;
+        }
+        bool queued = self->pending_size == 0 &&
+            bleio_packet_queue_put(&self->queue, header, header_len, data, len);
+        // Hand over whatever the SD has room for. If it was all sent already there is no TX
+        // complete event to come that would do it.
+        queue_next_write(self);
+        sd_nvic_critical_region_exit(is_nested_critical_region);
+        if (queued) {
+            return header_len + len;
+        }
+        // The queue is full. Wait for the SD to make room, and keep checking that we haven't
+        // been disconnected.
+        RUN_BACKGROUND_TASKS;
+        if (self->conn_handle == BLE_CONN_HANDLE_INVALID) {
+            return -1;
+        }
+    }
+}
+
+void common_hal_bleio_packet_buffer_get_write_stats(bleio_packet_buffer_obj_t *self, uint32_t *queued, uint32_t *sent, uint32_t *dropped) {
+    *queued = self->queue.queued;
+    *sent = self->queue.sent;
+    *dropped = self->queue.dropped;
+}
+
 mp_int_t common_hal_bleio_packet_buffer_get_incoming_packet_length(bleio_packet_buffer_obj_t *self) {
     // If this PacketBuffer is coming from a remote service via NOTIFY or INDICATE
     // the maximum size is what can be sent in one
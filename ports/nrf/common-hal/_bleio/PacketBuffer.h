@@ -31,6 +31,7 @@
 
 #include "py/ringbuf.h"
 #include "shared-bindings/_bleio/Characteristic.h"
+#include "shared-module/_bleio/PacketQueue.h"
 
 typedef struct {
     mp_obj_base_t base;
@@ -41,6 +42,10 @@ typedef struct {
     // the other is waiting to be queued and can be extended.
     uint8_t* outgoing[2];
     volatile uint16_t pending_size;
+    // Whole packets from write_packets(), allocated on first use. Anything
+    // in the queue goes out before the pending buffer.
+    bleio_packet_queue_t queue;
+    uint16_t queue_packets;
     // We remember the conn_handle so we can do a NOTIFY/INDICATE to a client.
     // We can find out the conn_handle on a Characteristic write or a CCCD write (but not a read).
     volatile uint16_t conn_handle;
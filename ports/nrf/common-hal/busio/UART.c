@@ -246,14 +246,10 @@ size_t common_hal_busio_uart_read(busio_uart_obj_t *self, uint8_t *data, size_t
         }
     }
 
-    // prevent conflict with uart irq
-    NVIC_DisableIRQ(nrfx_get_irq_number(self->uarte->p_reg));
-
-    // Copy as much received data as available, up to len bytes.
+    // Copy as much received data as available, up to len bytes. The ring
+    // buffer is safe against the uart irq, so it doesn't need disabling.
     size_t rx_bytes = ringbuf_get_n(&self->ringbuf, data, len);
 
-    NVIC_EnableIRQ(nrfx_get_irq_number(self->uarte->p_reg));
-
     return rx_bytes;
 }
 
@@ -311,10 +307,7 @@ uint32_t common_hal_busio_uart_rx_characters_available(busio_uart_obj_t *self) {
 }
 
 void common_hal_busio_uart_clear_rx_buffer(busio_uart_obj_t *self) {
-    // prevent conflict with uart irq
-    NVIC_DisableIRQ(nrfx_get_irq_number(self->uarte->p_reg));
     ringbuf_clear(&self->ringbuf);
-    NVIC_EnableIRQ(nrfx_get_irq_number(self->uarte->p_reg));
 }
 
 bool common_hal_busio_uart_ready_to_tx(busio_uart_obj_t *self) {
@@ -26,6 +26,7 @@
 
 #include <stdint.h>
 #include "supervisor/port.h"
+#include "py/mphal.h"
 #include "boards/board.h"
 
 #include "nrfx/hal/nrf_clock.h"
@@ -273,6 +274,21 @@ uint32_t port_get_saved_word(void) {
     return _saved_word;
 }
 
+#if MICROPY_PY_BENCHMARK
+mp_uint_t mp_hal_ticks_cpu(void) {
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    return DWT->CYCCNT;
+}
+
+mp_uint_t mp_hal_ticks_cpu_hz(void) {
+    return SystemCoreClock;
+}
+#endif
+
 uint64_t port_get_raw_ticks(uint8_t* subticks) {
     common_hal_mcu_disable_interrupts();
     uint32_t rtc = nrfx_rtc_counter_get(&rtc_instance);
@@ -50,6 +50,14 @@ char serial_read(void) {
     return (char) ble_uart_rx_chr();
 }
 
+uint32_t serial_read_into(uint8_t* buf, uint32_t len) {
+    uint32_t count = 0;
+    while (count < len && serial_bytes_available()) {
+        buf[count++] = serial_read();
+    }
+    return count;
+}
+
 bool serial_bytes_available(void) {
     return ble_uart_stdin_any();
 }
@@ -97,6 +105,14 @@ char serial_read(void) {
     return data;
 }
 
+uint32_t serial_read_into(uint8_t* buf, uint32_t len) {
+    uint32_t count = 0;
+    while (count < len && serial_bytes_available()) {
+        buf[count++] = serial_read();
+    }
+    return count;
+}
+
 bool serial_bytes_available(void) {
     return nrf_uarte_event_check(serial_instance.p_reg, NRF_UARTE_EVENT_RXDRDY);
 }
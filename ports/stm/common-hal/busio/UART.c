@@ -219,7 +219,12 @@ void common_hal_busio_uart_construct(busio_uart_obj_t *self,
     // Init buffer for rx and claim pins
     if (self->rx != NULL) {
         if (receiver_buffer != NULL) {
-            self->ringbuf = (ringbuf_t){ receiver_buffer, receiver_buffer_size };
+            // ringbuf_init would silently use only the largest power of two
+            // that fits, so refuse a buffer it can't use in full.
+            if ((receiver_buffer_size & (receiver_buffer_size - 1)) != 0) {
+                mp_raise_ValueError_varg(translate("%q must be a power of 2"), MP_QSTR_receiver_buffer_size);
+            }
+            ringbuf_init(&self->ringbuf, receiver_buffer, receiver_buffer_size);
         } else {
             if (!ringbuf_alloc(&self->ringbuf, receiver_buffer_size, true)) {
                 mp_raise_ValueError(translate("UART Buffer allocation error"));
@@ -305,11 +310,9 @@ size_t common_hal_busio_uart_read(busio_uart_obj_t *self, uint8_t *data, size_t
         }
     }
 
-    // Halt reception
-    HAL_NVIC_DisableIRQ(self->irq);
-    // Copy as much received data as available, up to len bytes.
+    // Copy as much received data as available, up to len bytes. The ring
+    // buffer is safe against the RX interrupt, so reception continues.
     size_t rx_bytes = ringbuf_get_n(&self->ringbuf, data, len);
-    HAL_NVIC_EnableIRQ(self->irq);
 
     if (rx_bytes == 0) {
         *errcode = EAGAIN;
@@ -418,10 +421,7 @@ uint32_t common_hal_busio_uart_rx_characters_available(busio_uart_obj_t *self) {
 }
 
 void common_hal_busio_uart_clear_rx_buffer(busio_uart_obj_t *self) {
-    // Halt reception
-    HAL_NVIC_DisableIRQ(self->irq);
     ringbuf_clear(&self->ringbuf);
-    HAL_NVIC_EnableIRQ(self->irq);
 }
 
 bool common_hal_busio_uart_ready_to_tx(busio_uart_obj_t *self) {
@@ -234,15 +234,23 @@ void common_hal_canio_listener_construct(canio_listener_obj_t *self, canio_can_o
         mp_raise_ValueError(translate("All RX FIFOs in use"));
     }
 
+    // When the banks cannot hold every match, accept everything in hardware
+    // and match in software instead.
+    canio_filter_t *filter = NULL;
     if (num_filters_needed(nmatch, matches) > num_filters_available(can)) {
-        mp_raise_ValueError(translate("Filters too complex"));
+        if (num_filters_available(can) < 1) {
+            mp_raise_ValueError(translate("Filters too complex"));
+        }
+        filter = canio_filter_new(nmatch, matches);
     }
 
     // Nothing can fail now so it's safe to assign self->can
     self->can = can;
+    self->filter = filter;
+    self->overruns = 0;
 
     self->mailbox = &can->handle.Instance->sFIFOMailBox[self->fifo_idx];
-    set_filters(self, nmatch, matches);
+    set_filters(self, filter ? 0 : nmatch, matches);
     common_hal_canio_listener_set_timeout(self, timeout);
 }
 
@@ -265,37 +273,76 @@ int common_hal_canio_listener_in_waiting(canio_listener_obj_t *self) {
     return *(self->rfr) & CAN_RF0R_FMP0;
 }
 
-mp_obj_t common_hal_canio_listener_receive(canio_listener_obj_t *self) {
-    if (!common_hal_canio_listener_in_waiting(self)) {
-        uint64_t deadline = supervisor_ticks_ms64() + self->timeout_ms;
-        do {
-            if (supervisor_ticks_ms64() > deadline) {
-                return NULL;
-            }
-        } while (!common_hal_canio_listener_in_waiting(self));
-    }
+uint32_t common_hal_canio_listener_get_overruns(canio_listener_obj_t *self) {
+    return self->overruns;
+}
 
-    uint32_t rir = self->mailbox->RIR;
-    uint32_t rdtr = self->mailbox->RDTR;
+// Takes the next frame that passes the software filter out of the FIFO.
+// Returns false once the FIFO is empty.
+STATIC bool read_frame(canio_listener_obj_t *self, canio_frame_t *frame) {
+    while (true) {
+        uint32_t rfr = *self->rfr;
+        if (rfr & CAN_RF0R_FOVR0) {
+            self->overruns++;
+            // The flags are cleared by writing 1, so write only this one
+            *self->rfr = CAN_RF0R_FOVR0;
+        }
+        if (!(rfr & CAN_RF0R_FMP0)) {
+            return false;
+        }
 
-    bool rtr = rir & CAN_RI0R_RTR;
-    canio_message_obj_t *message = m_new_obj(canio_message_obj_t);
-    message->base.type = rtr ? &canio_remote_transmission_request_type : &canio_message_type;
-    message->extended = rir & CAN_RI0R_IDE;
-    if (message->extended) {
-        message->id = rir >> 3;
-    } else {
-        message->id = rir >> 21;
+        uint32_t rir = self->mailbox->RIR;
+        uint32_t rdtr = self->mailbox->RDTR;
+
+        bool extended = rir & CAN_RI0R_IDE;
+        bool rtr = rir & CAN_RI0R_RTR;
+        frame->id = extended ? rir >> 3 : rir >> 21;
+        frame->flags = (extended ? CANIO_FRAME_EXTENDED : 0) | (rtr ? CANIO_FRAME_RTR : 0);
+        frame->dlc = rdtr & CAN_RDT0R_DLC;
+        frame->reserved = 0;
+        if (rtr) {
+            memset(frame->data, 0, sizeof(frame->data));
+        } else {
+            uint32_t payload[] = { self->mailbox->RDLR, self->mailbox->RDHR };
+            MP_STATIC_ASSERT(sizeof(payload) == sizeof(frame->data));
+            memcpy(frame->data, payload, sizeof(payload));
+        }
+        // Release the mailbox, without writing 1 to the overrun flag
+        *self->rfr = CAN_RF0R_RFOM0;
+
+        if (canio_filter_matches(self->filter, frame->id, extended)) {
+            frame->timestamp = supervisor_ticks_ms32();
+            return true;
+        }
+    }
+}
+
+size_t common_hal_canio_listener_receive_into(canio_listener_obj_t *self, void *frames, size_t max_frames) {
+    canio_frame_t frame;
+    uint64_t deadline = supervisor_ticks_ms64() + self->timeout_ms;
+    while (!read_frame(self, &frame)) {
+        if (supervisor_ticks_ms64() > deadline) {
+            return 0;
+        }
     }
-    message->size = rdtr & CAN_RDT0R_DLC;
-    if (!rtr) {
-        uint32_t payload[] = { self->mailbox->RDLR, self->mailbox->RDHR };
-        MP_STATIC_ASSERT(sizeof(payload) == sizeof(message->data));
-        memcpy(message->data, payload, sizeof(payload));
+
+    // Once the first frame is in, drain whatever else is waiting
+    uint8_t *dest = frames;
+    size_t count = 0;
+    do {
+        memcpy(dest, &frame, sizeof(frame));
+        dest += sizeof(frame);
+        count++;
+    } while (count < max_frames && read_frame(self, &frame));
+    return count;
+}
+
+mp_obj_t common_hal_canio_listener_receive(canio_listener_obj_t *self) {
+    canio_frame_t frame;
+    if (!common_hal_canio_listener_receive_into(self, &frame, 1)) {
+        return NULL;
     }
-    // Release the mailbox
-    SET_BIT(*self->rfr, CAN_RF0R_RFOM0);
-    return message;
+    return canio_message_new_from_frame(&frame);
 }
 
 void common_hal_canio_listener_deinit(canio_listener_obj_t *self) {
@@ -310,6 +357,7 @@ void common_hal_canio_listener_deinit(canio_listener_obj_t *self) {
     }
     self->fifo_idx = -1;
     self->can = NULL;
+    self->filter = NULL;
     self->mailbox = NULL;
     self->rfr = NULL;
 }
@@ -27,6 +27,7 @@
 #pragma once
 
 #include "common-hal/canio/CAN.h"
+#include "shared-module/canio/Filter.h"
 #include "shared-module/canio/Match.h"
 
 typedef struct canio_listener_obj {
@@ -34,6 +35,9 @@ typedef struct canio_listener_obj {
     canio_can_obj_t *can;
     CAN_FIFOMailBox_TypeDef *mailbox;
     __IO uint32_t *rfr;
+    // Software filter used when the hardware filters cannot hold the matches
+    canio_filter_t *filter;
     uint32_t timeout_ms;
+    uint32_t overruns;
     uint8_t fifo_idx;
 } canio_listener_obj_t;
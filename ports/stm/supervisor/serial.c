@@ -58,6 +58,14 @@ char serial_read(void) {
     return data;
 }
 
+uint32_t serial_read_into(uint8_t* buf, uint32_t len) {
+    uint32_t count = 0;
+    while (count < len && serial_bytes_available()) {
+        buf[count++] = serial_read();
+    }
+    return count;
+}
+
 bool serial_bytes_available(void) {
     return __HAL_UART_GET_FLAG(&huart2, UART_FLAG_RXNE);
 }
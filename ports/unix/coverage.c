@@ -1,3 +1,5 @@
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -13,6 +15,13 @@
 #include "py/stream.h"
 #include "py/binary.h"
 #include "py/bc.h"
+#include "py/mphal.h"
+#include "py/ringbuf.h"
+#include "shared-module/_bleio/PacketQueue.h"
+#include "shared-module/_bleio/ScanFilter.h"
+#include "shared-bindings/canio/Match.h"
+#include "shared-module/canio/Filter.h"
+#include "shared-module/canio/Frame.h"
 
 #if defined(MICROPY_UNIX_COVERAGE)
 
@@ -140,6 +149,277 @@ STATIC const mp_obj_type_t mp_type_stest_textio2 = {
 STATIC const mp_obj_str_t str_no_hash_obj = {{&mp_type_str}, 0, 10, (const byte*)"0123456789"};
 STATIC const mp_obj_str_t bytes_no_hash_obj = {{&mp_type_bytes}, 0, 10, (const byte*)"0123456789"};
 
+// Streams bytes through a ring buffer from a producer thread to the calling
+// thread, and returns how many arrived out of order.
+typedef struct _ringbuf_producer_t {
+    ringbuf_t *ring;
+    size_t total;
+    size_t chunk;
+} ringbuf_producer_t;
+
+STATIC void *ringbuf_producer(void *arg) {
+    ringbuf_producer_t *p = arg;
+    uint8_t buf[256];
+    size_t pos = 0;
+    while (pos < p->total) {
+        size_t len = p->total - pos < p->chunk ? p->total - pos : p->chunk;
+        for (size_t i = 0; i < len; ++i) {
+            buf[i] = (pos + i) & 0xff;
+        }
+        size_t done = 0;
+        while (done < len) {
+            size_t n = ringbuf_put_n(p->ring, buf + done, len - done);
+            if (n == 0) {
+                // let the consumer run if we share a CPU
+                sched_yield();
+            }
+            done += n;
+        }
+        pos += len;
+    }
+    return NULL;
+}
+
+STATIC mp_int_t ringbuf_threaded(size_t total, size_t chunk) {
+    static uint8_t storage[4096];
+    ringbuf_t ring;
+    ringbuf_init(&ring, storage, sizeof(storage));
+    ringbuf_producer_t producer = { &ring, total, chunk };
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, ringbuf_producer, &producer);
+    uint8_t buf[256];
+    size_t pos = 0;
+    mp_int_t errors = 0;
+    while (pos < producer.total) {
+        size_t n = ringbuf_get_n(&ring, buf, producer.chunk);
+        if (n == 0) {
+            sched_yield();
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (buf[i] != ((pos + i) & 0xff)) {
+                ++errors;
+            }
+        }
+        pos += n;
+    }
+    pthread_join(thread, NULL);
+    return errors;
+}
+
+// Callback for the scheduler burst test: counts the callbacks run and those
+// that ran out of the order they were queued in.
+STATIC struct {
+    mp_int_t runs;
+    mp_int_t next;
+    mp_int_t out_of_order;
+} sched_burst_state;
+
+STATIC mp_obj_t sched_burst_callback(mp_obj_t seq_in) {
+    if (MP_OBJ_SMALL_INT_VALUE(seq_in) != sched_burst_state.next) {
+        ++sched_burst_state.out_of_order;
+    }
+    sched_burst_state.next = MP_OBJ_SMALL_INT_VALUE(seq_in) + 1;
+    ++sched_burst_state.runs;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(sched_burst_callback_obj, sched_burst_callback);
+
+// Feeds n synthetic advertisements through a prefix filter into a record ring
+// the way _bleio.ScanResults does, draining the ring whenever it fills.
+// Returns the number of packets that passed the filter, or -1 if a different
+// number came out of the ring.
+STATIC mp_int_t bleio_scan_pipeline(mp_int_t n) {
+    static const uint8_t prefixes[] = {
+        3, 0xff, 0x4c, 0x00, // Apple manufacturer data
+        3, 0x16, 0x0a, 0x18, // device information service data
+        3, 0x16, 0x0f, 0x18, // battery service data
+    };
+    static uint32_t storage[1024];
+    bleio_scanfilter_t *filter = bleio_scanfilter_new(prefixes, sizeof(prefixes));
+    ringbuf_t ring;
+    ringbuf_init(&ring, (uint8_t *)storage, sizeof(storage));
+
+    uint32_t seed = 1;
+    mp_int_t accepted = 0;
+    mp_int_t received = 0;
+    for (mp_int_t i = 0; i < n; ++i) {
+        uint8_t adv[31] = {2, 0x01, 0x06};
+        seed = seed * 1103515245 + 12345;
+        uint8_t len = 3;
+        switch ((seed >> 16) & 3) {
+            case 0:
+                adv[len++] = 5;
+                adv[len++] = 0xff;
+                adv[len++] = 0x4c;
+                adv[len++] = (seed >> 24) & 1;
+                break;
+            case 1:
+                adv[len++] = 5;
+                adv[len++] = 0x16;
+                adv[len++] = 0x0a + ((seed >> 24) & 7);
+                adv[len++] = 0x18;
+                break;
+            default:
+                adv[len++] = 5;
+                adv[len++] = 0x09;
+                break;
+        }
+        len = 3 + adv[3] + 1;
+        for (uint8_t k = 0; k < 31 - len && k < ((seed >> 8) & 15); ++k) {
+            adv[len++] = k;
+        }
+
+        if (!bleio_scanfilter_matches(filter, adv, len)) {
+            continue;
+        }
+        ++accepted;
+        uint8_t *p;
+        while ((p = ringbuf_record_reserve(&ring, 16 + len)) == NULL) {
+            size_t record_len;
+            while (ringbuf_record_peek(&ring, &record_len) != NULL) {
+                ringbuf_record_release(&ring);
+                ++received;
+            }
+        }
+        memset(p, 0, 16);
+        memcpy(p + 16, adv, len);
+        ringbuf_record_commit(&ring, 16 + len);
+    }
+    size_t record_len;
+    while (ringbuf_record_peek(&ring, &record_len) != NULL) {
+        ringbuf_record_release(&ring);
+        ++received;
+    }
+    return received == accepted ? accepted : -1;
+}
+
+// Stand-in for the BLE stack's transmit buffers: each connection event frees
+// them all, and a packet starting with 0xff is rejected.
+typedef struct {
+    size_t free;
+    size_t sent;
+} bleio_stub_link_t;
+
+STATIC bleio_packet_send_result_t bleio_stub_link_send(void *context, const uint8_t *data, size_t len) {
+    bleio_stub_link_t *link = context;
+    if (len > 0 && data[0] == 0xff) {
+        return BLEIO_PACKET_FAILED;
+    }
+    if (link->free == 0) {
+        return BLEIO_PACKET_BUSY;
+    }
+    link->free--;
+    link->sent++;
+    return BLEIO_PACKET_SENT;
+}
+
+// A CAN controller's receive FIFO as seen in loopback mode: sent frames land
+// in the FIFO, and a frame sent while it is full is lost and flags an
+// overrun.  This is not a virtual CAN backend for the canio module; it only
+// feeds the filter and overrun checks below.
+#define CANIO_LOOPBACK_DEPTH (32)
+
+typedef struct {
+    canio_frame_t fifo[CANIO_LOOPBACK_DEPTH];
+    size_t head;
+    size_t count;
+    bool overrun;
+} canio_loopback_t;
+
+STATIC void canio_loopback_send(canio_loopback_t *bus, uint32_t id, bool extended, uint8_t dlc) {
+    if (bus->count == CANIO_LOOPBACK_DEPTH) {
+        bus->overrun = true;
+        return;
+    }
+    canio_frame_t *frame = &bus->fifo[(bus->head + bus->count) % CANIO_LOOPBACK_DEPTH];
+    frame->id = id;
+    frame->flags = extended ? CANIO_FRAME_EXTENDED : 0;
+    frame->dlc = dlc;
+    memset(frame->data, dlc, sizeof(frame->data));
+    bus->count++;
+}
+
+// A copy of the logic in the ports' read_frame(), not the port code itself:
+// counts overruns and drops frames that fail the filter. filter is a
+// canio_filter_t, or with nmatch > 0 the matches are checked one by one
+// instead.
+STATIC bool canio_loopback_read(canio_loopback_t *bus, const canio_filter_t *filter, size_t nmatch, canio_match_obj_t *matches, uint32_t *overruns, canio_frame_t *frame) {
+    while (true) {
+        if (bus->overrun) {
+            (*overruns)++;
+            bus->overrun = false;
+        }
+        if (bus->count == 0) {
+            return false;
+        }
+        *frame = bus->fifo[bus->head];
+        bus->head = (bus->head + 1) % CANIO_LOOPBACK_DEPTH;
+        bus->count--;
+        frame->timestamp = 0;
+
+        bool extended = frame->flags & CANIO_FRAME_EXTENDED;
+        bool match = nmatch == 0 && canio_filter_matches(filter, frame->id, extended);
+        for (size_t i = 0; i < nmatch && !match; i++) {
+            match = matches[i].extended == extended && ((frame->id ^ (uint32_t)matches[i].id) & (uint32_t)matches[i].mask) == 0;
+        }
+        if (match) {
+            return true;
+        }
+    }
+}
+
+// Bursts of up to 48 frames, n in total, go through the loopback FIFO to a
+// listener with 40 matches that drains them 64 at a time the way
+// Listener.receive_into() does. Runs once with the compiled filter and once
+// checking the matches one by one. Returns the frames accepted, or -1 if the
+// two runs differ, and sets the overruns.
+STATIC mp_int_t canio_loopback_pipeline(mp_int_t n, uint32_t *overruns_out) {
+    canio_match_obj_t matches[40];
+    canio_match_obj_t *match_ptrs[MP_ARRAY_SIZE(matches)];
+    for (size_t i = 0; i < MP_ARRAY_SIZE(matches); i++) {
+        if (i < 32) {
+            // every other standard id from 0x100
+            common_hal_canio_match_construct(&matches[i], 0x100 + 2 * i, 0x7ff, false);
+        } else {
+            // J1939 style: a PGN from any source address, any priority
+            common_hal_canio_match_construct(&matches[i], (0xfe00 + i) << 8, 0x3ffff00, true);
+        }
+        match_ptrs[i] = &matches[i];
+    }
+    canio_filter_t *filter = canio_filter_new(MP_ARRAY_SIZE(matches), match_ptrs);
+
+    mp_int_t accepted[2] = {0, 0};
+    uint32_t overruns[2] = {0, 0};
+    for (int pass = 0; pass < 2; pass++) {
+        static canio_loopback_t bus;
+        static canio_frame_t frames[64];
+        memset(&bus, 0, sizeof(bus));
+        uint32_t seed = 1;
+        for (mp_int_t sent = 0; sent < n;) {
+            seed = seed * 1103515245 + 12345;
+            for (uint32_t burst = 1 + ((seed >> 26) * 3 >> 2); burst > 0 && sent < n; burst--, sent++) {
+                seed = seed * 1103515245 + 12345;
+                if (seed & 0x10000) {
+                    canio_loopback_send(&bus, 0x100 + ((seed >> 20) & 0x7f), false, 8);
+                } else {
+                    canio_loopback_send(&bus, ((seed >> 20) & 7) << 26 | (0xfe00 + 24 + ((seed >> 8) & 31)) << 8 | (seed >> 24), true, 8);
+                }
+            }
+            size_t count = 0;
+            while (count < MP_ARRAY_SIZE(frames) &&
+                   canio_loopback_read(&bus, filter, pass ? MP_ARRAY_SIZE(matches) : 0, matches, &overruns[pass], &frames[count])) {
+                count++;
+            }
+            accepted[pass] += count;
+        }
+    }
+
+    *overruns_out = overruns[0];
+    bool same = accepted[0] == accepted[1] && overruns[0] == overruns[1];
+    return same ? accepted[0] : -1;
+}
+
 // function to run extra tests for things that can't be checked by scripts
 STATIC mp_obj_t extra_coverage(void) {
     // mp_printf (used by ports that don't have a native printf)
@@ -403,6 +683,9 @@ STATIC mp_obj_t extra_coverage(void) {
             mp_printf(&mp_plat_print, "sched(%d)=%d\n", i, mp_sched_schedule(MP_OBJ_FROM_PTR(&mp_builtin_print_obj), MP_OBJ_NEW_SMALL_INT(i)));
         }
 
+        // a high priority callback has its own queue and runs first
+        mp_printf(&mp_plat_print, "sched(high)=%d\n", mp_sched_schedule_priority(MP_OBJ_FROM_PTR(&mp_builtin_print_obj), MP_OBJ_NEW_SMALL_INT(10), MP_SCHED_PRIORITY_HIGH));
+
         // test nested locking/unlocking
         mp_sched_lock();
         mp_sched_unlock();
@@ -418,6 +701,259 @@ STATIC mp_obj_t extra_coverage(void) {
         while (mp_sched_num_pending()) {
             mp_handle_pending();
         }
+        mp_printf(&mp_plat_print, "pending=%d peak=%d dropped=%d\n", (int)MP_STATE_VM(sched_len), (int)MP_STATE_VM(sched_peak), (int)MP_STATE_VM(sched_dropped));
+    }
+
+    // scheduler bursts, as queued by an interrupt handler between VM checks:
+    // the callbacks run in order and only those beyond the queue depth drop
+    {
+        mp_printf(&mp_plat_print, "# scheduler bursts\n");
+        memset(&sched_burst_state, 0, sizeof(sched_burst_state));
+        mp_int_t dropped = MP_STATE_VM(sched_dropped);
+        mp_int_t queued = 0;
+        mp_int_t expected_dropped = 0;
+        for (int i = 0; i < 200; ++i) {
+            int burst = i % (MICROPY_SCHEDULER_DEPTH + 3);
+            // a dropped callback leaves a gap, so restart the sequence
+            sched_burst_state.next = queued;
+            for (int j = 0; j < burst; ++j) {
+                if (mp_sched_schedule(MP_OBJ_FROM_PTR(&sched_burst_callback_obj), MP_OBJ_NEW_SMALL_INT(queued))) {
+                    ++queued;
+                }
+            }
+            if (burst > MICROPY_SCHEDULER_DEPTH) {
+                expected_dropped += burst - MICROPY_SCHEDULER_DEPTH;
+            }
+            while (mp_sched_num_pending()) {
+                mp_handle_pending();
+            }
+        }
+        mp_printf(&mp_plat_print, "%d %d %d\n", (int)sched_burst_state.runs, sched_burst_state.runs == queued,
+            (int)sched_burst_state.out_of_order);
+        mp_printf(&mp_plat_print, "%d\n", MP_STATE_VM(sched_dropped) - dropped == expected_dropped);
+    }
+
+    // ringbuf
+    {
+        mp_printf(&mp_plat_print, "# ringbuf\n");
+
+        // only the largest power of two that fits in the storage is used
+        uint8_t storage[10];
+        ringbuf_t ring;
+        ringbuf_init(&ring, storage, sizeof(storage));
+        mp_printf(&mp_plat_print, "%d %d %d\n", (int)ringbuf_capacity(&ring), (int)ringbuf_num_filled(&ring), (int)ringbuf_num_empty(&ring));
+
+        // fill byte by byte until full
+        for (int i = 0; i < 9; ++i) {
+            if (ringbuf_put(&ring, i) < 0) {
+                mp_printf(&mp_plat_print, "full at %d\n", i);
+            }
+        }
+        for (int i = 0; i < 3; ++i) {
+            mp_printf(&mp_plat_print, "%d ", ringbuf_get(&ring));
+        }
+        mp_printf(&mp_plat_print, "\n");
+
+        // bulk put and get wrap around the end of the storage
+        const uint8_t data[] = {10, 11, 12, 13, 14};
+        mp_printf(&mp_plat_print, "%d\n", (int)ringbuf_put_n(&ring, data, sizeof(data)));
+        uint8_t out[16];
+        size_t n = ringbuf_get_n(&ring, out, sizeof(out));
+        for (size_t i = 0; i < n; ++i) {
+            mp_printf(&mp_plat_print, "%d ", out[i]);
+        }
+        mp_printf(&mp_plat_print, "\n");
+
+        // clear discards pending data
+        ringbuf_put_n(&ring, data, 2);
+        ringbuf_clear(&ring);
+        mp_printf(&mp_plat_print, "%d %d\n", (int)ringbuf_num_filled(&ring), ringbuf_get(&ring));
+    }
+
+    // ringbuf between a producer thread and a consumer
+    {
+        mp_printf(&mp_plat_print, "# ringbuf threads\n");
+        static const size_t chunks[] = {1, 7, 64, 256};
+        for (size_t i = 0; i < MP_ARRAY_SIZE(chunks); ++i) {
+            mp_printf(&mp_plat_print, "%d%s", (int)ringbuf_threaded(1 << 16, chunks[i]), i + 1 < MP_ARRAY_SIZE(chunks) ? " " : "\n");
+        }
+    }
+
+    // ringbuf records
+    {
+        mp_printf(&mp_plat_print, "# ringbuf records\n");
+
+        uint32_t storage[8];
+        ringbuf_t ring;
+        ringbuf_init(&ring, (uint8_t *)storage, sizeof(storage));
+
+        // each record takes a length word and is padded to 4 bytes, so a
+        // third one doesn't fit
+        for (int i = 0; i < 3; ++i) {
+            mp_printf(&mp_plat_print, "%d ", ringbuf_record_put(&ring, (const uint8_t *)"abcde", 5));
+        }
+        mp_printf(&mp_plat_print, "\n");
+
+        // a record that doesn't fit before the end starts again at the beginning
+        size_t len;
+        uint8_t *p = ringbuf_record_peek(&ring, &len);
+        mp_printf(&mp_plat_print, "%.*s\n", (int)len, p);
+        ringbuf_record_release(&ring);
+        mp_printf(&mp_plat_print, "%d\n", ringbuf_record_put(&ring, (const uint8_t *)"fghijklm", 8));
+        while ((p = ringbuf_record_peek(&ring, &len)) != NULL) {
+            mp_printf(&mp_plat_print, "%.*s %d\n", (int)len, p, (int)(p - (uint8_t *)storage));
+            ringbuf_record_release(&ring);
+        }
+
+        // zero-length records
+        ringbuf_record_put(&ring, NULL, 0);
+        p = ringbuf_record_peek(&ring, &len);
+        mp_printf(&mp_plat_print, "%d %d\n", p != NULL, (int)len);
+        ringbuf_record_release(&ring);
+        mp_printf(&mp_plat_print, "%d\n", ringbuf_record_peek(&ring, &len) != NULL);
+    }
+
+    // BLE packet queue
+    {
+        mp_printf(&mp_plat_print, "# bleio packet queue\n");
+
+        bleio_packet_queue_t queue;
+        bleio_packet_queue_init(&queue);
+        mp_printf(&mp_plat_print, "%d %d\n", bleio_packet_queue_allocated(&queue), bleio_packet_queue_put(&queue, NULL, 0, NULL, 0));
+        bleio_packet_queue_alloc(&queue, 4, 20);
+        mp_printf(&mp_plat_print, "%d %d\n", bleio_packet_queue_allocated(&queue), bleio_packet_queue_is_empty(&queue));
+
+        // 10 keyboard reports with a link that has 3 TX buffers per connection
+        // event: flushing on every TX complete event sends them in 4 events
+        // rather than 10
+        const uint8_t header[] = {1};
+        const uint8_t report[8] = {0, 0, 4};
+        bleio_stub_link_t link = {0, 0};
+        int reports = 0;
+        int events = 0;
+        while (reports < 10 || !bleio_packet_queue_is_empty(&queue)) {
+            while (reports < 10 && bleio_packet_queue_put(&queue, header, sizeof(header), report, sizeof(report))) {
+                ++reports;
+            }
+            ++events;
+            link.free = 3;
+            bleio_packet_queue_flush(&queue, bleio_stub_link_send, &link);
+        }
+        mp_printf(&mp_plat_print, "%d %d %d %d %d\n", events, (int)link.sent, (int)queue.queued, (int)queue.sent, (int)queue.dropped);
+
+        // rejected packets are dropped; busy ones stay queued until cleared
+        const uint8_t bad[] = {0xff};
+        bleio_packet_queue_put(&queue, NULL, 0, bad, sizeof(bad));
+        bleio_packet_queue_put(&queue, header, sizeof(header), report, sizeof(report));
+        link.free = 0;
+        mp_printf(&mp_plat_print, "%d ", (int)bleio_packet_queue_flush(&queue, bleio_stub_link_send, &link));
+        bleio_packet_queue_clear(&queue);
+        mp_printf(&mp_plat_print, "%d %d %d %d\n", bleio_packet_queue_is_empty(&queue), (int)queue.queued, (int)queue.sent, (int)queue.dropped);
+        ringbuf_free(&queue.ring);
+    }
+
+    // BLE scan prefix filter
+    {
+        mp_printf(&mp_plat_print, "# bleio scan filter\n");
+
+        // the one byte prefix 0x09 covers the longer one
+        static const uint8_t prefixes[] = {3, 0xff, 0x4c, 0x00, 1, 0x09, 3, 0x09, 'a', 'b', 3, 0x16, 0x0a, 0x18};
+        bleio_scanfilter_t *filter = bleio_scanfilter_new(prefixes, sizeof(prefixes));
+        mp_printf(&mp_plat_print, "%d %d\n", (int)filter->n_nodes, bleio_scanfilter_new(prefixes, 0) == NULL);
+        // each packet is its length followed by its data
+        static const uint8_t packets[][8] = {
+            {7, 2, 0x01, 0x06, 3, 0xff, 0x4c, 0x00}, // manufacturer data
+            {7, 2, 0x01, 0x06, 3, 0xff, 0x4d, 0x00}, // other manufacturer
+            {7, 2, 0x01, 0x06, 3, 0x09, 'x', 'y'}, // name
+            {7, 2, 0x01, 0x06, 3, 0x16, 0x0a, 0x18}, // service data
+            {3, 6, 0xff, 0x4c}, // structure cut short by the end of the packet
+            {5, 0, 3, 0xff, 0x4c, 0x00}, // zero length ends the packet
+        };
+        for (size_t i = 0; i < MP_ARRAY_SIZE(packets); ++i) {
+            mp_printf(&mp_plat_print, "%d ", bleio_scanfilter_matches(filter, packets[i] + 1, packets[i][0]));
+        }
+        mp_printf(&mp_plat_print, "%d\n", bleio_scanfilter_matches(filter, NULL, 0));
+
+        // a prefix overrunning the buffer is rejected
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0) {
+            bleio_scanfilter_new(prefixes, 3);
+            nlr_pop();
+        } else {
+            mp_obj_print_exception(&mp_plat_print, MP_OBJ_FROM_PTR(nlr.ret_val));
+        }
+    }
+
+    // BLE scan filter and record ring together
+    {
+        mp_printf(&mp_plat_print, "# bleio scan pipeline\n");
+        mp_printf(&mp_plat_print, "%d\n", (int)bleio_scan_pipeline(5000));
+    }
+
+    // CAN compiled filter
+    {
+        mp_printf(&mp_plat_print, "# canio filter\n");
+
+        canio_match_obj_t matches[6];
+        canio_match_obj_t *match_ptrs[MP_ARRAY_SIZE(matches)];
+        common_hal_canio_match_construct(&matches[0], 0x123, 0x7ff, false);
+        common_hal_canio_match_construct(&matches[1], 0x100, 0x7ff, false);
+        common_hal_canio_match_construct(&matches[2], 0x123, 0x7ff, false); // duplicate
+        common_hal_canio_match_construct(&matches[3], 0x200, 0x700, false);
+        common_hal_canio_match_construct(&matches[4], 0x123, 0x1fffffff, true);
+        common_hal_canio_match_construct(&matches[5], 0x18fef100, 0x00ffff00, true);
+        for (size_t i = 0; i < MP_ARRAY_SIZE(matches); i++) {
+            match_ptrs[i] = &matches[i];
+        }
+        canio_filter_t *filter = canio_filter_new(MP_ARRAY_SIZE(matches), match_ptrs);
+        mp_printf(&mp_plat_print, "%d %d %d\n", (int)filter->n_groups, (int)filter->groups[filter->n_groups - 1].end, canio_filter_new(0, match_ptrs) == NULL);
+
+        static const struct {
+            uint32_t id;
+            bool extended;
+        } frames[] = {
+            {0x123, false}, {0x123, true}, {0x100, false}, {0x101, false},
+            {0x2ab, false}, {0x3ab, false}, {0x18fef1ab, true}, {0x0cfef100, true}, {0x18fef200, true},
+        };
+        for (size_t i = 0; i < MP_ARRAY_SIZE(frames); ++i) {
+            mp_printf(&mp_plat_print, "%d ", canio_filter_matches(filter, frames[i].id, frames[i].extended));
+        }
+        mp_printf(&mp_plat_print, "%d\n", canio_filter_matches(NULL, 0x7ff, false));
+
+        // agrees with checking each match in turn
+        canio_loopback_t bus;
+        memset(&bus, 0, sizeof(bus));
+        uint32_t seed = 1;
+        int mismatches = 0;
+        for (int i = 0; i < 10000; i++) {
+            seed = seed * 1103515245 + 12345;
+            bool extended = seed & 1;
+            uint32_t id = extended ? (seed >> 3) & 0x1fffffff : 0x100 + ((seed >> 16) & 0x3ff);
+            canio_loopback_send(&bus, id, extended, 0);
+            canio_frame_t compiled, linear;
+            uint32_t overruns = 0;
+            canio_loopback_t copy = bus;
+            bool a = canio_loopback_read(&bus, filter, 0, NULL, &overruns, &compiled);
+            bool b = canio_loopback_read(&copy, NULL, MP_ARRAY_SIZE(matches), matches, &overruns, &linear);
+            mismatches += a != b;
+        }
+        mp_printf(&mp_plat_print, "%d\n", mismatches);
+
+        // a full FIFO loses frames and reports one overrun
+        uint32_t overruns = 0;
+        for (int i = 0; i < CANIO_LOOPBACK_DEPTH + 5; i++) {
+            canio_loopback_send(&bus, 0x100, false, 0);
+        }
+        canio_frame_t frame;
+        int received = 0;
+        while (canio_loopback_read(&bus, filter, 0, NULL, &overruns, &frame)) {
+            ++received;
+        }
+        mp_printf(&mp_plat_print, "%d %d\n", received, (int)overruns);
+
+        // bursts drained the way Listener.receive_into() does
+        mp_int_t accepted = canio_loopback_pipeline(5000, &overruns);
+        mp_printf(&mp_plat_print, "%d %d\n", (int)accepted, (int)overruns);
     }
 
     mp_obj_streamtest_t *s = m_new_obj(mp_obj_streamtest_t);
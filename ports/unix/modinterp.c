@@ -0,0 +1,507 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/mpconfig.h"
+#if MICROPY_PY_INTERP
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "py/compile.h"
+#include "py/gc.h"
+#include "py/mperrno.h"
+#include "py/mpthread.h"
+#include "py/runtime.h"
+#include "py/stackctrl.h"
+#include "extmod/vfs.h"
+#include "extmod/vfs_posix.h"
+
+#if !MICROPY_MULTI_INTERP || !MICROPY_PY_THREAD
+#error "_interp requires MICROPY_MULTI_INTERP and MICROPY_PY_THREAD"
+#endif
+
+// Independent interpreters, each with its own state, heap and qstr pool,
+// running in their own OS threads.  They share no Python objects, so they
+// never contend for a lock while running Python code; bytes are passed
+// between them over channels.
+
+#define INTERP_DEFAULT_HEAP_SIZE (256 * 1024 * (BYTES_PER_WORD / 4))
+#define INTERP_STACK_SIZE (64 * 1024 * BYTES_PER_WORD)
+
+/******************************************************************************/
+// Channels live outside every heap and are reference counted by the Channel
+// objects that wrap them, one per interpreter using the channel.
+
+typedef struct _interp_msg_t {
+    struct _interp_msg_t *next;
+    size_t len;
+    byte data[];
+} interp_msg_t;
+
+typedef struct _interp_channel_t {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    size_t refs;
+    bool closed;
+    interp_msg_t *head;
+    interp_msg_t *tail;
+} interp_channel_t;
+
+STATIC void interp_channel_retain(interp_channel_t *ch) {
+    pthread_mutex_lock(&ch->mutex);
+    ++ch->refs;
+    pthread_mutex_unlock(&ch->mutex);
+}
+
+STATIC void interp_channel_release(interp_channel_t *ch) {
+    pthread_mutex_lock(&ch->mutex);
+    size_t refs = --ch->refs;
+    pthread_mutex_unlock(&ch->mutex);
+    if (refs == 0) {
+        for (interp_msg_t *msg = ch->head, *next; msg != NULL; msg = next) {
+            next = msg->next;
+            free(msg);
+        }
+        pthread_cond_destroy(&ch->cond);
+        pthread_mutex_destroy(&ch->mutex);
+        free(ch);
+    }
+}
+
+typedef struct _mp_obj_channel_t {
+    mp_obj_base_t base;
+    interp_channel_t *ch;
+} mp_obj_channel_t;
+
+STATIC const mp_obj_type_t mp_type_interp_channel;
+
+STATIC mp_obj_t channel_wrap(interp_channel_t *ch) {
+    mp_obj_channel_t *self = m_new_obj_with_finaliser(mp_obj_channel_t);
+    self->base.type = &mp_type_interp_channel;
+    self->ch = ch;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+STATIC mp_obj_t channel_make_new(const mp_obj_type_t *type, size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    (void)type;
+    (void)args;
+    mp_arg_check_num(n_args, kw_args, 0, 0, false);
+    interp_channel_t *ch = malloc(sizeof(interp_channel_t));
+    if (ch == NULL) {
+        mp_raise_OSError(MP_ENOMEM);
+    }
+    pthread_mutex_init(&ch->mutex, NULL);
+    pthread_cond_init(&ch->cond, NULL);
+    ch->refs = 1;
+    ch->closed = false;
+    ch->head = NULL;
+    ch->tail = NULL;
+    return channel_wrap(ch);
+}
+
+STATIC mp_obj_t channel_del(mp_obj_t self_in) {
+    mp_obj_channel_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->ch != NULL) {
+        interp_channel_release(self->ch);
+        self->ch = NULL;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(channel_del_obj, channel_del);
+
+STATIC mp_obj_t channel_send(mp_obj_t self_in, mp_obj_t buf_in) {
+    interp_channel_t *ch = ((mp_obj_channel_t*)MP_OBJ_TO_PTR(self_in))->ch;
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_READ);
+    interp_msg_t *msg = malloc(sizeof(interp_msg_t) + bufinfo.len);
+    if (msg == NULL) {
+        mp_raise_OSError(MP_ENOMEM);
+    }
+    msg->next = NULL;
+    msg->len = bufinfo.len;
+    memcpy(msg->data, bufinfo.buf, bufinfo.len);
+
+    pthread_mutex_lock(&ch->mutex);
+    if (ch->closed) {
+        pthread_mutex_unlock(&ch->mutex);
+        free(msg);
+        mp_raise_OSError(MP_EPIPE);
+    }
+    if (ch->tail == NULL) {
+        ch->head = msg;
+    } else {
+        ch->tail->next = msg;
+    }
+    ch->tail = msg;
+    pthread_cond_signal(&ch->cond);
+    pthread_mutex_unlock(&ch->mutex);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(channel_send_obj, channel_send);
+
+// Wait for the next message and return it, or None once the channel is
+// closed and empty.
+STATIC mp_obj_t channel_recv(mp_obj_t self_in) {
+    interp_channel_t *ch = ((mp_obj_channel_t*)MP_OBJ_TO_PTR(self_in))->ch;
+    MP_THREAD_GIL_EXIT();
+    pthread_mutex_lock(&ch->mutex);
+    while (ch->head == NULL && !ch->closed) {
+        pthread_cond_wait(&ch->cond, &ch->mutex);
+    }
+    interp_msg_t *msg = ch->head;
+    if (msg != NULL) {
+        ch->head = msg->next;
+        if (ch->head == NULL) {
+            ch->tail = NULL;
+        }
+    }
+    pthread_mutex_unlock(&ch->mutex);
+    MP_THREAD_GIL_ENTER();
+
+    if (msg == NULL) {
+        return mp_const_none;
+    }
+    // don't leak the message if the allocation raises
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_obj_t data = mp_obj_new_bytes(msg->data, msg->len);
+        nlr_pop();
+        free(msg);
+        return data;
+    } else {
+        free(msg);
+        nlr_jump(nlr.ret_val);
+    }
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(channel_recv_obj, channel_recv);
+
+// Closing wakes up all receivers; queued messages can still be received but
+// no more can be sent.
+STATIC mp_obj_t channel_close(mp_obj_t self_in) {
+    interp_channel_t *ch = ((mp_obj_channel_t*)MP_OBJ_TO_PTR(self_in))->ch;
+    pthread_mutex_lock(&ch->mutex);
+    ch->closed = true;
+    pthread_cond_broadcast(&ch->cond);
+    pthread_mutex_unlock(&ch->mutex);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(channel_close_obj, channel_close);
+
+STATIC const mp_rom_map_elem_t channel_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&channel_del_obj) },
+    { MP_ROM_QSTR(MP_QSTR_send), MP_ROM_PTR(&channel_send_obj) },
+    { MP_ROM_QSTR(MP_QSTR_recv), MP_ROM_PTR(&channel_recv_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&channel_close_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(channel_locals_dict, channel_locals_dict_table);
+
+STATIC const mp_obj_type_t mp_type_interp_channel = {
+    { &mp_type_type },
+    .name = MP_QSTR_Channel,
+    .make_new = channel_make_new,
+    .locals_dict = (mp_obj_dict_t*)&channel_locals_dict,
+};
+
+/******************************************************************************/
+// Interpreters.  The state is shared by the Interpreter object in the parent
+// and the thread running the child, and freed when both are done with it.
+
+typedef struct _interp_t {
+    mp_state_ctx_t ctx;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    size_t refs;
+    bool done;
+    int status;
+    size_t stack_limit;
+    size_t heap_size;
+    char *heap;
+    // the source to run, then the entries of the parent's sys.path, all
+    // nul-terminated
+    char *strings;
+    size_t source_len;
+    size_t n_path;
+    size_t n_channels;
+    interp_channel_t *channels[];
+} interp_t;
+
+// the interpreter this thread runs, or NULL for the main interpreter
+STATIC __thread interp_t *interp_current;
+
+STATIC void interp_release(interp_t *interp) {
+    pthread_mutex_lock(&interp->mutex);
+    size_t refs = --interp->refs;
+    pthread_mutex_unlock(&interp->mutex);
+    if (refs == 0) {
+        for (size_t i = 0; i < interp->n_channels; ++i) {
+            interp_channel_release(interp->channels[i]);
+        }
+        pthread_cond_destroy(&interp->cond);
+        pthread_mutex_destroy(&interp->mutex);
+        free(interp->strings);
+        free(interp->heap);
+        free(interp);
+    }
+}
+
+STATIC int interp_run(interp_t *interp) {
+    #if MICROPY_VFS_POSIX
+    {
+        // mount the host FS at the root, as the main interpreter does
+        mp_obj_t args[2] = {
+            mp_type_vfs_posix.make_new(&mp_type_vfs_posix, 0, 0, NULL),
+            MP_OBJ_NEW_QSTR(MP_QSTR__slash_),
+        };
+        mp_vfs_mount(2, args, (mp_map_t*)&mp_const_empty_map);
+        MP_STATE_VM(vfs_cur) = MP_STATE_VM(vfs_mount_table);
+    }
+    #endif
+
+    const char *source = interp->strings;
+    mp_obj_list_init(MP_OBJ_TO_PTR(mp_sys_path), 0);
+    const char *path = source + interp->source_len + 1;
+    for (size_t i = 0; i < interp->n_path; ++i) {
+        size_t len = strlen(path);
+        mp_obj_list_append(mp_sys_path, mp_obj_new_str(path, len));
+        path += len + 1;
+    }
+    mp_obj_list_init(MP_OBJ_TO_PTR(mp_sys_argv), 0);
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_lexer_t *lex = mp_lexer_new_from_str_len(MP_QSTR__lt_interp_gt_, source, interp->source_len, 0);
+        qstr source_name = lex->source_name;
+        mp_parse_tree_t parse_tree = mp_parse(lex, MP_PARSE_FILE_INPUT);
+        mp_obj_t module_fun = mp_compile(&parse_tree, source_name, MP_EMIT_OPT_NONE, false);
+        mp_call_function_0(module_fun);
+        nlr_pop();
+        return 0;
+    } else {
+        mp_obj_base_t *exc = (mp_obj_base_t*)nlr.ret_val;
+        if (mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(exc->type), MP_OBJ_FROM_PTR(&mp_type_SystemExit))) {
+            mp_obj_t exit_val = mp_obj_exception_get_value(MP_OBJ_FROM_PTR(exc));
+            mp_int_t val = 0;
+            if (exit_val != mp_const_none && !mp_obj_get_int_maybe(exit_val, &val)) {
+                val = 1;
+            }
+            return val;
+        }
+        mp_obj_print_exception(MICROPY_ERROR_PRINTER, MP_OBJ_FROM_PTR(exc));
+        return 1;
+    }
+}
+
+STATIC void *interp_thread_entry(void *arg) {
+    interp_t *interp = arg;
+    mp_state_ctx_ptr = &interp->ctx;
+    interp_current = interp;
+    mp_thread_set_state(&interp->ctx.thread);
+    mp_stack_ctrl_init();
+    mp_stack_set_limit(interp->stack_limit);
+
+    gc_init(interp->heap, interp->heap + interp->heap_size);
+    mp_init();
+    mp_thread_start();
+
+    int status = interp_run(interp);
+
+    gc_deinit();
+    mp_deinit();
+    mp_thread_finish();
+
+    pthread_mutex_lock(&interp->mutex);
+    interp->done = true;
+    interp->status = status;
+    pthread_cond_broadcast(&interp->cond);
+    pthread_mutex_unlock(&interp->mutex);
+    interp_release(interp);
+    return NULL;
+}
+
+typedef struct _mp_obj_interp_t {
+    mp_obj_base_t base;
+    interp_t *interp;
+} mp_obj_interp_t;
+
+STATIC mp_obj_t interp_make_new(const mp_obj_type_t *type, size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_source, ARG_channels, ARG_heap_size };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_source, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_channels, MP_ARG_OBJ, {.u_obj = mp_const_empty_tuple} },
+        { MP_QSTR_heap_size, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = INTERP_DEFAULT_HEAP_SIZE} },
+    };
+    mp_arg_val_t parsed[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, parsed);
+
+    size_t source_len;
+    const char *source = mp_obj_str_get_data(parsed[ARG_source].u_obj, &source_len);
+    size_t n_channels;
+    mp_obj_t *channels;
+    mp_obj_get_array(parsed[ARG_channels].u_obj, &n_channels, &channels);
+    for (size_t i = 0; i < n_channels; ++i) {
+        if (!MP_OBJ_IS_TYPE(channels[i], &mp_type_interp_channel)) {
+            mp_raise_TypeError(NULL);
+        }
+    }
+    if (parsed[ARG_heap_size].u_int < 4096) {
+        mp_raise_ValueError(NULL);
+    }
+    size_t n_path;
+    mp_obj_t *path;
+    mp_obj_list_get(mp_sys_path, &n_path, &path);
+    size_t strings_len = source_len + 1;
+    for (size_t i = 0; i < n_path; ++i) {
+        strings_len += strlen(mp_obj_str_get_str(path[i])) + 1;
+    }
+
+    mp_obj_interp_t *self = m_new_obj_with_finaliser(mp_obj_interp_t);
+    self->base.type = type;
+    self->interp = NULL;
+
+    // everything the child needs is copied out of our heap
+    interp_t *interp = calloc(1, sizeof(interp_t) + n_channels * sizeof(interp_channel_t*));
+    char *strings = malloc(strings_len);
+    char *heap = malloc(parsed[ARG_heap_size].u_int);
+    if (interp == NULL || strings == NULL || heap == NULL) {
+        free(interp);
+        free(strings);
+        free(heap);
+        mp_raise_OSError(MP_ENOMEM);
+    }
+    memcpy(strings, source, source_len);
+    strings[source_len] = '\0';
+    char *p = strings + source_len + 1;
+    for (size_t i = 0; i < n_path; ++i) {
+        const char *s = mp_obj_str_get_str(path[i]);
+        size_t len = strlen(s) + 1;
+        memcpy(p, s, len);
+        p += len;
+    }
+    pthread_mutex_init(&interp->mutex, NULL);
+    pthread_cond_init(&interp->cond, NULL);
+    interp->refs = 2;
+    interp->heap_size = parsed[ARG_heap_size].u_int;
+    interp->heap = heap;
+    interp->strings = strings;
+    interp->source_len = source_len;
+    interp->n_path = n_path;
+    interp->n_channels = n_channels;
+    for (size_t i = 0; i < n_channels; ++i) {
+        interp->channels[i] = ((mp_obj_channel_t*)MP_OBJ_TO_PTR(channels[i]))->ch;
+        interp_channel_retain(interp->channels[i]);
+    }
+
+    size_t stack_size = INTERP_STACK_SIZE;
+    // leave room to recover from hitting the limit, as _thread does
+    interp->stack_limit = stack_size - 8192;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_thread_create(interp_thread_entry, interp, &stack_size);
+        nlr_pop();
+    } else {
+        // the thread never started, so drop its reference too
+        interp_release(interp);
+        interp_release(interp);
+        nlr_jump(nlr.ret_val);
+    }
+    self->interp = interp;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+STATIC mp_obj_t interp_del(mp_obj_t self_in) {
+    mp_obj_interp_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->interp != NULL) {
+        interp_release(self->interp);
+        self->interp = NULL;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(interp_del_obj, interp_del);
+
+// Wait for the interpreter to finish and return its exit status: 0 if the
+// source ran to completion, the SystemExit code if it exited, or 1 if it
+// raised any other exception.
+STATIC mp_obj_t interp_join(mp_obj_t self_in) {
+    interp_t *interp = ((mp_obj_interp_t*)MP_OBJ_TO_PTR(self_in))->interp;
+    MP_THREAD_GIL_EXIT();
+    pthread_mutex_lock(&interp->mutex);
+    while (!interp->done) {
+        pthread_cond_wait(&interp->cond, &interp->mutex);
+    }
+    int status = interp->status;
+    pthread_mutex_unlock(&interp->mutex);
+    MP_THREAD_GIL_ENTER();
+    return MP_OBJ_NEW_SMALL_INT(status);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(interp_join_obj, interp_join);
+
+STATIC const mp_rom_map_elem_t interp_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&interp_del_obj) },
+    { MP_ROM_QSTR(MP_QSTR_join), MP_ROM_PTR(&interp_join_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(interp_locals_dict, interp_locals_dict_table);
+
+STATIC const mp_obj_type_t mp_type_interp = {
+    { &mp_type_type },
+    .name = MP_QSTR_Interpreter,
+    .make_new = interp_make_new,
+    .locals_dict = (mp_obj_dict_t*)&interp_locals_dict,
+};
+
+/******************************************************************************/
+// _interp module
+
+// Return the channels passed to this interpreter when it was started.
+STATIC mp_obj_t mod_interp_channels(void) {
+    interp_t *interp = interp_current;
+    if (interp == NULL) {
+        return mp_const_empty_tuple;
+    }
+    mp_obj_tuple_t *t = MP_OBJ_TO_PTR(mp_obj_new_tuple(interp->n_channels, NULL));
+    for (size_t i = 0; i < interp->n_channels; ++i) {
+        t->items[i] = channel_wrap(interp->channels[i]);
+        interp_channel_retain(interp->channels[i]);
+    }
+    return MP_OBJ_FROM_PTR(t);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mod_interp_channels_obj, mod_interp_channels);
+
+STATIC const mp_rom_map_elem_t mp_module_interp_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR__interp) },
+    { MP_ROM_QSTR(MP_QSTR_Interpreter), MP_ROM_PTR(&mp_type_interp) },
+    { MP_ROM_QSTR(MP_QSTR_Channel), MP_ROM_PTR(&mp_type_interp_channel) },
+    { MP_ROM_QSTR(MP_QSTR_channels), MP_ROM_PTR(&mod_interp_channels_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_interp_globals, mp_module_interp_globals_table);
+
+const mp_obj_module_t mp_module_interp = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&mp_module_interp_globals,
+};
+
+#endif // MICROPY_PY_INTERP
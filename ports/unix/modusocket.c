@@ -33,6 +33,10 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
@@ -194,13 +198,14 @@ STATIC mp_obj_t socket_recv(size_t n_args, const mp_obj_t *args) {
         flags = MP_OBJ_SMALL_INT_VALUE(args[2]);
     }
 
-    byte *buf = m_new(byte, sz);
-    int out_sz = recv(self->fd, buf, sz, flags);
+    // Receive straight into the storage of the returned bytes object
+    vstr_t vstr;
+    vstr_init_len(&vstr, sz);
+    int out_sz = recv(self->fd, vstr.buf, sz, flags);
     RAISE_ERRNO(out_sz, errno);
 
-    mp_obj_t ret = mp_obj_new_str_of_type(&mp_type_bytes, buf, out_sz);
-    m_del(char, buf, sz);
-    return ret;
+    vstr.len = out_sz;
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recv_obj, 2, 3, socket_recv);
 
@@ -216,12 +221,13 @@ STATIC mp_obj_t socket_recvfrom(size_t n_args, const mp_obj_t *args) {
     struct sockaddr_storage addr;
     socklen_t addr_len = sizeof(addr);
 
-    byte *buf = m_new(byte, sz);
-    int out_sz = recvfrom(self->fd, buf, sz, flags, (struct sockaddr*)&addr, &addr_len);
+    vstr_t vstr;
+    vstr_init_len(&vstr, sz);
+    int out_sz = recvfrom(self->fd, vstr.buf, sz, flags, (struct sockaddr*)&addr, &addr_len);
     RAISE_ERRNO(out_sz, errno);
 
-    mp_obj_t buf_o = mp_obj_new_str_of_type(&mp_type_bytes, buf, out_sz);
-    m_del(char, buf, sz);
+    vstr.len = out_sz;
+    mp_obj_t buf_o = mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 
     mp_obj_tuple_t *t = MP_OBJ_TO_PTR(mp_obj_new_tuple(2, NULL));
     t->items[0] = buf_o;
@@ -231,6 +237,37 @@ STATIC mp_obj_t socket_recvfrom(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recvfrom_obj, 2, 3, socket_recvfrom);
 
+// Like recv() but into an existing buffer, such as a slice of a memoryview,
+// so receiving allocates nothing. Returns the number of bytes received.
+STATIC mp_obj_t socket_recv_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_WRITE);
+    size_t len = bufinfo.len;
+    int flags = 0;
+
+    if (n_args > 2) {
+        mp_int_t nbytes = mp_obj_get_int(args[2]);
+        if (nbytes < 0) {
+            mp_raise_ValueError_varg(translate("%q must be >= 0"), MP_QSTR_nbytes);
+        }
+        if ((size_t)nbytes > len) {
+            mp_raise_ValueError(translate("buffer too small"));
+        }
+        if (nbytes > 0) {
+            len = nbytes;
+        }
+    }
+    if (n_args > 3) {
+        flags = MP_OBJ_SMALL_INT_VALUE(args[3]);
+    }
+
+    ssize_t out_sz = recv(self->fd, bufinfo.buf, len, flags);
+    RAISE_ERRNO(out_sz, errno);
+    return MP_OBJ_NEW_SMALL_INT(out_sz);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recv_into_obj, 2, 4, socket_recv_into);
+
 // Note: besides flag param, this differs from write() in that
 // this does not swallow blocking errors (EAGAIN, EWOULDBLOCK) -
 // these would be thrown as exceptions.
@@ -251,6 +288,104 @@ STATIC mp_obj_t socket_send(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_send_obj, 2, 3, socket_send);
 
+// Sends a sequence of buffers with one sendmsg() call, so a header and its
+// payload need not be joined into a new object first. Like send(), this can
+// be a short write.
+STATIC mp_obj_t socket_sendv(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    int flags = 0;
+
+    if (n_args > 2) {
+        flags = MP_OBJ_SMALL_INT_VALUE(args[2]);
+    }
+
+    size_t n;
+    mp_obj_t *items;
+    mp_obj_get_array(args[1], &n, &items);
+    struct iovec iov_stack[16];
+    struct iovec *iov = n <= MP_ARRAY_SIZE(iov_stack) ? iov_stack : m_new(struct iovec, n);
+    for (size_t i = 0; i < n; i++) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(items[i], &bufinfo, MP_BUFFER_READ);
+        iov[i].iov_base = bufinfo.buf;
+        iov[i].iov_len = bufinfo.len;
+    }
+
+    struct msghdr msg = {
+        .msg_iov = iov,
+        .msg_iovlen = n,
+    };
+    ssize_t out_sz = sendmsg(self->fd, &msg, flags);
+    if (iov != iov_stack) {
+        m_del(struct iovec, iov, n);
+    }
+    RAISE_ERRNO(out_sz, errno);
+
+    return MP_OBJ_NEW_SMALL_INT(out_sz);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_sendv_obj, 2, 3, socket_sendv);
+
+// Sends count bytes (or up to the end) of a file from offset, without
+// copying through Python objects: sendfile(2) on Linux, elsewhere pread()
+// and send() through a stack buffer. As in CPython the file position ends
+// up just after the last byte sent. On a non-blocking socket this returns
+// early once some data has been sent and the socket would block.
+STATIC mp_obj_t socket_sendfile(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t dest[2];
+    mp_load_method(args[1], MP_QSTR_fileno, dest);
+    int in_fd = mp_obj_get_int(mp_call_method_n_kw(0, 0, dest));
+
+    mp_int_t start = n_args > 2 ? mp_obj_get_int(args[2]) : 0;
+    if (start < 0) {
+        mp_raise_ValueError_varg(translate("%q must be >= 0"), MP_QSTR_offset);
+    }
+    size_t count = SIZE_MAX;
+    if (n_args > 3 && args[3] != mp_const_none) {
+        mp_int_t n = mp_obj_get_int(args[3]);
+        if (n < 0) {
+            mp_raise_ValueError_varg(translate("%q must be >= 0"), MP_QSTR_count);
+        }
+        count = n;
+    }
+
+    off_t offset = start;
+    size_t total = 0;
+    while (total < count) {
+        // sendfile() moves at most 0x7ffff000 bytes per call
+        size_t chunk = MIN(count - total, 0x7ffff000);
+        #ifdef __linux__
+        ssize_t r = sendfile(self->fd, in_fd, &offset, chunk);
+        #else
+        byte buf[4096];
+        ssize_t r = pread(in_fd, buf, MIN(chunk, sizeof(buf)), offset);
+        if (r > 0) {
+            r = send(self->fd, buf, r, 0);
+            if (r > 0) {
+                offset += r;
+            }
+        }
+        #endif
+        if (r == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (total > 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            mp_raise_OSError(errno);
+        }
+        if (r == 0) {
+            break;
+        }
+        total += r;
+    }
+    lseek(in_fd, offset, SEEK_SET);
+
+    return mp_obj_new_int_from_uint(total);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_sendfile_obj, 2, 4, socket_sendfile);
+
 STATIC mp_obj_t socket_sendto(size_t n_args, const mp_obj_t *args) {
     mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
     int flags = 0;
@@ -363,8 +498,11 @@ STATIC const mp_rom_map_elem_t usocket_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_listen), MP_ROM_PTR(&socket_listen_obj) },
     { MP_ROM_QSTR(MP_QSTR_accept), MP_ROM_PTR(&socket_accept_obj) },
     { MP_ROM_QSTR(MP_QSTR_recv), MP_ROM_PTR(&socket_recv_obj) },
+    { MP_ROM_QSTR(MP_QSTR_recv_into), MP_ROM_PTR(&socket_recv_into_obj) },
     { MP_ROM_QSTR(MP_QSTR_recvfrom), MP_ROM_PTR(&socket_recvfrom_obj) },
     { MP_ROM_QSTR(MP_QSTR_send), MP_ROM_PTR(&socket_send_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sendv), MP_ROM_PTR(&socket_sendv_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sendfile), MP_ROM_PTR(&socket_sendfile_obj) },
     { MP_ROM_QSTR(MP_QSTR_sendto), MP_ROM_PTR(&socket_sendto_obj) },
     { MP_ROM_QSTR(MP_QSTR_setsockopt), MP_ROM_PTR(&socket_setsockopt_obj) },
     { MP_ROM_QSTR(MP_QSTR_setblocking), MP_ROM_PTR(&socket_setblocking_obj) },
@@ -70,6 +70,15 @@
 #ifndef MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
 #define MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE (1)
 #endif
+#ifndef MICROPY_OPT_FAST_EXCEPTIONS
+#define MICROPY_OPT_FAST_EXCEPTIONS (1)
+#endif
+#ifndef MICROPY_OPT_GEN_FRAME_POOL
+#define MICROPY_OPT_GEN_FRAME_POOL (4)
+#endif
+#ifndef MICROPY_OPT_KW_ARG_CACHE
+#define MICROPY_OPT_KW_ARG_CACHE (64)
+#endif
 #define MICROPY_CAN_OVERRIDE_BUILTINS (1)
 #define MICROPY_PY_FUNCTION_ATTRS   (1)
 #define MICROPY_PY_DESCRIPTORS      (1)
@@ -85,6 +94,8 @@
 #define MICROPY_PY_BUILTINS_POW3    (1)
 #define MICROPY_PY_BUILTINS_ROUND_INT    (1)
 #define MICROPY_PY_MICROPYTHON_MEM_INFO (1)
+#define MICROPY_PY_PROFILER         (1)
+#define MICROPY_PY_BENCHMARK        (1)
 #define MICROPY_PY_ALL_SPECIAL_METHODS (1)
 #define MICROPY_PY_REVERSE_SPECIAL_METHODS (1)
 #define MICROPY_PY_ARRAY_SLICE_ASSIGN (1)
@@ -178,6 +189,13 @@ extern const struct _mp_obj_module_t mp_module_termios;
 extern const struct _mp_obj_module_t mp_module_socket;
 extern const struct _mp_obj_module_t mp_module_ffi;
 extern const struct _mp_obj_module_t mp_module_jni;
+extern const struct _mp_obj_module_t mp_module_interp;
+extern const struct _mp_obj_module_t aesio_module;
+extern const struct _mp_obj_module_t struct_module;
+extern const struct _mp_obj_module_t random_module;
+extern const struct _mp_obj_module_t _http_module;
+extern const struct _mp_obj_module_t telemetry_module;
+extern const struct _mp_obj_module_t ringbuffer_module;
 
 #if MICROPY_PY_UOS_VFS
 #define MICROPY_PY_UOS_DEF { MP_ROM_QSTR(MP_QSTR_uos), MP_ROM_PTR(&mp_module_uos_vfs) },
@@ -209,6 +227,44 @@ extern const struct _mp_obj_module_t mp_module_jni;
 #else
 #define MICROPY_PY_SOCKET_DEF
 #endif
+#if MICROPY_PY_INTERP
+#define MICROPY_PY_INTERP_DEF { MP_ROM_QSTR(MP_QSTR__interp), MP_ROM_PTR(&mp_module_interp) },
+#else
+#define MICROPY_PY_INTERP_DEF
+#endif
+#if MICROPY_PY_AESIO
+#define MICROPY_PY_AESIO_DEF { MP_ROM_QSTR(MP_QSTR_aesio), MP_ROM_PTR(&aesio_module) },
+#else
+#define MICROPY_PY_AESIO_DEF
+#endif
+#if MICROPY_PY_STRUCT_SHARED
+#ifndef MICROPY_PY_STRUCT_FORMAT_CACHE
+#define MICROPY_PY_STRUCT_FORMAT_CACHE (4)
+#endif
+#define MICROPY_PY_STRUCT_SHARED_DEF { MP_ROM_QSTR(MP_QSTR_struct), MP_ROM_PTR(&struct_module) },
+#else
+#define MICROPY_PY_STRUCT_SHARED_DEF
+#endif
+#if MICROPY_PY_RANDOM_SHARED
+#define MICROPY_PY_RANDOM_SHARED_DEF { MP_ROM_QSTR(MP_QSTR_random), MP_ROM_PTR(&random_module) },
+#else
+#define MICROPY_PY_RANDOM_SHARED_DEF
+#endif
+#if MICROPY_PY_HTTP
+#define MICROPY_PY_HTTP_DEF { MP_ROM_QSTR(MP_QSTR__http), MP_ROM_PTR(&_http_module) },
+#else
+#define MICROPY_PY_HTTP_DEF
+#endif
+#if MICROPY_PY_TELEMETRY
+#define MICROPY_PY_TELEMETRY_DEF { MP_ROM_QSTR(MP_QSTR_telemetry), MP_ROM_PTR(&telemetry_module) },
+#else
+#define MICROPY_PY_TELEMETRY_DEF
+#endif
+#if MICROPY_PY_RINGBUFFER
+#define MICROPY_PY_RINGBUFFER_DEF { MP_ROM_QSTR(MP_QSTR_ringbuffer), MP_ROM_PTR(&ringbuffer_module) },
+#else
+#define MICROPY_PY_RINGBUFFER_DEF
+#endif
 #if MICROPY_PY_USELECT_POSIX
 #define MICROPY_PY_USELECT_DEF { MP_ROM_QSTR(MP_QSTR_uselect), MP_ROM_PTR(&mp_module_uselect) },
 #else
@@ -224,6 +280,13 @@ extern const struct _mp_obj_module_t mp_module_jni;
     MICROPY_PY_UOS_DEF \
     MICROPY_PY_USELECT_DEF \
     MICROPY_PY_TERMIOS_DEF \
+    MICROPY_PY_INTERP_DEF \
+    MICROPY_PY_AESIO_DEF \
+    MICROPY_PY_STRUCT_SHARED_DEF \
+    MICROPY_PY_RANDOM_SHARED_DEF \
+    MICROPY_PY_HTTP_DEF \
+    MICROPY_PY_TELEMETRY_DEF \
+    MICROPY_PY_RINGBUFFER_DEF \
 
 // type definitions for the specific machine
 
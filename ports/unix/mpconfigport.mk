@@ -14,12 +14,34 @@ MICROPY_PY_BTREE = 1
 # _thread module using pthreads
 MICROPY_PY_THREAD = 1
 
+# _interp module for independent interpreters in parallel threads; every
+# access to the interpreter state then goes through a thread-local pointer
+MICROPY_PY_INTERP = 0
+
 # Subset of CPython termios module
 MICROPY_PY_TERMIOS = 1
 
 # Subset of CPython socket module
 MICROPY_PY_SOCKET = 1
 
+# aesio module, the CircuitPython AES API
+MICROPY_PY_AESIO = 1
+
+# struct module, the CircuitPython struct API (ustruct stays available)
+MICROPY_PY_STRUCT_SHARED = 1
+
+# random module, the CircuitPython random API (urandom stays available)
+MICROPY_PY_RANDOM_SHARED = 1
+
+# _http module, the native HTTP/1.1 response parser and connection pool
+MICROPY_PY_HTTP = 1
+
+# telemetry module, batched binary telemetry
+MICROPY_PY_TELEMETRY = 1
+
+# ringbuffer module, single-producer single-consumer buffers
+MICROPY_PY_RINGBUFFER = 1
+
 # ffi module requires libffi (libffi-dev Debian package)
 MICROPY_PY_FFI = 1
 
@@ -34,7 +34,11 @@
 
 #define MICROPY_FLOAT_HIGH_QUALITY_HASH (1)
 #define MICROPY_ENABLE_SCHEDULER       (1)
+#define MICROPY_TRACE_BUFFER           (1)
 #define MICROPY_READER_VFS             (1)
+#define MICROPY_VFS_IMPORT_CACHE       (1)
+#define MICROPY_PERSISTENT_CODE_SAVE   (1)
+#define MICROPY_MODULE_MPY_CACHE       (1)
 #define MICROPY_PY_DELATTR_SETATTR     (1)
 #define MICROPY_PY_REVERSE_SPECIAL_METHODS (1)
 #define MICROPY_PY_BUILTINS_RANGE_BINOP (1)
@@ -51,7 +51,8 @@ static inline int mp_hal_readline(vstr_t *vstr, const char *p) {
 // "The useconds argument shall be less than one million."
 static inline void mp_hal_delay_ms(mp_uint_t ms) { usleep((ms) * 1000); }
 static inline void mp_hal_delay_us(mp_uint_t us) { usleep(us); }
-#define mp_hal_ticks_cpu() 0
+// The CPU "cycle" counter is CLOCK_MONOTONIC in nanoseconds.
+#define mp_hal_ticks_cpu_hz() (1000000000)
 
 #define RAISE_ERRNO(err_flag, error_val) \
     { if (err_flag == -1) \
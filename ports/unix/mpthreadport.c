@@ -42,6 +42,9 @@ typedef struct _thread_t {
     pthread_t id;           // system id of thread
     int ready;              // whether the thread is ready and running
     void *arg;              // thread Python args, a GC root pointer
+    #if MICROPY_MULTI_INTERP
+    mp_state_ctx_t *ctx;    // interpreter the thread runs in
+    #endif
     struct _thread_t *next;
 } thread_t;
 
@@ -83,6 +86,9 @@ void mp_thread_init(void) {
     thread->id = pthread_self();
     thread->ready = 1;
     thread->arg = NULL;
+    #if MICROPY_MULTI_INTERP
+    thread->ctx = &mp_state_ctx;
+    #endif
     thread->next = NULL;
 
     // enable signal handler for garbage collection
@@ -102,6 +108,12 @@ void mp_thread_init(void) {
 void mp_thread_gc_others(void) {
     pthread_mutex_lock(&thread_mutex);
     for (thread_t *th = thread; th != NULL; th = th->next) {
+        #if MICROPY_MULTI_INTERP
+        // threads of other interpreters don't hold pointers into our heap
+        if (th->ctx != &mp_state_ctx) {
+            continue;
+        }
+        #endif
         gc_collect_root(&th->arg, 1);
         if (th->id == pthread_self()) {
             continue;
@@ -131,6 +143,10 @@ void mp_thread_start(void) {
     for (thread_t *th = thread; th != NULL; th = th->next) {
         if (th->id == pthread_self()) {
             th->ready = 1;
+            #if MICROPY_MULTI_INTERP
+            // the thread may have started a new interpreter
+            th->ctx = &mp_state_ctx;
+            #endif
             break;
         }
     }
@@ -178,6 +194,9 @@ void mp_thread_create(void *(*entry)(void*), void *arg, size_t *stack_size) {
     th->id = id;
     th->ready = 0;
     th->arg = arg;
+    #if MICROPY_MULTI_INTERP
+    th->ctx = &mp_state_ctx;
+    #endif
     th->next = thread;
     thread = th;
 
@@ -191,10 +210,12 @@ er:
 
 void mp_thread_finish(void) {
     pthread_mutex_lock(&thread_mutex);
-    // TODO unlink from list
-    for (thread_t *th = thread; th != NULL; th = th->next) {
+    // Unlink the finished thread so its stale arg pointer isn't scanned (it
+    // may point into the heap of a later interpreter) and its id can be reused.
+    for (thread_t **prev = &thread, *th; (th = *prev) != NULL; prev = &th->next) {
         if (th->id == pthread_self()) {
-            th->ready = 0;
+            *prev = th->next;
+            free(th);
             break;
         }
     }
@@ -28,6 +28,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include "py/mphal.h"
 #include "py/runtime.h"
@@ -58,6 +59,46 @@ STATIC void sighandler(int signum) {
 }
 #endif
 
+#if MICROPY_PY_PROFILER && !defined(_WIN32)
+#include "py/profiler.h"
+
+// Samples are driven by ITIMER_PROF, which only counts while the process is
+// using CPU, so a program blocked in sleep() or select() is not sampled.
+STATIC void profiler_sighandler(int signum) {
+    (void)signum;
+    mp_profiler_sample();
+}
+
+void mp_profiler_port_start(mp_uint_t rate_hz) {
+    struct sigaction sa;
+    sa.sa_flags = SA_RESTART;
+    sa.sa_handler = profiler_sighandler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, NULL);
+
+    mp_uint_t period_us = 1000000 / rate_hz;
+    if (period_us == 0) {
+        period_us = 1;
+    }
+    struct itimerval timer;
+    timer.it_interval.tv_sec = period_us / 1000000;
+    timer.it_interval.tv_usec = period_us % 1000000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+void mp_profiler_port_stop(void) {
+    struct itimerval timer = { { 0, 0 }, { 0, 0 } };
+    setitimer(ITIMER_PROF, &timer, NULL);
+
+    struct sigaction sa;
+    sa.sa_flags = 0;
+    sa.sa_handler = SIG_IGN;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, NULL);
+}
+#endif
+
 void mp_hal_set_interrupt_char(char c) {
     // configure terminal settings to (not) let ctrl-C through
     if (c == CHAR_CTRL_C) {
@@ -197,3 +238,9 @@ mp_uint_t mp_hal_ticks_us(void) {
     gettimeofday(&tv, NULL);
     return tv.tv_sec * 1000000 + tv.tv_usec;
 }
+
+mp_uint_t mp_hal_ticks_cpu(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (mp_uint_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
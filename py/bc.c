@@ -72,6 +72,56 @@ const byte *mp_decode_uint_skip(const byte *ptr) {
     return ptr;
 }
 
+// Find the block name, source file and source line that correspond to the
+// bytecode position ip within the function whose bytecode starts at bytecode.
+void mp_bytecode_get_source_info(const byte *bytecode, const byte *ip, qstr *block_name, qstr *source_file, size_t *source_line) {
+    const byte *info = bytecode;
+    info = mp_decode_uint_skip(info); // skip n_state
+    info = mp_decode_uint_skip(info); // skip n_exc_stack
+    info++; // skip scope_params
+    info++; // skip n_pos_args
+    info++; // skip n_kwonly_args
+    info++; // skip n_def_pos_args
+    size_t bc = ip - info;
+    size_t code_info_size = mp_decode_uint_value(info);
+    info = mp_decode_uint_skip(info); // skip code_info_size
+    bc -= code_info_size;
+    #if MICROPY_PERSISTENT_CODE
+    *block_name = info[0] | (info[1] << 8);
+    *source_file = info[2] | (info[3] << 8);
+    info += 4;
+    #else
+    *block_name = mp_decode_uint_value(info);
+    info = mp_decode_uint_skip(info);
+    *source_file = mp_decode_uint_value(info);
+    info = mp_decode_uint_skip(info);
+    #endif
+    size_t line = 1;
+    size_t c;
+    while ((c = *info)) {
+        size_t b, l;
+        if ((c & 0x80) == 0) {
+            // 0b0LLBBBBB encoding
+            b = c & 0x1f;
+            l = c >> 5;
+            info += 1;
+        } else {
+            // 0b1LLLBBBB 0bLLLLLLLL encoding (l's LSB in second byte)
+            b = c & 0xf;
+            l = ((c << 4) & 0x700) | info[1];
+            info += 2;
+        }
+        if (bc >= b) {
+            bc -= b;
+            line += l;
+        } else {
+            // found source line corresponding to bytecode offset
+            break;
+        }
+    }
+    *source_line = line;
+}
+
 STATIC NORETURN void fun_pos_args_mismatch(mp_obj_fun_bc_t *f, size_t expected, size_t given) {
 #if MICROPY_ERROR_REPORTING == MICROPY_ERROR_REPORTING_TERSE
     // generic message, used also for other argument issues
@@ -90,6 +140,37 @@ STATIC NORETURN void fun_pos_args_mismatch(mp_obj_fun_bc_t *f, size_t expected,
 #endif
 }
 
+// Returns the index in arg_names of the parameter called name, or n_names if
+// there isn't one.  With MICROPY_OPT_KW_ARG_CACHE the answer for a function
+// is remembered, keyed on its bytecode so all closures of a def share it.  An
+// entry is only used if the name at its slot matches, so one left behind by
+// a function that has since been freed can never give a wrong answer.
+STATIC size_t arg_name_slot(const mp_obj_fun_bc_t *self, const mp_obj_t *arg_names, size_t n_names, mp_obj_t name) {
+    #if MICROPY_OPT_KW_ARG_CACHE
+    // a short list is as quick to scan as the cache is to probe
+    mp_kw_arg_cache_entry_t *entry = NULL;
+    if (n_names > 4) {
+        size_t hash = ((uintptr_t)self->bytecode >> 2) ^ MP_OBJ_QSTR_VALUE(name);
+        entry = &MP_STATE_VM(kw_arg_cache)[hash & (MICROPY_OPT_KW_ARG_CACHE - 1)];
+        if (entry->bytecode == self->bytecode && entry->slot < n_names && arg_names[entry->slot] == name) {
+            return entry->slot;
+        }
+    }
+    #endif
+    for (size_t j = 0; j < n_names; j++) {
+        if (arg_names[j] == name) {
+            #if MICROPY_OPT_KW_ARG_CACHE
+            if (entry != NULL) {
+                entry->bytecode = self->bytecode;
+                entry->slot = j;
+            }
+            #endif
+            return j;
+        }
+    }
+    return n_names;
+}
+
 #if DEBUG_PRINT
 STATIC void dump_args(const mp_obj_t *a, size_t sz) {
     DEBUG_printf("%p: ", a);
@@ -199,15 +280,14 @@ void mp_setup_code_state(mp_code_state_t *code_state, size_t n_args, size_t n_kw
                     mp_raise_TypeError(translate("keywords must be strings"));
                 #endif
             }
-            for (size_t j = 0; j < n_pos_args + n_kwonly_args; j++) {
-                if (wanted_arg_name == arg_names[j]) {
-                    if (code_state->state[n_state - 1 - j] != MP_OBJ_NULL) {
-                        mp_raise_TypeError_varg(
-                            translate("function got multiple values for argument '%q'"), MP_OBJ_QSTR_VALUE(wanted_arg_name));
-                    }
-                    code_state->state[n_state - 1 - j] = kwargs[2 * i + 1];
-                    goto continue2;
+            size_t j = arg_name_slot(self, arg_names, n_pos_args + n_kwonly_args, wanted_arg_name);
+            if (j < n_pos_args + n_kwonly_args) {
+                if (code_state->state[n_state - 1 - j] != MP_OBJ_NULL) {
+                    mp_raise_TypeError_varg(
+                        translate("function got multiple values for argument '%q'"), MP_OBJ_QSTR_VALUE(wanted_arg_name));
                 }
+                code_state->state[n_state - 1 - j] = kwargs[2 * i + 1];
+                continue;
             }
             // Didn't find name match with positional args
             if ((scope_flags & MP_SCOPE_FLAG_VARKEYWORDS) == 0) {
@@ -219,7 +299,6 @@ void mp_setup_code_state(mp_code_state_t *code_state, size_t n_args, size_t n_kw
                 #endif
             }
             mp_obj_dict_store(dict, kwargs[2 * i], kwargs[2 * i + 1]);
-continue2:;
         }
 
         DEBUG_printf("Args with kws flattened: ");
@@ -294,7 +373,7 @@ continue2:;
     dump_args(code_state->state, n_state);
 }
 
-#if MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE
+#if MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE || MICROPY_OPT_FAST_EXCEPTIONS
 
 // The following table encodes the number of bytes that a specific opcode
 // takes up.  There are 3 special opcodes that always have an extra byte:
@@ -396,18 +475,19 @@ uint mp_opcode_format(const byte *ip, size_t *opcode_size) {
     uint f = (opcode_format_table[*ip >> 2] >> (2 * (*ip & 3))) & 3;
     const byte *ip_start = ip;
     if (f == MP_OPCODE_QSTR) {
+        if (MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE_DYNAMIC
+            && (*ip == MP_BC_LOAD_NAME
+                || *ip == MP_BC_LOAD_GLOBAL
+                || *ip == MP_BC_LOAD_ATTR
+                || *ip == MP_BC_STORE_ATTR)) {
+            ip += 1;
+        }
         ip += 3;
     } else {
         int extra_byte = (
             *ip == MP_BC_RAISE_VARARGS
             || *ip == MP_BC_MAKE_CLOSURE
             || *ip == MP_BC_MAKE_CLOSURE_DEFARGS
-            #if MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
-            || *ip == MP_BC_LOAD_NAME
-            || *ip == MP_BC_LOAD_GLOBAL
-            || *ip == MP_BC_LOAD_ATTR
-            || *ip == MP_BC_STORE_ATTR
-            #endif
         );
         ip += 1;
         if (f == MP_OPCODE_VAR_UINT) {
@@ -422,4 +502,4 @@ uint mp_opcode_format(const byte *ip, size_t *opcode_size) {
     return f;
 }
 
-#endif // MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE
+#endif // MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE || MICROPY_OPT_FAST_EXCEPTIONS
@@ -83,7 +83,12 @@ MP_DECLARE_CONST_FUN_OBJ_2(mp_op_getitem_obj);
 MP_DECLARE_CONST_FUN_OBJ_3(mp_op_setitem_obj);
 MP_DECLARE_CONST_FUN_OBJ_2(mp_op_delitem_obj);
 
+#if MICROPY_MULTI_INTERP
+#define mp_module___main__ (MP_STATE_VM(module_main))
+mp_obj_t mp_sys_state_attr(qstr attr);
+#else
 extern const mp_obj_module_t mp_module___main__;
+#endif
 extern const mp_obj_module_t mp_module_builtins;
 extern const mp_obj_module_t mp_module_array;
 extern const mp_obj_module_t mp_module_collections;
@@ -95,6 +100,8 @@ extern const mp_obj_module_t mp_module_ustruct;
 extern const mp_obj_module_t mp_module_sys;
 extern const mp_obj_module_t mp_module_gc;
 extern const mp_obj_module_t mp_module_thread;
+extern const mp_obj_module_t mp_module_profiler;
+extern const mp_obj_module_t mp_module_benchmark;
 
 extern const mp_obj_dict_t mp_module_builtins_globals;
 
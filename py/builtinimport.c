@@ -191,6 +191,217 @@ STATIC void do_execute_raw_code(mp_obj_t module_obj, mp_raw_code_t *raw_code, co
 }
 #endif
 
+#if MICROPY_MODULE_MPY_CACHE && MICROPY_ENABLE_COMPILER
+// A module compiled from foo.py is kept in MICROPY_MODULE_MPY_CACHE_DIR as
+// <hash of the absolute source path>.mpy, which holds:
+//
+//   "MPYC"
+//   uint32 firmware hash, source size, source mtime (little endian)
+//   uint16 length of the absolute source path, then the path
+//   the module in .mpy format
+//
+// An entry is only used if all of these match the running firmware and the
+// source file, so editing a module or updating the firmware recompiles it.
+// A new entry is written to a .tmp file and renamed into place, so a reset
+// part way through leaves the old entry, no entry or a stray .tmp file, but
+// never a truncated .mpy.
+
+#if !MICROPY_VFS || !MICROPY_PERSISTENT_CODE_LOAD || !MICROPY_PERSISTENT_CODE_SAVE
+#error MICROPY_MODULE_MPY_CACHE needs MICROPY_VFS and persistent code load and save
+#endif
+
+#include "genhdr/mpversion.h"
+#include "py/mperrno.h"
+#include "py/stream.h"
+#include "extmod/vfs.h"
+
+#define MPY_CACHE_HEADER_SIZE (4 + 3 * 4 + 2)
+
+typedef struct _mpy_cache_entry_t {
+    vstr_t source;
+    uint32_t key[3];
+    // MICROPY_MODULE_MPY_CACHE_DIR "/xxxxxxxx.mpy"
+    char file[sizeof(MICROPY_MODULE_MPY_CACHE_DIR) + 13];
+} mpy_cache_entry_t;
+
+// 32-bit FNV-1a; qstr hashes are too short to name files by.
+STATIC uint32_t mpy_cache_hash(const char *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ (byte)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Fills in the entry for a source file.  Returns false if the cache isn't in
+// use or the source can't be stat'd, and the module should be compiled as usual.
+STATIC bool mpy_cache_entry_init(mpy_cache_entry_t *entry, const char *file_str) {
+    if (mp_import_stat(MICROPY_MODULE_MPY_CACHE_DIR) != MP_IMPORT_STAT_DIR) {
+        return false;
+    }
+    vstr_init(&entry->source, 32);
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) != 0) {
+        vstr_clear(&entry->source);
+        return false;
+    }
+    if (file_str[0] != '/') {
+        const char *cwd = mp_obj_str_get_str(mp_vfs_getcwd());
+        vstr_add_str(&entry->source, cwd);
+        if (cwd[0] == '\0' || cwd[strlen(cwd) - 1] != '/') {
+            vstr_add_char(&entry->source, '/');
+        }
+    }
+    vstr_add_str(&entry->source, file_str);
+    mp_obj_t stat = mp_vfs_stat(mp_obj_new_str(file_str, strlen(file_str)));
+    mp_obj_t *items;
+    mp_obj_get_array_fixed_n(stat, 10, &items);
+    entry->key[1] = mp_obj_get_int_truncated(items[6]);
+    entry->key[2] = mp_obj_get_int_truncated(items[8]);
+    nlr_pop();
+
+    static const char firmware[] = MICROPY_GIT_HASH " " MICROPY_BUILD_DATE;
+    entry->key[0] = mpy_cache_hash(firmware, sizeof(firmware) - 1);
+
+    static const char hex[] = "0123456789abcdef";
+    uint32_t hash = mpy_cache_hash(entry->source.buf, entry->source.len);
+    char *name = entry->file;
+    memcpy(name, MICROPY_MODULE_MPY_CACHE_DIR "/", sizeof(MICROPY_MODULE_MPY_CACHE_DIR));
+    name += sizeof(MICROPY_MODULE_MPY_CACHE_DIR);
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        *name++ = hex[(hash >> shift) & 0xf];
+    }
+    memcpy(name, ".mpy", 5);
+    return true;
+}
+
+STATIC void mpy_cache_header(const mpy_cache_entry_t *entry, byte *header) {
+    memcpy(header, "MPYC", 4);
+    byte *h = header + 4;
+    for (size_t i = 0; i < MP_ARRAY_SIZE(entry->key); ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            *h++ = entry->key[i] >> (8 * j);
+        }
+    }
+    h[0] = entry->source.len;
+    h[1] = entry->source.len >> 8;
+}
+
+// Returns the cached module, or NULL if there's no valid entry for it.
+STATIC mp_raw_code_t *mpy_cache_load(const mpy_cache_entry_t *entry) {
+    if (mp_import_stat(entry->file) != MP_IMPORT_STAT_FILE) {
+        return NULL;
+    }
+    // Set once the file is open, so a failed load can close it.
+    mp_reader_t reader = { .close = NULL };
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_reader_new_file(&reader, entry->file);
+        byte expected[MPY_CACHE_HEADER_SIZE];
+        mpy_cache_header(entry, expected);
+        bool valid = true;
+        for (size_t i = 0; valid && i < MPY_CACHE_HEADER_SIZE + entry->source.len; ++i) {
+            byte b = i < MPY_CACHE_HEADER_SIZE ? expected[i] : entry->source.buf[i - MPY_CACHE_HEADER_SIZE];
+            valid = reader.readbyte(reader.data) == b;
+        }
+        mp_raw_code_t *rc = NULL;
+        if (valid) {
+            rc = mp_raw_code_load(&reader);
+        } else {
+            reader.close(reader.data);
+        }
+        nlr_pop();
+        return rc;
+    } else {
+        // unreadable or from an incompatible VM: recompile and replace it
+        if (reader.close != NULL) {
+            reader.close(reader.data);
+        }
+        return NULL;
+    }
+}
+
+STATIC void mpy_cache_remove(mp_obj_t path) {
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_vfs_remove(path);
+        nlr_pop();
+    }
+}
+
+// Writes the entry for rc to the open file f at path.  The file is closed, and
+// removed if the write fails.
+STATIC void mpy_cache_write(const mpy_cache_entry_t *entry, mp_raw_code_t *rc, mp_obj_t f, mp_obj_t path) {
+    vstr_t vstr;
+    mp_print_t print;
+    vstr_init_print(&vstr, 512, &print);
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        byte header[MPY_CACHE_HEADER_SIZE];
+        mpy_cache_header(entry, header);
+        vstr_add_strn(&vstr, (const char*)header, sizeof(header));
+        vstr_add_strn(&vstr, entry->source.buf, entry->source.len);
+        mp_raw_code_save(rc, &print);
+        mp_obj_t n = mp_stream_write(f, vstr.buf, vstr.len, MP_STREAM_RW_WRITE);
+        if (mp_obj_get_int(n) != (mp_int_t)vstr.len) {
+            mp_raise_OSError(MP_ENOSPC);
+        }
+        nlr_pop();
+        vstr_clear(&vstr);
+        mp_stream_close(f);
+    } else {
+        vstr_clear(&vstr);
+        mp_stream_close(f);
+        mpy_cache_remove(path);
+        nlr_jump(nlr.ret_val);
+    }
+}
+
+STATIC void mpy_cache_save(const mpy_cache_entry_t *entry, mp_raw_code_t *rc) {
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        size_t len = strlen(entry->file);
+        mp_obj_t path = mp_obj_new_str(entry->file, len);
+        vstr_t tmp;
+        vstr_init(&tmp, len + 1);
+        vstr_add_strn(&tmp, entry->file, len - 3);
+        vstr_add_str(&tmp, "tmp");
+        mp_obj_t tmp_path = mp_obj_new_str_from_vstr(&mp_type_str, &tmp);
+        // Open before serializing the module, so that a read-only filesystem,
+        // which is usual while the USB host has it, fails cheaply.
+        mp_obj_t args[2] = { tmp_path, MP_OBJ_NEW_QSTR(MP_QSTR_wb) };
+        mp_obj_t f = mp_vfs_open(MP_ARRAY_SIZE(args), args, (mp_map_t*)&mp_const_empty_map);
+        mpy_cache_write(entry, rc, f, tmp_path);
+        // FAT can't rename over an existing file
+        mpy_cache_remove(path);
+        mp_vfs_rename(tmp_path, path);
+        nlr_pop();
+    } else {
+        // The filesystem is read-only (e.g. the USB host has it), full, or the
+        // module has native code: just run it uncached.
+    }
+}
+
+STATIC void do_load_cached(mp_obj_t module_obj, const char *file_str) {
+    mpy_cache_entry_t entry;
+    if (!mpy_cache_entry_init(&entry, file_str)) {
+        mp_lexer_t *lex = mp_lexer_new_from_file(file_str);
+        do_load_from_lexer(module_obj, lex);
+        return;
+    }
+    mp_raw_code_t *rc = mpy_cache_load(&entry);
+    if (rc == NULL) {
+        mp_lexer_t *lex = mp_lexer_new_from_file(file_str);
+        qstr source_name = lex->source_name;
+        mp_parse_tree_t parse_tree = mp_parse(lex, MP_PARSE_FILE_INPUT);
+        rc = mp_compile_to_raw_code(&parse_tree, source_name, MP_EMIT_OPT_NONE, false);
+        mpy_cache_save(&entry, rc);
+    }
+    vstr_clear(&entry.source);
+    do_execute_raw_code(module_obj, rc, file_str);
+}
+#endif
+
 STATIC void do_load(mp_obj_t module_obj, vstr_t *file) {
     #if MICROPY_MODULE_FROZEN || MICROPY_PERSISTENT_CODE_LOAD || MICROPY_ENABLE_COMPILER
     char *file_str = vstr_null_terminated_str(file);
@@ -241,8 +452,12 @@ STATIC void do_load(mp_obj_t module_obj, vstr_t *file) {
     // If we can compile scripts then load the file and compile and execute it.
     #if MICROPY_ENABLE_COMPILER
     {
+        #if MICROPY_MODULE_MPY_CACHE
+        do_load_cached(module_obj, file_str);
+        #else
         mp_lexer_t *lex = mp_lexer_new_from_file(file_str);
         do_load_from_lexer(module_obj, lex);
+        #endif
         return;
     }
     #else
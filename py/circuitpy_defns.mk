@@ -217,6 +217,9 @@ endif
 ifeq ($(CIRCUITPY_RANDOM),1)
 SRC_PATTERNS += random/%
 endif
+ifeq ($(CIRCUITPY_RINGBUFFER),1)
+SRC_PATTERNS += ringbuffer/%
+endif
 ifeq ($(CIRCUITPY_ROTARYIO),1)
 SRC_PATTERNS += rotaryio/%
 endif
@@ -238,6 +241,9 @@ endif
 ifeq ($(CIRCUITPY_SOCKETPOOL),1)
 SRC_PATTERNS += socketpool/%
 endif
+ifeq ($(CIRCUITPY__HTTP),1)
+SRC_PATTERNS += _http/%
+endif
 ifeq ($(CIRCUITPY_SSL),1)
 SRC_PATTERNS += ssl/%
 endif
@@ -253,6 +259,9 @@ endif
 ifeq ($(CIRCUITPY_SUPERVISOR),1)
 SRC_PATTERNS += supervisor/%
 endif
+ifeq ($(CIRCUITPY_TELEMETRY),1)
+SRC_PATTERNS += telemetry/%
+endif
 ifeq ($(CIRCUITPY_TERMINALIO),1)
 SRC_PATTERNS += terminalio/% fontio/%
 endif
@@ -394,8 +403,10 @@ $(filter $(SRC_PATTERNS), \
 	digitalio/DriveMode.c \
 	digitalio/Pull.c \
 	fontio/Glyph.c \
+	_http/__init__.c \
 	math/__init__.c \
 	microcontroller/RunMode.c \
+	ringbuffer/__init__.c \
 )
 
 SRC_BINDINGS_ENUMS += \
@@ -404,8 +415,11 @@ SRC_BINDINGS_ENUMS += \
 SRC_SHARED_MODULE_ALL = \
 	_bleio/Address.c \
 	_bleio/Attribute.c \
+	_bleio/PacketQueue.c \
 	_bleio/ScanEntry.c \
+	_bleio/ScanFilter.c \
 	_bleio/ScanResults.c \
+	canio/Filter.c \
 	canio/Match.c \
 	canio/Message.c \
 	canio/RemoteTransmissionRequest.c \
@@ -449,6 +463,8 @@ SRC_SHARED_MODULE_ALL = \
 	fontio/__init__.c \
 	framebufferio/FramebufferDisplay.c \
 	framebufferio/__init__.c \
+	_http/ConnectionPool.c \
+	_http/Response.c \
 	ipaddress/IPv4Address.c \
 	ipaddress/__init__.c \
 	sdcardio/SDCard.c \
@@ -462,14 +478,19 @@ SRC_SHARED_MODULE_ALL = \
 	memorymonitor/AllocationSize.c \
 	network/__init__.c \
 	os/__init__.c \
+	random/Random.c \
 	random/__init__.c \
 	rgbmatrix/RGBMatrix.c \
 	rgbmatrix/__init__.c \
+	ringbuffer/RingBuffer.c \
 	sharpdisplay/SharpMemoryFramebuffer.c \
 	sharpdisplay/__init__.c \
 	socket/__init__.c \
 	storage/__init__.c \
+	struct/Struct.c \
 	struct/__init__.c \
+	telemetry/Buffer.c \
+	telemetry/__init__.c \
 	terminalio/Terminal.c \
 	terminalio/__init__.c \
 	time/__init__.c \
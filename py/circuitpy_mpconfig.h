@@ -75,7 +75,12 @@
 #define MICROPY_MODULE_BUILTIN_INIT      (1)
 #define MICROPY_NONSTANDARD_TYPECODES    (0)
 #define MICROPY_OPT_COMPUTED_GOTO        (1)
+#define MICROPY_OPT_FAST_EXCEPTIONS      (1)
+#define MICROPY_OPT_GEN_FRAME_POOL       (4)
+#define MICROPY_OPT_KW_ARG_CACHE         (CIRCUITPY_FULL_BUILD ? 32 : 0)
 #define MICROPY_PERSISTENT_CODE_LOAD     (1)
+// the .mpy import cache saves what it compiles
+#define MICROPY_PERSISTENT_CODE_SAVE     (MICROPY_MODULE_MPY_CACHE)
 
 #define MICROPY_PY_ARRAY                 (1)
 #define MICROPY_PY_ARRAY_SLICE_ASSIGN    (1)
@@ -121,6 +126,9 @@
 #define MICROPY_ENABLE_PYSTACK           (1)
 #define MICROPY_STACK_CHECK              (1)
 #define MICROPY_STREAMS_NON_BLOCK        (1)
+// Trace buffer entries are timestamped with the port's raw 32768Hz ticks.
+#define MICROPY_TRACE_TIMESTAMP()        supervisor_ticks_subticks32()
+#define MICROPY_TRACE_TIMESTAMP_HZ       (32768)
 #ifndef MICROPY_USE_INTERNAL_PRINTF
 #define MICROPY_USE_INTERNAL_PRINTF      (1)
 #endif
@@ -569,6 +577,13 @@ extern const struct _mp_obj_module_t random_module;
 #define RANDOM_MODULE
 #endif
 
+#if CIRCUITPY_RINGBUFFER
+extern const struct _mp_obj_module_t ringbuffer_module;
+#define RINGBUFFER_MODULE      { MP_OBJ_NEW_QSTR(MP_QSTR_ringbuffer), (mp_obj_t)&ringbuffer_module },
+#else
+#define RINGBUFFER_MODULE
+#endif
+
 #if CIRCUITPY_ROTARYIO
 extern const struct _mp_obj_module_t rotaryio_module;
 #define ROTARYIO_MODULE        { MP_OBJ_NEW_QSTR(MP_QSTR_rotaryio), (mp_obj_t)&rotaryio_module },
@@ -619,6 +634,13 @@ extern const struct _mp_obj_module_t socketpool_module;
 #define SOCKETPOOL_MODULE
 #endif
 
+#if CIRCUITPY__HTTP
+extern const struct _mp_obj_module_t _http_module;
+#define _HTTP_MODULE                { MP_OBJ_NEW_QSTR(MP_QSTR__http), (mp_obj_t)&_http_module },
+#else
+#define _HTTP_MODULE
+#endif
+
 #if CIRCUITPY_SSL
 extern const struct _mp_obj_module_t ssl_module;
 #define SSL_MODULE           { MP_OBJ_NEW_QSTR(MP_QSTR_ssl), (mp_obj_t)&ssl_module },
@@ -643,6 +665,7 @@ extern const struct _mp_obj_module_t storage_module;
 #if CIRCUITPY_STRUCT
 extern const struct _mp_obj_module_t struct_module;
 #define STRUCT_MODULE          { MP_OBJ_NEW_QSTR(MP_QSTR_struct), (mp_obj_t)&struct_module },
+#define MICROPY_PY_STRUCT_FORMAT_CACHE (4)
 #else
 #define STRUCT_MODULE
 #endif
@@ -654,6 +677,15 @@ extern const struct _mp_obj_module_t supervisor_module;
 #define SUPERVISOR_MODULE
 #endif
 
+#if CIRCUITPY_TELEMETRY
+extern const struct _mp_obj_module_t telemetry_module;
+#define TELEMETRY_MODULE       { MP_OBJ_NEW_QSTR(MP_QSTR_telemetry), (mp_obj_t)&telemetry_module },
+#define TELEMETRY_ROOT_POINTERS mp_obj_t active_telemetry_buffers;
+#else
+#define TELEMETRY_MODULE
+#define TELEMETRY_ROOT_POINTERS
+#endif
+
 #if CIRCUITPY_TIME
 extern const struct _mp_obj_module_t time_module;
 #define TIME_MODULE            { MP_OBJ_NEW_QSTR(MP_QSTR_time), (mp_obj_t)&time_module },
@@ -808,6 +840,7 @@ extern const struct _mp_obj_module_t wifi_module;
     RANDOM_MODULE \
     RE_MODULE \
     RGBMATRIX_MODULE \
+    RINGBUFFER_MODULE \
     ROTARYIO_MODULE \
     RTC_MODULE \
     SAMD_MODULE \
@@ -815,11 +848,13 @@ extern const struct _mp_obj_module_t wifi_module;
     SDIOIO_MODULE \
     SHARPDISPLAY_MODULE \
     SOCKETPOOL_MODULE \
+    _HTTP_MODULE \
     SSL_MODULE \
     STAGE_MODULE \
     STORAGE_MODULE \
     STRUCT_MODULE \
     SUPERVISOR_MODULE \
+    TELEMETRY_MODULE \
     TOUCHIO_MODULE \
     UHEAP_MODULE \
     USB_HID_MODULE \
@@ -859,6 +894,7 @@ extern const struct _mp_obj_module_t wifi_module;
     FLASH_ROOT_POINTERS \
     MEMORYMONITOR_ROOT_POINTERS \
     NETWORK_ROOT_POINTERS \
+    TELEMETRY_ROOT_POINTERS \
 
 void supervisor_run_background_tasks_if_tick(void);
 #define RUN_BACKGROUND_TASKS (supervisor_run_background_tasks_if_tick())
@@ -36,6 +36,31 @@ CFLAGS += -DCIRCUITPY_FULL_BUILD=$(CIRCUITPY_FULL_BUILD)
 MICROPY_PY_ASYNC_AWAIT ?= $(CIRCUITPY_FULL_BUILD)
 CFLAGS += -DMICROPY_PY_ASYNC_AWAIT=$(MICROPY_PY_ASYNC_AWAIT)
 
+# Sampling profiler for Python code, driven by the supervisor tick
+MICROPY_PY_PROFILER ?= 0
+CFLAGS += -DMICROPY_PY_PROFILER=$(MICROPY_PY_PROFILER)
+
+# Microbenchmark module using the CPU cycle counter
+MICROPY_PY_BENCHMARK ?= 0
+CFLAGS += -DMICROPY_PY_BENCHMARK=$(MICROPY_PY_BENCHMARK)
+
+# micropython.schedule() callback queue.  The depth is per priority level and
+# the batch is the most callbacks run each time the VM checks for them.
+MICROPY_ENABLE_SCHEDULER ?= 0
+CFLAGS += -DMICROPY_ENABLE_SCHEDULER=$(MICROPY_ENABLE_SCHEDULER)
+MICROPY_SCHEDULER_DEPTH ?= 4
+CFLAGS += -DMICROPY_SCHEDULER_DEPTH=$(MICROPY_SCHEDULER_DEPTH)
+MICROPY_SCHEDULER_BATCH ?= $(MICROPY_SCHEDULER_DEPTH)
+CFLAGS += -DMICROPY_SCHEDULER_BATCH=$(MICROPY_SCHEDULER_BATCH)
+
+# Cache directory listings while resolving imports instead of a stat per probe
+MICROPY_VFS_IMPORT_CACHE ?= $(CIRCUITPY_FULL_BUILD)
+CFLAGS += -DMICROPY_VFS_IMPORT_CACHE=$(MICROPY_VFS_IMPORT_CACHE)
+
+# Compile each imported .py once and keep the .mpy in /.mpycache, if it exists
+MICROPY_MODULE_MPY_CACHE ?= 0
+CFLAGS += -DMICROPY_MODULE_MPY_CACHE=$(MICROPY_MODULE_MPY_CACHE)
+
 CIRCUITPY_AESIO ?= 0
 CFLAGS += -DCIRCUITPY_AESIO=$(CIRCUITPY_AESIO)
 
@@ -188,6 +213,9 @@ CFLAGS += -DCIRCUITPY_RANDOM=$(CIRCUITPY_RANDOM)
 CIRCUITPY_RGBMATRIX ?= 0
 CFLAGS += -DCIRCUITPY_RGBMATRIX=$(CIRCUITPY_RGBMATRIX)
 
+CIRCUITPY_RINGBUFFER ?= $(CIRCUITPY_FULL_BUILD)
+CFLAGS += -DCIRCUITPY_RINGBUFFER=$(CIRCUITPY_RINGBUFFER)
+
 CIRCUITPY_ROTARYIO ?= 1
 CFLAGS += -DCIRCUITPY_ROTARYIO=$(CIRCUITPY_ROTARYIO)
 
@@ -212,6 +240,9 @@ CFLAGS += -DCIRCUITPY_SHARPDISPLAY=$(CIRCUITPY_SHARPDISPLAY)
 CIRCUITPY_SOCKETPOOL ?= $(CIRCUITPY_WIFI)
 CFLAGS += -DCIRCUITPY_SOCKETPOOL=$(CIRCUITPY_SOCKETPOOL)
 
+CIRCUITPY__HTTP ?= $(CIRCUITPY_SOCKETPOOL)
+CFLAGS += -DCIRCUITPY__HTTP=$(CIRCUITPY__HTTP)
+
 CIRCUITPY_SSL ?= $(CIRCUITPY_WIFI)
 CFLAGS += -DCIRCUITPY_SSL=$(CIRCUITPY_SSL)
 
@@ -228,6 +259,9 @@ CFLAGS += -DCIRCUITPY_STRUCT=$(CIRCUITPY_STRUCT)
 CIRCUITPY_SUPERVISOR ?= 1
 CFLAGS += -DCIRCUITPY_SUPERVISOR=$(CIRCUITPY_SUPERVISOR)
 
+CIRCUITPY_TELEMETRY ?= $(CIRCUITPY_FULL_BUILD)
+CFLAGS += -DCIRCUITPY_TELEMETRY=$(CIRCUITPY_TELEMETRY)
+
 CIRCUITPY_TERMINALIO ?= $(CIRCUITPY_DISPLAYIO)
 CFLAGS += -DCIRCUITPY_TERMINALIO=$(CIRCUITPY_TERMINALIO)
 
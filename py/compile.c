@@ -253,6 +253,8 @@ STATIC void compile_store_id(compiler_t *comp, qstr qst) {
 STATIC void compile_delete_id(compiler_t *comp, qstr qst) {
     if (comp->pass == MP_PASS_SCOPE) {
         mp_emit_common_get_id_for_modification(comp->scope_cur, qst);
+        // the emitter needs to know which locals can become unbound
+        scope_find(comp->scope_cur, qst)->flags |= ID_FLAG_IS_DELETED;
     } else {
         #if NEED_METHOD_TABLE
         mp_emit_common_id_op(comp->emit, &comp->emit_method_table->delete_id, comp->scope_cur, qst);
@@ -3300,7 +3302,7 @@ STATIC void scope_compute_things(scope_t *scope) {
                     id_info_t temp = *id_param; *id_param = *id; *id = temp;
                 }
                 break;
-            } else if (id_param == NULL && id->flags == ID_FLAG_IS_PARAM) {
+            } else if (id_param == NULL && (id->flags & ~ID_FLAG_IS_DELETED) == ID_FLAG_IS_PARAM) {
                 id_param = id;
             }
         }
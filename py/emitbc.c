@@ -39,6 +39,24 @@
 #define BYTES_FOR_INT ((BYTES_PER_WORD * 8 + 6) / 7)
 #define DUMMY_DATA_SIZE (BYTES_FOR_INT)
 
+#if MICROPY_COMP_PEEPHOLE
+// Instructions that are held back so they can be combined with, or cancelled
+// by, what follows them.  For the conditional jumps bit 0 is the condition.
+enum {
+    EMIT_BC_PENDING_NONE,
+    EMIT_BC_PENDING_LOAD_FAST,
+    EMIT_BC_PENDING_NOT,
+    EMIT_BC_PENDING_JUMP,
+    EMIT_BC_PENDING_POP_JUMP_IF_FALSE,
+    EMIT_BC_PENDING_POP_JUMP_IF_TRUE,
+    EMIT_BC_PENDING_POP_JUMP_IF_FALSE_JUMP, // followed by an unconditional jump
+    EMIT_BC_PENDING_POP_JUMP_IF_TRUE_JUMP,
+};
+
+// Number of labels remembered at the current offset, for jump threading
+#define EMIT_BC_MAX_LABELS_HERE (4)
+#endif
+
 struct _emit_t {
     // Accessed as mp_obj_t, so must be aligned as such, and we rely on the
     // memory allocator returning a suitably aligned pointer.
@@ -58,6 +76,23 @@ struct _emit_t {
     mp_uint_t max_num_labels;
     mp_uint_t *label_offsets;
 
+    #if MICROPY_COMP_PEEPHOLE
+    // Set after an unconditional jump, return or raise; cleared by the next
+    // label that is jumped to.  Nothing is written while it's set.
+    bool dead;
+    uint8_t pending_kind;
+    uint8_t num_labels_here;
+    mp_uint_t pending_arg;
+    mp_uint_t pending_arg2;
+    mp_uint_t labels_here[EMIT_BC_MAX_LABELS_HERE];
+    // For each label, whether any reachable instruction refers to it.  Found
+    // on MP_PASS_STACK_SIZE, used on MP_PASS_CODE_SIZE and MP_PASS_EMIT.
+    byte *label_used;
+    // For each label that sits on an unconditional jump, the target of that
+    // jump (else -1).  Found on MP_PASS_CODE_SIZE, used on MP_PASS_EMIT.
+    mp_uint_t *label_jump;
+    #endif
+
     size_t code_info_offset;
     size_t code_info_size;
     size_t bytecode_offset;
@@ -80,10 +115,18 @@ emit_t *emit_bc_new(void) {
 void emit_bc_set_max_num_labels(emit_t *emit, mp_uint_t max_num_labels) {
     emit->max_num_labels = max_num_labels;
     emit->label_offsets = m_new(mp_uint_t, emit->max_num_labels);
+    #if MICROPY_COMP_PEEPHOLE
+    emit->label_used = m_new(byte, emit->max_num_labels);
+    emit->label_jump = m_new(mp_uint_t, emit->max_num_labels);
+    #endif
 }
 
 void emit_bc_free(emit_t *emit) {
     m_del(mp_uint_t, emit->label_offsets, emit->max_num_labels);
+    #if MICROPY_COMP_PEEPHOLE
+    m_del(byte, emit->label_used, emit->max_num_labels);
+    m_del(mp_uint_t, emit->label_jump, emit->max_num_labels);
+    #endif
     m_del_obj(emit_t, emit);
 }
 
@@ -168,9 +211,50 @@ STATIC void emit_write_code_info_bytes_lines(emit_t *emit, mp_uint_t bytes_to_sk
 }
 #endif
 
+#if MICROPY_COMP_PEEPHOLE
+STATIC void emit_bc_flush_pending(emit_t *emit);
+
+static inline bool emit_bc_is_dead(emit_t *emit) {
+    return emit->dead;
+}
+
+// Called before writing an instruction that refers to a label.
+STATIC void emit_bc_pre_label(emit_t *emit, mp_uint_t label) {
+    if (!emit->dead) {
+        // flush first so bytecode_offset is that of this instruction
+        emit_bc_flush_pending(emit);
+        if (emit->pass == MP_PASS_STACK_SIZE) {
+            emit->label_used[label] = true;
+        }
+    }
+}
+#else
+static inline void emit_bc_flush_pending(emit_t *emit) {
+    (void)emit;
+}
+
+static inline bool emit_bc_is_dead(emit_t *emit) {
+    (void)emit;
+    return false;
+}
+
+static inline void emit_bc_pre_label(emit_t *emit, mp_uint_t label) {
+    (void)emit;
+    (void)label;
+}
+#endif
+
 // all functions must go through this one to emit byte code
 STATIC byte *emit_get_cur_to_write_bytecode(emit_t *emit, int num_bytes_to_write) {
     //printf("emit %d\n", num_bytes_to_write);
+    #if MICROPY_COMP_PEEPHOLE
+    if (emit->dead) {
+        // unreachable code is discarded
+        return emit->dummy_data;
+    }
+    emit_bc_flush_pending(emit);
+    emit->num_labels_here = 0;
+    #endif
     if (emit->pass < MP_PASS_EMIT) {
         emit->bytecode_offset += num_bytes_to_write;
         return emit->dummy_data;
@@ -254,7 +338,9 @@ STATIC void emit_write_bytecode_byte_obj(emit_t *emit, byte b, mp_obj_t obj) {
     #else
     // aligns the pointer so it is friendly to GC
     emit_write_bytecode_byte(emit, b);
-    emit->bytecode_offset = (size_t)MP_ALIGN(emit->bytecode_offset, sizeof(mp_obj_t));
+    if (!emit_bc_is_dead(emit)) {
+        emit->bytecode_offset = (size_t)MP_ALIGN(emit->bytecode_offset, sizeof(mp_obj_t));
+    }
     mp_obj_t *c = (mp_obj_t*)emit_get_cur_to_write_bytecode(emit, sizeof(mp_obj_t));
     // Verify thar c is already uint-aligned
     assert(c == MP_ALIGN(c, sizeof(mp_obj_t)));
@@ -270,7 +356,9 @@ STATIC void emit_write_bytecode_byte_raw_code(emit_t *emit, byte b, mp_raw_code_
     #else
     // aligns the pointer so it is friendly to GC
     emit_write_bytecode_byte(emit, b);
-    emit->bytecode_offset = (size_t)MP_ALIGN(emit->bytecode_offset, sizeof(void*));
+    if (!emit_bc_is_dead(emit)) {
+        emit->bytecode_offset = (size_t)MP_ALIGN(emit->bytecode_offset, sizeof(void*));
+    }
     void **c = (void**)emit_get_cur_to_write_bytecode(emit, sizeof(void*));
     // Verify thar c is already uint-aligned
     assert(c == MP_ALIGN(c, sizeof(void*)));
@@ -280,6 +368,7 @@ STATIC void emit_write_bytecode_byte_raw_code(emit_t *emit, byte b, mp_raw_code_
 
 // unsigned labels are relative to ip following this instruction, stored as 16 bits
 STATIC void emit_write_bytecode_byte_unsigned_label(emit_t *emit, byte b1, mp_uint_t label) {
+    emit_bc_pre_label(emit, label);
     mp_uint_t bytecode_offset;
     if (emit->pass < MP_PASS_EMIT) {
         bytecode_offset = 0;
@@ -294,6 +383,7 @@ STATIC void emit_write_bytecode_byte_unsigned_label(emit_t *emit, byte b1, mp_ui
 
 // signed labels are relative to ip following this instruction, stored as 16 bits, in excess
 STATIC void emit_write_bytecode_byte_signed_label(emit_t *emit, byte b1, mp_uint_t label) {
+    emit_bc_pre_label(emit, label);
     int bytecode_offset;
     if (emit->pass < MP_PASS_EMIT) {
         bytecode_offset = 0;
@@ -306,6 +396,107 @@ STATIC void emit_write_bytecode_byte_signed_label(emit_t *emit, byte b1, mp_uint
     c[2] = bytecode_offset >> 8;
 }
 
+#if MICROPY_COMP_PEEPHOLE
+
+// Follow a chain of unconditional jumps to its final destination.  The chains
+// are only known once MP_PASS_CODE_SIZE is complete; threading doesn't change
+// the size of the jump so the label offsets stay valid.
+STATIC mp_uint_t emit_bc_thread_label(emit_t *emit, mp_uint_t label) {
+    if (emit->pass == MP_PASS_EMIT) {
+        // bound the walk so a cycle of jumps (an infinite loop) terminates
+        for (int i = 0; i < 8; ++i) {
+            mp_uint_t next = emit->label_jump[label];
+            if (next == (mp_uint_t)-1 || next == label) {
+                break;
+            }
+            label = next;
+        }
+    }
+    return label;
+}
+
+STATIC void emit_bc_write_load_fast(emit_t *emit, mp_uint_t local_num) {
+    if (local_num <= 15) {
+        emit_write_bytecode_byte(emit, MP_BC_LOAD_FAST_MULTI + local_num);
+    } else {
+        emit_write_bytecode_byte_uint(emit, MP_BC_LOAD_FAST_N, local_num);
+    }
+}
+
+// Write an unconditional jump; what follows it is unreachable.
+STATIC void emit_bc_write_jump(emit_t *emit, mp_uint_t label) {
+    if (emit->pass == MP_PASS_CODE_SIZE) {
+        // any label at this offset now leads straight on to the jump target
+        for (size_t i = 0; i < emit->num_labels_here; ++i) {
+            emit->label_jump[emit->labels_here[i]] = label;
+        }
+    }
+    emit->dead = false;
+    emit_write_bytecode_byte_signed_label(emit, MP_BC_JUMP, emit_bc_thread_label(emit, label));
+    emit->dead = true;
+}
+
+STATIC void emit_bc_write_pop_jump_if(emit_t *emit, bool cond, mp_uint_t label) {
+    label = emit_bc_thread_label(emit, label);
+    if (cond) {
+        emit_write_bytecode_byte_signed_label(emit, MP_BC_POP_JUMP_IF_TRUE, label);
+    } else {
+        emit_write_bytecode_byte_signed_label(emit, MP_BC_POP_JUMP_IF_FALSE, label);
+    }
+}
+
+STATIC void emit_bc_flush_pending(emit_t *emit) {
+    int kind = emit->pending_kind;
+    emit->pending_kind = EMIT_BC_PENDING_NONE;
+    switch (kind) {
+        case EMIT_BC_PENDING_NONE:
+            break;
+        case EMIT_BC_PENDING_LOAD_FAST:
+            emit_bc_write_load_fast(emit, emit->pending_arg);
+            break;
+        case EMIT_BC_PENDING_NOT:
+            emit_write_bytecode_byte(emit, MP_BC_UNARY_OP_MULTI + MP_UNARY_OP_NOT);
+            break;
+        case EMIT_BC_PENDING_JUMP:
+            emit_bc_write_jump(emit, emit->pending_arg);
+            break;
+        case EMIT_BC_PENDING_POP_JUMP_IF_FALSE:
+        case EMIT_BC_PENDING_POP_JUMP_IF_TRUE:
+            emit_bc_write_pop_jump_if(emit, kind & 1, emit->pending_arg);
+            break;
+        default:
+            assert(kind == EMIT_BC_PENDING_POP_JUMP_IF_FALSE_JUMP || kind == EMIT_BC_PENDING_POP_JUMP_IF_TRUE_JUMP);
+            emit->dead = false;
+            emit_bc_write_pop_jump_if(emit, kind & 1, emit->pending_arg);
+            emit_bc_write_jump(emit, emit->pending_arg2);
+            break;
+    }
+}
+
+STATIC void emit_bc_set_pending(emit_t *emit, int kind, mp_uint_t arg) {
+    if (emit->dead) {
+        return;
+    }
+    emit_bc_flush_pending(emit);
+    emit->pending_kind = kind;
+    emit->pending_arg = arg;
+}
+
+// Parameters are bound on entry and stay bound unless they are deleted, so
+// loading one can't raise and "x = x" is a no-op.
+STATIC bool emit_bc_local_is_bound_param(emit_t *emit, mp_uint_t local_num) {
+    scope_t *scope = emit->scope;
+    for (int i = 0; i < scope->id_info_len; i++) {
+        id_info_t *id = &scope->id_info[i];
+        if (id->kind == ID_INFO_KIND_LOCAL && id->local_num == local_num) {
+            return (id->flags & (ID_FLAG_IS_PARAM | ID_FLAG_IS_DELETED)) == ID_FLAG_IS_PARAM;
+        }
+    }
+    return false;
+}
+
+#endif // MICROPY_COMP_PEEPHOLE
+
 void mp_emit_bc_start_pass(emit_t *emit, pass_kind_t pass, scope_t *scope) {
     emit->pass = pass;
     emit->stack_size = 0;
@@ -313,6 +504,16 @@ void mp_emit_bc_start_pass(emit_t *emit, pass_kind_t pass, scope_t *scope) {
     emit->scope = scope;
     emit->last_source_line_offset = 0;
     emit->last_source_line = 1;
+    #if MICROPY_COMP_PEEPHOLE
+    emit->dead = false;
+    emit->pending_kind = EMIT_BC_PENDING_NONE;
+    emit->num_labels_here = 0;
+    if (pass == MP_PASS_STACK_SIZE) {
+        memset(emit->label_used, false, emit->max_num_labels);
+    } else if (pass == MP_PASS_CODE_SIZE) {
+        memset(emit->label_jump, -1, emit->max_num_labels * sizeof(mp_uint_t));
+    }
+    #endif
     #ifndef NDEBUG
     // With debugging enabled labels are checked for unique assignment
     if (pass < MP_PASS_EMIT && emit->label_offsets != NULL) {
@@ -405,6 +606,8 @@ void mp_emit_bc_end_pass(emit_t *emit) {
         return;
     }
 
+    emit_bc_flush_pending(emit);
+
     // check stack is back to zero size
     assert(emit->stack_size == 0);
 
@@ -475,11 +678,23 @@ void mp_emit_bc_set_source_line(emit_t *emit, mp_uint_t source_line) {
         // If we compile with -O3, don't store line numbers.
         return;
     }
+    mp_uint_t bytecode_offset = emit->bytecode_offset;
+    #if MICROPY_COMP_PEEPHOLE
+    if (emit->pending_kind <= EMIT_BC_PENDING_NOT) {
+        emit_bc_flush_pending(emit);
+        bytecode_offset = emit->bytecode_offset;
+    } else if (emit->pending_kind != EMIT_BC_PENDING_JUMP) {
+        // Jumps are left pending so they can still be elided.  A conditional
+        // jump is 3 bytes whichever way it goes and belongs to the previous
+        // line; an unconditional one can't raise so its line doesn't matter.
+        bytecode_offset += 3;
+    }
+    #endif
     if (source_line > emit->last_source_line) {
-        mp_uint_t bytes_to_skip = emit->bytecode_offset - emit->last_source_line_offset;
+        mp_uint_t bytes_to_skip = bytecode_offset - emit->last_source_line_offset;
         mp_uint_t lines_to_skip = source_line - emit->last_source_line;
         emit_write_code_info_bytes_lines(emit, bytes_to_skip, lines_to_skip);
-        emit->last_source_line_offset = emit->bytecode_offset;
+        emit->last_source_line_offset = bytecode_offset;
         emit->last_source_line = source_line;
     }
 #else
@@ -494,6 +709,27 @@ void mp_emit_bc_label_assign(emit_t *emit, mp_uint_t l) {
         return;
     }
     assert(l < emit->max_num_labels);
+    #if MICROPY_COMP_PEEPHOLE
+    int kind = emit->pending_kind;
+    if (kind == EMIT_BC_PENDING_JUMP && emit->pending_arg == l) {
+        // jump to the next instruction
+        emit->pending_kind = EMIT_BC_PENDING_NONE;
+        emit->dead = false;
+    } else if (kind >= EMIT_BC_PENDING_POP_JUMP_IF_FALSE_JUMP && emit->pending_arg == l) {
+        // conditional jump over an unconditional jump: invert the condition
+        emit->pending_kind = EMIT_BC_PENDING_NONE;
+        emit->dead = false;
+        emit_bc_write_pop_jump_if(emit, !(kind & 1), emit->pending_arg2);
+    } else if (emit->pass == MP_PASS_STACK_SIZE || emit->label_used[l]) {
+        // code after a label is reachable if anything jumps to it (on the
+        // stack-size pass this isn't known yet, so assume it is)
+        emit_bc_flush_pending(emit);
+        emit->dead = false;
+    }
+    if (emit->pass == MP_PASS_CODE_SIZE && emit->num_labels_here < EMIT_BC_MAX_LABELS_HERE) {
+        emit->labels_here[emit->num_labels_here++] = l;
+    }
+    #endif
     if (emit->pass < MP_PASS_EMIT) {
         // assign label offset
         assert(emit->label_offsets[l] == (mp_uint_t)-1);
@@ -561,6 +797,13 @@ void mp_emit_bc_load_local(emit_t *emit, qstr qst, mp_uint_t local_num, int kind
     MP_STATIC_ASSERT(MP_BC_LOAD_FAST_N + MP_EMIT_IDOP_LOCAL_DEREF == MP_BC_LOAD_DEREF);
     (void)qst;
     emit_bc_pre(emit, 1);
+    #if MICROPY_COMP_PEEPHOLE
+    if (kind == MP_EMIT_IDOP_LOCAL_FAST) {
+        // held back in case it's stored straight back to the same local
+        emit_bc_set_pending(emit, EMIT_BC_PENDING_LOAD_FAST, local_num);
+        return;
+    }
+    #endif
     if (kind == MP_EMIT_IDOP_LOCAL_FAST && local_num <= 15) {
         emit_write_bytecode_byte(emit, MP_BC_LOAD_FAST_MULTI + local_num);
     } else {
@@ -625,6 +868,15 @@ void mp_emit_bc_store_local(emit_t *emit, qstr qst, mp_uint_t local_num, int kin
     MP_STATIC_ASSERT(MP_BC_STORE_FAST_N + MP_EMIT_IDOP_LOCAL_DEREF == MP_BC_STORE_DEREF);
     (void)qst;
     emit_bc_pre(emit, -1);
+    #if MICROPY_COMP_PEEPHOLE
+    if (kind == MP_EMIT_IDOP_LOCAL_FAST
+        && emit->pending_kind == EMIT_BC_PENDING_LOAD_FAST && emit->pending_arg == local_num
+        && emit_bc_local_is_bound_param(emit, local_num)) {
+        // x = x
+        emit->pending_kind = EMIT_BC_PENDING_NONE;
+        return;
+    }
+    #endif
     if (kind == MP_EMIT_IDOP_LOCAL_FAST && local_num <= 15) {
         emit_write_bytecode_byte(emit, MP_BC_STORE_FAST_MULTI + local_num);
     } else {
@@ -680,20 +932,45 @@ void mp_emit_bc_rot_three(emit_t *emit) {
 
 void mp_emit_bc_jump(emit_t *emit, mp_uint_t label) {
     emit_bc_pre(emit, 0);
+    #if MICROPY_COMP_PEEPHOLE
+    // held back in case the next thing is its target label
+    if (!emit->dead && (emit->pending_kind == EMIT_BC_PENDING_POP_JUMP_IF_FALSE
+        || emit->pending_kind == EMIT_BC_PENDING_POP_JUMP_IF_TRUE)) {
+        emit->pending_kind += 2;
+        emit->pending_arg2 = label;
+    } else {
+        emit_bc_set_pending(emit, EMIT_BC_PENDING_JUMP, label);
+    }
+    emit->dead = true;
+    #else
     emit_write_bytecode_byte_signed_label(emit, MP_BC_JUMP, label);
+    #endif
 }
 
 void mp_emit_bc_pop_jump_if(emit_t *emit, bool cond, mp_uint_t label) {
     emit_bc_pre(emit, -1);
+    #if MICROPY_COMP_PEEPHOLE
+    if (emit->pending_kind == EMIT_BC_PENDING_NOT) {
+        // "not" then a conditional jump is the opposite conditional jump
+        emit->pending_kind = EMIT_BC_PENDING_NONE;
+        cond = !cond;
+    }
+    // held back in case it only skips over an unconditional jump
+    emit_bc_set_pending(emit, EMIT_BC_PENDING_POP_JUMP_IF_FALSE + cond, label);
+    #else
     if (cond) {
         emit_write_bytecode_byte_signed_label(emit, MP_BC_POP_JUMP_IF_TRUE, label);
     } else {
         emit_write_bytecode_byte_signed_label(emit, MP_BC_POP_JUMP_IF_FALSE, label);
     }
+    #endif
 }
 
 void mp_emit_bc_jump_if_or_pop(emit_t *emit, bool cond, mp_uint_t label) {
     emit_bc_pre(emit, -1);
+    #if MICROPY_COMP_PEEPHOLE
+    label = emit_bc_thread_label(emit, label);
+    #endif
     if (cond) {
         emit_write_bytecode_byte_signed_label(emit, MP_BC_JUMP_IF_TRUE_OR_POP, label);
     } else {
@@ -712,10 +989,13 @@ void mp_emit_bc_unwind_jump(emit_t *emit, mp_uint_t label, mp_uint_t except_dept
                 emit_write_bytecode_byte(emit, MP_BC_POP_TOP);
             }
         }
-        emit_write_bytecode_byte_signed_label(emit, MP_BC_JUMP, label & ~MP_EMIT_BREAK_FROM_FOR);
+        mp_emit_bc_jump(emit, label & ~MP_EMIT_BREAK_FROM_FOR);
     } else {
         emit_write_bytecode_byte_signed_label(emit, MP_BC_UNWIND_JUMP, label & ~MP_EMIT_BREAK_FROM_FOR);
         emit_write_bytecode_byte(emit, ((label & MP_EMIT_BREAK_FROM_FOR) ? 0x80 : 0) | except_depth);
+        #if MICROPY_COMP_PEEPHOLE
+        emit->dead = true;
+        #endif
     }
 }
 
@@ -773,6 +1053,13 @@ void mp_emit_bc_pop_except(emit_t *emit) {
 
 void mp_emit_bc_unary_op(emit_t *emit, mp_unary_op_t op) {
     emit_bc_pre(emit, 0);
+    #if MICROPY_COMP_PEEPHOLE
+    if (op == MP_UNARY_OP_NOT) {
+        // held back in case a conditional jump follows
+        emit_bc_set_pending(emit, EMIT_BC_PENDING_NOT, 0);
+        return;
+    }
+    #endif
     emit_write_bytecode_byte(emit, MP_BC_UNARY_OP_MULTI + op);
 }
 
@@ -788,8 +1075,7 @@ void mp_emit_bc_binary_op(emit_t *emit, mp_binary_op_t op) {
     emit_bc_pre(emit, -1);
     emit_write_bytecode_byte(emit, MP_BC_BINARY_OP_MULTI + op);
     if (invert) {
-        emit_bc_pre(emit, 0);
-        emit_write_bytecode_byte(emit, MP_BC_UNARY_OP_MULTI + MP_UNARY_OP_NOT);
+        mp_emit_bc_unary_op(emit, MP_UNARY_OP_NOT);
     }
 }
 
@@ -885,12 +1171,18 @@ void mp_emit_bc_return_value(emit_t *emit) {
     emit_bc_pre(emit, -1);
     emit->last_emit_was_return_value = true;
     emit_write_bytecode_byte(emit, MP_BC_RETURN_VALUE);
+    #if MICROPY_COMP_PEEPHOLE
+    emit->dead = true;
+    #endif
 }
 
 void mp_emit_bc_raise_varargs(emit_t *emit, mp_uint_t n_args) {
     assert(n_args <= 2);
     emit_bc_pre(emit, -n_args);
     emit_write_bytecode_byte_byte(emit, MP_BC_RAISE_VARARGS, n_args);
+    #if MICROPY_COMP_PEEPHOLE
+    emit->dead = true;
+    #endif
 }
 
 void mp_emit_bc_yield(emit_t *emit, int kind) {
@@ -29,6 +29,7 @@
 #include <string.h>
 
 #include "py/gc.h"
+#include "py/mptrace.h"
 #include "py/runtime.h"
 
 #include "supervisor/shared/safe_mode.h"
@@ -357,6 +358,7 @@ STATIC void gc_mark(void* ptr) {
 }
 
 void gc_collect_start(void) {
+    MP_TRACE_BEGIN(MP_TRACE_EVENT_GC_COLLECT, 0);
     GC_ENTER();
     MP_STATE_MEM(gc_lock_depth)++;
     #if MICROPY_GC_ALLOC_THRESHOLD
@@ -401,9 +403,11 @@ void gc_collect_end(void) {
     MP_STATE_MEM(gc_last_free_atb_index) = MP_STATE_MEM(gc_alloc_table_byte_len) - 1;
     MP_STATE_MEM(gc_lock_depth)--;
     GC_EXIT();
+    MP_TRACE_END(MP_TRACE_EVENT_GC_COLLECT, 0);
 }
 
 void gc_sweep_all(void) {
+    MP_TRACE_BEGIN(MP_TRACE_EVENT_GC_COLLECT, 0);
     GC_ENTER();
     MP_STATE_MEM(gc_lock_depth)++;
     MP_STATE_MEM(gc_stack_overflow) = 0;
@@ -661,6 +665,11 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
     memorymonitor_track_allocation(end_block - start_block + 1);
     #endif
 
+    #if MICROPY_GC_ALLOC_COUNTERS
+    MP_STATE_MEM(gc_alloc_count)++;
+    MP_STATE_MEM(gc_alloc_bytes) += (end_block - start_block + 1) * BYTES_PER_BLOCK;
+    #endif
+
     return ret_ptr;
 }
 
@@ -951,6 +960,11 @@ void *gc_realloc(void *ptr_in, size_t n_bytes, bool allow_move) {
         memorymonitor_track_allocation(new_blocks);
         #endif
 
+        #if MICROPY_GC_ALLOC_COUNTERS
+        MP_STATE_MEM(gc_alloc_count)++;
+        MP_STATE_MEM(gc_alloc_bytes) += (new_blocks - n_blocks) * BYTES_PER_BLOCK;
+        #endif
+
         return ptr_in;
     }
 
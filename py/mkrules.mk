@@ -114,13 +114,15 @@ $(MPY_CROSS): $(TOP)/py/*.[ch] $(TOP)/mpy-cross/*.[ch] $(TOP)/ports/windows/fmod
 # Do any preprocessing necessary: currently, this adds version information, removes examples, and
 # non-library .py files in the modules (setup.py and conf.py)
 # Then compile .mpy files from all the .py files, placing them in the same directories as the .py files.
+# mpy-cross compiles them all in one batch, one worker per CPU, reusing outputs from
+# $(BUILD)/frozen_mpy_cache for sources that haven't changed.
 $(BUILD)/frozen_mpy: $(FROZEN_MPY_DIRS)
 	$(ECHO) FREEZE $(FROZEN_MPY_DIRS)
 	$(Q)$(MKDIR) -p $@
 	$(Q)$(PREPROCESS_FROZEN_MODULES) -o $@ $(FROZEN_MPY_DIRS)
 	$(Q)$(CD) $@ && \
 $(FIND) -L . -type f -name '*.py' | sed 's=^\./==' | \
-xargs -n1 "$(abspath $(MPY_CROSS))" $(MPY_CROSS_FLAGS)
+"$(abspath $(MPY_CROSS))" $(MPY_CROSS_FLAGS) -j0 -C "$(abspath $(BUILD))/frozen_mpy_cache" @-
 
 # to build frozen_mpy.c from all .mpy files
 # You need to define MPY_TOOL_LONGINT_IMPL in mpconfigport.mk
@@ -0,0 +1,180 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/mphal.h"
+#include "py/objtuple.h"
+#include "py/runtime.h"
+
+#include "supervisor/shared/translate.h"
+
+#if MICROPY_PY_BENCHMARK
+
+// Microbenchmarks timed with the CPU cycle counter.
+//
+// run() calls the function once per sample and times each call separately,
+// so the reported percentiles show the spread between calls rather than
+// averaging it away.  The cost of reading the counter itself is measured
+// first and subtracted from every sample.
+
+STATIC mp_obj_t benchmark_cycles(void) {
+    return mp_obj_new_int_from_uint(mp_hal_ticks_cpu());
+}
+MP_DEFINE_CONST_FUN_OBJ_0(benchmark_cycles_obj, benchmark_cycles);
+
+STATIC mp_obj_t benchmark_frequency(void) {
+    return mp_obj_new_int_from_uint(mp_hal_ticks_cpu_hz());
+}
+MP_DEFINE_CONST_FUN_OBJ_0(benchmark_frequency_obj, benchmark_frequency);
+
+// Shell sort, which needs no recursion or extra memory.
+STATIC void benchmark_sort(mp_uint_t *samples, size_t n) {
+    size_t gap = 1;
+    while (gap < n / 3) {
+        gap = gap * 3 + 1;
+    }
+    for (; gap > 0; gap /= 3) {
+        for (size_t i = gap; i < n; i++) {
+            mp_uint_t value = samples[i];
+            size_t j = i;
+            for (; j >= gap && samples[j - gap] > value; j -= gap) {
+                samples[j] = samples[j - gap];
+            }
+            samples[j] = value;
+        }
+    }
+}
+
+STATIC mp_obj_t benchmark_per_iteration(size_t total, size_t iterations) {
+    #if MICROPY_PY_BUILTINS_FLOAT
+    return mp_obj_new_float((mp_float_t)total / iterations);
+    #else
+    return mp_obj_new_int_from_uint(total / iterations);
+    #endif
+}
+
+// run(function, iterations=1000, *, warmup=10): call function repeatedly and
+// return statistics of the time taken per call in CPU cycles
+STATIC mp_obj_t benchmark_run(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_function, ARG_iterations, ARG_warmup };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_function, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_iterations, MP_ARG_INT, {.u_int = 1000} },
+        { MP_QSTR_warmup, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 10} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t function = args[ARG_function].u_obj;
+    if (!mp_obj_is_callable(function)) {
+        mp_raise_TypeError_varg(translate("'%q' object is not callable"), mp_obj_get_type_qstr(function));
+    }
+    mp_int_t iterations = args[ARG_iterations].u_int;
+    if (iterations < 1) {
+        mp_raise_ValueError_varg(translate("%q must be >= 1"), MP_QSTR_iterations);
+    }
+    mp_int_t warmup = args[ARG_warmup].u_int;
+    if (warmup < 0) {
+        mp_raise_ValueError_varg(translate("%q must be >= 0"), MP_QSTR_warmup);
+    }
+
+    mp_uint_t *samples = m_new(mp_uint_t, iterations);
+
+    // Warm up caches, lazily created attributes and the like.
+    for (mp_int_t i = 0; i < warmup; i++) {
+        mp_call_function_0(function);
+    }
+
+    // The minimum over a few back-to-back reads is the fixed cost of timing.
+    mp_uint_t overhead = (mp_uint_t)-1;
+    for (int i = 0; i < 8; i++) {
+        mp_uint_t start = mp_hal_ticks_cpu();
+        mp_uint_t elapsed = mp_hal_ticks_cpu() - start;
+        if (elapsed < overhead) {
+            overhead = elapsed;
+        }
+    }
+
+    #if MICROPY_GC_ALLOC_COUNTERS
+    size_t alloc_count = MP_STATE_MEM(gc_alloc_count);
+    size_t alloc_bytes = MP_STATE_MEM(gc_alloc_bytes);
+    #endif
+    for (mp_int_t i = 0; i < iterations; i++) {
+        mp_uint_t start = mp_hal_ticks_cpu();
+        mp_call_function_0(function);
+        mp_uint_t elapsed = mp_hal_ticks_cpu() - start;
+        samples[i] = elapsed > overhead ? elapsed - overhead : 0;
+    }
+    #if MICROPY_GC_ALLOC_COUNTERS
+    alloc_count = MP_STATE_MEM(gc_alloc_count) - alloc_count;
+    alloc_bytes = MP_STATE_MEM(gc_alloc_bytes) - alloc_bytes;
+    #endif
+
+    // Average before sorting; the sum of 32-bit samples may need 64 bits.
+    uint64_t total = 0;
+    for (mp_int_t i = 0; i < iterations; i++) {
+        total += samples[i];
+    }
+    benchmark_sort(samples, iterations);
+
+    static const qstr fields[] = {
+        MP_QSTR_iterations, MP_QSTR_min, MP_QSTR_median, MP_QSTR_p99, MP_QSTR_max,
+        MP_QSTR_mean, MP_QSTR_allocs, MP_QSTR_alloc_bytes,
+    };
+    mp_obj_t items[MP_ARRAY_SIZE(fields)] = {
+        MP_OBJ_NEW_SMALL_INT(iterations),
+        mp_obj_new_int_from_uint(samples[0]),
+        mp_obj_new_int_from_uint(samples[(iterations - 1) / 2]),
+        mp_obj_new_int_from_uint(samples[(iterations - 1) * 99 / 100]),
+        mp_obj_new_int_from_uint(samples[iterations - 1]),
+        mp_obj_new_int_from_uint(total / iterations),
+        #if MICROPY_GC_ALLOC_COUNTERS
+        benchmark_per_iteration(alloc_count, iterations),
+        benchmark_per_iteration(alloc_bytes, iterations),
+        #else
+        mp_const_none,
+        mp_const_none,
+        #endif
+    };
+    m_del(mp_uint_t, samples, iterations);
+    return mp_obj_new_attrtuple(fields, MP_ARRAY_SIZE(fields), items);
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(benchmark_run_obj, 1, benchmark_run);
+
+STATIC const mp_rom_map_elem_t mp_module_benchmark_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_benchmark) },
+    { MP_ROM_QSTR(MP_QSTR_cycles), MP_ROM_PTR(&benchmark_cycles_obj) },
+    { MP_ROM_QSTR(MP_QSTR_frequency), MP_ROM_PTR(&benchmark_frequency_obj) },
+    { MP_ROM_QSTR(MP_QSTR_run), MP_ROM_PTR(&benchmark_run_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_benchmark_globals, mp_module_benchmark_globals_table);
+
+const mp_obj_module_t mp_module_benchmark = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&mp_module_benchmark_globals,
+};
+
+#endif // MICROPY_PY_BENCHMARK
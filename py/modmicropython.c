@@ -31,6 +31,7 @@
 #include "py/runtime.h"
 #include "py/gc.h"
 #include "py/mphal.h"
+#include "py/mptrace.h"
 
 #include "supervisor/shared/translate.h"
 
@@ -150,13 +151,57 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_micropython_kbd_intr_obj, mp_micropython_kbd
 #endif
 
 #if MICROPY_ENABLE_SCHEDULER
-STATIC mp_obj_t mp_micropython_schedule(mp_obj_t function, mp_obj_t arg) {
-    if (!mp_sched_schedule(function, arg)) {
+STATIC mp_obj_t mp_micropython_schedule(size_t n_args, const mp_obj_t *args) {
+    mp_int_t priority = MP_SCHED_PRIORITY_NORMAL;
+    if (n_args > 2) {
+        priority = mp_obj_get_int(args[2]);
+        if (priority < 0 || priority >= MP_SCHED_NUM_PRIORITIES) {
+            mp_raise_ValueError(translate("invalid priority"));
+        }
+    }
+    if (!mp_sched_schedule_priority(args[0], args[1], priority)) {
         mp_raise_msg(&mp_type_RuntimeError, translate("schedule stack full"));
     }
     return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_2(mp_micropython_schedule_obj, mp_micropython_schedule);
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_micropython_schedule_obj, 2, 3, mp_micropython_schedule);
+
+STATIC mp_obj_t mp_micropython_sched_stats(void) {
+    mp_uint_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    mp_obj_t items[] = {
+        MP_OBJ_NEW_SMALL_INT(MP_STATE_VM(sched_len)),
+        MP_OBJ_NEW_SMALL_INT(MP_STATE_VM(sched_peak)),
+        mp_obj_new_int_from_uint(MP_STATE_VM(sched_dropped)),
+    };
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(items), items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_micropython_sched_stats_obj, mp_micropython_sched_stats);
+#endif
+
+#if MICROPY_VFS && MICROPY_VFS_IMPORT_CACHE
+STATIC mp_obj_t mp_micropython_import_cache_stats(void) {
+    mp_obj_t items[] = {
+        mp_obj_new_int_from_uint(MP_STATE_VM(vfs_import_cache_dirs)),
+        mp_obj_new_int_from_uint(MP_STATE_VM(vfs_import_cache_hits)),
+        mp_obj_new_int_from_uint(MP_STATE_VM(vfs_import_cache_misses)),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(items), items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_micropython_import_cache_stats_obj, mp_micropython_import_cache_stats);
+#endif
+
+#if MICROPY_TRACE_BUFFER
+STATIC mp_obj_t mp_micropython_trace_enable(mp_obj_t enable_in) {
+    mp_trace_set_enabled(mp_obj_is_true(enable_in));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_micropython_trace_enable_obj, mp_micropython_trace_enable);
+
+STATIC mp_obj_t mp_micropython_trace_dump(void) {
+    return mp_trace_dump();
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_micropython_trace_dump_obj, mp_micropython_trace_dump);
 #endif
 
 STATIC const mp_rom_map_elem_t mp_module_micropython_globals_table[] = {
@@ -192,6 +237,14 @@ STATIC const mp_rom_map_elem_t mp_module_micropython_globals_table[] = {
     #endif
     #if MICROPY_ENABLE_SCHEDULER
     { MP_ROM_QSTR(MP_QSTR_schedule), MP_ROM_PTR(&mp_micropython_schedule_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sched_stats), MP_ROM_PTR(&mp_micropython_sched_stats_obj) },
+    #endif
+    #if MICROPY_VFS && MICROPY_VFS_IMPORT_CACHE
+    { MP_ROM_QSTR(MP_QSTR_import_cache_stats), MP_ROM_PTR(&mp_micropython_import_cache_stats_obj) },
+    #endif
+    #if MICROPY_TRACE_BUFFER
+    { MP_ROM_QSTR(MP_QSTR_trace_enable), MP_ROM_PTR(&mp_micropython_trace_enable_obj) },
+    { MP_ROM_QSTR(MP_QSTR_trace_dump), MP_ROM_PTR(&mp_micropython_trace_dump_obj) },
     #endif
 };
 
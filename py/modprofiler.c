@@ -0,0 +1,195 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/bc.h"
+#include "py/mpstate.h"
+#include "py/objfun.h"
+#include "py/profiler.h"
+#include "py/runtime.h"
+
+#include "supervisor/shared/translate.h"
+
+#if MICROPY_PY_PROFILER
+
+// A sampling profiler for Python code.
+//
+// While running, the port calls mp_profiler_sample() from a timer interrupt
+// (or SIGPROF on unix).  Each sample records the innermost bytecode function
+// and its instruction offset, and is only resolved to a source line by dump().
+// The sample buffer is a root pointer, so sampled functions stay alive until
+// the next start().
+
+void mp_profiler_sample(void) {
+    if (!MP_STATE_VM(profiler_running)) {
+        return;
+    }
+    const mp_code_state_t *code_state = MP_STATE_THREAD(current_code_state);
+    if (code_state == NULL) {
+        return;
+    }
+    size_t n = MP_STATE_VM(profiler_count);
+    if (n >= MP_STATE_VM(profiler_capacity)) {
+        MP_STATE_VM(profiler_dropped)++;
+        return;
+    }
+    mp_profiler_sample_t *sample = &MP_STATE_VM(profiler_samples)[n];
+    sample->fun_bc = code_state->fun_bc;
+    sample->offset = code_state->ip - code_state->fun_bc->bytecode;
+    MP_STATE_VM(profiler_count) = n + 1;
+}
+
+// The port's timer is shared by the whole process, so only the VM that
+// started it may stop it.  Identified by its profiler_running flag.
+STATIC volatile bool *profiler_timer_owner;
+
+STATIC void profiler_stop_sampling(void) {
+    if (MP_STATE_VM(profiler_running)) {
+        MP_STATE_VM(profiler_running) = false;
+        if (profiler_timer_owner == &MP_STATE_VM(profiler_running)) {
+            profiler_timer_owner = NULL;
+            mp_profiler_port_stop();
+        }
+    }
+}
+
+void mp_profiler_init(void) {
+    MP_STATE_VM(profiler_running) = false;
+    MP_STATE_VM(profiler_samples) = NULL;
+    MP_STATE_VM(profiler_capacity) = 0;
+    MP_STATE_VM(profiler_count) = 0;
+    MP_STATE_VM(profiler_dropped) = 0;
+}
+
+void mp_profiler_reset(void) {
+    profiler_stop_sampling();
+    MP_STATE_VM(profiler_samples) = NULL;
+    MP_STATE_VM(profiler_capacity) = 0;
+    MP_STATE_VM(profiler_count) = 0;
+    MP_STATE_VM(profiler_dropped) = 0;
+}
+
+// start(samples=1000, rate=1000): discard previous samples and start sampling
+STATIC mp_obj_t profiler_start(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_samples, ARG_rate };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_samples, MP_ARG_INT, {.u_int = 1000} },
+        { MP_QSTR_rate, MP_ARG_INT, {.u_int = MP_PROFILER_DEFAULT_RATE_HZ} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    if (MP_STATE_VM(profiler_running) || profiler_timer_owner != NULL) {
+        mp_raise_RuntimeError(translate("Already running"));
+    }
+    mp_int_t capacity = args[ARG_samples].u_int;
+    mp_int_t rate = args[ARG_rate].u_int;
+    if (capacity < 1) {
+        mp_raise_ValueError_varg(translate("%q must be >= 1"), MP_QSTR_samples);
+    }
+    if (rate < 1) {
+        mp_raise_ValueError_varg(translate("%q must be >= 1"), MP_QSTR_rate);
+    }
+
+    mp_profiler_reset();
+    MP_STATE_VM(profiler_samples) = m_new(mp_profiler_sample_t, capacity);
+    MP_STATE_VM(profiler_capacity) = capacity;
+    MP_STATE_VM(profiler_running) = true;
+    profiler_timer_owner = &MP_STATE_VM(profiler_running);
+    mp_profiler_port_start(rate);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(profiler_start_obj, 0, profiler_start);
+
+// stop(): stop sampling, returning the number of samples dropped because the
+// sample buffer was full
+STATIC mp_obj_t profiler_stop(void) {
+    profiler_stop_sampling();
+    return MP_OBJ_NEW_SMALL_INT(MP_STATE_VM(profiler_dropped));
+}
+MP_DEFINE_CONST_FUN_OBJ_0(profiler_stop_obj, profiler_stop);
+
+// dump(): return the samples taken so far as a list of
+// (hits, filename, line, function) tuples, most frequent first
+STATIC mp_obj_t profiler_dump(void) {
+    mp_obj_t hits = mp_obj_new_dict(0);
+    mp_map_t *hits_map = mp_obj_dict_get_map(hits);
+
+    // Take the count once; samples arriving while we resolve are left for
+    // the next dump.
+    size_t n = MP_STATE_VM(profiler_count);
+    const mp_profiler_sample_t *samples = MP_STATE_VM(profiler_samples);
+    for (size_t i = 0; i < n; i++) {
+        const byte *bytecode = samples[i].fun_bc->bytecode;
+        qstr block_name, source_file;
+        size_t source_line;
+        mp_bytecode_get_source_info(bytecode, bytecode + samples[i].offset, &block_name, &source_file, &source_line);
+        mp_obj_t key_items[3] = {
+            MP_OBJ_NEW_QSTR(source_file),
+            MP_OBJ_NEW_SMALL_INT(source_line),
+            MP_OBJ_NEW_QSTR(block_name),
+        };
+        mp_obj_t key = mp_obj_new_tuple(3, key_items);
+        mp_map_elem_t *elem = mp_map_lookup(hits_map, key, MP_MAP_LOOKUP_ADD_IF_NOT_FOUND);
+        if (elem->value == MP_OBJ_NULL) {
+            elem->value = MP_OBJ_NEW_SMALL_INT(1);
+        } else {
+            elem->value = MP_OBJ_NEW_SMALL_INT(MP_OBJ_SMALL_INT_VALUE(elem->value) + 1);
+        }
+    }
+
+    mp_obj_t result = mp_obj_new_list(0, NULL);
+    for (size_t i = 0; i < hits_map->alloc; i++) {
+        if (!MP_MAP_SLOT_IS_FILLED(hits_map, i)) {
+            continue;
+        }
+        mp_obj_tuple_t *key = MP_OBJ_TO_PTR(hits_map->table[i].key);
+        mp_obj_t items[4] = { hits_map->table[i].value, key->items[0], key->items[1], key->items[2] };
+        mp_obj_list_append(result, mp_obj_new_tuple(4, items));
+    }
+
+    const mp_obj_t reverse[2] = { MP_OBJ_NEW_QSTR(MP_QSTR_reverse), mp_const_true };
+    mp_map_t sort_kwargs;
+    mp_map_init_fixed_table(&sort_kwargs, 1, reverse);
+    mp_obj_list_sort(1, &result, &sort_kwargs);
+    return result;
+}
+MP_DEFINE_CONST_FUN_OBJ_0(profiler_dump_obj, profiler_dump);
+
+STATIC const mp_rom_map_elem_t mp_module_profiler_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_profiler) },
+    { MP_ROM_QSTR(MP_QSTR_start), MP_ROM_PTR(&profiler_start_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stop), MP_ROM_PTR(&profiler_stop_obj) },
+    { MP_ROM_QSTR(MP_QSTR_dump), MP_ROM_PTR(&profiler_dump_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_profiler_globals, mp_module_profiler_globals_table);
+
+const mp_obj_module_t mp_module_profiler = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&mp_module_profiler_globals,
+};
+
+#endif // MICROPY_PY_PROFILER
@@ -124,6 +124,13 @@ MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_sys_print_exception_obj, 1, 2, mp_sys_pri
 #if MICROPY_PY_SYS_EXC_INFO
 STATIC mp_obj_t mp_sys_exc_info(void) {
     mp_obj_t cur_exc = MP_OBJ_FROM_PTR(MP_STATE_VM(cur_exception));
+    #if MICROPY_OPT_FAST_EXCEPTIONS
+    if (cur_exc != MP_OBJ_NULL && MP_OBJ_IS_FAST_EXCEPTION(cur_exc)) {
+        // the except handler still owns the preallocated exception
+        cur_exc = mp_obj_exception_fast_copy(cur_exc);
+        MP_STATE_VM(cur_exception) = MP_OBJ_TO_PTR(cur_exc);
+    }
+    #endif
     mp_obj_tuple_t *t = MP_OBJ_TO_PTR(mp_obj_new_tuple(3, NULL));
 
     if (cur_exc == MP_OBJ_NULL) {
@@ -148,11 +155,32 @@ STATIC mp_obj_t mp_sys_getsizeof(mp_obj_t obj) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_sys_getsizeof_obj, mp_sys_getsizeof);
 #endif
 
+#if MICROPY_MULTI_INTERP
+// The attributes of sys that belong to the running interpreter; a constant
+// table can't refer to them so they are looked up by module_attr instead.
+mp_obj_t mp_sys_state_attr(qstr attr) {
+    switch (attr) {
+        case MP_QSTR_path:
+            return MP_OBJ_FROM_PTR(&MP_STATE_VM(mp_sys_path_obj));
+        case MP_QSTR_argv:
+            return MP_OBJ_FROM_PTR(&MP_STATE_VM(mp_sys_argv_obj));
+        #if MICROPY_PY_SYS_MODULES
+        case MP_QSTR_modules:
+            return MP_OBJ_FROM_PTR(&MP_STATE_VM(mp_loaded_modules_dict));
+        #endif
+        default:
+            return MP_OBJ_NULL;
+    }
+}
+#endif
+
 STATIC const mp_rom_map_elem_t mp_module_sys_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_sys) },
 
+    #if !MICROPY_MULTI_INTERP
     { MP_ROM_QSTR(MP_QSTR_path), MP_ROM_PTR(&MP_STATE_VM(mp_sys_path_obj)) },
     { MP_ROM_QSTR(MP_QSTR_argv), MP_ROM_PTR(&MP_STATE_VM(mp_sys_argv_obj)) },
+    #endif
     { MP_ROM_QSTR(MP_QSTR_version), MP_ROM_PTR(&version_obj) },
     { MP_ROM_QSTR(MP_QSTR_version_info), MP_ROM_PTR(&mp_sys_version_info_obj) },
     { MP_ROM_QSTR(MP_QSTR_implementation), MP_ROM_PTR(&mp_sys_implementation_obj) },
@@ -188,7 +216,7 @@ STATIC const mp_rom_map_elem_t mp_module_sys_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_stderr), MP_ROM_PTR(&mp_sys_stderr_obj) },
     #endif
 
-    #if MICROPY_PY_SYS_MODULES
+    #if MICROPY_PY_SYS_MODULES && !MICROPY_MULTI_INTERP
     { MP_ROM_QSTR(MP_QSTR_modules), MP_ROM_PTR(&MP_STATE_VM(mp_loaded_modules_dict)) },
     #endif
     #if MICROPY_PY_SYS_EXC_INFO
@@ -28,6 +28,7 @@
 #include <string.h>
 
 #include "py/runtime.h"
+#include "py/objgenerator.h"
 #include "py/stackctrl.h"
 
 #include "supervisor/shared/translate.h"
@@ -147,6 +148,9 @@ STATIC mp_obj_t mod_thread_stack_size(size_t n_args, const mp_obj_t *args) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_thread_stack_size_obj, 0, 1, mod_thread_stack_size);
 
 typedef struct _thread_entry_args_t {
+    #if MICROPY_MULTI_INTERP
+    mp_state_ctx_t *ctx;
+    #endif
     mp_obj_dict_t *dict_locals;
     mp_obj_dict_t *dict_globals;
     size_t stack_size;
@@ -161,8 +165,19 @@ STATIC void *thread_entry(void *args_in) {
 
     thread_entry_args_t *args = (thread_entry_args_t*)args_in;
 
+    #if MICROPY_MULTI_INTERP
+    // run in the interpreter that started us
+    mp_state_ctx_ptr = args->ctx;
+    #endif
+
     mp_state_thread_t ts;
     mp_thread_set_state(&ts);
+    #if MICROPY_OPT_FAST_EXCEPTIONS
+    mp_obj_exception_fast_init();
+    #endif
+    #if MICROPY_OPT_GEN_FRAME_POOL
+    mp_obj_gen_frame_pool_init();
+    #endif
 
     mp_stack_set_top(&ts + 1); // need to include ts in root-pointer scan
     mp_stack_set_limit(args->stack_size);
@@ -255,6 +270,10 @@ STATIC mp_obj_t mod_thread_start_new_thread(size_t n_args, const mp_obj_t *args)
     th_args->n_args = pos_args_len;
     memcpy(th_args->args, pos_args_items, pos_args_len * sizeof(mp_obj_t));
 
+    #if MICROPY_MULTI_INTERP
+    th_args->ctx = &mp_state_ctx;
+    #endif
+
     // pass our locals and globals into the new thread
     th_args->dict_locals = mp_locals_get();
     th_args->dict_globals = mp_globals_get();
@@ -127,6 +127,12 @@
 #define MICROPY_GC_ALLOC_THRESHOLD (1)
 #endif
 
+// Keep running totals of the number and size of heap allocations, used by
+// the "benchmark" module to report allocations per iteration.
+#ifndef MICROPY_GC_ALLOC_COUNTERS
+#define MICROPY_GC_ALLOC_COUNTERS (MICROPY_PY_BENCHMARK)
+#endif
+
 // Number of bytes to allocate initially when creating new chunks to store
 // interned string data.  Smaller numbers lead to more chunks being needed
 // and more wastage at the end of the chunk.  Larger numbers lead to wasted
@@ -265,6 +271,11 @@
 #define MICROPY_PERSISTENT_CODE_SAVE (0)
 #endif
 
+// Whether persistent code loading supports .mpy files with compressed code
+#ifndef MICROPY_PERSISTENT_CODE_LOAD_COMPRESSED
+#define MICROPY_PERSISTENT_CODE_LOAD_COMPRESSED (MICROPY_PERSISTENT_CODE_LOAD)
+#endif
+
 // Whether generated code can persist independently of the VM/runtime instance
 // This is enabled automatically when needed by other features
 #ifndef MICROPY_PERSISTENT_CODE
@@ -377,6 +388,13 @@
 #define MICROPY_COMP_RETURN_IF_EXPR (0)
 #endif
 
+// Whether to run a peephole pass in the bytecode emitter: drops unreachable
+// code, jumps to the next instruction and "x = x" on parameters, threads
+// jump-to-jump chains and merges "not" into a following conditional jump
+#ifndef MICROPY_COMP_PEEPHOLE
+#define MICROPY_COMP_PEEPHOLE (1)
+#endif
+
 // Whether to include parsing of f-string literals
 #ifndef MICROPY_COMP_FSTRING_LITERAL
 #define MICROPY_COMP_FSTRING_LITERAL (1)
@@ -402,6 +420,23 @@
 #define MICROPY_DEBUG_VERBOSE (0)
 #endif
 
+// Whether to record GC, VM call, scheduler and background task events into a
+// binary ring buffer, readable with micropython.trace_dump()
+#ifndef MICROPY_TRACE_BUFFER
+#define MICROPY_TRACE_BUFFER (0)
+#endif
+
+// Number of entries in the trace ring buffer; must be a power of 2
+#ifndef MICROPY_TRACE_BUFFER_SIZE
+#define MICROPY_TRACE_BUFFER_SIZE (1024)
+#endif
+
+// Timestamp source for trace entries, and its rate in ticks per second
+#ifndef MICROPY_TRACE_TIMESTAMP
+#define MICROPY_TRACE_TIMESTAMP() ((uint32_t)mp_hal_ticks_us())
+#define MICROPY_TRACE_TIMESTAMP_HZ (1000000)
+#endif
+
 /*****************************************************************************/
 /* Optimisations                                                             */
 
@@ -426,6 +461,36 @@
 #define MICROPY_OPT_MPZ_BITWISE (0)
 #endif
 
+// Whether StopIteration, KeyError and IndexError raised by the runtime use a
+// preallocated per-thread exception instance, so that the common case of
+// such an exception being caught and discarded close to where it was raised
+// (a for loop, an except clause without "as", mp_iternext) doesn't allocate.
+// Costs a few words of RAM per thread and a little code in the VM.
+#ifndef MICROPY_OPT_FAST_EXCEPTIONS
+#define MICROPY_OPT_FAST_EXCEPTIONS (0)
+#endif
+
+// Number of traceback entries stored in the preallocated exception before
+// its traceback moves to the heap
+#ifndef MICROPY_OPT_FAST_EXCEPTIONS_TRACEBACK
+#define MICROPY_OPT_FAST_EXCEPTIONS_TRACEBACK (4)
+#endif
+
+// Number of finished generator frames kept per thread for reuse by new
+// generators with the same state size (0 to disable).  Pooled frames are
+// cleared so they don't keep objects alive, and cost their heap size in RAM.
+#ifndef MICROPY_OPT_GEN_FRAME_POOL
+#define MICROPY_OPT_GEN_FRAME_POOL (0)
+#endif
+
+// Number of entries (a power of 2, or 0 to disable) in a cache mapping a
+// function's bytecode and a keyword argument name to the parameter it fills,
+// saving a scan of the parameter names for each keyword passed in a call.
+// Costs 2 words of RAM per entry.
+#ifndef MICROPY_OPT_KW_ARG_CACHE
+#define MICROPY_OPT_KW_ARG_CACHE (0)
+#endif
+
 /*****************************************************************************/
 /* Python internal features                                                  */
 
@@ -477,6 +542,14 @@
 #define MICROPY_ENABLE_FINALISER (0)
 #endif
 
+// Whether the interpreter state (mp_state_ctx) is reached through a
+// thread-local pointer instead of a single global, so that independent
+// interpreters, each with its own heap, can run in separate OS threads.
+// Every state access costs an extra load, so only enable it when needed.
+#ifndef MICROPY_MULTI_INTERP
+#define MICROPY_MULTI_INTERP (0)
+#endif
+
 // Whether to enable a separate allocator for the Python stack.
 // If enabled then the code must call mp_pystack_init before mp_init.
 #ifndef MICROPY_ENABLE_PYSTACK
@@ -676,6 +749,18 @@ typedef double mp_float_t;
 #define MICROPY_MODULE_FROZEN (MICROPY_MODULE_FROZEN_STR || MICROPY_MODULE_FROZEN_MPY)
 #endif
 
+// Whether an imported .py file is compiled once and the result kept as a .mpy
+// in MICROPY_MODULE_MPY_CACHE_DIR.  The cache is only used while that directory
+// exists, so it is opted into by creating it.  Needs the VFS and persistent
+// code load and save.
+#ifndef MICROPY_MODULE_MPY_CACHE
+#define MICROPY_MODULE_MPY_CACHE (0)
+#endif
+
+#ifndef MICROPY_MODULE_MPY_CACHE_DIR
+#define MICROPY_MODULE_MPY_CACHE_DIR "/.mpycache"
+#endif
+
 // Whether you can override builtins in the builtins module
 #ifndef MICROPY_CAN_OVERRIDE_BUILTINS
 #define MICROPY_CAN_OVERRIDE_BUILTINS (0)
@@ -705,16 +790,28 @@ typedef double mp_float_t;
 #define MICROPY_ENABLE_SCHEDULER (0)
 #endif
 
-// Maximum number of entries in the scheduler
+// Maximum number of entries in each priority queue of the scheduler
 #ifndef MICROPY_SCHEDULER_DEPTH
 #define MICROPY_SCHEDULER_DEPTH (4)
 #endif
 
+// Maximum number of scheduled callbacks run each time the VM checks for
+// pending events; any others wait for the next check
+#ifndef MICROPY_SCHEDULER_BATCH
+#define MICROPY_SCHEDULER_BATCH (MICROPY_SCHEDULER_DEPTH)
+#endif
+
 // Support for generic VFS sub-system
 #ifndef MICROPY_VFS
 #define MICROPY_VFS (0)
 #endif
 
+// Whether import resolution caches directory listings instead of issuing a
+// stat for every candidate path; the cache is dropped by any VFS write
+#ifndef MICROPY_VFS_IMPORT_CACHE
+#define MICROPY_VFS_IMPORT_CACHE (0)
+#endif
+
 // Support for VFS POSIX component, to mount a POSIX filesystem within VFS
 #ifndef MICROPY_VFS
 #define MICROPY_VFS_POSIX (0)
@@ -963,6 +1060,19 @@ typedef double mp_float_t;
 #define MICROPY_PY_MICROPYTHON_STACK_USE (MICROPY_PY_MICROPYTHON_MEM_INFO)
 #endif
 
+// Whether to provide "profiler" module, a sampling profiler for Python code.
+// The port must implement mp_profiler_port_start/stop, see py/profiler.h
+#ifndef MICROPY_PY_PROFILER
+#define MICROPY_PY_PROFILER (0)
+#endif
+
+// Whether to provide "benchmark" module for timing small operations with the
+// CPU cycle counter.  The port must provide mp_hal_ticks_cpu and
+// mp_hal_ticks_cpu_hz.
+#ifndef MICROPY_PY_BENCHMARK
+#define MICROPY_PY_BENCHMARK (0)
+#endif
+
 // Whether to provide "array" module. Note that large chunk of the
 // underlying code is shared with "bytearray" builtin type, so to
 // get real savings, it should be disabled too.
@@ -1074,6 +1184,12 @@ typedef double mp_float_t;
 #define MICROPY_PY_STRUCT (1)
 #endif
 
+// Number of compiled formats kept for the module-level functions of the
+// shared-bindings "struct" module, most recently used first (0 to disable)
+#ifndef MICROPY_PY_STRUCT_FORMAT_CACHE
+#define MICROPY_PY_STRUCT_FORMAT_CACHE (0)
+#endif
+
 // Whether to provide "sys" module
 #ifndef MICROPY_PY_SYS
 #define MICROPY_PY_SYS (1)
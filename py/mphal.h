@@ -38,6 +38,11 @@
 int mp_hal_stdin_rx_chr(void);
 #endif
 
+#ifndef mp_hal_stdin_rx_into
+// Waits for at least one byte, then reads up to len bytes that are waiting.
+size_t mp_hal_stdin_rx_into(uint8_t *buf, size_t len);
+#endif
+
 #ifndef mp_hal_stdout_tx_str
 void mp_hal_stdout_tx_str(const char *str);
 #endif
@@ -70,6 +75,10 @@ mp_uint_t mp_hal_ticks_us(void);
 mp_uint_t mp_hal_ticks_cpu(void);
 #endif
 
+#ifndef mp_hal_ticks_cpu_hz
+mp_uint_t mp_hal_ticks_cpu_hz(void);
+#endif
+
 // If port HAL didn't define its own pin API, use generic
 // "virtual pin" API from the core.
 #ifndef mp_hal_pin_obj_t
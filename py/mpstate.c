@@ -31,4 +31,9 @@
 mp_dynamic_compiler_t mp_dynamic_compiler = {0};
 #endif
 
+#if MICROPY_MULTI_INTERP
+STATIC mp_state_ctx_t mp_state_ctx_main;
+__thread mp_state_ctx_t *mp_state_ctx_ptr = &mp_state_ctx_main;
+#else
 mp_state_ctx_t PLACE_IN_DTCM_BSS(mp_state_ctx);
+#endif
@@ -46,6 +46,7 @@ typedef struct mp_dynamic_compiler_t {
     uint8_t small_int_bits; // must be <= host small_int_bits
     bool opt_cache_map_lookup_in_bytecode;
     bool py_builtins_str_unicode;
+    uint8_t mpy_compress_bits; // LZSS window bits for saved .mpy files, 0 for none
 } mp_dynamic_compiler_t;
 extern mp_dynamic_compiler_t mp_dynamic_compiler;
 #endif
@@ -60,6 +61,18 @@ typedef struct _mp_sched_item_t {
     mp_obj_t arg;
 } mp_sched_item_t;
 
+// Scheduler priority levels; higher levels are dispatched first
+#define MP_SCHED_PRIORITY_NORMAL (0)
+#define MP_SCHED_PRIORITY_HIGH (1)
+#define MP_SCHED_NUM_PRIORITIES (2)
+
+// FIFO of scheduled callbacks for one priority level
+typedef struct _mp_sched_queue_t {
+    uint16_t head;
+    uint16_t len;
+    mp_sched_item_t items[MICROPY_SCHEDULER_DEPTH];
+} mp_sched_queue_t;
+
 // This structure hold information about the memory allocation system.
 typedef struct _mp_state_mem_t {
     #if MICROPY_MEM_STATS
@@ -99,6 +112,12 @@ typedef struct _mp_state_mem_t {
     size_t gc_collected;
     #endif
 
+    #if MICROPY_GC_ALLOC_COUNTERS
+    // Running totals of heap allocations, never reset.
+    size_t gc_alloc_count;
+    size_t gc_alloc_bytes;
+    #endif
+
     #if MICROPY_PY_THREAD
     // This is a global mutex used to make the GC thread-safe.
     mp_thread_mutex_t gc_mutex;
@@ -107,6 +126,13 @@ typedef struct _mp_state_mem_t {
     void** permanent_pointers;
 } mp_state_mem_t;
 
+#if MICROPY_OPT_KW_ARG_CACHE
+typedef struct _mp_kw_arg_cache_entry_t {
+    const byte *bytecode;
+    size_t slot;
+} mp_kw_arg_cache_entry_t;
+#endif
+
 // This structure hold runtime and VM information.  It includes a section
 // which contains root pointers that must be scanned by the GC.
 typedef struct _mp_state_vm_t {
@@ -148,7 +174,7 @@ typedef struct _mp_state_vm_t {
     volatile mp_obj_t mp_pending_exception;
 
     #if MICROPY_ENABLE_SCHEDULER
-    mp_sched_item_t sched_stack[MICROPY_SCHEDULER_DEPTH];
+    mp_sched_queue_t sched_queue[MP_SCHED_NUM_PRIORITIES];
     #endif
 
     // current exception being handled, for sys.exc_info()
@@ -159,6 +185,12 @@ typedef struct _mp_state_vm_t {
     // dictionary for the __main__ module
     mp_obj_dict_t dict_main;
 
+    #if MICROPY_MULTI_INTERP
+    // the __main__ module itself, which can't be a constant shared by all
+    // interpreters
+    mp_obj_module_t module_main;
+    #endif
+
     // these two lists must be initialised per port, after the call to mp_init
     mp_obj_list_t mp_sys_path_obj;
     mp_obj_list_t mp_sys_argv_obj;
@@ -189,6 +221,19 @@ typedef struct _mp_state_vm_t {
     #if MICROPY_VFS
     struct _mp_vfs_mount_t *vfs_cur;
     struct _mp_vfs_mount_t *vfs_mount_table;
+    #if MICROPY_VFS_IMPORT_CACHE
+    // maps a directory to a dict of the names in it, see extmod/vfs.c
+    mp_obj_dict_t *vfs_import_cache;
+    #endif
+    #endif
+
+    #if MICROPY_PY_PROFILER
+    struct _mp_profiler_sample_t *profiler_samples;
+    #endif
+
+    #if MICROPY_PY_STRUCT_FORMAT_CACHE
+    // compiled struct.Struct objects, see shared-module/struct/Struct.c
+    mp_obj_t struct_format_cache[MICROPY_PY_STRUCT_FORMAT_CACHE];
     #endif
 
     //
@@ -210,6 +255,12 @@ typedef struct _mp_state_vm_t {
     mp_uint_t mp_optimise_value;
     #endif
 
+    #if MICROPY_OPT_KW_ARG_CACHE
+    // parameter slots of recently passed keyword arguments, see py/bc.c
+    // (not a root pointer: entries are checked against the function on use)
+    mp_kw_arg_cache_entry_t kw_arg_cache[MICROPY_OPT_KW_ARG_CACHE];
+    #endif
+
     // size of the emergency exception buf, if it's dynamically allocated
     #if MICROPY_ENABLE_EMERGENCY_EXCEPTION_BUF && MICROPY_EMERGENCY_EXCEPTION_BUF_SIZE == 0
     mp_int_t mp_emergency_exception_buf_size;
@@ -217,7 +268,24 @@ typedef struct _mp_state_vm_t {
 
     #if MICROPY_ENABLE_SCHEDULER
     volatile int16_t sched_state;
-    uint16_t sched_sp;
+    // total number of queued callbacks, over all priority levels
+    uint16_t sched_len;
+    uint16_t sched_peak;
+    uint32_t sched_dropped;
+    #endif
+
+    #if MICROPY_VFS && MICROPY_VFS_IMPORT_CACHE
+    // directories listed, probes answered from the cache, probes that needed a stat
+    uint32_t vfs_import_cache_dirs;
+    uint32_t vfs_import_cache_hits;
+    uint32_t vfs_import_cache_misses;
+    #endif
+
+    #if MICROPY_PY_PROFILER
+    size_t profiler_capacity;
+    volatile size_t profiler_count;
+    volatile size_t profiler_dropped;
+    volatile bool profiler_running;
     #endif
 
     #if MICROPY_PY_THREAD_GIL
@@ -246,6 +314,11 @@ typedef struct _mp_state_thread_t {
     uint8_t *pystack_cur;
     #endif
 
+    #if MICROPY_PY_PROFILER
+    // innermost running bytecode function, read by the sampling profiler
+    struct _mp_code_state_t *volatile current_code_state;
+    #endif
+
     ////////////////////////////////////////////////////////////
     // START ROOT POINTER SECTION
     // Everything that needs GC scanning must start here, and
@@ -256,6 +329,16 @@ typedef struct _mp_state_thread_t {
     mp_obj_dict_t *dict_globals;
 
     nlr_buf_t *nlr_top;
+
+    #if MICROPY_OPT_FAST_EXCEPTIONS
+    mp_obj_exception_fast_t fast_exc;
+    #endif
+
+    #if MICROPY_OPT_GEN_FRAME_POOL
+    // finished generator frames, and the size in bytes of each
+    struct _mp_code_state_t *gen_frame_pool[MICROPY_OPT_GEN_FRAME_POOL];
+    uint16_t gen_frame_pool_size[MICROPY_OPT_GEN_FRAME_POOL];
+    #endif
 } mp_state_thread_t;
 
 // This structure combines the above 3 structures.
@@ -266,7 +349,14 @@ typedef struct _mp_state_ctx_t {
     mp_state_mem_t mem;
 } mp_state_ctx_t;
 
+#if MICROPY_MULTI_INTERP
+// Each OS thread runs the interpreter this points to; it starts out pointing
+// at the main interpreter.
+extern __thread mp_state_ctx_t *mp_state_ctx_ptr;
+#define mp_state_ctx (*mp_state_ctx_ptr)
+#else
 extern mp_state_ctx_t mp_state_ctx;
+#endif
 
 #define MP_STATE_VM(x) (mp_state_ctx.vm.x)
 #define MP_STATE_MEM(x) (mp_state_ctx.mem.x)
@@ -0,0 +1,159 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/mphal.h"
+#include "py/mptrace.h"
+#include "py/runtime.h"
+
+#if MICROPY_TRACE_BUFFER
+
+#if (MICROPY_TRACE_BUFFER_SIZE & (MICROPY_TRACE_BUFFER_SIZE - 1)) != 0
+#error MICROPY_TRACE_BUFFER_SIZE must be a power of 2
+#endif
+
+// The ring lives outside the GC heap so that it can be filled before the heap
+// exists.  It holds no object pointers, but VM_CALL args are qstrs of the VM
+// that recorded them, so mp_init and mp_deinit clear it.
+STATIC mp_trace_entry_t mp_trace_buf[MICROPY_TRACE_BUFFER_SIZE];
+// Total number of entries ever recorded; the next entry goes at
+// mp_trace_head % MICROPY_TRACE_BUFFER_SIZE.
+STATIC volatile uint32_t mp_trace_head;
+STATIC volatile bool mp_trace_enabled = true;
+
+void mp_trace_record(mp_trace_event_t event, mp_trace_phase_t phase, uint32_t arg) {
+    if (!mp_trace_enabled) {
+        return;
+    }
+    // Take the timestamp inside the atomic section so that entries are
+    // ordered by time even when recorded from an interrupt.
+    mp_uint_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    mp_trace_entry_t *entry = &mp_trace_buf[mp_trace_head++ & (MICROPY_TRACE_BUFFER_SIZE - 1)];
+    entry->timestamp = MICROPY_TRACE_TIMESTAMP();
+    entry->arg = arg;
+    entry->event = event;
+    entry->phase = phase;
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+}
+
+void mp_trace_set_enabled(bool enabled) {
+    mp_trace_enabled = enabled;
+}
+
+void mp_trace_clear(void) {
+    mp_uint_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    mp_trace_head = 0;
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+}
+
+STATIC void trace_add_u16(vstr_t *vstr, uint16_t v) {
+    vstr_add_strn(vstr, (const char*)&v, sizeof(v));
+}
+
+STATIC void trace_add_u32(vstr_t *vstr, uint32_t v) {
+    vstr_add_strn(vstr, (const char*)&v, sizeof(v));
+}
+
+// Dump layout, all fields in native (little endian) byte order:
+//   header:  "MPTR", u8 version, u8 sizeof(entry), u16 zero,
+//            u32 timestamp ticks per second, u32 n_entries, u32 n_lost
+//   entries: n_entries * mp_trace_entry_t, oldest first
+//   names:   u32 n_names, then n_names * (u32 qstr, u16 len, len bytes)
+// The names table resolves the qstr args of MP_TRACE_EVENT_VM_CALL entries,
+// except those outside the current qstr pool.
+// The ring is cleared after the snapshot, so consecutive dumps don't overlap.
+mp_obj_t mp_trace_dump(void) {
+    // Snapshot the ring with recording paused, so the copy is consistent
+    // without holding an atomic section while allocating.
+    bool was_enabled = mp_trace_enabled;
+    mp_trace_enabled = false;
+
+    uint32_t head = mp_trace_head;
+    uint32_t n_entries = MIN(head, (uint32_t)MICROPY_TRACE_BUFFER_SIZE);
+    uint32_t first = head - n_entries;
+
+    vstr_t vstr;
+    vstr_init(&vstr, 20 + n_entries * sizeof(mp_trace_entry_t) + 64);
+    vstr_add_strn(&vstr, "MPTR", 4);
+    vstr_add_byte(&vstr, MP_TRACE_DUMP_VERSION);
+    vstr_add_byte(&vstr, sizeof(mp_trace_entry_t));
+    trace_add_u16(&vstr, 0);
+    trace_add_u32(&vstr, MICROPY_TRACE_TIMESTAMP_HZ);
+    trace_add_u32(&vstr, n_entries);
+    trace_add_u32(&vstr, first);
+    for (uint32_t i = first; i != head; i++) {
+        vstr_add_strn(&vstr, (const char*)&mp_trace_buf[i & (MICROPY_TRACE_BUFFER_SIZE - 1)], sizeof(mp_trace_entry_t));
+    }
+
+    // Count and then emit each distinct function name once.  Dumps are rare
+    // and the ring is small, so a quadratic scan is fine.
+    uint32_t n_names = 0;
+    uint32_t n_qstrs = MP_STATE_VM(last_pool)->total_prev_len + MP_STATE_VM(last_pool)->len;
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            trace_add_u32(&vstr, n_names);
+        }
+        for (uint32_t i = first; i != head; i++) {
+            const mp_trace_entry_t *entry = &mp_trace_buf[i & (MICROPY_TRACE_BUFFER_SIZE - 1)];
+            if (entry->event != MP_TRACE_EVENT_VM_CALL || entry->phase != MP_TRACE_PHASE_BEGIN) {
+                continue;
+            }
+            bool seen = false;
+            for (uint32_t j = first; j != i; j++) {
+                const mp_trace_entry_t *other = &mp_trace_buf[j & (MICROPY_TRACE_BUFFER_SIZE - 1)];
+                if (other->event == MP_TRACE_EVENT_VM_CALL && other->phase == MP_TRACE_PHASE_BEGIN
+                    && other->arg == entry->arg) {
+                    seen = true;
+                    break;
+                }
+            }
+            if (seen) {
+                continue;
+            }
+            // An arg from outside the current qstr pool can't be resolved.
+            // The converter shows it as an unnamed qstr.
+            if (entry->arg >= n_qstrs) {
+                continue;
+            }
+            if (pass == 0) {
+                n_names++;
+            } else {
+                size_t len;
+                const byte *name = qstr_data(entry->arg, &len);
+                trace_add_u32(&vstr, entry->arg);
+                trace_add_u16(&vstr, len);
+                vstr_add_strn(&vstr, (const char*)name, len);
+            }
+        }
+    }
+
+    mp_trace_clear();
+    mp_trace_enabled = was_enabled;
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+
+#endif // MICROPY_TRACE_BUFFER
@@ -0,0 +1,86 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MICROPY_INCLUDED_PY_MPTRACE_H
+#define MICROPY_INCLUDED_PY_MPTRACE_H
+
+#include "py/obj.h"
+
+// Binary trace ring buffer for VM, GC and background task events.
+//
+// Each entry is a (timestamp, event, phase, arg) record.  Entries are written
+// to a fixed size statically allocated ring, so recording never allocates and
+// is safe from interrupt context.  The oldest entries are overwritten once the
+// ring is full.  micropython.trace_dump() returns the ring contents as bytes;
+// tools/trace_to_chrome.py converts such a dump to Chrome trace JSON.
+
+// Event ids.  These are part of the dump format, so only append new ones and
+// keep tools/trace_to_chrome.py in sync.
+typedef enum {
+    MP_TRACE_EVENT_GC_COLLECT = 1,
+    MP_TRACE_EVENT_BACKGROUND_CALLBACK = 2,
+    MP_TRACE_EVENT_DISPLAYIO_BACKGROUND = 3,
+    MP_TRACE_EVENT_USB_BACKGROUND = 4,
+    MP_TRACE_EVENT_VM_CALL = 5,
+    MP_TRACE_EVENT_SCHED_SCHEDULE = 6,
+    MP_TRACE_EVENT_SCHED_RUN = 7,
+} mp_trace_event_t;
+
+// Phases use the Chrome trace event letters.
+typedef enum {
+    MP_TRACE_PHASE_BEGIN = 'B',
+    MP_TRACE_PHASE_END = 'E',
+    MP_TRACE_PHASE_INSTANT = 'i',
+} mp_trace_phase_t;
+
+typedef struct _mp_trace_entry_t {
+    uint32_t timestamp;
+    uint32_t arg;
+    uint16_t event;
+    uint16_t phase;
+} mp_trace_entry_t;
+
+#define MP_TRACE_DUMP_VERSION (1)
+
+#if MICROPY_TRACE_BUFFER
+
+void mp_trace_record(mp_trace_event_t event, mp_trace_phase_t phase, uint32_t arg);
+void mp_trace_set_enabled(bool enabled);
+void mp_trace_clear(void);
+mp_obj_t mp_trace_dump(void);
+
+#define MP_TRACE_BEGIN(event, arg) mp_trace_record((event), MP_TRACE_PHASE_BEGIN, (uint32_t)(arg))
+#define MP_TRACE_END(event, arg) mp_trace_record((event), MP_TRACE_PHASE_END, (uint32_t)(arg))
+#define MP_TRACE_INSTANT(event, arg) mp_trace_record((event), MP_TRACE_PHASE_INSTANT, (uint32_t)(arg))
+
+#else
+
+#define MP_TRACE_BEGIN(event, arg) (void)0
+#define MP_TRACE_END(event, arg) (void)0
+#define MP_TRACE_INSTANT(event, arg) (void)0
+
+#endif // MICROPY_TRACE_BUFFER
+
+#endif // MICROPY_INCLUDED_PY_MPTRACE_H
@@ -40,6 +40,9 @@ __attribute__((used)) unsigned int nlr_push_tail(nlr_buf_t *nlr);
 unsigned int nlr_push_tail(nlr_buf_t *nlr) {
     nlr_buf_t **top = &MP_STATE_THREAD(nlr_top);
     nlr->prev = *top;
+    #if MICROPY_OPT_FAST_EXCEPTIONS
+    nlr->ret_val = NULL;
+    #endif
     MP_NLR_SAVE_PYSTACK(nlr);
     *top = nlr;
     return 0; // normal return
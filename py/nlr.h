@@ -107,6 +107,21 @@ struct _nlr_buf_t {
 #define MP_NLR_RESTORE_PYSTACK(nlr_buf) (void)nlr_buf
 #endif
 
+#if MICROPY_OPT_FAST_EXCEPTIONS
+// A catcher that knows how to deal with the per-thread preallocated exception
+// (see py/objexcept.c) marks its nlr buf with this right after nlr_push.  Any
+// other catcher is given a heap copy of that exception by nlr_jump.
+#define MP_NLR_FAST_EXC_ACCEPTED ((void*)1)
+#define MP_NLR_ACCEPT_FAST_EXC(nlr_buf) (nlr_buf)->ret_val = MP_NLR_FAST_EXC_ACCEPTED
+#define MP_NLR_CHECK_FAST_EXC(val, top) \
+    if (top->ret_val != MP_NLR_FAST_EXC_ACCEPTED && MP_OBJ_IS_FAST_EXCEPTION(val)) { \
+        val = MP_OBJ_TO_PTR(mp_obj_exception_fast_escape(MP_OBJ_FROM_PTR(val))); \
+    }
+#else
+#define MP_NLR_ACCEPT_FAST_EXC(nlr_buf) (void)nlr_buf
+#define MP_NLR_CHECK_FAST_EXC(val, top)
+#endif
+
 // Helper macro to use at the start of a specific nlr_jump implementation
 #define MP_NLR_JUMP_HEAD(val, top) \
     nlr_buf_t **_top_ptr = &MP_STATE_THREAD(nlr_top); \
@@ -114,6 +129,7 @@ struct _nlr_buf_t {
     if (top == NULL) { \
         nlr_jump_fail(val); \
     } \
+    MP_NLR_CHECK_FAST_EXC(val, top) \
     top->ret_val = val; \
     MP_NLR_RESTORE_PYSTACK(top); \
     *_top_ptr = top->prev; \
@@ -34,6 +34,7 @@ void nlr_jump(void *val) {
     if (top == NULL) {
         nlr_jump_fail(val);
     }
+    MP_NLR_CHECK_FAST_EXC(val, top)
     top->ret_val = val;
     MP_NLR_RESTORE_PYSTACK(top);
     *top_ptr = top->prev;
@@ -427,8 +427,8 @@ size_t mp_get_index(const mp_obj_type_t *type, size_t len, mp_obj_t index, bool
             if (MICROPY_ERROR_REPORTING == MICROPY_ERROR_REPORTING_TERSE) {
                 mp_raise_IndexError(translate("index out of range"));
             } else {
-                mp_raise_msg_varg(&mp_type_IndexError,
-                    translate("%q index out of range"), type->name);
+                nlr_raise(mp_obj_new_exception_fast_msg_varg(&mp_type_IndexError,
+                    translate("%q index out of range"), type->name));
             }
         }
     }
@@ -450,6 +450,107 @@ mp_obj_t mp_obj_new_exception_msg_vlist(const mp_obj_type_t *exc_type, const com
     return mp_obj_exception_make_new(exc_type, 1, &arg, NULL);
 }
 
+#if MICROPY_OPT_FAST_EXCEPTIONS
+
+// StopIteration, KeyError and IndexError raised by the runtime are usually caught
+// straight away, by a for loop, an except clause that doesn't bind the exception
+// or C code like mp_iternext, and thrown away.  So that this doesn't cost a heap
+// allocation every time, each thread has one preallocated exception instance
+// which is used for them whenever it is free.  Its catchers mark their nlr buf
+// with MP_NLR_ACCEPT_FAST_EXC and release it when they are done with it; any
+// other catcher, or an except clause that may keep the exception, gets a heap
+// copy instead (see mp_obj_exception_fast_escape).  Until then the args tuple
+// is empty and the message of an IndexError is not formatted.
+
+void mp_obj_exception_fast_init(void) {
+    mp_obj_exception_fast_t *fast = &MP_STATE_THREAD(fast_exc);
+    fast->exc.base.type = &mp_type_StopIteration;
+    fast->exc.args = (mp_obj_tuple_t*)&mp_const_empty_tuple_obj;
+    mp_obj_exception_fast_release();
+}
+
+void mp_obj_exception_fast_release(void) {
+    mp_obj_exception_fast_t *fast = &MP_STATE_THREAD(fast_exc);
+    fast->busy = false;
+    fast->handler = NULL;
+    fast->arg = MP_OBJ_NULL;
+    fast->fmt = NULL;
+    fast->exc.traceback_data = fast->traceback;
+    fast->exc.traceback_alloc = MP_ARRAY_SIZE(fast->traceback);
+    fast->exc.traceback_len = 0;
+    #if MICROPY_PY_SYS_EXC_INFO
+    if (MP_STATE_VM(cur_exception) == &fast->exc.base) {
+        MP_STATE_VM(cur_exception) = NULL;
+    }
+    #endif
+}
+
+STATIC mp_obj_exception_fast_t *exception_fast_take(const mp_obj_type_t *exc_type) {
+    mp_obj_exception_fast_t *fast = &MP_STATE_THREAD(fast_exc);
+    if (fast->busy) {
+        return NULL;
+    }
+    fast->busy = true;
+    fast->exc.base.type = exc_type;
+    return fast;
+}
+
+mp_obj_t mp_obj_new_exception_fast(const mp_obj_type_t *exc_type, mp_obj_t arg) {
+    mp_obj_exception_fast_t *fast = exception_fast_take(exc_type);
+    if (fast == NULL) {
+        if (arg == MP_OBJ_NULL) {
+            return mp_obj_new_exception(exc_type);
+        }
+        return mp_obj_new_exception_arg1(exc_type, arg);
+    }
+    fast->arg = arg;
+    return MP_OBJ_FROM_PTR(&fast->exc);
+}
+
+mp_obj_t mp_obj_new_exception_fast_msg_varg(const mp_obj_type_t *exc_type, const compressed_string_t *fmt, qstr arg) {
+    mp_obj_exception_fast_t *fast = exception_fast_take(exc_type);
+    if (fast == NULL) {
+        return mp_obj_new_exception_msg_varg(exc_type, fmt, arg);
+    }
+    fast->fmt = fmt;
+    fast->fmt_arg = arg;
+    return MP_OBJ_FROM_PTR(&fast->exc);
+}
+
+// Make a heap exception equivalent to the fast exception, which stays as it is
+mp_obj_t mp_obj_exception_fast_copy(mp_obj_t self_in) {
+    mp_obj_exception_fast_t *fast = &MP_STATE_THREAD(fast_exc);
+    assert(MP_OBJ_TO_PTR(self_in) == &fast->exc);
+    const mp_obj_type_t *exc_type = fast->exc.base.type;
+    mp_obj_t o;
+    if (fast->fmt != NULL) {
+        o = mp_obj_new_exception_msg_varg(exc_type, fast->fmt, fast->fmt_arg);
+    } else if (fast->arg != MP_OBJ_NULL) {
+        o = mp_obj_new_exception_arg1(exc_type, fast->arg);
+    } else {
+        o = mp_obj_new_exception(exc_type);
+    }
+    size_t *values = fast->exc.traceback_data;
+    for (size_t i = 0; i < fast->exc.traceback_len; i += TRACEBACK_ENTRY_LEN) {
+        mp_obj_exception_add_traceback(o, values[i], values[i + 1], values[i + 2]);
+    }
+    return o;
+}
+
+// Called when the fast exception reaches code that might keep a reference to it
+mp_obj_t mp_obj_exception_fast_escape(mp_obj_t self_in) {
+    mp_obj_t o = mp_obj_exception_fast_copy(self_in);
+    #if MICROPY_PY_SYS_EXC_INFO
+    if (MP_STATE_VM(cur_exception) == MP_OBJ_TO_PTR(self_in)) {
+        MP_STATE_VM(cur_exception) = MP_OBJ_TO_PTR(o);
+    }
+    #endif
+    mp_obj_exception_fast_release();
+    return o;
+}
+
+#endif // MICROPY_OPT_FAST_EXCEPTIONS
+
 // return true if the given object is an exception type
 bool mp_obj_is_exception_type(mp_obj_t self_in) {
     if (MP_OBJ_IS_TYPE(self_in, &mp_type_type)) {
@@ -532,9 +633,21 @@ void mp_obj_exception_add_traceback(mp_obj_t self_in, qstr file, size_t line, qs
             return;
         }
         #endif
-        // be conservative with growing traceback data
-        size_t *tb_data = m_renew_maybe(size_t, self->traceback_data, self->traceback_alloc,
-            self->traceback_alloc + TRACEBACK_ENTRY_LEN, true);
+        size_t *tb_data;
+        #if MICROPY_OPT_FAST_EXCEPTIONS
+        if (self->traceback_data == MP_STATE_THREAD(fast_exc).traceback) {
+            // The preallocated traceback is full so continue on the heap
+            tb_data = m_new_maybe(size_t, self->traceback_alloc + TRACEBACK_ENTRY_LEN);
+            if (tb_data != NULL) {
+                memcpy(tb_data, self->traceback_data, self->traceback_len * sizeof(size_t));
+            }
+        } else
+        #endif
+        {
+            // be conservative with growing traceback data
+            tb_data = m_renew_maybe(size_t, self->traceback_data, self->traceback_alloc,
+                self->traceback_alloc + TRACEBACK_ENTRY_LEN, true);
+        }
         if (tb_data == NULL) {
             return;
         }
@@ -37,6 +37,36 @@ typedef struct _mp_obj_exception_t {
     mp_obj_tuple_t *args;
 } mp_obj_exception_t;
 
+#if MICROPY_OPT_FAST_EXCEPTIONS
+// The preallocated exception that each thread uses for StopIteration, KeyError
+// and IndexError raised by the runtime, see py/objexcept.c.
+typedef struct _mp_obj_exception_fast_t {
+    mp_obj_exception_t exc;
+    bool busy;
+    // exception stack entry of the except handler that owns it, if any
+    void *handler;
+    // the argument, or the message format and its %q argument; the real
+    // args tuple is only made if the exception escapes
+    mp_obj_t arg;
+    const compressed_string_t *fmt;
+    qstr fmt_arg;
+    // traceback entries are (file, line, block) triples
+    size_t traceback[MICROPY_OPT_FAST_EXCEPTIONS_TRACEBACK * 3];
+} mp_obj_exception_fast_t;
+
+// These need py/mpstate.h
+#define MP_OBJ_IS_FAST_EXCEPTION(o) (MP_OBJ_TO_PTR(o) == (void*)&MP_STATE_THREAD(fast_exc).exc)
+// For code that has caught exception o and throws it away
+#define MP_OBJ_EXCEPTION_FAST_DISCARD(o) do { if (MP_OBJ_IS_FAST_EXCEPTION(o)) { mp_obj_exception_fast_release(); } } while (0)
+
+void mp_obj_exception_fast_init(void);
+void mp_obj_exception_fast_release(void);
+mp_obj_t mp_obj_exception_fast_copy(mp_obj_t self_in);
+mp_obj_t mp_obj_exception_fast_escape(mp_obj_t self_in);
+#else
+#define MP_OBJ_EXCEPTION_FAST_DISCARD(o) (void)0
+#endif
+
 void mp_obj_exception_print(const mp_print_t *print, mp_obj_t o_in, mp_print_kind_t kind);
 void mp_obj_exception_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest);
 
@@ -26,6 +26,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "py/runtime.h"
@@ -49,28 +50,97 @@ typedef struct _mp_obj_gen_instance_t {
     mp_obj_base_t base;
     mp_obj_dict_t *globals;
     bool coroutine_generator;
-    mp_code_state_t code_state;
+    #if MICROPY_OPT_GEN_FRAME_POOL
+    // The frame is allocated separately so that it can go back to the pool
+    // when the generator finishes, after which code_state is NULL.
+    mp_obj_fun_bc_t *fun_bc;
+    mp_code_state_t *code_state;
+    #else
+    mp_code_state_t code_state[1];
+    #endif
 } mp_obj_gen_instance_t;
 
+#if MICROPY_OPT_GEN_FRAME_POOL
+#define GEN_FUN_BC(self) ((self)->fun_bc)
+#define GEN_IS_FINISHED(self) ((self)->code_state == NULL)
+#else
+#define GEN_FUN_BC(self) ((self)->code_state->fun_bc)
+#define GEN_IS_FINISHED(self) ((self)->code_state->ip == 0)
+#endif
+
+// Size of the variable part of a generator frame: local stack and exception stack
+STATIC size_t gen_state_size(mp_obj_fun_bc_t *fun_bc) {
+    // bytecode prelude: get state size and exception stack size
+    size_t n_state = mp_decode_uint_value(fun_bc->bytecode);
+    size_t n_exc_stack = mp_decode_uint_value(mp_decode_uint_skip(fun_bc->bytecode));
+    return n_state * sizeof(mp_obj_t) + n_exc_stack * sizeof(mp_exc_stack_t);
+}
+
+#if MICROPY_OPT_GEN_FRAME_POOL
+
+// Frames of finished generators are kept in a small per-thread pool and
+// handed to new generators needing exactly the same frame size, so that
+// creating and exhausting generators in a loop reuses the same memory.
+// Pooled frames are zeroed so they don't keep stale objects alive.
+
+void mp_obj_gen_frame_pool_init(void) {
+    memset(MP_STATE_THREAD(gen_frame_pool), 0, sizeof(MP_STATE_THREAD(gen_frame_pool)));
+}
+
+STATIC mp_code_state_t *gen_frame_new(size_t state_size) {
+    for (size_t i = 0; i < MICROPY_OPT_GEN_FRAME_POOL; i++) {
+        mp_code_state_t *frame = MP_STATE_THREAD(gen_frame_pool)[i];
+        if (frame != NULL && MP_STATE_THREAD(gen_frame_pool_size)[i] == state_size) {
+            MP_STATE_THREAD(gen_frame_pool)[i] = NULL;
+            return frame;
+        }
+    }
+    return m_new_obj_var(mp_code_state_t, byte, state_size);
+}
+
+STATIC void gen_frame_release(mp_obj_gen_instance_t *self) {
+    mp_code_state_t *frame = self->code_state;
+    self->code_state = NULL;
+    size_t state_size = gen_state_size(self->fun_bc);
+    if (state_size > UINT16_MAX) {
+        return;
+    }
+    for (size_t i = 0; i < MICROPY_OPT_GEN_FRAME_POOL; i++) {
+        if (MP_STATE_THREAD(gen_frame_pool)[i] == NULL) {
+            memset(frame, 0, sizeof(mp_code_state_t) + state_size);
+            MP_STATE_THREAD(gen_frame_pool)[i] = frame;
+            MP_STATE_THREAD(gen_frame_pool_size)[i] = state_size;
+            return;
+        }
+    }
+    // pool is full: leave the frame to the GC
+}
+
+#endif // MICROPY_OPT_GEN_FRAME_POOL
+
 STATIC mp_obj_t gen_wrap_call(mp_obj_t self_in, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     mp_obj_gen_wrap_t *self = MP_OBJ_TO_PTR(self_in);
     mp_obj_fun_bc_t *self_fun = (mp_obj_fun_bc_t*)self->fun;
     assert(self_fun->base.type == &mp_type_fun_bc);
 
-    // bytecode prelude: get state size and exception stack size
-    size_t n_state = mp_decode_uint_value(self_fun->bytecode);
-    size_t n_exc_stack = mp_decode_uint_value(mp_decode_uint_skip(self_fun->bytecode));
+    size_t state_size = gen_state_size(self_fun);
 
+    #if MICROPY_OPT_GEN_FRAME_POOL
+    mp_code_state_t *code_state = gen_frame_new(state_size);
+    mp_obj_gen_instance_t *o = m_new_obj(mp_obj_gen_instance_t);
+    o->fun_bc = self_fun;
+    o->code_state = code_state;
+    #else
     // allocate the generator object, with room for local stack and exception stack
-    mp_obj_gen_instance_t *o = m_new_obj_var(mp_obj_gen_instance_t, byte,
-        n_state * sizeof(mp_obj_t) + n_exc_stack * sizeof(mp_exc_stack_t));
+    mp_obj_gen_instance_t *o = m_new_obj_var(mp_obj_gen_instance_t, byte, state_size);
+    #endif
     o->base.type = &mp_type_gen_instance;
 
     o->coroutine_generator = self->coroutine_generator;
     o->globals = self_fun->globals;
-    o->code_state.fun_bc = self_fun;
-    o->code_state.ip = 0;
-    mp_setup_code_state(&o->code_state, n_args, n_kw, args);
+    o->code_state->fun_bc = self_fun;
+    o->code_state->ip = 0;
+    mp_setup_code_state(o->code_state, n_args, n_kw, args);
     return MP_OBJ_FROM_PTR(o);
 }
 
@@ -97,36 +167,82 @@ STATIC void gen_instance_print(const mp_print_t *print, mp_obj_t self_in, mp_pri
     mp_obj_gen_instance_t *self = MP_OBJ_TO_PTR(self_in);
 #if MICROPY_PY_ASYNC_AWAIT
     if (self->coroutine_generator) {
-        mp_printf(print, "<coroutine object '%q' at %p>", mp_obj_fun_get_name(MP_OBJ_FROM_PTR(self->code_state.fun_bc)), self);
+        mp_printf(print, "<coroutine object '%q' at %p>", mp_obj_fun_get_name(MP_OBJ_FROM_PTR(GEN_FUN_BC(self))), self);
         return;
     }
 #endif
-    mp_printf(print, "<generator object '%q' at %p>", mp_obj_fun_get_name(MP_OBJ_FROM_PTR(self->code_state.fun_bc)), self);
+    mp_printf(print, "<generator object '%q' at %p>", mp_obj_fun_get_name(MP_OBJ_FROM_PTR(GEN_FUN_BC(self))), self);
+}
+
+// Explicitly mark generator as completed. If we don't do this,
+// subsequent next() may re-execute statements after last yield
+// again and again, leading to side effects.
+STATIC void gen_finish(mp_obj_gen_instance_t *self) {
+    #if MICROPY_OPT_GEN_FRAME_POOL
+    gen_frame_release(self);
+    #else
+    self->code_state->ip = 0;
+    #endif
+}
+
+// Called after the generator's bytecode stops running, to restore the
+// caller's globals.  Returns the yielded or returned value, or the exception.
+STATIC mp_obj_t gen_exit(mp_obj_gen_instance_t *self, mp_vm_return_kind_t ret_kind) {
+    mp_code_state_t *code_state = self->code_state;
+    self->globals = mp_globals_get();
+    mp_globals_set(code_state->old_globals);
+
+    mp_obj_t ret_val;
+    switch (ret_kind) {
+        case MP_VM_RETURN_NORMAL:
+        default:
+            // TODO: check how return with value behaves under such conditions
+            // in CPython.
+            ret_val = *code_state->sp;
+            gen_finish(self);
+            break;
+
+        case MP_VM_RETURN_YIELD:
+            ret_val = *code_state->sp;
+            #if MICROPY_PY_GENERATOR_PEND_THROW
+            *code_state->sp = mp_const_none;
+            #endif
+            break;
+
+        case MP_VM_RETURN_EXCEPTION: {
+            size_t n_state = mp_decode_uint_value(GEN_FUN_BC(self)->bytecode);
+            ret_val = code_state->state[n_state - 1];
+            gen_finish(self);
+            break;
+        }
+    }
+    return ret_val;
 }
 
 mp_vm_return_kind_t mp_obj_gen_resume(mp_obj_t self_in, mp_obj_t send_value, mp_obj_t throw_value, mp_obj_t *ret_val) {
     MP_STACK_CHECK();
     mp_check_self(MP_OBJ_IS_TYPE(self_in, &mp_type_gen_instance));
     mp_obj_gen_instance_t *self = MP_OBJ_TO_PTR(self_in);
-    if (self->code_state.ip == 0) {
+    if (GEN_IS_FINISHED(self)) {
         // Trying to resume already stopped generator
         *ret_val = MP_OBJ_STOP_ITERATION;
         return MP_VM_RETURN_NORMAL;
     }
-    if (self->code_state.sp == self->code_state.state - 1) {
+    mp_code_state_t *code_state = self->code_state;
+    if (code_state->sp == code_state->state - 1) {
         if (send_value != mp_const_none) {
             mp_raise_TypeError(translate("can't send non-None value to a just-started generator"));
         }
     } else {
         #if MICROPY_PY_GENERATOR_PEND_THROW
         // If exception is pending (set using .pend_throw()), process it now.
-        if (*self->code_state.sp != mp_const_none) {
-            throw_value = *self->code_state.sp;
-            *self->code_state.sp = MP_OBJ_NULL;
+        if (*code_state->sp != mp_const_none) {
+            throw_value = *code_state->sp;
+            *code_state->sp = MP_OBJ_NULL;
         } else
         #endif
         {
-            *self->code_state.sp = send_value;
+            *code_state->sp = send_value;
         }
     }
 
@@ -137,42 +253,48 @@ mp_vm_return_kind_t mp_obj_gen_resume(mp_obj_t self_in, mp_obj_t send_value, mp_
     }
 
     // Set up the correct globals context for the generator and execute it
-    self->code_state.old_globals = mp_globals_get();
+    code_state->old_globals = mp_globals_get();
     mp_globals_set(self->globals);
     self->globals = NULL;
-    mp_vm_return_kind_t ret_kind = mp_execute_bytecode(&self->code_state, throw_value);
-    self->globals = mp_globals_get();
-    mp_globals_set(self->code_state.old_globals);
-
-    switch (ret_kind) {
-        case MP_VM_RETURN_NORMAL:
-        default:
-            // Explicitly mark generator as completed. If we don't do this,
-            // subsequent next() may re-execute statements after last yield
-            // again and again, leading to side effects.
-            // TODO: check how return with value behaves under such conditions
-            // in CPython.
-            self->code_state.ip = 0;
-            *ret_val = *self->code_state.sp;
-            break;
-
-        case MP_VM_RETURN_YIELD:
-            *ret_val = *self->code_state.sp;
-            #if MICROPY_PY_GENERATOR_PEND_THROW
-            *self->code_state.sp = mp_const_none;
-            #endif
-            break;
+    mp_vm_return_kind_t ret_kind = mp_execute_bytecode(code_state, throw_value);
+    *ret_val = gen_exit(self, ret_kind);
+    return ret_kind;
+}
 
-        case MP_VM_RETURN_EXCEPTION: {
-            size_t n_state = mp_decode_uint_value(self->code_state.fun_bc->bytecode);
-            self->code_state.ip = 0;
-            *ret_val = self->code_state.state[n_state - 1];
-            break;
+#if MICROPY_STACKLESS
+// Start resuming a generator from yield from without recursing into
+// mp_execute_bytecode: the VM runs the returned frame in its own loop and calls
+// mp_obj_gen_stackless_exit when it yields, returns or raises.  Returns NULL
+// if the full mp_obj_gen_resume path is needed instead (the generator is
+// finished or executing, has a pending throw, or the send is invalid).
+mp_code_state_t *mp_obj_gen_resume_stackless(mp_obj_t self_in, mp_obj_t send_value) {
+    mp_obj_gen_instance_t *self = MP_OBJ_TO_PTR(self_in);
+    if (GEN_IS_FINISHED(self) || self->globals == NULL) {
+        return NULL;
+    }
+    mp_code_state_t *code_state = self->code_state;
+    if (code_state->sp == code_state->state - 1) {
+        if (send_value != mp_const_none) {
+            return NULL;
         }
+    } else {
+        #if MICROPY_PY_GENERATOR_PEND_THROW
+        if (*code_state->sp != mp_const_none) {
+            return NULL;
+        }
+        #endif
+        *code_state->sp = send_value;
     }
+    code_state->old_globals = mp_globals_get();
+    mp_globals_set(self->globals);
+    self->globals = NULL;
+    return code_state;
+}
 
-    return ret_kind;
+mp_obj_t mp_obj_gen_stackless_exit(mp_obj_t self_in, mp_vm_return_kind_t ret_kind) {
+    return gen_exit(MP_OBJ_TO_PTR(self_in), ret_kind);
 }
+#endif
 
 STATIC mp_obj_t gen_resume_and_raise(mp_obj_t self_in, mp_obj_t send_value, mp_obj_t throw_value) {
     mp_obj_t ret;
@@ -196,6 +318,7 @@ STATIC mp_obj_t gen_resume_and_raise(mp_obj_t self_in, mp_obj_t send_value, mp_o
             if (mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(mp_obj_get_type(ret)), MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
                 mp_obj_t val = mp_obj_exception_get_value(ret);
                 if (val == mp_const_none) {
+                    MP_OBJ_EXCEPTION_FAST_DISCARD(ret);
                     return MP_OBJ_STOP_ITERATION;
                 }
             }
@@ -265,6 +388,7 @@ STATIC mp_obj_t gen_instance_close(mp_obj_t self_in) {
             // ret should always be an instance of an exception class
             if (mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(mp_obj_get_type(ret)), MP_OBJ_FROM_PTR(&mp_type_GeneratorExit)) ||
                 mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(mp_obj_get_type(ret)), MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
+                MP_OBJ_EXCEPTION_FAST_DISCARD(ret);
                 return mp_const_none;
             }
             nlr_raise(ret);
@@ -279,11 +403,16 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(gen_instance_close_obj, gen_instance_close);
 
 STATIC mp_obj_t gen_instance_pend_throw(mp_obj_t self_in, mp_obj_t exc_in) {
     mp_obj_gen_instance_t *self = MP_OBJ_TO_PTR(self_in);
-    if (self->code_state.sp == self->code_state.state - 1) {
+    if (GEN_IS_FINISHED(self)) {
+        // it will never run again, so there's nothing to throw into
+        return mp_const_none;
+    }
+    mp_code_state_t *code_state = self->code_state;
+    if (code_state->sp == code_state->state - 1) {
         mp_raise_TypeError(translate("can't pend throw to just-started generator"));
     }
-    mp_obj_t prev = *self->code_state.sp;
-    *self->code_state.sp = exc_in;
+    mp_obj_t prev = *code_state->sp;
+    *code_state->sp = exc_in;
     return prev;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(gen_instance_pend_throw_obj, gen_instance_pend_throw);
@@ -31,4 +31,14 @@
 
 mp_vm_return_kind_t mp_obj_gen_resume(mp_obj_t self_in, mp_obj_t send_val, mp_obj_t throw_val, mp_obj_t *ret_val);
 
+#if MICROPY_OPT_GEN_FRAME_POOL
+void mp_obj_gen_frame_pool_init(void);
+#endif
+
+#if MICROPY_STACKLESS
+// Used by the VM to run a generator resumed by yield from in its own loop
+struct _mp_code_state_t *mp_obj_gen_resume_stackless(mp_obj_t self_in, mp_obj_t send_val);
+mp_obj_t mp_obj_gen_stackless_exit(mp_obj_t self_in, mp_vm_return_kind_t ret_kind);
+#endif
+
 #endif // MICROPY_INCLUDED_PY_OBJGENERATOR_H
@@ -65,6 +65,11 @@ STATIC void module_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
         if (elem != NULL) {
             dest[0] = elem->value;
         }
+        #if MICROPY_MULTI_INTERP && MICROPY_PY_SYS
+        else if (self == &mp_module_sys) {
+            dest[0] = mp_sys_state_attr(attr);
+        }
+        #endif
     } else {
         // delete/store attribute
         mp_obj_dict_t *dict = self->globals;
@@ -149,7 +154,10 @@ void mp_obj_module_set_globals(mp_obj_t self_in, mp_obj_dict_t *globals) {
 // Global module table and related functions
 
 STATIC const mp_rom_map_elem_t mp_builtin_module_table[] = {
+    #if !MICROPY_MULTI_INTERP
+    // with multiple interpreters each registers its own __main__ in mp_init
     { MP_ROM_QSTR(MP_QSTR___main__), MP_ROM_PTR(&mp_module___main__) },
+    #endif
     { MP_ROM_QSTR(MP_QSTR_builtins), MP_ROM_PTR(&mp_module_builtins) },
     { MP_ROM_QSTR(MP_QSTR_micropython), MP_ROM_PTR(&mp_module_micropython) },
 
@@ -188,6 +196,12 @@ STATIC const mp_rom_map_elem_t mp_builtin_module_table[] = {
 #if MICROPY_PY_THREAD
     { MP_ROM_QSTR(MP_QSTR__thread), MP_ROM_PTR(&mp_module_thread) },
 #endif
+#if MICROPY_PY_PROFILER
+    { MP_ROM_QSTR(MP_QSTR_profiler), MP_ROM_PTR(&mp_module_profiler) },
+#endif
+#if MICROPY_PY_BENCHMARK
+    { MP_ROM_QSTR(MP_QSTR_benchmark), MP_ROM_PTR(&mp_module_benchmark) },
+#endif
 
     // extmod modules
 
@@ -488,6 +488,10 @@ STATIC void push_result_token(parser_t *parser, uint8_t rule_id) {
             && (elem = mp_map_lookup(&parser->consts, MP_OBJ_NEW_QSTR(id), MP_MAP_LOOKUP)) != NULL) {
             if (MP_OBJ_IS_SMALL_INT(elem->value)) {
                 pn = mp_parse_node_new_small_int_checked(parser, elem->value);
+            } else if (elem->value == mp_const_false) {
+                pn = mp_parse_node_new_leaf(MP_PARSE_NODE_TOKEN, MP_TOKEN_KW_FALSE);
+            } else if (elem->value == mp_const_true) {
+                pn = mp_parse_node_new_leaf(MP_PARSE_NODE_TOKEN, MP_TOKEN_KW_TRUE);
             } else {
                 pn = make_node_const_object(parser, lex->tok_line, elem->value);
             }
@@ -604,6 +608,43 @@ STATIC bool fold_logical_constants(parser_t *parser, uint8_t rule_id, size_t *nu
         pop_result(parser);
         push_result_node(parser, pn);
         return true;
+
+    } else if (rule_id == RULE_comparison) {
+        // folding for comparisons of integers: < > == <= >= !=
+        // a chain like 0 < x < 10 is only folded if every operand is constant
+        mp_obj_t lhs;
+        if (!mp_parse_node_get_int_maybe(peek_result(parser, *num_args - 1), &lhs)) {
+            return false;
+        }
+        bool result = true;
+        for (ssize_t i = *num_args - 2; i >= 1; i -= 2) {
+            mp_parse_node_t pn_op = peek_result(parser, i);
+            mp_obj_t rhs;
+            if (!MP_PARSE_NODE_IS_TOKEN(pn_op)
+                || !mp_parse_node_get_int_maybe(peek_result(parser, i - 1), &rhs)) {
+                return false;
+            }
+            mp_binary_op_t op;
+            switch (MP_PARSE_NODE_LEAF_ARG(pn_op)) {
+                case MP_TOKEN_OP_LESS: op = MP_BINARY_OP_LESS; break;
+                case MP_TOKEN_OP_MORE: op = MP_BINARY_OP_MORE; break;
+                case MP_TOKEN_OP_DBL_EQUAL: op = MP_BINARY_OP_EQUAL; break;
+                case MP_TOKEN_OP_LESS_EQUAL: op = MP_BINARY_OP_LESS_EQUAL; break;
+                case MP_TOKEN_OP_MORE_EQUAL: op = MP_BINARY_OP_MORE_EQUAL; break;
+                case MP_TOKEN_OP_NOT_EQUAL: op = MP_BINARY_OP_NOT_EQUAL; break;
+                default: return false;
+            }
+            if (result && mp_binary_op(op, lhs, rhs) == mp_const_false) {
+                result = false;
+            }
+            lhs = rhs;
+        }
+        for (size_t i = *num_args; i > 0; i--) {
+            pop_result(parser);
+        }
+        push_result_node(parser, mp_parse_node_new_leaf(MP_PARSE_NODE_TOKEN,
+            result ? MP_TOKEN_KW_TRUE : MP_TOKEN_KW_FALSE));
+        return true;
     }
 
     return false;
@@ -724,7 +765,11 @@ STATIC bool fold_constants(parser_t *parser, uint8_t rule_id, size_t num_args) {
                 // get the value
                 mp_parse_node_t pn_value = ((mp_parse_node_struct_t*)((mp_parse_node_struct_t*)pn1)->nodes[1])->nodes[0];
                 mp_obj_t value;
-                if (!mp_parse_node_get_int_maybe(pn_value, &value)) {
+                if (MP_PARSE_NODE_IS_TOKEN_KIND(pn_value, MP_TOKEN_KW_FALSE)) {
+                    value = mp_const_false;
+                } else if (MP_PARSE_NODE_IS_TOKEN_KIND(pn_value, MP_TOKEN_KW_TRUE)) {
+                    value = mp_const_true;
+                } else if (!mp_parse_node_get_int_maybe(pn_value, &value)) {
                     mp_obj_t exc = mp_obj_new_exception_msg(&mp_type_SyntaxError,
                         translate("constant must be an integer"));
                     mp_obj_exception_add_traceback(exc, parser->lexer->source_name,
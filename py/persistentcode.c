@@ -41,7 +41,21 @@
 #include "py/smallint.h"
 
 // The current version of .mpy files
-#define MPY_VERSION (3)
+//
+// Version 4 stores one deduplicated table of qstrs per file; bytecode, the
+// prelude and argument names refer to qstrs by their index in that table.
+// The file layout is:
+//  - header: 'M', version, feature flags, number of bits in a small int
+//  - byte: compression window bits, or 0 if the rest is not compressed
+//  - qstr table: count, then length and data of each qstr
+//  - the outer raw code, which includes the nested ones
+// When compressed, everything after the compression byte is an LZSS stream
+// that the loader decompresses as it reads (see lzss_readbyte).
+#define MPY_VERSION (4)
+
+// Range of LZSS window sizes; the loader needs a buffer of this many bytes.
+#define MPY_LZSS_WINDOW_BITS_MIN (8)
+#define MPY_LZSS_WINDOW_BITS_MAX (12)
 
 // The feature flags byte encodes the compile-time config options that
 // affect the generate bytecode.
@@ -147,6 +161,29 @@ STATIC qstr load_qstr(mp_reader_t *reader) {
     return qst;
 }
 
+typedef struct _qstr_table_t {
+    qstr *qstrs;
+    size_t len;
+} qstr_table_t;
+
+STATIC qstr qstr_table_get(const qstr_table_t *qstr_table, size_t index) {
+    if (index >= qstr_table->len) {
+        raise_corrupt_mpy();
+    }
+    return qstr_table->qstrs[index];
+}
+
+STATIC qstr load_qstr_index(mp_reader_t *reader, const qstr_table_t *qstr_table) {
+    return qstr_table_get(qstr_table, read_uint(reader));
+}
+
+// Replace the 16-bit qstr table index at ip with the qstr it refers to.
+STATIC void link_qstr(const qstr_table_t *qstr_table, byte *ip) {
+    qstr qst = qstr_table_get(qstr_table, ip[0] | (ip[1] << 8));
+    ip[0] = qst;
+    ip[1] = qst >> 8;
+}
+
 STATIC mp_obj_t load_obj(mp_reader_t *reader) {
     byte obj_type = read_byte(reader);
     if (obj_type == 'e') {
@@ -168,20 +205,18 @@ STATIC mp_obj_t load_obj(mp_reader_t *reader) {
     return MP_OBJ_FROM_PTR(&mp_const_none_obj);
 }
 
-STATIC void load_bytecode_qstrs(mp_reader_t *reader, byte *ip, byte *ip_top) {
+STATIC void link_bytecode_qstrs(const qstr_table_t *qstr_table, byte *ip, byte *ip_top) {
     while (ip < ip_top) {
         size_t sz;
         uint f = mp_opcode_format(ip, &sz);
         if (f == MP_OPCODE_QSTR) {
-            qstr qst = load_qstr(reader);
-            ip[1] = qst;
-            ip[2] = qst >> 8;
+            link_qstr(qstr_table, ip + 1);
         }
         ip += sz;
     }
 }
 
-STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
+STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader, const qstr_table_t *qstr_table) {
     // load bytecode
     size_t bc_len = read_uint(reader);
     byte *bytecode = m_new(byte, bc_len);
@@ -193,12 +228,10 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
     bytecode_prelude_t prelude;
     extract_prelude(&ip, &ip2, &prelude);
 
-    // load qstrs and link global qstr ids into bytecode
-    qstr simple_name = load_qstr(reader);
-    qstr source_file = load_qstr(reader);
-    ((byte*)ip2)[0] = simple_name; ((byte*)ip2)[1] = simple_name >> 8;
-    ((byte*)ip2)[2] = source_file; ((byte*)ip2)[3] = source_file >> 8;
-    load_bytecode_qstrs(reader, (byte*)ip, bytecode + bc_len);
+    // link global qstr ids into bytecode
+    link_qstr(qstr_table, (byte*)ip2); // simple_name
+    link_qstr(qstr_table, (byte*)ip2 + 2); // source_file
+    link_bytecode_qstrs(qstr_table, (byte*)ip, bytecode + bc_len);
 
     // load constant table
     size_t n_obj = read_uint(reader);
@@ -206,13 +239,13 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
     mp_uint_t *const_table = m_new(mp_uint_t, prelude.n_pos_args + prelude.n_kwonly_args + n_obj + n_raw_code);
     mp_uint_t *ct = const_table;
     for (size_t i = 0; i < prelude.n_pos_args + prelude.n_kwonly_args; ++i) {
-        *ct++ = (mp_uint_t)MP_OBJ_NEW_QSTR(load_qstr(reader));
+        *ct++ = (mp_uint_t)MP_OBJ_NEW_QSTR(load_qstr_index(reader, qstr_table));
     }
     for (size_t i = 0; i < n_obj; ++i) {
         *ct++ = (mp_uint_t)load_obj(reader);
     }
     for (size_t i = 0; i < n_raw_code; ++i) {
-        *ct++ = (mp_uint_t)(uintptr_t)load_raw_code(reader);
+        *ct++ = (mp_uint_t)(uintptr_t)load_raw_code(reader, qstr_table);
     }
 
     // create raw_code and return it
@@ -229,16 +262,123 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
     return rc;
 }
 
+#if MICROPY_PERSISTENT_CODE_LOAD_COMPRESSED
+
+// Streaming LZSS decompressor, wrapped around the reader of the file.  The
+// stream is a sequence of groups, each a flags byte followed by 8 items
+// (fewer at the end), one per flag bit starting from the least significant:
+//  - bit clear: a literal byte
+//  - bit set: a big-endian 16-bit match, whose top window_bits bits are the
+//    distance back minus 1 and whose other bits are the length minus 3
+// The only state is the window of recent output, so loading needs
+// 1 << window_bits bytes of RAM however large the file is.
+typedef struct _lzss_reader_t {
+    mp_reader_t *src;
+    byte *window;
+    uint16_t mask;
+    uint16_t pos;
+    uint16_t copy_dist;
+    uint16_t copy_len;
+    uint8_t len_bits;
+    uint8_t flags;
+    uint8_t n_flags;
+} lzss_reader_t;
+
+STATIC mp_uint_t lzss_readbyte(void *data) {
+    lzss_reader_t *lz = (lzss_reader_t*)data;
+    if (lz->copy_len == 0) {
+        if (lz->n_flags == 0) {
+            mp_uint_t flags = lz->src->readbyte(lz->src->data);
+            if (flags == MP_READER_EOF) {
+                return MP_READER_EOF;
+            }
+            lz->flags = flags;
+            lz->n_flags = 8;
+        }
+        bool match = lz->flags & 1;
+        lz->flags >>= 1;
+        lz->n_flags -= 1;
+        mp_uint_t b = lz->src->readbyte(lz->src->data);
+        if (!match || b == MP_READER_EOF) {
+            if (b != MP_READER_EOF) {
+                lz->window[lz->pos++ & lz->mask] = b;
+            }
+            return b;
+        }
+        mp_uint_t b2 = lz->src->readbyte(lz->src->data);
+        if (b2 == MP_READER_EOF) {
+            return MP_READER_EOF;
+        }
+        uint match_code = (b << 8) | b2;
+        lz->copy_dist = (match_code >> lz->len_bits) + 1;
+        lz->copy_len = (match_code & ((1 << lz->len_bits) - 1)) + 3;
+    }
+    lz->copy_len -= 1;
+    byte b = lz->window[(uint16_t)(lz->pos - lz->copy_dist) & lz->mask];
+    lz->window[lz->pos++ & lz->mask] = b;
+    return b;
+}
+
+STATIC void lzss_close(void *data) {
+    (void)data;
+}
+
+#endif
+
 mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader) {
-    byte header[4];
-    read_bytes(reader, header, sizeof(header));
+    byte header[5];
+    read_bytes(reader, header, 4);
     if (header[0] != 'M'
         || header[1] != MPY_VERSION
         || header[2] != MPY_FEATURE_FLAGS
         || header[3] > mp_small_int_bits()) {
         mp_raise_MpyError(translate("Incompatible .mpy file. Please update all .mpy files. See http://adafru.it/mpy-update for more info."));
     }
-    mp_raw_code_t *rc = load_raw_code(reader);
+    header[4] = read_byte(reader);
+    #if MICROPY_PERSISTENT_CODE_LOAD_COMPRESSED
+    if (header[4] != 0 && (header[4] < MPY_LZSS_WINDOW_BITS_MIN || header[4] > MPY_LZSS_WINDOW_BITS_MAX)) {
+    #else
+    if (header[4] != 0) {
+    #endif
+        mp_raise_MpyError(translate("Incompatible .mpy file. Please update all .mpy files. See http://adafru.it/mpy-update for more info."));
+    }
+
+    mp_reader_t *body = reader;
+    #if MICROPY_PERSISTENT_CODE_LOAD_COMPRESSED
+    mp_reader_t lzss;
+    lzss_reader_t lz;
+    if (header[4] != 0) {
+        lz.src = reader;
+        lz.window = m_new(byte, 1 << header[4]);
+        lz.mask = (1 << header[4]) - 1;
+        lz.pos = 0;
+        lz.copy_len = 0;
+        lz.len_bits = 16 - header[4];
+        lz.n_flags = 0;
+        lzss.data = &lz;
+        lzss.readbyte = lzss_readbyte;
+        lzss.close = lzss_close;
+        body = &lzss;
+    }
+    #endif
+
+    // Intern the whole table up front: each qstr is looked up once per file
+    // rather than once per use.
+    qstr_table_t qstr_table;
+    qstr_table.len = read_uint(body);
+    qstr_table.qstrs = m_new(qstr, qstr_table.len);
+    for (size_t i = 0; i < qstr_table.len; ++i) {
+        qstr_table.qstrs[i] = load_qstr(body);
+    }
+
+    mp_raw_code_t *rc = load_raw_code(body, &qstr_table);
+
+    m_del(qstr, qstr_table.qstrs, qstr_table.len);
+    #if MICROPY_PERSISTENT_CODE_LOAD_COMPRESSED
+    if (header[4] != 0) {
+        m_del(byte, lz.window, 1 << header[4]);
+    }
+    #endif
     reader->close(reader->data);
     return rc;
 }
@@ -284,6 +424,22 @@ STATIC void save_qstr(mp_print_t *print, qstr qst) {
     mp_print_bytes(print, str, len);
 }
 
+// Return the index of qst in the file's qstr table, adding it if needed.
+STATIC size_t qstr_table_index(mp_map_t *qstr_map, qstr qst) {
+    mp_map_elem_t *elem = mp_map_lookup(qstr_map, MP_OBJ_NEW_QSTR(qst), MP_MAP_LOOKUP_ADD_IF_NOT_FOUND);
+    if (elem->value == MP_OBJ_NULL) {
+        elem->value = MP_OBJ_NEW_SMALL_INT(qstr_map->used - 1);
+    }
+    return MP_OBJ_SMALL_INT_VALUE(elem->value);
+}
+
+// Replace the 16-bit qstr id at ip with its index in the qstr table.
+STATIC void index_qstr(mp_map_t *qstr_map, byte *ip) {
+    size_t index = qstr_table_index(qstr_map, ip[0] | (ip[1] << 8));
+    ip[0] = index;
+    ip[1] = index >> 8;
+}
+
 STATIC void save_obj(mp_print_t *print, mp_obj_t o) {
     if (MP_OBJ_IS_STR_OR_BYTES(o)) {
         byte obj_type;
@@ -325,37 +481,37 @@ STATIC void save_obj(mp_print_t *print, mp_obj_t o) {
     }
 }
 
-STATIC void save_bytecode_qstrs(mp_print_t *print, const byte *ip, const byte *ip_top) {
-    while (ip < ip_top) {
-        size_t sz;
-        uint f = mp_opcode_format(ip, &sz);
-        if (f == MP_OPCODE_QSTR) {
-            qstr qst = ip[1] | (ip[2] << 8);
-            save_qstr(print, qst);
-        }
-        ip += sz;
-    }
-}
-
-STATIC void save_raw_code(mp_print_t *print, mp_raw_code_t *rc) {
+STATIC void save_raw_code(mp_print_t *print, mp_map_t *qstr_map, mp_raw_code_t *rc) {
     if (rc->kind != MP_CODE_BYTECODE) {
         mp_raise_ValueError(translate("can only save bytecode"));
     }
 
-    // save bytecode
-    mp_print_uint(print, rc->data.u_byte.bc_len);
-    mp_print_bytes(print, rc->data.u_byte.bytecode, rc->data.u_byte.bc_len);
+    // copy the bytecode and replace its qstr ids with qstr table indices
+    size_t bc_len = rc->data.u_byte.bc_len;
+    byte *bytecode = m_new(byte, bc_len);
+    memcpy(bytecode, rc->data.u_byte.bytecode, bc_len);
 
     // extract prelude
-    const byte *ip = rc->data.u_byte.bytecode;
+    const byte *ip = bytecode;
     const byte *ip2;
     bytecode_prelude_t prelude;
     extract_prelude(&ip, &ip2, &prelude);
 
-    // save qstrs
-    save_qstr(print, ip2[0] | (ip2[1] << 8)); // simple_name
-    save_qstr(print, ip2[2] | (ip2[3] << 8)); // source_file
-    save_bytecode_qstrs(print, ip, rc->data.u_byte.bytecode + rc->data.u_byte.bc_len);
+    index_qstr(qstr_map, (byte*)ip2); // simple_name
+    index_qstr(qstr_map, (byte*)ip2 + 2); // source_file
+    for (byte *ip_top = bytecode + bc_len; ip < ip_top;) {
+        size_t sz;
+        uint f = mp_opcode_format(ip, &sz);
+        if (f == MP_OPCODE_QSTR) {
+            index_qstr(qstr_map, (byte*)ip + 1);
+        }
+        ip += sz;
+    }
+
+    // save bytecode
+    mp_print_uint(print, bc_len);
+    mp_print_bytes(print, bytecode, bc_len);
+    m_del(byte, bytecode, bc_len);
 
     // save constant table
     mp_print_uint(print, rc->data.u_byte.n_obj);
@@ -363,36 +519,162 @@ STATIC void save_raw_code(mp_print_t *print, mp_raw_code_t *rc) {
     const mp_uint_t *const_table = rc->data.u_byte.const_table;
     for (uint i = 0; i < prelude.n_pos_args + prelude.n_kwonly_args; ++i) {
         mp_obj_t o = (mp_obj_t)*const_table++;
-        save_qstr(print, MP_OBJ_QSTR_VALUE(o));
+        mp_print_uint(print, qstr_table_index(qstr_map, MP_OBJ_QSTR_VALUE(o)));
     }
     for (uint i = 0; i < rc->data.u_byte.n_obj; ++i) {
         save_obj(print, (mp_obj_t)*const_table++);
     }
     for (uint i = 0; i < rc->data.u_byte.n_raw_code; ++i) {
-        save_raw_code(print, (mp_raw_code_t*)(uintptr_t)*const_table++);
+        save_raw_code(print, qstr_map, (mp_raw_code_t*)(uintptr_t)*const_table++);
+    }
+}
+
+#if MICROPY_DYNAMIC_COMPILER
+
+#define LZSS_HASH_BITS (12)
+
+STATIC uint lzss_hash(const byte *data) {
+    return ((data[0] << 8) ^ (data[1] << 4) ^ data[2]) & ((1 << LZSS_HASH_BITS) - 1);
+}
+
+// Greedy LZSS compressor for the format that lzss_readbyte decodes.  Matches
+// are found through hash chains of 3-byte prefixes, capped at 64 links.
+STATIC void lzss_compress(mp_print_t *print, const byte *data, size_t len, uint window_bits) {
+    size_t window = 1 << window_bits;
+    uint len_bits = 16 - window_bits;
+    size_t max_len = (1 << len_bits) + 2;
+    // position + 1 of the latest, and the previous, occurrence of each hash
+    size_t *head = m_new0(size_t, 1 << LZSS_HASH_BITS);
+    size_t *prev = m_new0(size_t, window);
+
+    byte group[1 + 8 * 2];
+    size_t group_len = 1;
+    uint n_items = 0;
+    group[0] = 0;
+    for (size_t i = 0; i < len;) {
+        size_t best_len = 0;
+        size_t best_dist = 0;
+        if (i + 3 <= len) {
+            size_t limit = MIN(max_len, len - i);
+            size_t cand = head[lzss_hash(data + i)];
+            for (int chain = 64; cand != 0 && i - (cand - 1) <= window && chain > 0; --chain) {
+                size_t p = cand - 1;
+                size_t l = 0;
+                while (l < limit && data[p + l] == data[i + l]) {
+                    ++l;
+                }
+                if (l > best_len) {
+                    best_len = l;
+                    best_dist = i - p;
+                    if (l == limit) {
+                        break;
+                    }
+                }
+                cand = prev[p & (window - 1)];
+            }
+        }
+
+        size_t step = 1;
+        if (best_len >= 3) {
+            uint match_code = ((best_dist - 1) << len_bits) | (best_len - 3);
+            group[0] |= 1 << n_items;
+            group[group_len++] = match_code >> 8;
+            group[group_len++] = match_code;
+            step = best_len;
+        } else {
+            group[group_len++] = data[i];
+        }
+        if (++n_items == 8) {
+            mp_print_bytes(print, group, group_len);
+            group[0] = 0;
+            group_len = 1;
+            n_items = 0;
+        }
+
+        for (; step > 0; --step, ++i) {
+            if (i + 3 <= len) {
+                uint h = lzss_hash(data + i);
+                prev[i & (window - 1)] = head[h];
+                head[h] = i + 1;
+            }
+        }
     }
+    if (n_items > 0) {
+        mp_print_bytes(print, group, group_len);
+    }
+
+    m_del(size_t, head, 1 << LZSS_HASH_BITS);
+    m_del(size_t, prev, window);
 }
 
+#endif
+
 void mp_raw_code_save(mp_raw_code_t *rc, mp_print_t *print) {
+    #if MICROPY_DYNAMIC_COMPILER
+    // mpy-cross checks this is in range
+    uint window_bits = mp_dynamic_compiler.mpy_compress_bits;
+    #else
+    uint window_bits = 0;
+    #endif
+
     // header contains:
     //  byte  'M'
     //  byte  version
     //  byte  feature flags
     //  byte  number of bits in a small int
-    byte header[4] = {'M', MPY_VERSION, MPY_FEATURE_FLAGS_DYNAMIC,
+    //  byte  compression window bits, 0 for none
+    byte header[5] = {'M', MPY_VERSION, MPY_FEATURE_FLAGS_DYNAMIC,
         #if MICROPY_DYNAMIC_COMPILER
         mp_dynamic_compiler.small_int_bits,
         #else
         mp_small_int_bits(),
         #endif
+        window_bits,
     };
     mp_print_bytes(print, header, sizeof(header));
 
-    save_raw_code(print, rc);
+    // The qstr table precedes the code but is only complete once all the code
+    // has been written, so write the code to a buffer first.
+    mp_map_t qstr_map;
+    mp_map_init(&qstr_map, 16);
+    vstr_t code;
+    mp_print_t code_print;
+    vstr_init_print(&code, 256, &code_print);
+    save_raw_code(&code_print, &qstr_map, rc);
+
+    vstr_t body;
+    mp_print_t body_print;
+    vstr_init_print(&body, code.len + 16 * qstr_map.used, &body_print);
+    qstr *qstrs = m_new(qstr, qstr_map.used);
+    for (size_t i = 0; i < qstr_map.alloc; ++i) {
+        if (MP_MAP_SLOT_IS_FILLED(&qstr_map, i)) {
+            qstrs[MP_OBJ_SMALL_INT_VALUE(qstr_map.table[i].value)] = MP_OBJ_QSTR_VALUE(qstr_map.table[i].key);
+        }
+    }
+    mp_print_uint(&body_print, qstr_map.used);
+    for (size_t i = 0; i < qstr_map.used; ++i) {
+        save_qstr(&body_print, qstrs[i]);
+    }
+    mp_print_bytes(&body_print, (const byte*)code.buf, code.len);
+    m_del(qstr, qstrs, qstr_map.used);
+    vstr_clear(&code);
+    mp_map_deinit(&qstr_map);
+
+    #if MICROPY_DYNAMIC_COMPILER
+    if (window_bits != 0) {
+        lzss_compress(print, (const byte*)body.buf, body.len, window_bits);
+    } else
+    #endif
+    {
+        mp_print_bytes(print, (const byte*)body.buf, body.len);
+    }
+    vstr_clear(&body);
 }
 
 // here we define mp_raw_code_save_file depending on the port
 // TODO abstract this away properly
+// (ports with a VFS can save through mp_raw_code_save and a stream instead,
+// see the .mpy cache in py/builtinimport.c)
 
 #if defined(__i386__) || defined(__x86_64__) || defined(__unix__)
 
@@ -413,7 +695,7 @@ void mp_raw_code_save_file(mp_raw_code_t *rc, const char *filename) {
     close(fd);
 }
 
-#else
+#elif !MICROPY_VFS
 #error mp_raw_code_save_file not implemented for this platform
 #endif
 
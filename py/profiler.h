@@ -0,0 +1,61 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MICROPY_INCLUDED_PY_PROFILER_H
+#define MICROPY_INCLUDED_PY_PROFILER_H
+
+#include "py/obj.h"
+
+#if MICROPY_PY_PROFILER
+
+// Default sampling rate requested from the port, in Hz.
+#define MP_PROFILER_DEFAULT_RATE_HZ (1000)
+
+typedef struct _mp_profiler_sample_t {
+    // Keeps the sampled function alive until the samples are dumped.
+    const struct _mp_obj_fun_bc_t *fun_bc;
+    // Offset of the sampled instruction from the start of fun_bc->bytecode.
+    mp_uint_t offset;
+} mp_profiler_sample_t;
+
+// Record the bytecode position of the running thread.  Called by the port
+// from its timer interrupt or signal handler while the profiler is running.
+void mp_profiler_sample(void);
+
+// Clear a new VM's profiler state.  Called by mp_init, and leaves the port's
+// timer alone because another VM may be sampling with it.
+void mp_profiler_init(void);
+
+// Stop sampling and release the sample buffer.  Called on soft reset.
+void mp_profiler_reset(void);
+
+// Implemented by the port: call mp_profiler_sample() roughly rate_hz times
+// per second until mp_profiler_port_stop() is called.
+void mp_profiler_port_start(mp_uint_t rate_hz);
+void mp_profiler_port_stop(void);
+
+#endif // MICROPY_PY_PROFILER
+
+#endif // MICROPY_INCLUDED_PY_PROFILER_H
@@ -242,6 +242,8 @@ PY_CORE_O_BASENAME = $(addprefix py/,\
 	modsys.o \
 	moduerrno.o \
 	modthread.o \
+	modprofiler.o \
+	modbenchmark.o \
 	vm.o \
 	bc.o \
 	showbc.o \
@@ -249,6 +251,7 @@ PY_CORE_O_BASENAME = $(addprefix py/,\
 	smallint.o \
 	frozenmod.o \
 	ringbuf.o \
+	mptrace.o \
 	)
 
 PY_EXTMOD_O_BASENAME = \
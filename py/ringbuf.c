@@ -24,92 +24,246 @@
  * THE SOFTWARE.
  */
 
+#include <string.h>
+
 #include "ringbuf.h"
 
+// The index owned by the other side is read with acquire semantics, so its
+// buffer accesses are complete before we reuse the space it released.
+#define RINGBUF_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RINGBUF_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
 // Dynamic initialization. This should be accessible from a root pointer.
-// capacity is the number of bytes the ring buffer can hold. The actual
-// size of the buffer is one greater than that, due to how the buffer
-// handles empty and full statuses.
+// capacity is the number of bytes the ring buffer must hold. It is rounded up
+// to a power of two.
 bool ringbuf_alloc(ringbuf_t *r, size_t capacity, bool long_lived) {
-    r->buf = gc_alloc(capacity + 1, false, long_lived);
-    r->size = capacity +  1;
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    r->buf = gc_alloc(size, false, long_lived);
+    r->size = r->buf != NULL ? size : 0;
     r->iget = r->iput = 0;
     return r->buf != NULL;
 }
 
+// Use a caller-provided buffer. Only the largest power of two that fits in
+// size bytes is used.
+void ringbuf_init(ringbuf_t *r, uint8_t *buf, size_t size) {
+    uint32_t pow2 = 1;
+    while (pow2 * 2 <= size) {
+        pow2 <<= 1;
+    }
+    r->buf = buf;
+    r->size = size == 0 ? 0 : pow2;
+    r->iget = r->iput = 0;
+}
+
 void ringbuf_free(ringbuf_t *r) {
     gc_free(r->buf);
+    r->buf = NULL;
     r->size = 0;
-    ringbuf_clear(r);
+    r->iget = r->iput = 0;
 }
 
 size_t ringbuf_capacity(ringbuf_t *r) {
-    return r->size - 1;
+    return r->size;
 }
 
 // Returns -1 if buffer is empty, else returns byte fetched.
 int ringbuf_get(ringbuf_t *r) {
-    if (r->iget == r->iput) {
+    uint32_t iget = r->iget;
+    if (iget == RINGBUF_LOAD_ACQUIRE(&r->iput)) {
         return -1;
     }
-    uint8_t v = r->buf[r->iget++];
-    if (r->iget >= r->size) {
-        r->iget = 0;
-    }
+    uint8_t v = r->buf[iget & (r->size - 1)];
+    RINGBUF_STORE_RELEASE(&r->iget, iget + 1);
     return v;
 }
 
 // Returns -1 if no room in buffer, else returns 0.
 int ringbuf_put(ringbuf_t *r, uint8_t v) {
-    uint32_t iput_new = r->iput + 1;
-    if (iput_new >= r->size) {
-        iput_new = 0;
-    }
-    if (iput_new == r->iget) {
+    uint32_t iput = r->iput;
+    if (iput - RINGBUF_LOAD_ACQUIRE(&r->iget) >= r->size) {
         return -1;
     }
-    r->buf[r->iput] = v;
-    r->iput = iput_new;
+    r->buf[iput & (r->size - 1)] = v;
+    RINGBUF_STORE_RELEASE(&r->iput, iput + 1);
     return 0;
 }
 
+// Discard everything currently in the buffer. Call from the consumer side.
 void ringbuf_clear(ringbuf_t *r) {
-    r->iput = r->iget = 0;
+    RINGBUF_STORE_RELEASE(&r->iget, RINGBUF_LOAD_ACQUIRE(&r->iput));
 }
 
 // Number of free slots that can be written.
 size_t ringbuf_num_empty(ringbuf_t *r) {
-    return (r->size + r->iget - r->iput - 1) % r->size;
+    return r->size - ringbuf_num_filled(r);
 }
 
 // Number of bytes available to read.
 size_t ringbuf_num_filled(ringbuf_t *r) {
-    return (r->size + r->iput - r->iget) % r->size;
+    return RINGBUF_LOAD_ACQUIRE(&r->iput) - RINGBUF_LOAD_ACQUIRE(&r->iget);
 }
 
 // If the ring buffer fills up, not all bytes will be written.
 // Returns how many bytes were successfully written.
-size_t ringbuf_put_n(ringbuf_t* r, uint8_t* buf, size_t bufsize)
+size_t ringbuf_put_n(ringbuf_t* r, const uint8_t* buf, size_t bufsize)
 {
-    for(size_t i=0; i < bufsize; i++) {
-        if ( ringbuf_put(r, buf[i]) < 0 ) {
-            // If ringbuf is full, give up and return how many bytes
-            // we wrote so far.
-            return i;
-        }
+    uint32_t iput = r->iput;
+    size_t n = r->size - (iput - RINGBUF_LOAD_ACQUIRE(&r->iget));
+    if (bufsize < n) {
+        n = bufsize;
+    }
+    // Copy up to the end of the buffer, then the rest from the start.
+    size_t offset = iput & (r->size - 1);
+    size_t first = r->size - offset;
+    if (first > n) {
+        first = n;
     }
-    return bufsize;
+    memcpy(r->buf + offset, buf, first);
+    memcpy(r->buf, buf + first, n - first);
+    RINGBUF_STORE_RELEASE(&r->iput, iput + n);
+    return n;
 }
 
 // Returns how many bytes were fetched.
 size_t ringbuf_get_n(ringbuf_t* r, uint8_t* buf, size_t bufsize)
 {
-    for(size_t i=0; i < bufsize; i++) {
-        int b = ringbuf_get(r);
-        if (b < 0) {
-            return i;
-        }
-        buf[i] = b;
-    }
-    return bufsize;
+    uint32_t iget = r->iget;
+    size_t n = RINGBUF_LOAD_ACQUIRE(&r->iput) - iget;
+    if (bufsize < n) {
+        n = bufsize;
+    }
+    size_t offset = iget & (r->size - 1);
+    size_t first = r->size - offset;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(buf, r->buf + offset, first);
+    memcpy(buf + first, r->buf, n - first);
+    RINGBUF_STORE_RELEASE(&r->iget, iget + n);
+    return n;
+}
+
+// Returns the readable bytes that are contiguous in the storage and sets *len
+// to how many there are, 0 if the buffer is empty. Call ringbuf_release_n once
+// they have been used.
+uint8_t *ringbuf_peek_n(ringbuf_t *r, size_t *len) {
+    uint32_t iget = r->iget;
+    size_t n = RINGBUF_LOAD_ACQUIRE(&r->iput) - iget;
+    size_t offset = iget & (r->size - 1);
+    if (n > r->size - offset) {
+        n = r->size - offset;
+    }
+    *len = n;
+    return r->buf + offset;
+}
+
+// Discard len bytes, at most what ringbuf_peek_n returned.
+void ringbuf_release_n(ringbuf_t *r, size_t len) {
+    RINGBUF_STORE_RELEASE(&r->iget, r->iget + len);
+}
+
+// Returns the free space that is contiguous in the storage and sets *len to
+// its size, 0 if the buffer is full. What is written there isn't visible to
+// the consumer until ringbuf_commit_n.
+uint8_t *ringbuf_reserve_n(ringbuf_t *r, size_t *len) {
+    uint32_t iput = r->iput;
+    size_t n = r->size - (iput - RINGBUF_LOAD_ACQUIRE(&r->iget));
+    size_t offset = iput & (r->size - 1);
+    if (n > r->size - offset) {
+        n = r->size - offset;
+    }
+    *len = n;
+    return r->buf + offset;
+}
+
+// Publish len bytes, at most what ringbuf_reserve_n returned.
+void ringbuf_commit_n(ringbuf_t *r, size_t len) {
+    RINGBUF_STORE_RELEASE(&r->iput, r->iput + len);
+}
+
+// Records are variable-length messages that are each contiguous in memory,
+// so they can be filled and read in place. Each one is a uint32_t length
+// followed by the data, padded to a multiple of 4 bytes. A record that does
+// not fit before the end of the storage starts again at the beginning, with
+// a RINGBUF_RECORD_WRAP marker in place of the length. A ring must hold
+// either records or bytes, not both.
+
+#define RINGBUF_RECORD_WRAP (0xffffffff)
+
+static inline size_t ringbuf_record_size(size_t len) {
+    return sizeof(uint32_t) + ((len + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1));
+}
+
+// Bytes skipped at the end of the storage before a record of size bytes
+// written at iput.
+static inline size_t ringbuf_record_skip(ringbuf_t *r, uint32_t iput, size_t size) {
+    size_t contiguous = r->size - (iput & (r->size - 1));
+    return contiguous < size ? contiguous : 0;
+}
+
+// Returns where to write a record of len bytes, or NULL if there isn't room.
+// The record isn't visible to the consumer until ringbuf_record_commit.
+uint8_t *ringbuf_record_reserve(ringbuf_t *r, size_t len) {
+    uint32_t iput = r->iput;
+    size_t size = ringbuf_record_size(len);
+    size_t skip = ringbuf_record_skip(r, iput, size);
+    if (skip + size > r->size - (iput - RINGBUF_LOAD_ACQUIRE(&r->iget))) {
+        return NULL;
+    }
+    uint32_t *header = (uint32_t *)(r->buf + (iput & (r->size - 1)));
+    if (skip > 0) {
+        *header = RINGBUF_RECORD_WRAP;
+        header = (uint32_t *)r->buf;
+    }
+    *header = len;
+    return (uint8_t *)(header + 1);
+}
+
+// Publish the record of len bytes last returned by ringbuf_record_reserve.
+void ringbuf_record_commit(ringbuf_t *r, size_t len) {
+    uint32_t iput = r->iput;
+    size_t size = ringbuf_record_size(len);
+    RINGBUF_STORE_RELEASE(&r->iput, iput + ringbuf_record_skip(r, iput, size) + size);
+}
+
+// Copy a whole record in, or nothing if there isn't room.
+bool ringbuf_record_put(ringbuf_t *r, const uint8_t *buf, size_t len) {
+    uint8_t *p = ringbuf_record_reserve(r, len);
+    if (p == NULL) {
+        return false;
+    }
+    memcpy(p, buf, len);
+    ringbuf_record_commit(r, len);
+    return true;
+}
+
+// Returns the oldest record and sets *len to its length, or returns NULL if
+// there are none. The record stays in place until ringbuf_record_release.
+uint8_t *ringbuf_record_peek(ringbuf_t *r, size_t *len) {
+    uint32_t iget = r->iget;
+    if (iget == RINGBUF_LOAD_ACQUIRE(&r->iput)) {
+        return NULL;
+    }
+    uint32_t *header = (uint32_t *)(r->buf + (iget & (r->size - 1)));
+    if (*header == RINGBUF_RECORD_WRAP) {
+        header = (uint32_t *)r->buf;
+    }
+    *len = *header;
+    return (uint8_t *)(header + 1);
+}
+
+// Discard the record returned by ringbuf_record_peek.
+void ringbuf_record_release(ringbuf_t *r) {
+    uint32_t iget = r->iget;
+    size_t offset = iget & (r->size - 1);
+    uint32_t *header = (uint32_t *)(r->buf + offset);
+    if (*header == RINGBUF_RECORD_WRAP) {
+        iget += r->size - offset;
+        header = (uint32_t *)r->buf;
+    }
+    RINGBUF_STORE_RELEASE(&r->iget, iget + ringbuf_record_size(*header));
 }
@@ -30,21 +30,30 @@
 
 #include <stdint.h>
 
+// Single-producer, single-consumer byte ring buffer.
+//
+// One context (for example an interrupt handler) may put while another gets,
+// without locking: the producer only writes iput and the consumer only writes
+// iget, and each publishes its index with release semantics.  The indices run
+// freely and are masked on access, so the size must be a power of two and the
+// whole buffer is usable.  Anything else, such as two producers, needs the
+// caller to provide its own locking.
+
 typedef struct _ringbuf_t {
     uint8_t *buf;
-    // Allocated size; capacity is one less. Don't reference this directly.
+    // Allocated size, a power of two. Don't reference this directly.
     uint32_t size;
     uint32_t iget;
     uint32_t iput;
 } ringbuf_t;
 
-// Note that the capacity of the buffer is N-1!
-
-// Static initialization:
+// Static initialization, with N a power of two:
 // byte buf_array[N];
 // ringbuf_t buf = {buf_array, sizeof(buf_array)};
+// or ringbuf_init(&buf, buf_array, sizeof(buf_array)) for any size.
 
 bool ringbuf_alloc(ringbuf_t *r, size_t capacity, bool long_lived);
+void ringbuf_init(ringbuf_t *r, uint8_t *buf, size_t size);
 void ringbuf_free(ringbuf_t *r);
 size_t ringbuf_capacity(ringbuf_t *r);
 int ringbuf_get(ringbuf_t *r);
@@ -52,7 +61,21 @@ int ringbuf_put(ringbuf_t *r, uint8_t v);
 void ringbuf_clear(ringbuf_t *r);
 size_t ringbuf_num_empty(ringbuf_t *r);
 size_t ringbuf_num_filled(ringbuf_t *r);
-size_t ringbuf_put_n(ringbuf_t* r, uint8_t* buf, size_t bufsize);
+size_t ringbuf_put_n(ringbuf_t* r, const uint8_t* buf, size_t bufsize);
 size_t ringbuf_get_n(ringbuf_t* r, uint8_t* buf, size_t bufsize);
 
+// Zero-copy access to the bytes in place.
+uint8_t *ringbuf_peek_n(ringbuf_t *r, size_t *len);
+void ringbuf_release_n(ringbuf_t *r, size_t len);
+uint8_t *ringbuf_reserve_n(ringbuf_t *r, size_t *len);
+void ringbuf_commit_n(ringbuf_t *r, size_t len);
+
+// Variable-length records, each contiguous in the buffer (see ringbuf.c).
+// The storage must be 4-byte aligned.
+uint8_t *ringbuf_record_reserve(ringbuf_t *r, size_t len);
+void ringbuf_record_commit(ringbuf_t *r, size_t len);
+bool ringbuf_record_put(ringbuf_t *r, const uint8_t *buf, size_t len);
+uint8_t *ringbuf_record_peek(ringbuf_t *r, size_t *len);
+void ringbuf_record_release(ringbuf_t *r);
+
 #endif // MICROPY_INCLUDED_PY_RINGBUF_H
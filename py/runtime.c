@@ -46,6 +46,8 @@
 #include "py/builtin.h"
 #include "py/stackctrl.h"
 #include "py/gc.h"
+#include "py/profiler.h"
+#include "py/mptrace.h"
 
 #include "supervisor/shared/translate.h"
 
@@ -58,10 +60,12 @@
 #define DEBUG_OP_printf(...) (void)0
 #endif
 
+#if !MICROPY_MULTI_INTERP
 const mp_obj_module_t mp_module___main__ = {
     .base = { &mp_type_module },
     .globals = (mp_obj_dict_t*)&MP_STATE_VM(dict_main),
 };
+#endif
 
 void mp_init(void) {
     qstr_init();
@@ -70,13 +74,36 @@ void mp_init(void) {
     MP_STATE_VM(mp_pending_exception) = MP_OBJ_NULL;
     #if MICROPY_ENABLE_SCHEDULER
     MP_STATE_VM(sched_state) = MP_SCHED_IDLE;
-    MP_STATE_VM(sched_sp) = 0;
+    for (size_t i = 0; i < MP_SCHED_NUM_PRIORITIES; ++i) {
+        MP_STATE_VM(sched_queue)[i].head = 0;
+        MP_STATE_VM(sched_queue)[i].len = 0;
+    }
+    MP_STATE_VM(sched_len) = 0;
+    MP_STATE_VM(sched_peak) = 0;
+    MP_STATE_VM(sched_dropped) = 0;
+    #endif
+
+    #if MICROPY_PY_PROFILER
+    MP_STATE_THREAD(current_code_state) = NULL;
+    mp_profiler_init();
+    #endif
+
+    #if MICROPY_TRACE_BUFFER
+    mp_trace_clear();
     #endif
 
 #if MICROPY_ENABLE_EMERGENCY_EXCEPTION_BUF
     mp_init_emergency_exception_buf();
 #endif
 
+    #if MICROPY_OPT_FAST_EXCEPTIONS
+    mp_obj_exception_fast_init();
+    #endif
+
+    #if MICROPY_OPT_GEN_FRAME_POOL
+    mp_obj_gen_frame_pool_init();
+    #endif
+
     #if MICROPY_KBD_EXCEPTION
     // initialise the exception object for raising KeyboardInterrupt
     MP_STATE_VM(mp_kbd_exception).base.type = &mp_type_KeyboardInterrupt;
@@ -108,6 +135,11 @@ void mp_init(void) {
     // initialise the __main__ module
     mp_obj_dict_init(&MP_STATE_VM(dict_main), 1);
     mp_obj_dict_store(MP_OBJ_FROM_PTR(&MP_STATE_VM(dict_main)), MP_OBJ_NEW_QSTR(MP_QSTR___name__), MP_OBJ_NEW_QSTR(MP_QSTR___main__));
+    #if MICROPY_MULTI_INTERP
+    MP_STATE_VM(module_main).base.type = &mp_type_module;
+    MP_STATE_VM(module_main).globals = &MP_STATE_VM(dict_main);
+    mp_module_register(MP_QSTR___main__, MP_OBJ_FROM_PTR(&MP_STATE_VM(module_main)));
+    #endif
 
     // locals = globals for outer module (see Objects/frameobject.c/PyFrame_New())
     mp_locals_set(&MP_STATE_VM(dict_main));
@@ -125,6 +157,17 @@ void mp_init(void) {
     MP_STATE_VM(dupterm_arr_obj) = MP_OBJ_NULL;
     #endif
 
+    #if MICROPY_VFS && MICROPY_VFS_IMPORT_CACHE
+    MP_STATE_VM(vfs_import_cache) = NULL;
+    MP_STATE_VM(vfs_import_cache_dirs) = 0;
+    MP_STATE_VM(vfs_import_cache_hits) = 0;
+    MP_STATE_VM(vfs_import_cache_misses) = 0;
+    #endif
+
+    #if MICROPY_PY_STRUCT_FORMAT_CACHE
+    memset(MP_STATE_VM(struct_format_cache), 0, sizeof(MP_STATE_VM(struct_format_cache)));
+    #endif
+
     #ifdef MICROPY_FSUSERMOUNT
     // zero out the pointers to the user-mounted devices
     memset(MP_STATE_VM(fs_user_mount) + MICROPY_FATFS_NUM_PERSISTENT, 0,
@@ -142,6 +185,15 @@ void mp_deinit(void) {
     //mp_obj_dict_free(&dict_main);
     //mp_map_deinit(&MP_STATE_VM(mp_loaded_modules_map));
 
+    #if MICROPY_TRACE_BUFFER
+    mp_trace_clear();
+    #endif
+
+    #if MICROPY_PY_PROFILER
+    // stops the port's timer only if this VM started it
+    mp_profiler_reset();
+    #endif
+
     // call port specific deinitialization if any
 #ifdef MICROPY_PORT_INIT_FUNC
     MICROPY_PORT_DEINIT_FUNC;
@@ -810,11 +862,64 @@ void PLACE_IN_ITCM(mp_call_prepare_args_n_kw_var)(bool have_self, size_t n_args_
     out_args->n_alloc = args2_alloc;
 }
 
+#if !MICROPY_ENABLE_PYSTACK
+// Calls like f(a, k=v, **d), where d is a dict with only qstr keys, are common
+// for passing options through to another function.  Their arguments are
+// flattened into this many words on the C stack instead of the heap.
+#define CALL_VAR_MAX_ARGS_ON_STACK (16)
+
+STATIC bool call_kw_dict_on_stack(bool have_self, size_t n_args_n_kw, const mp_obj_t *args, mp_obj_t *res) {
+    mp_obj_t fun = *args++;
+    mp_obj_t self = MP_OBJ_NULL;
+    if (have_self) {
+        self = *args++; // may be MP_OBJ_NULL
+    }
+    size_t n_args = n_args_n_kw & 0xff;
+    size_t n_kw = (n_args_n_kw >> 8) & 0xff;
+    mp_obj_t pos_seq = args[n_args + 2 * n_kw];
+    mp_obj_t kw_dict = args[n_args + 2 * n_kw + 1];
+    if (pos_seq != MP_OBJ_NULL || kw_dict == MP_OBJ_NULL || !MP_OBJ_IS_TYPE(kw_dict, &mp_type_dict)) {
+        return false;
+    }
+    mp_map_t *map = mp_obj_dict_get_map(kw_dict);
+    size_t n_pos = (self != MP_OBJ_NULL) + n_args;
+    if (n_pos + 2 * (n_kw + map->used) > CALL_VAR_MAX_ARGS_ON_STACK) {
+        return false;
+    }
+
+    mp_obj_t args2[CALL_VAR_MAX_ARGS_ON_STACK];
+    size_t args2_len = 0;
+    if (self != MP_OBJ_NULL) {
+        args2[args2_len++] = self;
+    }
+    mp_seq_copy(args2 + args2_len, args, n_args + 2 * n_kw, mp_obj_t);
+    args2_len += n_args + 2 * n_kw;
+    for (size_t i = 0; i < map->alloc; i++) {
+        if (MP_MAP_SLOT_IS_FILLED(map, i)) {
+            if (!MP_OBJ_IS_QSTR(map->table[i].key)) {
+                return false;
+            }
+            args2[args2_len++] = map->table[i].key;
+            args2[args2_len++] = map->table[i].value;
+        }
+    }
+    *res = mp_call_function_n_kw(fun, n_pos, (args2_len - n_pos) / 2, args2);
+    return true;
+}
+#endif
+
 mp_obj_t mp_call_method_n_kw_var(bool have_self, size_t n_args_n_kw, const mp_obj_t *args) {
+    mp_obj_t res;
+    #if !MICROPY_ENABLE_PYSTACK
+    if (call_kw_dict_on_stack(have_self, n_args_n_kw, args, &res)) {
+        return res;
+    }
+    #endif
+
     mp_call_args_t out_args;
     mp_call_prepare_args_n_kw_var(have_self, n_args_n_kw, args, &out_args);
 
-    mp_obj_t res = mp_call_function_n_kw(out_args.fun, out_args.n_args, out_args.n_kw, out_args.args);
+    res = mp_call_function_n_kw(out_args.fun, out_args.n_args, out_args.n_kw, out_args.args);
     mp_nonlocal_free(out_args.args, out_args.n_alloc * sizeof(mp_obj_t));
 
     return res;
@@ -1256,11 +1361,13 @@ mp_obj_t mp_iternext(mp_obj_t o_in) {
             // __next__ exists, call it and return its result
             nlr_buf_t nlr;
             if (nlr_push(&nlr) == 0) {
+                MP_NLR_ACCEPT_FAST_EXC(&nlr);
                 mp_obj_t ret = mp_call_method_n_kw(0, 0, dest);
                 nlr_pop();
                 return ret;
             } else {
                 if (mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(((mp_obj_base_t*)nlr.ret_val)->type), MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
+                    MP_OBJ_EXCEPTION_FAST_DISCARD(nlr.ret_val);
                     return MP_OBJ_STOP_ITERATION;
                 } else {
                     nlr_jump(nlr.ret_val);
@@ -1362,7 +1469,11 @@ mp_vm_return_kind_t mp_resume(mp_obj_t self_in, mp_obj_t send_value, mp_obj_t th
 
 mp_obj_t mp_make_raise_obj(mp_obj_t o) {
     DEBUG_printf("raise %p\n", o);
-    if (mp_obj_is_exception_type(o)) {
+    if (o == MP_OBJ_FROM_PTR(&mp_type_StopIteration)) {
+        // "raise StopIteration" ending a user-defined iterator is common, and
+        // the instance can't be seen until it is caught
+        return mp_obj_new_exception_fast(&mp_type_StopIteration, MP_OBJ_NULL);
+    } else if (mp_obj_is_exception_type(o)) {
         // o is an exception type (it is derived from BaseException (or is BaseException))
         // create and return a new exception instance by calling o
         // TODO could have an option to disable traceback, then builtin exceptions (eg TypeError)
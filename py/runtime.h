@@ -72,8 +72,11 @@ void mp_handle_pending_tail(mp_uint_t atomic_state);
 #if MICROPY_ENABLE_SCHEDULER
 void mp_sched_lock(void);
 void mp_sched_unlock(void);
-static inline unsigned int mp_sched_num_pending(void) { return MP_STATE_VM(sched_sp); }
-bool mp_sched_schedule(mp_obj_t function, mp_obj_t arg);
+static inline unsigned int mp_sched_num_pending(void) { return MP_STATE_VM(sched_len); }
+bool mp_sched_schedule_priority(mp_obj_t function, mp_obj_t arg, unsigned int priority);
+static inline bool mp_sched_schedule(mp_obj_t function, mp_obj_t arg) {
+    return mp_sched_schedule_priority(function, arg, MP_SCHED_PRIORITY_NORMAL);
+}
 #endif
 
 // extra printing method specifically for mp_obj_t's which are integral type
@@ -26,6 +26,7 @@
 
 #include <stdio.h>
 
+#include "py/mptrace.h"
 #include "py/runtime.h"
 
 #if MICROPY_ENABLE_SCHEDULER
@@ -47,17 +48,46 @@ void mp_handle_pending(void) {
     }
 }
 
+// Remove the oldest callback of the highest non-empty priority level.  Must be
+// called in an atomic section with at least one callback queued.
+STATIC mp_sched_item_t mp_sched_pop(void) {
+    mp_sched_queue_t *q = &MP_STATE_VM(sched_queue)[MP_SCHED_NUM_PRIORITIES - 1];
+    while (q->len == 0) {
+        --q;
+    }
+    mp_sched_item_t item = q->items[q->head];
+    // clear the slot so the GC doesn't keep the callback alive
+    q->items[q->head].func = MP_OBJ_NULL;
+    q->items[q->head].arg = MP_OBJ_NULL;
+    q->head = (q->head + 1) % MICROPY_SCHEDULER_DEPTH;
+    --q->len;
+    --MP_STATE_VM(sched_len);
+    return item;
+}
+
 // This function should only be called be mp_sched_handle_pending,
 // or by the VM's inlined version of that function.
 void mp_handle_pending_tail(mp_uint_t atomic_state) {
     MP_STATE_VM(sched_state) = MP_SCHED_LOCKED;
-    if (MP_STATE_VM(sched_sp) > 0) {
-        mp_sched_item_t item = MP_STATE_VM(sched_stack)[--MP_STATE_VM(sched_sp)];
+    // Only run callbacks that were queued on entry, so a callback that
+    // reschedules itself can't keep the VM here forever.
+    unsigned int n = MP_STATE_VM(sched_len);
+    if (n > MICROPY_SCHEDULER_BATCH) {
+        n = MICROPY_SCHEDULER_BATCH;
+    }
+    while (n-- > 0 && MP_STATE_VM(sched_len) > 0) {
+        mp_sched_item_t item = mp_sched_pop();
         MICROPY_END_ATOMIC_SECTION(atomic_state);
+        MP_TRACE_BEGIN(MP_TRACE_EVENT_SCHED_RUN, MP_STATE_VM(sched_len));
         mp_call_function_1_protected(item.func, item.arg);
-    } else {
-        MICROPY_END_ATOMIC_SECTION(atomic_state);
+        MP_TRACE_END(MP_TRACE_EVENT_SCHED_RUN, 0);
+        atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+        if (MP_STATE_VM(mp_pending_exception) != MP_OBJ_NULL) {
+            // let the exception be raised before running any more callbacks
+            break;
+        }
     }
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
     mp_sched_unlock();
 }
 
@@ -84,19 +114,29 @@ void mp_sched_unlock(void) {
     MICROPY_END_ATOMIC_SECTION(atomic_state);
 }
 
-bool mp_sched_schedule(mp_obj_t function, mp_obj_t arg) {
+bool mp_sched_schedule_priority(mp_obj_t function, mp_obj_t arg, unsigned int priority) {
+    if (priority >= MP_SCHED_NUM_PRIORITIES) {
+        priority = MP_SCHED_NUM_PRIORITIES - 1;
+    }
     mp_uint_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    mp_sched_queue_t *q = &MP_STATE_VM(sched_queue)[priority];
     bool ret;
-    if (MP_STATE_VM(sched_sp) < MICROPY_SCHEDULER_DEPTH) {
+    if (q->len < MICROPY_SCHEDULER_DEPTH) {
         if (MP_STATE_VM(sched_state) == MP_SCHED_IDLE) {
             MP_STATE_VM(sched_state) = MP_SCHED_PENDING;
         }
-        MP_STATE_VM(sched_stack)[MP_STATE_VM(sched_sp)].func = function;
-        MP_STATE_VM(sched_stack)[MP_STATE_VM(sched_sp)].arg = arg;
-        ++MP_STATE_VM(sched_sp);
+        mp_sched_item_t *item = &q->items[(q->head + q->len) % MICROPY_SCHEDULER_DEPTH];
+        item->func = function;
+        item->arg = arg;
+        ++q->len;
+        if (++MP_STATE_VM(sched_len) > MP_STATE_VM(sched_peak)) {
+            MP_STATE_VM(sched_peak) = MP_STATE_VM(sched_len);
+        }
+        MP_TRACE_INSTANT(MP_TRACE_EVENT_SCHED_SCHEDULE, MP_STATE_VM(sched_len));
         ret = true;
     } else {
-        // schedule stack is full
+        // queue for this priority is full
+        ++MP_STATE_VM(sched_dropped);
         ret = false;
     }
     MICROPY_END_ATOMIC_SECTION(atomic_state);
@@ -30,10 +30,12 @@
 #include <assert.h>
 
 #include "py/emitglue.h"
+#include "py/mptrace.h"
 #include "py/objtype.h"
 #include "py/runtime.h"
 #include "py/bc0.h"
 #include "py/bc.h"
+#include "py/objgenerator.h"
 
 #include "supervisor/linker.h"
 
@@ -43,6 +45,20 @@
 #define TRACE(ip)
 #endif
 
+// Record entry to and exit from a bytecode function in the trace buffer
+#define TRACE_VM_ENTER() MP_TRACE_BEGIN(MP_TRACE_EVENT_VM_CALL, mp_obj_fun_get_name(MP_OBJ_FROM_PTR(code_state->fun_bc)))
+#define TRACE_VM_EXIT() MP_TRACE_END(MP_TRACE_EVENT_VM_CALL, 0)
+
+// Publish the running code state for the sampling profiler, restoring the
+// caller's on exit so samples taken from native code land on the caller
+#if MICROPY_PY_PROFILER
+#define PROFILER_VM_ENTER() MP_STATE_THREAD(current_code_state) = code_state
+#define PROFILER_VM_EXIT() MP_STATE_THREAD(current_code_state) = profiler_prev_code_state
+#else
+#define PROFILER_VM_ENTER()
+#define PROFILER_VM_EXIT()
+#endif
+
 // Value stack grows up (this makes it incompatible with native C stack, but
 // makes sure that arguments to functions are in natural order arg1..argN
 // (Python semantics mandates left-to-right evaluation order, including for
@@ -112,6 +128,63 @@
     exc_sp--; /* pop back to previous exception handler */ \
     CLEAR_SYS_EXC_INFO() /* just clear sys.exc_info(), not compliant, but it shouldn't be used in 1st place */
 
+#if MICROPY_STACKLESS
+// Whether a frame that has a previous frame is a generator resumed by yield
+// from in that frame, rather than a function called from it (generator
+// functions only ever run through their generator object)
+STATIC bool code_state_is_generator(const mp_code_state_t *code_state) {
+    const byte *ip = mp_decode_uint_skip(mp_decode_uint_skip(code_state->fun_bc->bytecode));
+    return (*ip & MP_SCOPE_FLAG_GENERATOR) != 0;
+}
+#endif
+
+#if MICROPY_OPT_FAST_EXCEPTIONS
+// Used when leaving an except handler: if the handler owns the preallocated
+// exception (see py/objexcept.c) then it is finished with it
+#define RELEASE_HANDLER_FAST_EXC() \
+    if (MP_STATE_THREAD(fast_exc).handler == exc_sp) { \
+        mp_obj_exception_fast_release(); \
+    }
+
+// Whether the except handler at ip only ever throws away the exception it is
+// given: each clause either pops it after a successful match, or lets it
+// through to the END_FINALLY that re-raises it.  Then the handler can't leak
+// a reference to it, other than by a bare "raise".
+STATIC bool handler_discards_exception(const byte *ip) {
+    for (size_t n_op = 0; n_op < 64; ++n_op) {
+        if (*ip == MP_BC_POP_TOP || *ip == MP_BC_END_FINALLY) {
+            return true;
+        }
+        if (*ip != MP_BC_DUP_TOP) {
+            return false;
+        }
+        // skip the exception type expression, it can't refer to the exception
+        do {
+            size_t sz;
+            mp_opcode_format(ip, &sz);
+            ip += sz;
+            if (++n_op == 64) {
+                return false;
+            }
+        } while (*ip != MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_EXCEPTION_MATCH);
+        if (*++ip != MP_BC_POP_JUMP_IF_FALSE) {
+            return false;
+        }
+        ip += 1;
+        DECODE_SLABEL;
+        if (*ip != MP_BC_POP_TOP) {
+            // exception is bound to a name
+            return false;
+        }
+        // continue with the next clause
+        ip += slab;
+    }
+    return false;
+}
+#else
+#define RELEASE_HANDLER_FAST_EXC()
+#endif
+
 // fastn has items in reverse order (fastn[0] is local[0], fastn[-1] is local[1], etc)
 // sp points to bottom of stack which grows up
 // returns:
@@ -150,9 +223,15 @@ mp_vm_return_kind_t PLACE_IN_ITCM(mp_execute_bytecode)(mp_code_state_t *code_sta
     // loop and the exception handler, leading to very obscure bugs.
     #define RAISE(o) do { nlr_pop(); nlr.ret_val = MP_OBJ_TO_PTR(o); goto exception_handler; } while (0)
 
+    TRACE_VM_ENTER();
+    #if MICROPY_PY_PROFILER
+    mp_code_state_t *const profiler_prev_code_state = MP_STATE_THREAD(current_code_state);
+    #endif
+
 #if MICROPY_STACKLESS
 run_code_state: ;
 #endif
+    PROFILER_VM_ENTER();
     // Pointers which are constant for particular invocation of mp_execute_bytecode()
     mp_obj_t * /*const*/ fastn;
     mp_exc_stack_t * /*const*/ exc_stack;
@@ -177,6 +256,7 @@ run_code_state: ;
         nlr_buf_t nlr;
 outer_dispatch_loop:
         if (nlr_push(&nlr) == 0) {
+            MP_NLR_ACCEPT_FAST_EXC(&nlr);
             // local variables that are not visible to the exception handler
             const byte *ip = code_state->ip;
             mp_obj_t *sp = code_state->sp;
@@ -672,6 +752,7 @@ unwind_jump:;
                             exc_sp--; // pop exception handler
                             goto dispatch_loop; // run the exception handler
                         }
+                        RELEASE_HANDLER_FAST_EXC();
                         POP_EXC_BLOCK();
                     }
                     ip = (const byte*)MP_OBJ_TO_PTR(POP()); // pop destination ip for jump
@@ -774,6 +855,7 @@ unwind_jump:;
                 ENTRY(MP_BC_POP_EXCEPT):
                     assert(exc_sp >= exc_stack);
                     assert(currently_in_except_block);
+                    RELEASE_HANDLER_FAST_EXC();
                     POP_EXC_BLOCK();
                     DISPATCH();
 
@@ -927,6 +1009,7 @@ unwind_jump:;
                             new_state->prev = code_state;
                             code_state = new_state;
                             nlr_pop();
+                            TRACE_VM_ENTER();
                             goto run_code_state;
                         }
                     }
@@ -972,6 +1055,7 @@ unwind_jump:;
                             new_state->prev = code_state;
                             code_state = new_state;
                             nlr_pop();
+                            TRACE_VM_ENTER();
                             goto run_code_state;
                         }
                     }
@@ -1010,6 +1094,7 @@ unwind_jump:;
                             new_state->prev = code_state;
                             code_state = new_state;
                             nlr_pop();
+                            TRACE_VM_ENTER();
                             goto run_code_state;
                         }
                     }
@@ -1055,6 +1140,7 @@ unwind_jump:;
                             new_state->prev = code_state;
                             code_state = new_state;
                             nlr_pop();
+                            TRACE_VM_ENTER();
                             goto run_code_state;
                         }
                     }
@@ -1071,6 +1157,7 @@ unwind_jump:;
                     // the try-finally exception handler is still on the stack.
                     // TODO Possibly find a better way to handle this case.
                     if (currently_in_except_block) {
+                        RELEASE_HANDLER_FAST_EXC();
                         POP_EXC_BLOCK();
                     }
 unwind_return:
@@ -1097,24 +1184,35 @@ unwind_return:
                             exc_sp--;
                             goto dispatch_loop;
                         }
+                        RELEASE_HANDLER_FAST_EXC();
                         exc_sp--;
                     }
                     nlr_pop();
                     code_state->sp = sp;
                     assert(exc_sp == exc_stack - 1);
                     MICROPY_VM_HOOK_RETURN
+                    TRACE_VM_EXIT();
+                    PROFILER_VM_EXIT();
                     #if MICROPY_STACKLESS
                     if (code_state->prev != NULL) {
                         mp_obj_t res = *sp;
-                        mp_globals_set(code_state->old_globals);
                         mp_code_state_t *new_code_state = code_state->prev;
-                        #if MICROPY_ENABLE_PYSTACK
-                        // Free code_state, and args allocated by mp_call_prepare_args_n_kw_var
-                        // (The latter is implicitly freed when using pystack due to its LIFO nature.)
-                        // The sizeof in the following statement does not include the size of the variable
-                        // part of the struct.  This arg is anyway not used if pystack is enabled.
-                        mp_nonlocal_free(code_state, sizeof(mp_code_state_t));
-                        #endif
+                        if (code_state_is_generator(code_state)) {
+                            // Generator has finished, its return value is the result of the
+                            // yield from that resumed it (replacing the generator on the stack)
+                            code_state->prev = NULL;
+                            mp_obj_gen_stackless_exit(*new_code_state->sp, MP_VM_RETURN_NORMAL);
+                            new_code_state->ip++;
+                        } else {
+                            mp_globals_set(code_state->old_globals);
+                            #if MICROPY_ENABLE_PYSTACK
+                            // Free code_state, and args allocated by mp_call_prepare_args_n_kw_var
+                            // (The latter is implicitly freed when using pystack due to its LIFO nature.)
+                            // The sizeof in the following statement does not include the size of the variable
+                            // part of the struct.  This arg is anyway not used if pystack is enabled.
+                            mp_nonlocal_free(code_state, sizeof(mp_code_state_t));
+                            #endif
+                        }
                         code_state = new_code_state;
                         *code_state->sp = res;
                         goto run_code_state;
@@ -1157,6 +1255,20 @@ yield:
                     code_state->ip = ip;
                     code_state->sp = sp;
                     code_state->exc_sp = MP_TAGPTR_MAKE(exc_sp, currently_in_except_block);
+                    TRACE_VM_EXIT();
+                    PROFILER_VM_EXIT();
+                    #if MICROPY_STACKLESS
+                    // A generator resumed by yield from in the previous frame yields
+                    // through that frame's yield from, and so on up the chain
+                    while (code_state->prev != NULL && code_state_is_generator(code_state)) {
+                        mp_code_state_t *prev = code_state->prev;
+                        code_state->prev = NULL;
+                        mp_obj_t ret_value = mp_obj_gen_stackless_exit(*prev->sp, MP_VM_RETURN_YIELD);
+                        code_state = prev;
+                        *++code_state->sp = ret_value;
+                        TRACE_VM_EXIT();
+                    }
+                    #endif
                     return MP_VM_RETURN_YIELD;
 
                 ENTRY(MP_BC_YIELD_FROM): {
@@ -1174,6 +1286,22 @@ yield:
                         inject_exc = MP_OBJ_NULL;
                         ret_kind = mp_resume(TOP(), MP_OBJ_NULL, t_exc, &ret_value);
                     } else {
+                        #if MICROPY_STACKLESS
+                        if (MP_OBJ_IS_TYPE(TOP(), &mp_type_gen_instance)) {
+                            mp_code_state_t *new_state = mp_obj_gen_resume_stackless(TOP(), send_value);
+                            if (new_state != NULL) {
+                                // Run the generator in this loop, coming back to this
+                                // yield from when it yields, returns or raises
+                                code_state->ip = ip - 1;
+                                code_state->exc_sp = MP_TAGPTR_MAKE(exc_sp, currently_in_except_block);
+                                new_state->prev = code_state;
+                                code_state = new_state;
+                                nlr_pop();
+                                TRACE_VM_ENTER();
+                                goto run_code_state;
+                            }
+                        }
+                        #endif
                         ret_kind = mp_resume(TOP(), send_value, MP_OBJ_NULL, &ret_value);
                     }
 
@@ -1202,6 +1330,7 @@ yield:
                         sp--;
                         if (EXC_MATCH(ret_value, MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
                             PUSH(mp_obj_exception_get_value(ret_value));
+                            MP_OBJ_EXCEPTION_FAST_DISCARD(ret_value);
                             // If we injected GeneratorExit downstream, then even
                             // if it was swallowed, we re-raise GeneratorExit
                             GENERATOR_EXIT_IF_NEEDED(t_exc);
@@ -1286,6 +1415,8 @@ yield:
                     mp_obj_t obj = mp_obj_new_exception_msg(&mp_type_NotImplementedError, translate("byte code not implemented"));
                     nlr_pop();
                     fastn[0] = obj;
+                    TRACE_VM_EXIT();
+                    PROFILER_VM_EXIT();
                     return MP_VM_RETURN_EXCEPTION;
                 }
 
@@ -1351,11 +1482,22 @@ exception_handler:
             MP_STATE_VM(cur_exception) = nlr.ret_val;
             #endif
 
+            #if MICROPY_OPT_FAST_EXCEPTIONS
+            if (MP_OBJ_IS_FAST_EXCEPTION(nlr.ret_val)) {
+                // it's being raised (again), so no handler owns it now
+                MP_STATE_THREAD(fast_exc).handler = NULL;
+            }
+            #endif
+
             #if SELECTIVE_EXC_IP
             // with selective ip, we store the ip 1 byte past the opcode, so move ptr back
             code_state->ip -= 1;
             #endif
 
+#if MICROPY_STACKLESS
+yield_from_exception:
+#endif
+
             if (mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(((mp_obj_base_t*)nlr.ret_val)->type), MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
                 if (code_state->ip) {
                     // check if it's a StopIteration within a for block
@@ -1364,12 +1506,14 @@ exception_handler:
                         DECODE_ULABEL; // the jump offset if iteration finishes; for labels are always forward
                         code_state->ip = ip + ulab; // jump to after for-block
                         code_state->sp -= MP_OBJ_ITER_BUF_NSLOTS; // pop the exhausted iterator
+                        MP_OBJ_EXCEPTION_FAST_DISCARD(nlr.ret_val);
                         goto outer_dispatch_loop; // continue with dispatch loop
                     } else if (*code_state->ip == MP_BC_YIELD_FROM) {
                         // StopIteration inside yield from call means return a value of
                         // yield from, so inject exception's value as yield from's result
                         // (Instead of stack pop then push we just replace exhausted gen with value)
                         *code_state->sp = mp_obj_exception_get_value(MP_OBJ_FROM_PTR(nlr.ret_val));
+                        MP_OBJ_EXCEPTION_FAST_DISCARD(nlr.ret_val);
                         code_state->ip++; // yield from is over, move to next instruction
                         goto outer_dispatch_loop; // continue with dispatch loop
                     }
@@ -1383,50 +1527,9 @@ unwind_loop:
             // TODO: don't set traceback for exceptions re-raised by END_FINALLY.
             // But consider how to handle nested exceptions.
             if (nlr.ret_val != &mp_const_GeneratorExit_obj) {
-                const byte *ip = code_state->fun_bc->bytecode;
-                ip = mp_decode_uint_skip(ip); // skip n_state
-                ip = mp_decode_uint_skip(ip); // skip n_exc_stack
-                ip++; // skip scope_params
-                ip++; // skip n_pos_args
-                ip++; // skip n_kwonly_args
-                ip++; // skip n_def_pos_args
-                size_t bc = code_state->ip - ip;
-                size_t code_info_size = mp_decode_uint_value(ip);
-                ip = mp_decode_uint_skip(ip); // skip code_info_size
-                bc -= code_info_size;
-                #if MICROPY_PERSISTENT_CODE
-                qstr block_name = ip[0] | (ip[1] << 8);
-                qstr source_file = ip[2] | (ip[3] << 8);
-                ip += 4;
-                #else
-                qstr block_name = mp_decode_uint_value(ip);
-                ip = mp_decode_uint_skip(ip);
-                qstr source_file = mp_decode_uint_value(ip);
-                ip = mp_decode_uint_skip(ip);
-                #endif
-                size_t source_line = 1;
-                size_t c;
-                while ((c = *ip)) {
-                    size_t b, l;
-                    if ((c & 0x80) == 0) {
-                        // 0b0LLBBBBB encoding
-                        b = c & 0x1f;
-                        l = c >> 5;
-                        ip += 1;
-                    } else {
-                        // 0b1LLLBBBB 0bLLLLLLLL encoding (l's LSB in second byte)
-                        b = c & 0xf;
-                        l = ((c << 4) & 0x700) | ip[1];
-                        ip += 2;
-                    }
-                    if (bc >= b) {
-                        bc -= b;
-                        source_line += l;
-                    } else {
-                        // found source line corresponding to bytecode offset
-                        break;
-                    }
-                }
+                qstr block_name, source_file;
+                size_t source_line;
+                mp_bytecode_get_source_info(code_state->fun_bc->bytecode, code_state->ip, &block_name, &source_file, &source_line);
                 mp_obj_exception_add_traceback(MP_OBJ_FROM_PTR(nlr.ret_val), source_file, source_line, block_name);
             }
 
@@ -1439,6 +1542,7 @@ unwind_loop:
                 // at the moment we are just raising the very last exception (the one that caused the nested exception)
 
                 // move up to previous exception handler
+                RELEASE_HANDLER_FAST_EXC();
                 POP_EXC_BLOCK();
             }
 
@@ -1449,6 +1553,17 @@ unwind_loop:
                 // catch exception and pass to byte code
                 code_state->ip = exc_sp->handler;
                 mp_obj_t *sp = MP_TAGPTR_PTR(exc_sp->val_sp);
+                #if MICROPY_OPT_FAST_EXCEPTIONS
+                if (MP_OBJ_IS_FAST_EXCEPTION(nlr.ret_val)) {
+                    if (!MP_TAGPTR_TAG1(exc_sp->val_sp) && handler_discards_exception(code_state->ip)) {
+                        // the handler owns it until it is left
+                        MP_STATE_THREAD(fast_exc).handler = exc_sp;
+                    } else {
+                        // a finally or with block, or an except clause with "as"
+                        nlr.ret_val = MP_OBJ_TO_PTR(mp_obj_exception_fast_escape(MP_OBJ_FROM_PTR(nlr.ret_val)));
+                    }
+                }
+                #endif
                 // save this exception in the stack so it can be used in a reraise, if needed
                 exc_sp->prev_exc = nlr.ret_val;
                 // push exception object so it can be handled by bytecode
@@ -1457,22 +1572,36 @@ unwind_loop:
 
             #if MICROPY_STACKLESS
             } else if (code_state->prev != NULL) {
-                mp_globals_set(code_state->old_globals);
+                TRACE_VM_EXIT();
+                PROFILER_VM_EXIT();
                 mp_code_state_t *new_code_state = code_state->prev;
-                #if MICROPY_ENABLE_PYSTACK
-                // Free code_state, and args allocated by mp_call_prepare_args_n_kw_var
-                // (The latter is implicitly freed when using pystack due to its LIFO nature.)
-                // The sizeof in the following statement does not include the size of the variable
-                // part of the struct.  This arg is anyway not used if pystack is enabled.
-                mp_nonlocal_free(code_state, sizeof(mp_code_state_t));
-                #endif
+                bool is_generator = code_state_is_generator(code_state);
+                if (is_generator) {
+                    code_state->prev = NULL;
+                    fastn[0] = MP_OBJ_FROM_PTR(nlr.ret_val);
+                    mp_obj_gen_stackless_exit(*new_code_state->sp, MP_VM_RETURN_EXCEPTION);
+                } else {
+                    mp_globals_set(code_state->old_globals);
+                    #if MICROPY_ENABLE_PYSTACK
+                    // Free code_state, and args allocated by mp_call_prepare_args_n_kw_var
+                    // (The latter is implicitly freed when using pystack due to its LIFO nature.)
+                    // The sizeof in the following statement does not include the size of the variable
+                    // part of the struct.  This arg is anyway not used if pystack is enabled.
+                    mp_nonlocal_free(code_state, sizeof(mp_code_state_t));
+                    #endif
+                }
                 code_state = new_code_state;
+                PROFILER_VM_ENTER();
                 size_t n_state = mp_decode_uint_value(code_state->fun_bc->bytecode);
                 fastn = &code_state->state[n_state - 1];
                 exc_stack = (mp_exc_stack_t*)(code_state->state + n_state);
                 // variables that are visible to the exception handler (declared volatile)
                 currently_in_except_block = MP_TAGPTR_TAG0(code_state->exc_sp); // 0 or 1, to detect nested exceptions
                 exc_sp = MP_TAGPTR_PTR(code_state->exc_sp); // stack grows up, exc_sp points to top of stack
+                if (is_generator) {
+                    // a generator raising out of yield from, handled like in MP_BC_YIELD_FROM
+                    goto yield_from_exception;
+                }
                 goto unwind_loop;
 
             #endif
@@ -1480,6 +1609,8 @@ unwind_loop:
                 // propagate exception to higher level
                 // TODO what to do about ip and sp? they don't really make sense at this point
                 fastn[0] = MP_OBJ_FROM_PTR(nlr.ret_val); // must put exception here because sp is invalid
+                TRACE_VM_EXIT();
+                PROFILER_VM_EXIT();
                 return MP_VM_RETURN_EXCEPTION;
             }
         }
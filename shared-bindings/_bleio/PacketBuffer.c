@@ -169,6 +169,82 @@ STATIC mp_obj_t bleio_packet_buffer_write(mp_uint_t n_args, const mp_obj_t *pos_
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(bleio_packet_buffer_write_obj, 1, bleio_packet_buffer_write);
 
+//|     def write_packets(self, packets: Iterable[ReadableBuffer], *, header: Optional[bytes] = None) -> int:
+//|         """Queues each buffer in ``packets`` as a separate outgoing packet, with the bytes from
+//|         header before each one. Queued packets are handed to the BLE stack as fast as it has
+//|         transmit buffers for them, so several can go out in each connection event.
+//|
+//|         The queue holds ``buffer_size`` packets and is allocated on first use. This only blocks
+//|         while the queue is full. Packets written with `write` stay in order with these.
+//|
+//|         :return: number of packets queued, which is less than given if the connection is lost.
+//|         :rtype: int"""
+//|         ...
+//|
+STATIC mp_obj_t bleio_packet_buffer_write_packets(mp_uint_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_packets, ARG_header };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_packets,  MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_header, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL}},
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    bleio_packet_buffer_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    check_for_deinit(self);
+
+    mp_buffer_info_t header_bufinfo;
+    header_bufinfo.len = 0;
+    if (args[ARG_header].u_obj != MP_OBJ_NULL) {
+        mp_get_buffer_raise(args[ARG_header].u_obj, &header_bufinfo, MP_BUFFER_READ);
+    }
+
+    mp_int_t num_packets = 0;
+    mp_obj_iter_buf_t iter_buf;
+    mp_obj_t iterable = mp_getiter(args[ARG_packets].u_obj, &iter_buf);
+    mp_obj_t item;
+    while ((item = mp_iternext(iterable)) != MP_OBJ_STOP_ITERATION) {
+        mp_buffer_info_t data_bufinfo;
+        mp_get_buffer_raise(item, &data_bufinfo, MP_BUFFER_READ);
+        if (common_hal_bleio_packet_buffer_queue(
+                self, data_bufinfo.buf, data_bufinfo.len, header_bufinfo.buf, header_bufinfo.len) < 0) {
+            // Not connected. See write() for why this isn't an error.
+            break;
+        }
+        num_packets++;
+    }
+    return MP_OBJ_NEW_SMALL_INT(num_packets);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(bleio_packet_buffer_write_packets_obj, 1, bleio_packet_buffer_write_packets);
+
+//|     write_stats: Tuple[int, int, int]
+//|     """Counts of packets queued by `write_packets` (and by `write` while the queue is not
+//|     empty), handed to the BLE stack, and dropped because the connection was lost or the stack
+//|     rejected them, as ``(queued, sent, dropped)``. (read-only)"""
+//|
+STATIC mp_obj_t bleio_packet_buffer_get_write_stats(mp_obj_t self_in) {
+    bleio_packet_buffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    check_for_deinit(self);
+
+    uint32_t queued, sent, dropped;
+    common_hal_bleio_packet_buffer_get_write_stats(self, &queued, &sent, &dropped);
+    mp_obj_t items[3] = {
+        mp_obj_new_int_from_uint(queued),
+        mp_obj_new_int_from_uint(sent),
+        mp_obj_new_int_from_uint(dropped),
+    };
+    return mp_obj_new_tuple(3, items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(bleio_packet_buffer_get_write_stats_obj, bleio_packet_buffer_get_write_stats);
+
+const mp_obj_property_t bleio_packet_buffer_write_stats_obj = {
+    .base.type = &mp_type_property,
+    .proxy = { (mp_obj_t)&bleio_packet_buffer_get_write_stats_obj,
+               (mp_obj_t)&mp_const_none_obj,
+               (mp_obj_t)&mp_const_none_obj },
+};
+
 //|     def deinit(self) -> None:
 //|         """Disable permanently."""
 //|         ...
@@ -232,12 +308,14 @@ STATIC const mp_rom_map_elem_t bleio_packet_buffer_locals_dict_table[] = {
     // Standard stream methods.
     { MP_OBJ_NEW_QSTR(MP_QSTR_readinto),               MP_ROM_PTR(&bleio_packet_buffer_readinto_obj) },
     { MP_OBJ_NEW_QSTR(MP_QSTR_write),                  MP_ROM_PTR(&bleio_packet_buffer_write_obj) },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_write_packets),          MP_ROM_PTR(&bleio_packet_buffer_write_packets_obj) },
 
     // .packet_size is now an alias for .incoming_packet_length
     // TODO: Remove in 6.0.0.
     { MP_OBJ_NEW_QSTR(MP_QSTR_packet_size),            MP_ROM_PTR(&bleio_packet_buffer_incoming_packet_length_obj) },
     { MP_OBJ_NEW_QSTR(MP_QSTR_incoming_packet_length), MP_ROM_PTR(&bleio_packet_buffer_incoming_packet_length_obj) },
     { MP_OBJ_NEW_QSTR(MP_QSTR_outgoing_packet_length), MP_ROM_PTR(&bleio_packet_buffer_outgoing_packet_length_obj) },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_write_stats),            MP_ROM_PTR(&bleio_packet_buffer_write_stats_obj) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(bleio_packet_buffer_locals_dict, bleio_packet_buffer_locals_dict_table);
@@ -86,8 +86,9 @@ const mp_obj_property_t bleio_scanentry_address_obj = {
                (mp_obj_t)&mp_const_none_obj },
 };
 
-//|     advertisement_bytes: bytes
-//|     """All the advertisement data present in the packet, returned as a ``bytes`` object. (read-only)"""
+//|     advertisement_bytes: ReadableBuffer
+//|     """All the advertisement data present in the packet, returned as a ``bytes`` object, or as a
+//|     ``memoryview`` into the scan buffer when scanning with ``reuse_entry=True``. (read-only)"""
 //|
 STATIC mp_obj_t scanentry_get_advertisement_bytes(mp_obj_t self_in) {
     bleio_scanentry_obj_t *self = MP_OBJ_TO_PTR(self_in);
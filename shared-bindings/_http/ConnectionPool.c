@@ -0,0 +1,145 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-bindings/_http/ConnectionPool.h"
+#include "shared-bindings/_http/Response.h"
+
+#include "py/objproperty.h"
+#include "py/runtime.h"
+#include "supervisor/shared/translate.h"
+
+//| class ConnectionPool:
+//|     """Keeps idle keep-alive connections for reuse
+//|
+//|     Sockets are kept per host and port, so a client making repeated
+//|     requests to the same server skips the DNS lookup and TCP handshake."""
+//|
+//|     def __init__(self, socket_source: Any, *, max_idle: int = 4) -> None:
+//|         """Creates an empty pool.
+//|
+//|         :param socket_source: the `socket` module or a `socketpool.SocketPool`,
+//|           used to make new connections
+//|         :param int max_idle: the most idle sockets kept across all hosts"""
+//|         ...
+//|
+STATIC mp_obj_t _http_connectionpool_make_new(const mp_obj_type_t *type, size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_socket_source, ARG_max_idle };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_socket_source, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_max_idle, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 4} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    if (args[ARG_max_idle].u_int < 0) {
+        mp_raise_ValueError_varg(translate("%q must be >= 0"), MP_QSTR_max_idle);
+    }
+
+    http_connectionpool_obj_t *self = m_new_obj(http_connectionpool_obj_t);
+    self->base.type = type;
+    common_hal__http_connectionpool_construct(self, args[ARG_socket_source].u_obj, args[ARG_max_idle].u_int);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+//|     def connect(self, host: str, port: int) -> socket.socket:
+//|         """Returns an idle socket connected to ``host`` and ``port``, or a
+//|         newly connected one if there is none.
+//|
+//|         An idle socket may have been closed by the server in the meantime,
+//|         which shows up as `OSError` ``ECONNRESET`` from `Response`.  Retry
+//|         the request once on a new connection when that happens."""
+//|         ...
+//|
+STATIC mp_obj_t _http_connectionpool_connect(mp_obj_t self_in, mp_obj_t host, mp_obj_t port) {
+    http_connectionpool_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return common_hal__http_connectionpool_connect(self, host, mp_obj_get_int(port));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(_http_connectionpool_connect_obj, _http_connectionpool_connect);
+
+//|     def release(self, host: str, port: int, socket: socket.socket, response: Optional[Response] = None) -> None:
+//|         """Returns ``socket`` to the pool after ``response`` has been read from
+//|         it.  The socket is kept only if the whole body was read, the server
+//|         allows keep-alive and the pool isn't full; otherwise it is closed, so
+//|         leftover body bytes are never read as the next response.  Pass `None`
+//|         to close a socket with no response to read."""
+//|         ...
+//|
+STATIC mp_obj_t _http_connectionpool_release(size_t n_args, const mp_obj_t *args) {
+    http_connectionpool_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    bool reuse = false;
+    if (n_args > 4 && args[4] != mp_const_none) {
+        if (!MP_OBJ_IS_TYPE(args[4], &http_response_type)) {
+            mp_raise_TypeError_varg(translate("Expected a %q"), MP_QSTR_Response);
+        }
+        http_response_obj_t *response = MP_OBJ_TO_PTR(args[4]);
+        reuse = common_hal__http_response_get_keep_alive(response) && common_hal__http_response_get_done(response);
+    }
+    common_hal__http_connectionpool_release(self, args[1], mp_obj_get_int(args[2]), args[3], reuse);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(_http_connectionpool_release_obj, 4, 5, _http_connectionpool_release);
+
+//|     def close(self) -> None:
+//|         """Closes all idle sockets"""
+//|         ...
+//|
+STATIC mp_obj_t _http_connectionpool_close(mp_obj_t self_in) {
+    http_connectionpool_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    common_hal__http_connectionpool_close(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(_http_connectionpool_close_obj, _http_connectionpool_close);
+
+//|     idle_count: int
+//|     """The number of idle sockets in the pool (read-only)"""
+//|
+STATIC mp_obj_t _http_connectionpool_get_idle_count(mp_obj_t self_in) {
+    http_connectionpool_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return MP_OBJ_NEW_SMALL_INT(common_hal__http_connectionpool_get_idle_count(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(_http_connectionpool_get_idle_count_obj, _http_connectionpool_get_idle_count);
+
+const mp_obj_property_t _http_connectionpool_idle_count_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&_http_connectionpool_get_idle_count_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC const mp_rom_map_elem_t _http_connectionpool_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_connect), MP_ROM_PTR(&_http_connectionpool_connect_obj) },
+    { MP_ROM_QSTR(MP_QSTR_release), MP_ROM_PTR(&_http_connectionpool_release_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&_http_connectionpool_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR_idle_count), MP_ROM_PTR(&_http_connectionpool_idle_count_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(_http_connectionpool_locals_dict, _http_connectionpool_locals_dict_table);
+
+const mp_obj_type_t http_connectionpool_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_ConnectionPool,
+    .make_new = _http_connectionpool_make_new,
+    .locals_dict = (mp_obj_dict_t*)&_http_connectionpool_locals_dict,
+};
@@ -0,0 +1,40 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_BINDINGS__HTTP_CONNECTIONPOOL_H
+#define MICROPY_INCLUDED_SHARED_BINDINGS__HTTP_CONNECTIONPOOL_H
+
+#include "shared-module/_http/ConnectionPool.h"
+
+extern const mp_obj_type_t http_connectionpool_type;
+
+void common_hal__http_connectionpool_construct(http_connectionpool_obj_t *self, mp_obj_t socket_source, size_t max_idle);
+mp_obj_t common_hal__http_connectionpool_connect(http_connectionpool_obj_t *self, mp_obj_t host, mp_int_t port);
+void common_hal__http_connectionpool_release(http_connectionpool_obj_t *self, mp_obj_t host, mp_int_t port, mp_obj_t socket, bool reuse);
+size_t common_hal__http_connectionpool_get_idle_count(http_connectionpool_obj_t *self);
+void common_hal__http_connectionpool_close(http_connectionpool_obj_t *self);
+
+#endif // MICROPY_INCLUDED_SHARED_BINDINGS__HTTP_CONNECTIONPOOL_H
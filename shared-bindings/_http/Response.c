@@ -0,0 +1,221 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-bindings/_http/Response.h"
+
+#include "py/objproperty.h"
+#include "py/runtime.h"
+#include "supervisor/shared/translate.h"
+
+//| class Response:
+//|     """An HTTP/1.1 response read from a socket
+//|
+//|     The status line and headers are parsed in C as the response is
+//|     constructed, and the body is then read with `readinto`.  Chunked
+//|     transfer encoding is removed.  All reads go through the socket's
+//|     ``recv_into`` into buffers supplied by the caller, so reading a body
+//|     does not allocate."""
+//|
+//|     def __init__(self, socket: socket.socket, buffer: WriteableBuffer, headers: Optional[dict] = None, *, head: bool = False) -> None:
+//|         """Reads the status line and headers of a response from ``socket``.
+//|
+//|         :param socket.socket socket: a connected socket with ``recv_into``
+//|         :param ~_typing.WriteableBuffer buffer: scratch space for the response.  It must be
+//|           longer than the longest status, header or chunk size line.
+//|         :param dict headers: a dict to empty and fill with the headers, keyed by
+//|           lower case name.  Its storage is kept, so a dict reused across
+//|           responses stops allocating once it has grown to fit.  When
+//|           `None` the headers are only checked for the body length.
+//|         :param bool head: True if the request was HEAD, so there is no body
+//|
+//|         Interim 100, 102 and 103 responses are skipped.  A 101 response is
+//|         returned with the rest of the connection as its body.  Header text
+//|         is decoded as ISO-8859-1.  Raises `ValueError` if the response is
+//|         malformed, including repeated Content-Length headers that differ,
+//|         and `OSError` ``ECONNRESET`` if the connection closes early."""
+//|         ...
+//|
+STATIC mp_obj_t _http_response_make_new(const mp_obj_type_t *type, size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_socket, ARG_buffer, ARG_headers, ARG_head };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_socket, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_buffer, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_headers, MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_head, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t headers = args[ARG_headers].u_obj;
+    if (headers != mp_const_none && (!MP_OBJ_IS_TYPE(headers, &mp_type_dict) || mp_obj_dict_get_map(headers)->is_fixed)) {
+        mp_raise_TypeError_varg(translate("Expected a %q"), MP_QSTR_dict);
+    }
+
+    http_response_obj_t *self = m_new_obj(http_response_obj_t);
+    self->base.type = type;
+    common_hal__http_response_construct(self, args[ARG_socket].u_obj, args[ARG_buffer].u_obj, headers, args[ARG_head].u_bool);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+//|     def readinto(self, buf: WriteableBuffer, nbytes: int = 0) -> int:
+//|         """Reads body bytes into ``buf``, up to ``nbytes`` if it is given and
+//|         not zero, and returns how many were read.  Returns 0 only once the
+//|         whole body has been read.  A read may return fewer bytes than asked
+//|         for even when more of the body is still to come."""
+//|         ...
+//|
+STATIC mp_obj_t _http_response_readinto(size_t n_args, const mp_obj_t *args) {
+    http_response_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_WRITE);
+    size_t len = bufinfo.len;
+    if (n_args > 2) {
+        mp_int_t nbytes = mp_obj_get_int(args[2]);
+        if (nbytes < 0) {
+            mp_raise_ValueError_varg(translate("%q must be >= 0"), MP_QSTR_nbytes);
+        }
+        if (nbytes > 0) {
+            len = MIN(len, (size_t)nbytes);
+        }
+    }
+    return MP_OBJ_NEW_SMALL_INT(common_hal__http_response_readinto(self, bufinfo.buf, len));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(_http_response_readinto_obj, 2, 3, _http_response_readinto);
+
+//|     status_code: int
+//|     """The status code, such as 200 (read-only)"""
+//|
+STATIC mp_obj_t _http_response_get_status_code(mp_obj_t self_in) {
+    http_response_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return MP_OBJ_NEW_SMALL_INT(common_hal__http_response_get_status_code(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(_http_response_get_status_code_obj, _http_response_get_status_code);
+
+const mp_obj_property_t _http_response_status_code_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&_http_response_get_status_code_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     reason: str
+//|     """The reason phrase from the status line, such as ``"OK"`` (read-only)"""
+//|
+STATIC mp_obj_t _http_response_get_reason(mp_obj_t self_in) {
+    http_response_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return common_hal__http_response_get_reason(self);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(_http_response_get_reason_obj, _http_response_get_reason);
+
+const mp_obj_property_t _http_response_reason_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&_http_response_get_reason_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     version: int
+//|     """11 for an HTTP/1.1 response and 10 for HTTP/1.0 (read-only)"""
+//|
+STATIC mp_obj_t _http_response_get_version(mp_obj_t self_in) {
+    http_response_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return MP_OBJ_NEW_SMALL_INT(common_hal__http_response_get_version(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(_http_response_get_version_obj, _http_response_get_version);
+
+const mp_obj_property_t _http_response_version_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&_http_response_get_version_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     headers: Optional[dict]
+//|     """The dict passed to the constructor, filled with the headers (read-only)"""
+//|
+STATIC mp_obj_t _http_response_get_headers(mp_obj_t self_in) {
+    http_response_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return common_hal__http_response_get_headers(self);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(_http_response_get_headers_obj, _http_response_get_headers);
+
+const mp_obj_property_t _http_response_headers_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&_http_response_get_headers_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     keep_alive: bool
+//|     """True if the connection can be used for another request once the body
+//|     has been read (read-only)"""
+//|
+STATIC mp_obj_t _http_response_get_keep_alive(mp_obj_t self_in) {
+    http_response_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_bool(common_hal__http_response_get_keep_alive(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(_http_response_get_keep_alive_obj, _http_response_get_keep_alive);
+
+const mp_obj_property_t _http_response_keep_alive_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&_http_response_get_keep_alive_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     done: bool
+//|     """True once the whole body has been read (read-only)"""
+//|
+STATIC mp_obj_t _http_response_get_done(mp_obj_t self_in) {
+    http_response_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_bool(common_hal__http_response_get_done(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(_http_response_get_done_obj, _http_response_get_done);
+
+const mp_obj_property_t _http_response_done_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&_http_response_get_done_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC const mp_rom_map_elem_t _http_response_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_readinto), MP_ROM_PTR(&_http_response_readinto_obj) },
+    { MP_ROM_QSTR(MP_QSTR_status_code), MP_ROM_PTR(&_http_response_status_code_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reason), MP_ROM_PTR(&_http_response_reason_obj) },
+    { MP_ROM_QSTR(MP_QSTR_version), MP_ROM_PTR(&_http_response_version_obj) },
+    { MP_ROM_QSTR(MP_QSTR_headers), MP_ROM_PTR(&_http_response_headers_obj) },
+    { MP_ROM_QSTR(MP_QSTR_keep_alive), MP_ROM_PTR(&_http_response_keep_alive_obj) },
+    { MP_ROM_QSTR(MP_QSTR_done), MP_ROM_PTR(&_http_response_done_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(_http_response_locals_dict, _http_response_locals_dict_table);
+
+const mp_obj_type_t http_response_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Response,
+    .make_new = _http_response_make_new,
+    .locals_dict = (mp_obj_dict_t*)&_http_response_locals_dict,
+};
@@ -0,0 +1,43 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_BINDINGS__HTTP_RESPONSE_H
+#define MICROPY_INCLUDED_SHARED_BINDINGS__HTTP_RESPONSE_H
+
+#include "shared-module/_http/Response.h"
+
+extern const mp_obj_type_t http_response_type;
+
+void common_hal__http_response_construct(http_response_obj_t *self, mp_obj_t socket, mp_obj_t buffer, mp_obj_t headers, bool head);
+size_t common_hal__http_response_readinto(http_response_obj_t *self, uint8_t *data, size_t len);
+int common_hal__http_response_get_status_code(http_response_obj_t *self);
+mp_obj_t common_hal__http_response_get_reason(http_response_obj_t *self);
+int common_hal__http_response_get_version(http_response_obj_t *self);
+mp_obj_t common_hal__http_response_get_headers(http_response_obj_t *self);
+bool common_hal__http_response_get_keep_alive(http_response_obj_t *self);
+bool common_hal__http_response_get_done(http_response_obj_t *self);
+
+#endif // MICROPY_INCLUDED_SHARED_BINDINGS__HTTP_RESPONSE_H
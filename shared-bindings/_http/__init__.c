@@ -0,0 +1,63 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/obj.h"
+#include "py/runtime.h"
+
+#include "shared-bindings/_http/ConnectionPool.h"
+#include "shared-bindings/_http/Response.h"
+
+//| """HTTP/1.1 client support
+//|
+//| The `_http` module parses HTTP/1.1 responses in C and pools keep-alive
+//| connections.  It does not send requests; write those to the socket
+//| directly.  A typical exchange is::
+//|
+//|   pool = _http.ConnectionPool(socket)
+//|   buffer = bytearray(512)
+//|   headers = {}
+//|   body = bytearray(1024)
+//|
+//|   sock = pool.connect("example.com", 80)
+//|   sock.send(b"GET / HTTP/1.1\r\nHost: example.com\r\n\r\n")
+//|   response = _http.Response(sock, buffer, headers)
+//|   while response.readinto(body):
+//|       pass
+//|   pool.release("example.com", 80, sock, response.keep_alive)"""
+//|
+
+STATIC const mp_rom_map_elem_t _http_module_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR__http) },
+    { MP_ROM_QSTR(MP_QSTR_ConnectionPool), MP_ROM_PTR(&http_connectionpool_type) },
+    { MP_ROM_QSTR(MP_QSTR_Response), MP_ROM_PTR(&http_response_type) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(_http_module_globals, _http_module_globals_table);
+
+const mp_obj_module_t _http_module = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&_http_module_globals,
+};
@@ -53,6 +53,8 @@ STATIC const mp_rom_map_elem_t aesio_module_globals_table[] = {
     {MP_ROM_QSTR(MP_QSTR_MODE_ECB), MP_ROM_INT(AES_MODE_ECB)},
     {MP_ROM_QSTR(MP_QSTR_MODE_CBC), MP_ROM_INT(AES_MODE_CBC)},
     {MP_ROM_QSTR(MP_QSTR_MODE_CTR), MP_ROM_INT(AES_MODE_CTR)},
+    {MP_ROM_QSTR(MP_QSTR_MODE_CCM), MP_ROM_INT(AES_MODE_CCM)},
+    {MP_ROM_QSTR(MP_QSTR_MODE_GCM), MP_ROM_INT(AES_MODE_GCM)},
     {MP_ROM_QSTR(MP_QSTR_block_size), MP_ROM_INT(AES_BLOCKLEN)},
     {MP_ROM_QSTR(MP_QSTR_key_size), (mp_obj_t)&mp_aes_key_size_obj},
 };
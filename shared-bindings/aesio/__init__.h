@@ -35,19 +35,28 @@ void common_hal_aesio_aes_construct(aesio_aes_obj_t* self,
                               const uint8_t* key,
                               uint32_t key_length,
                               const uint8_t* iv,
+                              uint32_t iv_length,
                               int mode,
-                              int counter);
+                              int counter,
+                              uint32_t mac_len);
 void common_hal_aesio_aes_rekey(aesio_aes_obj_t* self,
                           const uint8_t* key,
                           uint32_t key_length,
-                          const uint8_t* iv);
+                          const uint8_t* iv,
+                          uint32_t iv_length);
 void common_hal_aesio_aes_set_mode(aesio_aes_obj_t* self,
                              int mode);
+void common_hal_aesio_aes_update(aesio_aes_obj_t* self,
+                           mp_obj_t aad);
 void common_hal_aesio_aes_encrypt(aesio_aes_obj_t* self,
-                            uint8_t* buffer,
+                            const uint8_t* src,
+                            uint8_t* dest,
                             size_t len);
 void common_hal_aesio_aes_decrypt(aesio_aes_obj_t* self,
-                            uint8_t* buffer,
+                            const uint8_t* src,
+                            uint8_t* dest,
                             size_t len);
+void common_hal_aesio_aes_digest(aesio_aes_obj_t* self,
+                           uint8_t* tag);
 
 #endif // MICROPY_INCLUDED_SHARED_BINDINGS_AESIO_H
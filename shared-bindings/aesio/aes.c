@@ -12,13 +12,16 @@
 //| class AES:
 //|     """Encrypt and decrypt AES streams"""
 //|
-//|     def __init__(self, key: ReadableBuffer, mode: int = 0, iv: Optional[ReadableBuffer] = None, segment_size: int = 8) -> None:
+//|     def __init__(self, key: ReadableBuffer, mode: int = 0, iv: Optional[ReadableBuffer] = None, segment_size: int = 8, mac_len: int = 16) -> None:
 //|         """Create a new AES state with the given key.
 //|
 //|            :param ~_typing.ReadableBuffer key: A 16-, 24-, or 32-byte key
-//|            :param int mode: AES mode to use.  One of: AES.MODE_ECB, AES.MODE_CBC, or
-//|                             AES.MODE_CTR
-//|            :param ~_typing.ReadableBuffer iv: Initialization vector to use for CBC or CTR mode
+//|            :param int mode: AES mode to use.  One of: AES.MODE_ECB, AES.MODE_CBC,
+//|                             AES.MODE_CTR, AES.MODE_GCM or AES.MODE_CCM
+//|            :param ~_typing.ReadableBuffer iv: Initialization vector to use for CBC or CTR mode,
+//|                             or the nonce for GCM (1 to 16 bytes, 12 recommended) or
+//|                             CCM (7 to 13 bytes) mode. Never reuse a nonce with the same key.
+//|            :param int mac_len: Length of the GCM or CCM tag, an even number from 4 to 16
 //|
 //|            Additional arguments are supported for legacy reasons.
 //|
@@ -32,21 +35,70 @@
 //|              outp = bytearray(len(inp))
 //|              cipher = aesio.AES(key, aesio.mode.MODE_ECB)
 //|              cipher.encrypt_into(inp, outp)
-//|              hexlify(outp)"""
+//|              hexlify(outp)
+//|
+//|            Encrypting and authenticating a message::
+//|
+//|              cipher = aesio.AES(key, aesio.MODE_GCM, nonce)
+//|              cipher.update(header)
+//|              cipher.encrypt_into(message, outp)
+//|              tag = cipher.digest()"""
 //|         ...
 //|
 
+// CBC and CTR take a full block, or nothing for an all-zero IV. The
+// authenticated modes need a nonce of a length they support.
+STATIC void validate_iv(int mode, size_t iv_length) {
+  switch (mode) {
+  case AES_MODE_GCM:
+    if (iv_length == 0 || iv_length > AES_BLOCKLEN) {
+      mp_raise_ValueError_varg(translate("Invalid %q"), MP_QSTR_IV);
+    }
+    break;
+  case AES_MODE_CCM:
+    if (iv_length < 7 || iv_length > 13) {
+      mp_raise_ValueError_varg(translate("Invalid %q"), MP_QSTR_IV);
+    }
+    break;
+  default:
+    if (iv_length != 0 && iv_length != AES_BLOCKLEN) {
+      mp_raise_TypeError_varg(translate("IV must be %d bytes long"),
+                              AES_BLOCKLEN);
+    }
+    break;
+  }
+}
+
+STATIC int validate_mode(mp_int_t mode) {
+  switch (mode) {
+  case AES_MODE_CBC:
+  case AES_MODE_ECB:
+  case AES_MODE_CTR:
+  case AES_MODE_GCM:
+  case AES_MODE_CCM:
+    break;
+  default:
+    mp_raise_TypeError(translate("Requested AES mode is unsupported"));
+  }
+  return mode;
+}
+
+STATIC bool is_authenticated(aesio_aes_obj_t *self) {
+  return self->mode == AES_MODE_GCM || self->mode == AES_MODE_CCM;
+}
+
 STATIC mp_obj_t aesio_aes_make_new(const mp_obj_type_t *type, size_t n_args,
                                    const mp_obj_t *pos_args,
                                    mp_map_t *kw_args) {
   (void)type;
-  enum { ARG_key, ARG_mode, ARG_IV, ARG_counter, ARG_segment_size };
+  enum { ARG_key, ARG_mode, ARG_IV, ARG_counter, ARG_segment_size, ARG_mac_len };
   static const mp_arg_t allowed_args[] = {
       {MP_QSTR_key, MP_ARG_OBJ | MP_ARG_REQUIRED},
       {MP_QSTR_mode, MP_ARG_INT, {.u_int = AES_MODE_ECB}},
       {MP_QSTR_IV, MP_ARG_OBJ},
       {MP_QSTR_counter, MP_ARG_OBJ},
       {MP_QSTR_segment_size, MP_ARG_INT, {.u_int = 8}},
+      {MP_QSTR_mac_len, MP_ARG_INT, {.u_int = AES_BLOCKLEN}},
   };
   mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
 
@@ -70,29 +122,25 @@ STATIC mp_obj_t aesio_aes_make_new(const mp_obj_type_t *type, size_t n_args,
     mp_raise_TypeError(translate("No key was specified"));
   }
 
-  int mode = args[ARG_mode].u_int;
-  switch (args[ARG_mode].u_int) {
-  case AES_MODE_CBC:
-  case AES_MODE_ECB:
-  case AES_MODE_CTR:
-    break;
-  default:
-    mp_raise_TypeError(translate("Requested AES mode is unsupported"));
+  int mode = validate_mode(args[ARG_mode].u_int);
+
+  mp_int_t mac_len = args[ARG_mac_len].u_int;
+  if (mac_len < 4 || mac_len > AES_BLOCKLEN || (mac_len & 1) != 0) {
+    mp_raise_ValueError_varg(translate("Invalid %q"), MP_QSTR_mac_len);
   }
 
   // IV is required for CBC mode and is ignored for other modes.
   const uint8_t *iv = NULL;
+  size_t iv_length = 0;
   if (args[ARG_IV].u_obj != NULL &&
       mp_get_buffer(args[ARG_IV].u_obj, &bufinfo, MP_BUFFER_READ)) {
-    if (bufinfo.len != AES_BLOCKLEN) {
-      mp_raise_TypeError_varg(translate("IV must be %d bytes long"),
-                              AES_BLOCKLEN);
-    }
     iv = bufinfo.buf;
+    iv_length = bufinfo.len;
   }
+  validate_iv(mode, iv_length);
 
-  common_hal_aesio_aes_construct(self, key, key_length, iv, mode,
-                                 args[ARG_counter].u_int);
+  common_hal_aesio_aes_construct(self, key, key_length, iv, iv_length, mode,
+                                 args[ARG_counter].u_int, mac_len);
   return MP_OBJ_FROM_PTR(self);
 }
 
@@ -111,17 +159,15 @@ STATIC mp_obj_t aesio_aes_rekey(size_t n_args, const mp_obj_t *pos_args) {
   }
 
   const uint8_t *iv = NULL;
+  size_t iv_length = 0;
   if (n_args > 2) {
     mp_get_buffer_raise(pos_args[2], &bufinfo, MP_BUFFER_READ);
-    size_t iv_length = bufinfo.len;
+    iv_length = bufinfo.len;
     iv = (const uint8_t *)bufinfo.buf;
-    if (iv_length != AES_BLOCKLEN) {
-      mp_raise_TypeError_varg(translate("IV must be %d bytes long"),
-                              AES_BLOCKLEN);
-    }
   }
+  validate_iv(self->mode, iv_length);
 
-  common_hal_aesio_aes_rekey(self, key, key_length, iv);
+  common_hal_aesio_aes_rekey(self, key, key_length, iv, iv_length);
   return mp_const_none;
 }
 
@@ -148,8 +194,19 @@ STATIC void validate_length(aesio_aes_obj_t *self, size_t src_length,
     }
     break;
   case AES_MODE_CTR:
+  case AES_MODE_GCM:
+    break;
+  case AES_MODE_CCM:
+    // The length field takes the bytes of the block the nonce leaves free.
+    if (self->iv_length > 11 && (src_length >> (8 * (15 - self->iv_length))) != 0) {
+      mp_raise_ValueError(translate("Invalid buffer size"));
+    }
     break;
   }
+
+  if (is_authenticated(self) && self->auth_state == AES_AUTH_DONE) {
+    mp_raise_ValueError(translate("Start a new message with rekey()"));
+  }
 }
 
 //|     def encrypt_into(self, src: ReadableBuffer, dest: WriteableBuffer) -> None:
@@ -157,7 +214,8 @@ STATIC void validate_length(aesio_aes_obj_t *self, size_t src_length,
 //|
 //|            For ECB mode, the buffers must be 16 bytes long.  For CBC mode, the
 //|            buffers must be a multiple of 16 bytes, and must be equal length.  For
-//|            CTX mode, there are no restrictions."""
+//|            CTX and GCM mode, there are no restrictions. In CCM mode the whole
+//|            message must be passed in one call."""
 //|         ...
 //|
 STATIC mp_obj_t aesio_aes_encrypt_into(mp_obj_t aesio_obj, mp_obj_t src,
@@ -173,10 +231,8 @@ STATIC mp_obj_t aesio_aes_encrypt_into(mp_obj_t aesio_obj, mp_obj_t src,
   mp_get_buffer_raise(dest, &destbufinfo, MP_BUFFER_WRITE);
   validate_length(aes, srcbufinfo.len, destbufinfo.len);
 
-  memcpy(destbufinfo.buf, srcbufinfo.buf, srcbufinfo.len);
-
-  common_hal_aesio_aes_encrypt(aes, (uint8_t *)destbufinfo.buf,
-                               destbufinfo.len);
+  common_hal_aesio_aes_encrypt(aes, (const uint8_t *)srcbufinfo.buf,
+                               (uint8_t *)destbufinfo.buf, destbufinfo.len);
   return mp_const_none;
 }
 
@@ -187,7 +243,9 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_3(aesio_aes_encrypt_into_obj,
 //|         """Decrypt the buffer from ``src`` into ``dest``.
 //|            For ECB mode, the buffers must be 16 bytes long.  For CBC mode, the
 //|            buffers must be a multiple of 16 bytes, and must be equal length.  For
-//|            CTX mode, there are no restrictions."""
+//|            CTX and GCM mode, there are no restrictions. In CCM mode the whole
+//|            message must be passed in one call. In GCM and CCM mode, call
+//|            `verify` before trusting the result."""
 //|         ...
 //|
 STATIC mp_obj_t aesio_aes_decrypt_into(mp_obj_t aesio_obj, mp_obj_t src,
@@ -203,16 +261,85 @@ STATIC mp_obj_t aesio_aes_decrypt_into(mp_obj_t aesio_obj, mp_obj_t src,
   mp_get_buffer_raise(dest, &destbufinfo, MP_BUFFER_WRITE);
   validate_length(aes, srcbufinfo.len, destbufinfo.len);
 
-  memcpy(destbufinfo.buf, srcbufinfo.buf, srcbufinfo.len);
-
-  common_hal_aesio_aes_decrypt(aes, (uint8_t *)destbufinfo.buf,
-                               destbufinfo.len);
+  common_hal_aesio_aes_decrypt(aes, (const uint8_t *)srcbufinfo.buf,
+                               (uint8_t *)destbufinfo.buf, destbufinfo.len);
   return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_3(aesio_aes_decrypt_into_obj,
                                  aesio_aes_decrypt_into);
 
+//|     def update(self, data: ReadableBuffer) -> None:
+//|         """Add ``data`` to the associated data of a GCM or CCM message: data that
+//|            is authenticated by the tag but not encrypted. It must all be supplied
+//|            before the message itself."""
+//|         ...
+//|
+STATIC mp_obj_t aesio_aes_update(mp_obj_t aesio_obj, mp_obj_t data) {
+  if (!MP_OBJ_IS_TYPE(aesio_obj, &aesio_aes_type)) {
+    mp_raise_TypeError_varg(translate("Expected a %q"), aesio_aes_type.name);
+  }
+  aesio_aes_obj_t *self = MP_OBJ_TO_PTR(aesio_obj);
+  if (!is_authenticated(self)) {
+    mp_raise_TypeError(translate("Requested AES mode is unsupported"));
+  }
+  if (self->auth_state != AES_AUTH_AAD) {
+    mp_raise_ValueError(translate("Associated data must come before the message"));
+  }
+  common_hal_aesio_aes_update(self, data);
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(aesio_aes_update_obj, aesio_aes_update);
+
+STATIC void get_tag(mp_obj_t aesio_obj, uint8_t *tag) {
+  if (!MP_OBJ_IS_TYPE(aesio_obj, &aesio_aes_type)) {
+    mp_raise_TypeError_varg(translate("Expected a %q"), aesio_aes_type.name);
+  }
+  aesio_aes_obj_t *self = MP_OBJ_TO_PTR(aesio_obj);
+  if (!is_authenticated(self)) {
+    mp_raise_TypeError(translate("Requested AES mode is unsupported"));
+  }
+  common_hal_aesio_aes_digest(self, tag);
+}
+
+//|     def digest(self) -> bytes:
+//|         """Finish a GCM or CCM message and return its tag, ``mac_len`` bytes long.
+//|            Call ``rekey()`` with a new nonce to start the next message."""
+//|         ...
+//|
+STATIC mp_obj_t aesio_aes_digest(mp_obj_t aesio_obj) {
+  uint8_t tag[AES_BLOCKLEN];
+  get_tag(aesio_obj, tag);
+  aesio_aes_obj_t *self = MP_OBJ_TO_PTR(aesio_obj);
+  return mp_obj_new_bytes(tag, self->mac_len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(aesio_aes_digest_obj, aesio_aes_digest);
+
+//|     def verify(self, tag: ReadableBuffer) -> None:
+//|         """Finish a decrypted GCM or CCM message and check it against ``tag``.
+//|            Raises `ValueError` if the message or associated data was altered."""
+//|         ...
+//|
+STATIC mp_obj_t aesio_aes_verify(mp_obj_t aesio_obj, mp_obj_t tag_obj) {
+  uint8_t tag[AES_BLOCKLEN];
+  get_tag(aesio_obj, tag);
+  aesio_aes_obj_t *self = MP_OBJ_TO_PTR(aesio_obj);
+
+  mp_buffer_info_t bufinfo;
+  mp_get_buffer_raise(tag_obj, &bufinfo, MP_BUFFER_READ);
+  // Compare without an early exit so the time taken says nothing about
+  // where the tags differ.
+  uint8_t diff = bufinfo.len != self->mac_len;
+  for (size_t i = 0; i < self->mac_len && i < bufinfo.len; i++) {
+    diff |= tag[i] ^ ((const uint8_t *)bufinfo.buf)[i];
+  }
+  if (diff != 0) {
+    mp_raise_ValueError(translate("MAC check failed"));
+  }
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(aesio_aes_verify_obj, aesio_aes_verify);
+
 STATIC mp_obj_t aesio_aes_get_mode(mp_obj_t aesio_obj) {
   if (!MP_OBJ_IS_TYPE(aesio_obj, &aesio_aes_type)) {
     mp_raise_TypeError_varg(translate("Expected a %q"), aesio_aes_type.name);
@@ -228,15 +355,8 @@ STATIC mp_obj_t aesio_aes_set_mode(mp_obj_t aesio_obj, mp_obj_t mode_obj) {
   }
   aesio_aes_obj_t *self = MP_OBJ_TO_PTR(aesio_obj);
 
-  int mode = mp_obj_get_int(mode_obj);
-  switch (mode) {
-  case AES_MODE_CBC:
-  case AES_MODE_ECB:
-  case AES_MODE_CTR:
-    break;
-  default:
-    mp_raise_TypeError(translate("Requested AES mode is unsupported"));
-  }
+  int mode = validate_mode(mp_obj_get_int(mode_obj));
+  validate_iv(mode, self->iv_length);
 
   common_hal_aesio_aes_set_mode(self, mode);
   return mp_const_none;
@@ -255,6 +375,9 @@ STATIC const mp_rom_map_elem_t aesio_locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_encrypt_into), (mp_obj_t)&aesio_aes_encrypt_into_obj},
     {MP_ROM_QSTR(MP_QSTR_decrypt_into), (mp_obj_t)&aesio_aes_decrypt_into_obj},
     {MP_ROM_QSTR(MP_QSTR_rekey), (mp_obj_t)&aesio_aes_rekey_obj},
+    {MP_ROM_QSTR(MP_QSTR_update), (mp_obj_t)&aesio_aes_update_obj},
+    {MP_ROM_QSTR(MP_QSTR_digest), (mp_obj_t)&aesio_aes_digest_obj},
+    {MP_ROM_QSTR(MP_QSTR_verify), (mp_obj_t)&aesio_aes_verify_obj},
     {MP_ROM_QSTR(MP_QSTR_mode), (mp_obj_t)&aesio_aes_mode_obj},
 };
 STATIC MP_DEFINE_CONST_DICT(aesio_locals_dict, aesio_locals_dict_table);
@@ -208,7 +208,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(canio_can_restart_obj, canio_can_restart);
 //|
 //|         There is an implementation-defined maximum number of listeners and limit to the complexity of the filters.
 //|
-//|         If the hardware cannot support all the requested matches, a ValueError is raised.  Note that generally there are some number of hardware filters shared among all fifos.
+//|         If the hardware filters cannot hold all the requested matches, the listener accepts every message in hardware and checks the matches in software.  This costs some time per message but the check is a binary search per distinct mask, not a comparison per match.  If even that is not possible, a ValueError is raised.  Note that generally there are some number of hardware filters shared among all fifos.
 //|
 //|         A message can be received by at most one Listener.  If more than one listener matches a message, it is undefined which one actually receives it.
 //|
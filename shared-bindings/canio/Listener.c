@@ -26,6 +26,7 @@
 
 #include "shared-bindings/canio/Listener.h"
 #include "shared-bindings/canio/Message.h"
+#include "shared-module/canio/Frame.h"
 #include "common-hal/canio/Listener.h"
 
 #include "py/runtime.h"
@@ -64,9 +65,37 @@ STATIC mp_obj_t canio_listener_receive(mp_obj_t self_in) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(canio_listener_receive_obj, canio_listener_receive);
 
+//|     def receive_into(self, buffer: WriteableBuffer) -> int:
+//|         """Reads as many messages as fit in ``buffer``, after waiting up to
+//|         ``self.timeout`` seconds for the first one, and returns how many
+//|         were read.  Nothing is allocated, so this keeps up with a busy bus
+//|         where `receive` would not.
+//|
+//|         Each message takes 20 bytes in the layout of `struct` format
+//|         ``"<IBBxx8sI"``: the id, the flags (1 for an extended id, 2 for a
+//|         remote transmission request), the length, the data padded to 8
+//|         bytes and the time in milliseconds when it was read from the
+//|         hardware.  Bytes after the last message read are left unchanged."""
+//|         ...
+//|
+STATIC mp_obj_t canio_listener_receive_into(mp_obj_t self_in, mp_obj_t buffer) {
+    canio_listener_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    common_hal_canio_listener_check_for_deinit(self);
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer, &bufinfo, MP_BUFFER_WRITE);
+    size_t max_frames = bufinfo.len / sizeof(canio_frame_t);
+    if (max_frames == 0) {
+        mp_raise_ValueError(translate("Buffer is too small"));
+    }
+    return MP_OBJ_NEW_SMALL_INT(common_hal_canio_listener_receive_into(self, bufinfo.buf, max_frames));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(canio_listener_receive_into_obj, canio_listener_receive_into);
+
 //|     def in_waiting(self) -> int:
 //|         """Returns the number of messages (including remote
-//|         transmission requests) waiting"""
+//|         transmission requests) waiting.  When the matches are checked in
+//|         software this includes messages that will be discarded."""
 //|         ...
 //|
 STATIC mp_obj_t canio_listener_in_waiting(mp_obj_t self_in) {
@@ -158,13 +187,34 @@ STATIC const mp_obj_property_t canio_listener_timeout_obj = {
 };
 
 
+//|     overruns: int
+//|     """The number of times the receive FIFO was found to have overflowed
+//|     and lost messages (read-only).  Each overflow is counted once however
+//|     many messages it lost."""
+//|
+STATIC mp_obj_t canio_listener_overruns_get(mp_obj_t self_in) {
+    canio_listener_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    common_hal_canio_listener_check_for_deinit(self);
+    return mp_obj_new_int_from_uint(common_hal_canio_listener_get_overruns(self));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(canio_listener_overruns_get_obj, canio_listener_overruns_get);
+
+STATIC const mp_obj_property_t canio_listener_overruns_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&canio_listener_overruns_get_obj,
+              (mp_obj_t)mp_const_none,
+              (mp_obj_t)mp_const_none},
+};
+
 
 STATIC const mp_rom_map_elem_t canio_listener_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&canio_listener_enter_obj) },
     { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&canio_listener_exit_obj) },
     { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&canio_listener_deinit_obj) },
     { MP_ROM_QSTR(MP_QSTR_in_waiting), MP_ROM_PTR(&canio_listener_in_waiting_obj) },
+    { MP_ROM_QSTR(MP_QSTR_overruns), MP_ROM_PTR(&canio_listener_overruns_obj) },
     { MP_ROM_QSTR(MP_QSTR_receive), MP_ROM_PTR(&canio_listener_receive_obj) },
+    { MP_ROM_QSTR(MP_QSTR_receive_into), MP_ROM_PTR(&canio_listener_receive_into_obj) },
     { MP_ROM_QSTR(MP_QSTR_timeout), MP_ROM_PTR(&canio_listener_timeout_obj) },
 };
 STATIC MP_DEFINE_CONST_DICT(canio_listener_locals_dict, canio_listener_locals_dict_table);
@@ -38,6 +38,8 @@ void common_hal_canio_listener_construct(canio_listener_obj_t *self, canio_can_o
 void common_hal_canio_listener_check_for_deinit(canio_listener_obj_t *self);
 void common_hal_canio_listener_deinit(canio_listener_obj_t *self);
 mp_obj_t common_hal_canio_listener_receive(canio_listener_obj_t *self);
+size_t common_hal_canio_listener_receive_into(canio_listener_obj_t *self, void *frames, size_t max_frames);
 int common_hal_canio_listener_in_waiting(canio_listener_obj_t *self);
+uint32_t common_hal_canio_listener_get_overruns(canio_listener_obj_t *self);
 float common_hal_canio_listener_get_timeout(canio_listener_obj_t *self);
 void common_hal_canio_listener_set_timeout(canio_listener_obj_t *self, float timeout);
@@ -0,0 +1,200 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/runtime.h"
+#include "shared-bindings/random/Random.h"
+#include "supervisor/shared/translate.h"
+
+//| class Random:
+//|     """An independent random number generator with the same methods as the
+//|     `random` module. Each instance has its own state, so seeding or drawing
+//|     from one doesn't change the sequence of any other."""
+//|
+//|     def __init__(self, seed: Optional[int] = None) -> None:
+//|         """Create a generator seeded with ``seed``, or from `os.urandom` (or
+//|         the uptime) when ``seed`` is None."""
+//|         ...
+//|
+
+STATIC void random_random_do_seed(random_random_obj_t *self, mp_obj_t seed_in) {
+    if (seed_in == mp_const_none) {
+        shared_modules_random_random_seed_urandom(self);
+    } else {
+        shared_modules_random_random_seed(self, mp_obj_get_int_truncated(seed_in));
+    }
+}
+
+STATIC mp_obj_t random_random_make_new(const mp_obj_type_t *type, size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    mp_arg_check_num(n_args, kw_args, 0, 1, false);
+    random_random_obj_t *self = m_new_obj(random_random_obj_t);
+    self->base.type = type;
+    random_random_do_seed(self, n_args > 0 ? args[0] : mp_const_none);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+//|     def seed(self, seed: Optional[int] = None) -> None:
+//|         """Restart the sequence from ``seed``, or from a new random seed when
+//|         ``seed`` is None."""
+//|         ...
+//|
+STATIC mp_obj_t random_random_seed(size_t n_args, const mp_obj_t *args) {
+    random_random_do_seed(MP_OBJ_TO_PTR(args[0]), n_args > 1 ? args[1] : mp_const_none);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(random_random_seed_obj, 1, 2, random_random_seed);
+
+//|     def getrandbits(self, k: int) -> int:
+//|         """Returns an integer with *k* random bits."""
+//|         ...
+//|
+STATIC mp_obj_t random_random_getrandbits(mp_obj_t self_in, mp_obj_t num_in) {
+    int n = mp_obj_get_int(num_in);
+    if (n > 32 || n <= 0) {
+        mp_raise_ValueError(NULL);
+    }
+    return mp_obj_new_int_from_uint(shared_modules_random_random_getrandbits(MP_OBJ_TO_PTR(self_in), (uint8_t)n));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(random_random_getrandbits_obj, random_random_getrandbits);
+
+//|     def randrange(self, start: int, stop: Optional[int] = None, step: int = 1) -> int:
+//|         """Returns a randomly selected integer from ``range(start, stop, step)``."""
+//|         ...
+//|
+STATIC mp_obj_t random_random_randrange(size_t n_args, const mp_obj_t *args) {
+    mp_int_t start = 0;
+    mp_int_t stop = mp_obj_get_int(args[1]);
+    mp_int_t step = 1;
+    if (n_args > 2) {
+        start = stop;
+        stop = mp_obj_get_int(args[2]);
+        if (n_args > 3) {
+            step = mp_obj_get_int(args[3]);
+        }
+    }
+    return mp_obj_new_int(shared_modules_random_random_randrange(MP_OBJ_TO_PTR(args[0]), start, stop, step));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(random_random_randrange_obj, 2, 4, random_random_randrange);
+
+//|     def randint(self, a: int, b: int) -> int:
+//|         """Returns a randomly selected integer between a and b inclusive."""
+//|         ...
+//|
+STATIC mp_obj_t random_random_randint(mp_obj_t self_in, mp_obj_t a_in, mp_obj_t b_in) {
+    mp_int_t a = mp_obj_get_int(a_in);
+    mp_int_t b = mp_obj_get_int(b_in);
+    if (a > b) {
+        mp_raise_ValueError(NULL);
+    }
+    return mp_obj_new_int(shared_modules_random_random_randrange(MP_OBJ_TO_PTR(self_in), a, b + 1, 1));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(random_random_randint_obj, random_random_randint);
+
+//|     def choice(self, seq: Sequence[_T]) -> _T:
+//|         """Returns a randomly selected element from the given sequence. Raises
+//|         IndexError when the sequence is empty."""
+//|         ...
+//|
+STATIC mp_obj_t random_random_choice(mp_obj_t self_in, mp_obj_t seq) {
+    mp_int_t len = mp_obj_get_int(mp_obj_len(seq));
+    if (len == 0) {
+        mp_raise_IndexError(translate("empty sequence"));
+    }
+    mp_int_t i = shared_modules_random_random_randrange(MP_OBJ_TO_PTR(self_in), 0, len, 1);
+    return mp_obj_subscr(seq, MP_OBJ_NEW_SMALL_INT(i), MP_OBJ_SENTINEL);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(random_random_choice_obj, random_random_choice);
+
+//|     def random(self) -> float:
+//|         """Returns a random float between 0 and 1.0."""
+//|         ...
+//|
+STATIC mp_obj_t random_random_random(mp_obj_t self_in) {
+    return mp_obj_new_float(shared_modules_random_random_random(MP_OBJ_TO_PTR(self_in)));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(random_random_random_obj, random_random_random);
+
+//|     def uniform(self, a: float, b: float) -> float:
+//|         """Returns a random float between a and b. It may or may not be inclusive
+//|         depending on float rounding."""
+//|         ...
+//|
+STATIC mp_obj_t random_random_uniform(mp_obj_t self_in, mp_obj_t a_in, mp_obj_t b_in) {
+    mp_float_t a = mp_obj_get_float(a_in);
+    mp_float_t b = mp_obj_get_float(b_in);
+    return mp_obj_new_float(shared_modules_random_random_uniform(MP_OBJ_TO_PTR(self_in), a, b));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(random_random_uniform_obj, random_random_uniform);
+
+//|     def randbytes(self, n: int) -> bytes:
+//|         """Returns ``n`` random bytes."""
+//|         ...
+//|
+STATIC mp_obj_t random_random_randbytes(mp_obj_t self_in, mp_obj_t n_in) {
+    mp_int_t n = mp_obj_get_int(n_in);
+    if (n < 0) {
+        mp_raise_ValueError(NULL);
+    }
+    vstr_t vstr;
+    vstr_init_len(&vstr, n);
+    shared_modules_random_random_fill_bytes(MP_OBJ_TO_PTR(self_in), (uint8_t *)vstr.buf, n);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(random_random_randbytes_obj, random_random_randbytes);
+
+//|     def fill(self, buffer: WriteableBuffer) -> None:
+//|         """Fills ``buffer`` in place. An ``array('f')`` or ``array('d')`` gets
+//|         floats between 0 and 1.0, like `random`. Any other buffer gets random
+//|         bits, so every integer array item is equally likely to be any value."""
+//|         ...
+//|
+STATIC mp_obj_t random_random_fill(mp_obj_t self_in, mp_obj_t buffer_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer_in, &bufinfo, MP_BUFFER_WRITE);
+    shared_modules_random_random_fill(MP_OBJ_TO_PTR(self_in), bufinfo.buf, bufinfo.len, bufinfo.typecode);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(random_random_fill_obj, random_random_fill);
+
+STATIC const mp_rom_map_elem_t random_random_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_seed), MP_ROM_PTR(&random_random_seed_obj) },
+    { MP_ROM_QSTR(MP_QSTR_getrandbits), MP_ROM_PTR(&random_random_getrandbits_obj) },
+    { MP_ROM_QSTR(MP_QSTR_randrange), MP_ROM_PTR(&random_random_randrange_obj) },
+    { MP_ROM_QSTR(MP_QSTR_randint), MP_ROM_PTR(&random_random_randint_obj) },
+    { MP_ROM_QSTR(MP_QSTR_choice), MP_ROM_PTR(&random_random_choice_obj) },
+    { MP_ROM_QSTR(MP_QSTR_random), MP_ROM_PTR(&random_random_random_obj) },
+    { MP_ROM_QSTR(MP_QSTR_uniform), MP_ROM_PTR(&random_random_uniform_obj) },
+    { MP_ROM_QSTR(MP_QSTR_randbytes), MP_ROM_PTR(&random_random_randbytes_obj) },
+    { MP_ROM_QSTR(MP_QSTR_fill), MP_ROM_PTR(&random_random_fill_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(random_random_locals_dict, random_random_locals_dict_table);
+
+const mp_obj_type_t random_random_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Random,
+    .make_new = random_random_make_new,
+    .locals_dict = (mp_obj_dict_t *)&random_random_locals_dict,
+};
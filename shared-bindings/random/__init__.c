@@ -31,6 +31,7 @@
 #include "py/obj.h"
 #include "py/runtime.h"
 #include "shared-bindings/random/__init__.h"
+#include "shared-bindings/random/Random.h"
 #include "supervisor/shared/translate.h"
 
 //| """pseudo-random numbers and choices
@@ -42,6 +43,8 @@
 //| Like its CPython cousin, CircuitPython's random seeds itself on first use
 //| with a true random from os.urandom() when available or the uptime otherwise.
 //| Once seeded, it will be deterministic, which is why its bad for cryptography.
+//| The generator is xoshiro128++. Create a `Random` for a sequence of your own
+//| that other code drawing numbers can't disturb.
 //|
 //| .. warning:: Numbers from this module are not cryptographically strong! Use
 //|   bytes from `os.urandom` directly for true randomness."""
@@ -68,7 +71,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(random_seed_obj, random_seed);
 //|
 STATIC mp_obj_t random_getrandbits(mp_obj_t num_in) {
     int n = mp_obj_get_int(num_in);
-    if (n > 32 || n == 0) {
+    if (n > 32 || n <= 0) {
         mp_raise_ValueError(NULL);
     }
     return mp_obj_new_int_from_uint(shared_modules_random_getrandbits((uint8_t) n));
@@ -83,36 +86,13 @@ STATIC mp_obj_t random_randrange(size_t n_args, const mp_obj_t *args) {
     mp_int_t start = 0;
     mp_int_t stop = mp_obj_get_int(args[0]);
     mp_int_t step = 1;
-    if (n_args == 1) {
-        // range(stop)
-        if (stop <= 0) {
-            mp_raise_ValueError(translate("stop not reachable from start"));
-        }
-    } else {
+    if (n_args > 1) {
         start = stop;
         stop = mp_obj_get_int(args[1]);
-        if (n_args == 2) {
-            // range(start, stop)
-            if (start >= stop) {
-                mp_raise_ValueError(translate("stop not reachable from start"));
-            }
-        } else {
-            // range(start, stop, step)
+        if (n_args > 2) {
             step = mp_obj_get_int(args[2]);
-            mp_int_t n;
-            if (step > 0) {
-                n = (stop - start + step - 1) / step;
-            } else if (step < 0) {
-                n = (stop - start + step + 1) / step;
-            } else {
-                mp_raise_ValueError(translate("step must be non-zero"));
-            }
-            if (n <= 0) {
-                mp_raise_ValueError(translate("invalid step"));
-            }
         }
     }
-
     return mp_obj_new_int(shared_modules_random_randrange(start, stop, step));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(random_randrange_obj, 1, 3, random_randrange);
@@ -167,6 +147,37 @@ STATIC mp_obj_t random_uniform(mp_obj_t a_in, mp_obj_t b_in) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(random_uniform_obj, random_uniform);
 
+//| def randbytes(n: int) -> bytes:
+//|     """Returns ``n`` random bytes."""
+//|     ...
+//|
+STATIC mp_obj_t random_randbytes(mp_obj_t n_in) {
+    mp_int_t n = mp_obj_get_int(n_in);
+    if (n < 0) {
+        mp_raise_ValueError(NULL);
+    }
+    vstr_t vstr;
+    vstr_init_len(&vstr, n);
+    shared_modules_random_random_fill_bytes(shared_modules_random_default(), (uint8_t *)vstr.buf, n);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(random_randbytes_obj, random_randbytes);
+
+//| def fill(buffer: WriteableBuffer) -> None:
+//|     """Fills ``buffer`` in place, much faster than calling `random` or
+//|     `getrandbits` for each item. An ``array('f')`` or ``array('d')`` gets
+//|     floats between 0 and 1.0, like `random`. Any other buffer gets random
+//|     bits, so every integer array item is equally likely to be any value."""
+//|     ...
+//|
+STATIC mp_obj_t random_fill(mp_obj_t buffer_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer_in, &bufinfo, MP_BUFFER_WRITE);
+    shared_modules_random_random_fill(shared_modules_random_default(), bufinfo.buf, bufinfo.len, bufinfo.typecode);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(random_fill_obj, random_fill);
+
 STATIC const mp_rom_map_elem_t mp_module_random_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_random) },
     { MP_ROM_QSTR(MP_QSTR_seed), MP_ROM_PTR(&random_seed_obj) },
@@ -176,6 +187,9 @@ STATIC const mp_rom_map_elem_t mp_module_random_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_choice), MP_ROM_PTR(&random_choice_obj) },
     { MP_ROM_QSTR(MP_QSTR_random), MP_ROM_PTR(&random_random_obj) },
     { MP_ROM_QSTR(MP_QSTR_uniform), MP_ROM_PTR(&random_uniform_obj) },
+    { MP_ROM_QSTR(MP_QSTR_randbytes), MP_ROM_PTR(&random_randbytes_obj) },
+    { MP_ROM_QSTR(MP_QSTR_fill), MP_ROM_PTR(&random_fill_obj) },
+    { MP_ROM_QSTR(MP_QSTR_Random), MP_ROM_PTR(&random_random_type) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_random_globals, mp_module_random_globals_table);
@@ -0,0 +1,394 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-bindings/ringbuffer/RingBuffer.h"
+
+#include "py/mperrno.h"
+#include "py/objproperty.h"
+#include "py/runtime.h"
+#include "py/stream.h"
+#include "supervisor/shared/translate.h"
+
+//| class RingBuffer:
+//|     """A buffer for passing data from one context to another
+//|
+//|     One producer and one consumer may use a `RingBuffer` at the same time
+//|     without locking, for example a `micropython.schedule` callback or an
+//|     interrupt handler putting data and the main loop getting it.
+//|     `put_from`, `get_into`, ``readinto``, ``write``, `peek`, `release`,
+//|     `reserve` and `commit` don't allocate, so they may be used where the
+//|     heap is locked; ``read`` returns a new `bytes`.
+//|
+//|     A `RingBuffer` holds either a stream of bytes or whole records of up
+//|     to ``record_size`` bytes each.  It is also a non-blocking stream, so
+//|     ``read``, ``readinto`` and ``write`` work, as do `select.poll` and
+//|     anything else that takes a stream.  Reading from an empty buffer or
+//|     writing to a full one returns `None`."""
+//|
+//|     def __init__(self, size: int, *, record_size: int = 0) -> None:
+//|         """Creates an empty buffer.
+//|
+//|         :param int size: the number of bytes to hold, rounded up to a power of
+//|           two, or the number of records if ``record_size`` is given
+//|         :param int record_size: the largest record, or 0 for a byte stream"""
+//|         ...
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_make_new(const mp_obj_type_t *type, size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_size, ARG_record_size };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_size, MP_ARG_REQUIRED | MP_ARG_INT },
+        { MP_QSTR_record_size, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_int_t size = args[ARG_size].u_int;
+    mp_int_t record_size = args[ARG_record_size].u_int;
+    if (record_size < 0 || record_size > 0x10000) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_record_size);
+    }
+    if (size < 1 || size > (1 << 30) / (record_size + 8)) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_size);
+    }
+
+    ringbuffer_ringbuffer_obj_t *self = m_new_obj(ringbuffer_ringbuffer_obj_t);
+    self->base.type = type;
+    common_hal_ringbuffer_ringbuffer_construct(self, size, record_size);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// Checks the length of a record to put or reserve.
+STATIC void check_record_len(ringbuffer_ringbuffer_obj_t *self, size_t len) {
+    size_t record_size = common_hal_ringbuffer_ringbuffer_get_record_size(self);
+    if (record_size > 0 && (len == 0 || len > record_size)) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_record_size);
+    }
+}
+
+//|     def put_from(self, buffer: ReadableBuffer) -> int:
+//|         """Copies as much of ``buffer`` in as fits and returns how many bytes
+//|         that was.  With records, ``buffer`` is one record and either all of it
+//|         is copied or, if there is no room, none of it."""
+//|         ...
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_put_from(mp_obj_t self_in, mp_obj_t buffer) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer, &bufinfo, MP_BUFFER_READ);
+    check_record_len(self, bufinfo.len);
+    return MP_OBJ_NEW_SMALL_INT(common_hal_ringbuffer_ringbuffer_put_from(self, bufinfo.buf, bufinfo.len));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(ringbuffer_ringbuffer_put_from_obj, ringbuffer_ringbuffer_put_from);
+
+//|     def get_into(self, buffer: WriteableBuffer) -> int:
+//|         """Copies as many bytes as fit into ``buffer`` and returns how many
+//|         that was, 0 if the buffer is empty.  With records, one record is
+//|         copied; `ValueError` is raised, and the record kept, if it doesn't
+//|         fit."""
+//|         ...
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_get_into(mp_obj_t self_in, mp_obj_t buffer) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer, &bufinfo, MP_BUFFER_WRITE);
+    bool too_small;
+    size_t len = common_hal_ringbuffer_ringbuffer_get_into(self, bufinfo.buf, bufinfo.len, &too_small);
+    if (too_small) {
+        mp_raise_ValueError(translate("Buffer is too small"));
+    }
+    return MP_OBJ_NEW_SMALL_INT(len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(ringbuffer_ringbuffer_get_into_obj, ringbuffer_ringbuffer_get_into);
+
+//|     def peek(self) -> Optional[memoryview]:
+//|         """Returns the oldest data in place, without copying it, or `None` if
+//|         the buffer is empty.  With bytes this is as much as is contiguous in
+//|         memory, which may not be everything; with records it is the oldest
+//|         record.  Call `release` when done with it.  The same memoryview is
+//|         returned every time, and it is emptied by `release`.  It keeps the
+//|         buffer's storage alive, but its contents may be overwritten once
+//|         released."""
+//|         ...
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_peek(mp_obj_t self_in) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return common_hal_ringbuffer_ringbuffer_peek(self);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(ringbuffer_ringbuffer_peek_obj, ringbuffer_ringbuffer_peek);
+
+//|     def release(self, nbytes: Optional[int] = None) -> None:
+//|         """Removes what `peek` returned, or only its first ``nbytes`` bytes.
+//|         A record is always removed whole."""
+//|         ...
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_release(size_t n_args, const mp_obj_t *args) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    size_t peeked = common_hal_ringbuffer_ringbuffer_get_peeked(self);
+    size_t len = peeked;
+    if (n_args > 1 && args[1] != mp_const_none) {
+        mp_int_t nbytes = mp_obj_get_int(args[1]);
+        if (nbytes < 0 || (size_t)nbytes > peeked ||
+            (common_hal_ringbuffer_ringbuffer_get_record_size(self) > 0 && (size_t)nbytes != peeked)) {
+            mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_nbytes);
+        }
+        len = nbytes;
+    }
+    if (peeked == 0) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_nbytes);
+    }
+    common_hal_ringbuffer_ringbuffer_release(self, len);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(ringbuffer_ringbuffer_release_obj, 1, 2, ringbuffer_ringbuffer_release);
+
+//|     def reserve(self, nbytes: int) -> Optional[memoryview]:
+//|         """Returns free space to fill in place, or `None` if there is none.
+//|         With bytes this is up to ``nbytes`` of contiguous space, which may be
+//|         less; with records it is exactly ``nbytes``, for one record.  Nothing
+//|         written there is seen by the consumer until `commit`.  The same
+//|         memoryview is returned every time, and it is emptied by `commit`.
+//|         It keeps the buffer's storage alive on its own."""
+//|         ...
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_reserve(mp_obj_t self_in, mp_obj_t nbytes_in) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_int_t nbytes = mp_obj_get_int(nbytes_in);
+    if (nbytes < 0) {
+        mp_raise_ValueError_varg(translate("%q must be >= 0"), MP_QSTR_nbytes);
+    }
+    check_record_len(self, nbytes);
+    return common_hal_ringbuffer_ringbuffer_reserve(self, nbytes);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(ringbuffer_ringbuffer_reserve_obj, ringbuffer_ringbuffer_reserve);
+
+//|     def commit(self, nbytes: Optional[int] = None) -> None:
+//|         """Passes what `reserve` returned, or only its first ``nbytes`` bytes,
+//|         to the consumer.  A record is always committed whole."""
+//|         ...
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_commit(size_t n_args, const mp_obj_t *args) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    size_t reserved = common_hal_ringbuffer_ringbuffer_get_reserved(self);
+    size_t len = reserved;
+    if (n_args > 1 && args[1] != mp_const_none) {
+        mp_int_t nbytes = mp_obj_get_int(args[1]);
+        if (nbytes < 0 || (size_t)nbytes > reserved ||
+            (common_hal_ringbuffer_ringbuffer_get_record_size(self) > 0 && (size_t)nbytes != reserved)) {
+            mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_nbytes);
+        }
+        len = nbytes;
+    }
+    if (reserved == 0) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_nbytes);
+    }
+    common_hal_ringbuffer_ringbuffer_commit(self, len);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(ringbuffer_ringbuffer_commit_obj, 1, 2, ringbuffer_ringbuffer_commit);
+
+//|     def clear(self) -> None:
+//|         """Removes everything.  Only the consumer may call this."""
+//|         ...
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_clear(mp_obj_t self_in) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    common_hal_ringbuffer_ringbuffer_clear(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(ringbuffer_ringbuffer_clear_obj, ringbuffer_ringbuffer_clear);
+
+//|     in_waiting: int
+//|     """The number of bytes, or records, waiting to be read (read-only)"""
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_get_in_waiting(mp_obj_t self_in) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return MP_OBJ_NEW_SMALL_INT(common_hal_ringbuffer_ringbuffer_get_in_waiting(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(ringbuffer_ringbuffer_get_in_waiting_obj, ringbuffer_ringbuffer_get_in_waiting);
+
+const mp_obj_property_t ringbuffer_ringbuffer_in_waiting_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&ringbuffer_ringbuffer_get_in_waiting_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     capacity: int
+//|     """The size of the storage in bytes (read-only)"""
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_get_capacity(mp_obj_t self_in) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return MP_OBJ_NEW_SMALL_INT(common_hal_ringbuffer_ringbuffer_get_capacity(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(ringbuffer_ringbuffer_get_capacity_obj, ringbuffer_ringbuffer_get_capacity);
+
+const mp_obj_property_t ringbuffer_ringbuffer_capacity_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&ringbuffer_ringbuffer_get_capacity_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     record_size: int
+//|     """The largest record, or 0 for a byte stream (read-only)"""
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_get_record_size(mp_obj_t self_in) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return MP_OBJ_NEW_SMALL_INT(common_hal_ringbuffer_ringbuffer_get_record_size(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(ringbuffer_ringbuffer_get_record_size_obj, ringbuffer_ringbuffer_get_record_size);
+
+const mp_obj_property_t ringbuffer_ringbuffer_record_size_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&ringbuffer_ringbuffer_get_record_size_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+// Stream protocol. Records are read and written one per call.
+STATIC mp_uint_t ringbuffer_ringbuffer_stream_read(mp_obj_t self_in, void *buf_in, mp_uint_t size, int *errcode) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (size == 0) {
+        return 0;
+    }
+    bool too_small;
+    size_t len = common_hal_ringbuffer_ringbuffer_get_into(self, buf_in, size, &too_small);
+    if (too_small) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    if (len == 0) {
+        *errcode = MP_EAGAIN;
+        return MP_STREAM_ERROR;
+    }
+    return len;
+}
+
+STATIC mp_uint_t ringbuffer_ringbuffer_stream_write(mp_obj_t self_in, const void *buf_in, mp_uint_t size, int *errcode) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (size == 0) {
+        return 0;
+    }
+    size_t record_size = common_hal_ringbuffer_ringbuffer_get_record_size(self);
+    if (record_size > 0 && size > record_size) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    size_t len = common_hal_ringbuffer_ringbuffer_put_from(self, buf_in, size);
+    if (len == 0) {
+        *errcode = MP_EAGAIN;
+        return MP_STREAM_ERROR;
+    }
+    return len;
+}
+
+STATIC mp_uint_t ringbuffer_ringbuffer_stream_ioctl(mp_obj_t self_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    ringbuffer_ringbuffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (request == MP_STREAM_POLL) {
+        mp_uint_t ret = 0;
+        if ((arg & MP_STREAM_POLL_RD) && common_hal_ringbuffer_ringbuffer_get_in_waiting(self) > 0) {
+            ret |= MP_STREAM_POLL_RD;
+        }
+        if ((arg & MP_STREAM_POLL_WR) && common_hal_ringbuffer_ringbuffer_can_put(self)) {
+            ret |= MP_STREAM_POLL_WR;
+        }
+        return ret;
+    }
+    *errcode = MP_EINVAL;
+    return MP_STREAM_ERROR;
+}
+
+//|     def read(self, nbytes: Optional[int] = None) -> Optional[bytes]:
+//|         """Reads up to ``nbytes`` bytes, or one record, and returns them, or
+//|         `None` if the buffer is empty.  Without ``nbytes`` everything waiting
+//|         is read, with records run together."""
+//|         ...
+//|
+//|     def readinto(self, buffer: WriteableBuffer, nbytes: Optional[int] = None) -> Optional[int]:
+//|         """Reads up to ``nbytes`` bytes, or one record, into ``buffer`` and
+//|         returns how many that was, or `None` if the buffer is empty."""
+//|         ...
+//|
+STATIC mp_obj_t ringbuffer_ringbuffer_readinto(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_WRITE);
+    size_t len = bufinfo.len;
+    if (n_args > 2) {
+        len = MIN(len, (size_t)mp_obj_get_int(args[2]));
+    }
+    // Unlike mp_stream_readinto_obj this reads once, so it stops after a record.
+    int errcode;
+    mp_uint_t out_sz = ringbuffer_ringbuffer_stream_read(args[0], bufinfo.buf, len, &errcode);
+    if (out_sz == MP_STREAM_ERROR) {
+        if (mp_is_nonblocking_error(errcode)) {
+            return mp_const_none;
+        }
+        mp_raise_OSError(errcode);
+    }
+    return MP_OBJ_NEW_SMALL_INT(out_sz);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(ringbuffer_ringbuffer_readinto_obj, 2, 3, ringbuffer_ringbuffer_readinto);
+
+//|     def write(self, buffer: ReadableBuffer) -> Optional[int]:
+//|         """Writes as much of ``buffer`` as fits, or it as one record, and
+//|         returns how many bytes that was, or `None` if the buffer is full."""
+//|         ...
+//|
+
+STATIC const mp_rom_map_elem_t ringbuffer_ringbuffer_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_put_from), MP_ROM_PTR(&ringbuffer_ringbuffer_put_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_into), MP_ROM_PTR(&ringbuffer_ringbuffer_get_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_peek), MP_ROM_PTR(&ringbuffer_ringbuffer_peek_obj) },
+    { MP_ROM_QSTR(MP_QSTR_release), MP_ROM_PTR(&ringbuffer_ringbuffer_release_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reserve), MP_ROM_PTR(&ringbuffer_ringbuffer_reserve_obj) },
+    { MP_ROM_QSTR(MP_QSTR_commit), MP_ROM_PTR(&ringbuffer_ringbuffer_commit_obj) },
+    { MP_ROM_QSTR(MP_QSTR_clear), MP_ROM_PTR(&ringbuffer_ringbuffer_clear_obj) },
+    { MP_ROM_QSTR(MP_QSTR_in_waiting), MP_ROM_PTR(&ringbuffer_ringbuffer_in_waiting_obj) },
+    { MP_ROM_QSTR(MP_QSTR_capacity), MP_ROM_PTR(&ringbuffer_ringbuffer_capacity_obj) },
+    { MP_ROM_QSTR(MP_QSTR_record_size), MP_ROM_PTR(&ringbuffer_ringbuffer_record_size_obj) },
+
+    // Stream methods. read and readinto stop after one record.
+    { MP_ROM_QSTR(MP_QSTR_read), MP_ROM_PTR(&mp_stream_read1_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readinto), MP_ROM_PTR(&ringbuffer_ringbuffer_readinto_obj) },
+    { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&mp_stream_write_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(ringbuffer_ringbuffer_locals_dict, ringbuffer_ringbuffer_locals_dict_table);
+
+STATIC const mp_stream_p_t ringbuffer_ringbuffer_stream_p = {
+    MP_PROTO_IMPLEMENT(MP_QSTR_protocol_stream)
+    .read = ringbuffer_ringbuffer_stream_read,
+    .write = ringbuffer_ringbuffer_stream_write,
+    .ioctl = ringbuffer_ringbuffer_stream_ioctl,
+    .is_text = false,
+};
+
+const mp_obj_type_t ringbuffer_ringbuffer_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_RingBuffer,
+    .make_new = ringbuffer_ringbuffer_make_new,
+    .protocol = &ringbuffer_ringbuffer_stream_p,
+    .locals_dict = (mp_obj_dict_t*)&ringbuffer_ringbuffer_locals_dict,
+};
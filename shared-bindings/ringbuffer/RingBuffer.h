@@ -0,0 +1,49 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_BINDINGS_RINGBUFFER_RINGBUFFER_H
+#define MICROPY_INCLUDED_SHARED_BINDINGS_RINGBUFFER_RINGBUFFER_H
+
+#include "shared-module/ringbuffer/RingBuffer.h"
+
+extern const mp_obj_type_t ringbuffer_ringbuffer_type;
+
+void common_hal_ringbuffer_ringbuffer_construct(ringbuffer_ringbuffer_obj_t *self, size_t size, size_t record_size);
+size_t common_hal_ringbuffer_ringbuffer_get_capacity(ringbuffer_ringbuffer_obj_t *self);
+size_t common_hal_ringbuffer_ringbuffer_get_record_size(ringbuffer_ringbuffer_obj_t *self);
+size_t common_hal_ringbuffer_ringbuffer_get_in_waiting(ringbuffer_ringbuffer_obj_t *self);
+bool common_hal_ringbuffer_ringbuffer_can_put(ringbuffer_ringbuffer_obj_t *self);
+size_t common_hal_ringbuffer_ringbuffer_put_from(ringbuffer_ringbuffer_obj_t *self, const uint8_t *data, size_t len);
+size_t common_hal_ringbuffer_ringbuffer_get_into(ringbuffer_ringbuffer_obj_t *self, uint8_t *data, size_t len, bool *too_small);
+mp_obj_t common_hal_ringbuffer_ringbuffer_peek(ringbuffer_ringbuffer_obj_t *self);
+size_t common_hal_ringbuffer_ringbuffer_get_peeked(ringbuffer_ringbuffer_obj_t *self);
+void common_hal_ringbuffer_ringbuffer_release(ringbuffer_ringbuffer_obj_t *self, size_t len);
+mp_obj_t common_hal_ringbuffer_ringbuffer_reserve(ringbuffer_ringbuffer_obj_t *self, size_t len);
+size_t common_hal_ringbuffer_ringbuffer_get_reserved(ringbuffer_ringbuffer_obj_t *self);
+void common_hal_ringbuffer_ringbuffer_commit(ringbuffer_ringbuffer_obj_t *self, size_t len);
+void common_hal_ringbuffer_ringbuffer_clear(ringbuffer_ringbuffer_obj_t *self);
+
+#endif // MICROPY_INCLUDED_SHARED_BINDINGS_RINGBUFFER_RINGBUFFER_H
@@ -0,0 +1,62 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/obj.h"
+#include "py/runtime.h"
+
+#include "shared-bindings/ringbuffer/RingBuffer.h"
+
+//| """Lock-free single-producer, single-consumer buffers
+//|
+//| The `ringbuffer` module passes data between a producer and a consumer
+//| running in different contexts, such as a scheduled callback and the main
+//| loop, without allocating or locking::
+//|
+//|   import micropython
+//|   import ringbuffer
+//|
+//|   samples = ringbuffer.RingBuffer(64, record_size=4)
+//|
+//|   def on_sample(value):
+//|       samples.put_from(value)
+//|
+//|   buf = bytearray(4)
+//|   while True:
+//|       if samples.get_into(buf):
+//|           process(buf)"""
+//|
+
+STATIC const mp_rom_map_elem_t ringbuffer_module_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ringbuffer) },
+    { MP_ROM_QSTR(MP_QSTR_RingBuffer), MP_ROM_PTR(&ringbuffer_ringbuffer_type) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(ringbuffer_module_globals, ringbuffer_module_globals_table);
+
+const mp_obj_module_t ringbuffer_module = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&ringbuffer_module_globals,
+};
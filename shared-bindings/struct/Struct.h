@@ -0,0 +1,41 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_BINDINGS_STRUCT_STRUCT_H
+#define MICROPY_INCLUDED_SHARED_BINDINGS_STRUCT_STRUCT_H
+
+#include "py/objtuple.h"
+#include "shared-module/struct/Struct.h"
+
+extern const mp_obj_type_t struct_struct_type;
+
+struct_struct_obj_t *shared_modules_struct_struct_compile(mp_obj_t fmt_in);
+struct_struct_obj_t *shared_modules_struct_struct_lookup(mp_obj_t fmt_in);
+void shared_modules_struct_struct_pack_into(struct_struct_obj_t *self, byte *p, byte *end_p, size_t n_args, const mp_obj_t *args);
+mp_obj_tuple_t *shared_modules_struct_struct_unpack_from(struct_struct_obj_t *self, const byte *p, const byte *end_p, bool exact_size);
+mp_obj_t shared_modules_struct_struct_iter_unpack(struct_struct_obj_t *self, mp_obj_t buffer);
+
+#endif // MICROPY_INCLUDED_SHARED_BINDINGS_STRUCT_STRUCT_H
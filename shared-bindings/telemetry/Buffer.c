@@ -0,0 +1,337 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-bindings/telemetry/Buffer.h"
+#include "shared-bindings/util.h"
+
+#include "lib/utils/context_manager_helpers.h"
+#include "py/objproperty.h"
+#include "py/objtuple.h"
+#include "py/runtime.h"
+#include "supervisor/shared/translate.h"
+
+//| class Buffer:
+//|     """Records telemetry samples and sends them in compact batches
+//|
+//|     Samples are delta and varint encoded into a ring as they are recorded,
+//|     counters and histograms are kept in C, and everything gathered is
+//|     written to a stream as one batch every ``interval`` seconds.  The wire
+//|     format is described in ``shared-module/telemetry/Buffer.h``."""
+//|
+//|     def __init__(self, stream: Any, keys: Sequence[str], *, capacity: int = 1024, interval: float = 1.0, histogram_buckets: int = 16) -> None:
+//|         """Creates a buffer that sends to ``stream``.
+//|
+//|         :param stream: where to send batches: a socket, `busio.UART`, or any
+//|           stream, or an object with a ``send`` or ``write`` method.  Only streams
+//|           are written from the background; other objects are written when
+//|           samples are recorded or on `flush`.  A stream that is closed or
+//|           deinited stops being written from the background until `stream`
+//|           is set again.
+//|         :param Sequence[str] keys: the names of the values being reported.
+//|           Methods take a key as an index into this sequence.  The names are
+//|           sent once, ahead of the first batch, rather than with every sample.
+//|         :param int capacity: bytes of encoded samples to hold between batches.
+//|           A batch is sent early when the buffer fills.
+//|         :param float interval: seconds between batches, or 0 to only send on `flush`
+//|         :param int histogram_buckets: power of two buckets per key for `observe`"""
+//|         ...
+//|
+STATIC mp_obj_t telemetry_buffer_make_new(const mp_obj_type_t *type, size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_stream, ARG_keys, ARG_capacity, ARG_interval, ARG_histogram_buckets };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_stream, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_keys, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_capacity, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 1024} },
+        { MP_QSTR_interval, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_histogram_buckets, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 16} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t keys = mp_obj_new_tuple(0, NULL);
+    mp_obj_t iterable = mp_getiter(args[ARG_keys].u_obj, NULL);
+    mp_obj_t item;
+    size_t n_keys = 0;
+    while ((item = mp_iternext(iterable)) != MP_OBJ_STOP_ITERATION) {
+        if (!MP_OBJ_IS_STR(item)) {
+            mp_raise_TypeError_varg(translate("Expected a %q"), MP_QSTR_str);
+        }
+        n_keys++;
+    }
+    if (n_keys == 0 || n_keys > 0x4000) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_keys);
+    }
+    keys = mp_obj_new_tuple(n_keys, NULL);
+    iterable = mp_getiter(args[ARG_keys].u_obj, NULL);
+    for (size_t i = 0; i < n_keys; i++) {
+        ((mp_obj_tuple_t *)MP_OBJ_TO_PTR(keys))->items[i] = mp_iternext(iterable);
+    }
+
+    mp_int_t capacity = args[ARG_capacity].u_int;
+    if (capacity < 64) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_capacity);
+    }
+    mp_float_t interval = args[ARG_interval].u_obj == MP_OBJ_NULL ? MICROPY_FLOAT_CONST(1.0) : mp_obj_get_float(args[ARG_interval].u_obj);
+    if (interval < 0 || interval > 86400) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_interval);
+    }
+    mp_int_t n_buckets = args[ARG_histogram_buckets].u_int;
+    if (n_buckets < 0 || n_buckets > 65) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_histogram_buckets);
+    }
+
+    telemetry_buffer_obj_t *self = m_new_obj(telemetry_buffer_obj_t);
+    self->base.type = type;
+    common_hal_telemetry_buffer_construct(self, args[ARG_stream].u_obj, keys, capacity,
+        (uint32_t)(interval * 1000), n_buckets);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+STATIC telemetry_buffer_obj_t *get_buffer(mp_obj_t self_in) {
+    telemetry_buffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (common_hal_telemetry_buffer_deinited(self)) {
+        raise_deinited_error();
+    }
+    return self;
+}
+
+STATIC size_t get_key(telemetry_buffer_obj_t *self, mp_obj_t key_in) {
+    mp_int_t key = mp_obj_get_int(key_in);
+    if (key < 0 || key >= self->n_keys) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_key);
+    }
+    return key;
+}
+
+//|     def deinit(self) -> None:
+//|         """Stops sending batches and frees the buffer.  Samples not yet sent
+//|         are lost; call `flush` first to send them."""
+//|         ...
+//|
+STATIC mp_obj_t telemetry_buffer_deinit(mp_obj_t self_in) {
+    telemetry_buffer_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    common_hal_telemetry_buffer_deinit(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(telemetry_buffer_deinit_obj, telemetry_buffer_deinit);
+
+//|     def __enter__(self) -> Buffer:
+//|         """No-op used by Context Managers."""
+//|         ...
+//|
+//  Provided by context manager helper.
+
+//|     def __exit__(self) -> None:
+//|         """Automatically deinitializes when exiting a context. See
+//|         :ref:`lifetime-and-contextmanagers` for more info."""
+//|         ...
+//|
+STATIC mp_obj_t telemetry_buffer_obj___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    common_hal_telemetry_buffer_deinit(MP_OBJ_TO_PTR(args[0]));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(telemetry_buffer___exit___obj, 4, 4, telemetry_buffer_obj___exit__);
+
+//|     def record(self, key: int, value: Union[int, float]) -> None:
+//|         """Records a timestamped sample.  An int is sent as the difference
+//|         from the key's previous sample, usually a single byte, and a float
+//|         as four bytes."""
+//|         ...
+//|
+STATIC mp_obj_t telemetry_buffer_record(mp_obj_t self_in, mp_obj_t key_in, mp_obj_t value) {
+    telemetry_buffer_obj_t *self = get_buffer(self_in);
+    size_t key = get_key(self, key_in);
+    #if MICROPY_PY_BUILTINS_FLOAT
+    if (mp_obj_is_float(value)) {
+        common_hal_telemetry_buffer_record_float(self, key, mp_obj_get_float(value));
+        return mp_const_none;
+    }
+    #endif
+    common_hal_telemetry_buffer_record_int(self, key, mp_obj_get_int(value));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(telemetry_buffer_record_obj, telemetry_buffer_record);
+
+//|     def count(self, key: int, n: int = 1) -> None:
+//|         """Adds ``n`` to the key's counter.  Only the total since the last
+//|         batch is sent."""
+//|         ...
+//|
+STATIC mp_obj_t telemetry_buffer_count(size_t n_args, const mp_obj_t *args) {
+    telemetry_buffer_obj_t *self = get_buffer(args[0]);
+    size_t key = get_key(self, args[1]);
+    common_hal_telemetry_buffer_count(self, key, n_args > 2 ? mp_obj_get_int(args[2]) : 1);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(telemetry_buffer_count_obj, 2, 3, telemetry_buffer_count);
+
+//|     def observe(self, key: int, value: Union[int, float]) -> None:
+//|         """Counts ``value`` in the key's histogram.  Bucket 0 counts values up
+//|         to 0, bucket ``b`` counts values from ``2**(b-1)`` up to ``2**b`` and
+//|         the last bucket counts everything larger.  Only the counts since the
+//|         last batch are sent."""
+//|         ...
+//|
+STATIC mp_obj_t telemetry_buffer_observe(mp_obj_t self_in, mp_obj_t key_in, mp_obj_t value) {
+    telemetry_buffer_obj_t *self = get_buffer(self_in);
+    size_t key = get_key(self, key_in);
+    mp_int_t v;
+    #if MICROPY_PY_BUILTINS_FLOAT
+    if (mp_obj_is_float(value)) {
+        v = (mp_int_t)mp_obj_get_float(value);
+    } else
+    #endif
+    {
+        v = mp_obj_get_int(value);
+    }
+    common_hal_telemetry_buffer_observe(self, key, v);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(telemetry_buffer_observe_obj, telemetry_buffer_observe);
+
+//|     def flush(self) -> bool:
+//|         """Sends what has been gathered as a batch now.  Returns False if
+//|         the stream could not take all of it yet, in which case the rest is
+//|         sent later.  Raises the stream's error if writing fails; the batch is
+//|         then dropped."""
+//|         ...
+//|
+STATIC mp_obj_t telemetry_buffer_flush(mp_obj_t self_in) {
+    telemetry_buffer_obj_t *self = get_buffer(self_in);
+    return mp_obj_new_bool(common_hal_telemetry_buffer_flush(self));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(telemetry_buffer_flush_obj, telemetry_buffer_flush);
+
+//|     stream: Any
+//|     """Where batches are sent.  Setting it drops anything partly sent to the
+//|     old stream and sends the key names again ahead of the next batch."""
+//|
+STATIC mp_obj_t telemetry_buffer_get_stream(mp_obj_t self_in) {
+    return common_hal_telemetry_buffer_get_stream(get_buffer(self_in));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(telemetry_buffer_get_stream_obj, telemetry_buffer_get_stream);
+
+STATIC mp_obj_t telemetry_buffer_set_stream(mp_obj_t self_in, mp_obj_t stream) {
+    common_hal_telemetry_buffer_set_stream(get_buffer(self_in), stream);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(telemetry_buffer_set_stream_obj, telemetry_buffer_set_stream);
+
+const mp_obj_property_t telemetry_buffer_stream_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&telemetry_buffer_get_stream_obj,
+              (mp_obj_t)&telemetry_buffer_set_stream_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     interval: float
+//|     """Seconds between batches, or 0 to only send on `flush`"""
+//|
+STATIC mp_obj_t telemetry_buffer_get_interval(mp_obj_t self_in) {
+    return mp_obj_new_float(common_hal_telemetry_buffer_get_interval(get_buffer(self_in)));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(telemetry_buffer_get_interval_obj, telemetry_buffer_get_interval);
+
+STATIC mp_obj_t telemetry_buffer_set_interval(mp_obj_t self_in, mp_obj_t interval_in) {
+    telemetry_buffer_obj_t *self = get_buffer(self_in);
+    mp_float_t interval = mp_obj_get_float(interval_in);
+    if (interval < 0 || interval > 86400) {
+        mp_raise_ValueError_varg(translate("%q out of range"), MP_QSTR_interval);
+    }
+    common_hal_telemetry_buffer_set_interval(self, (uint32_t)(interval * 1000));
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(telemetry_buffer_set_interval_obj, telemetry_buffer_set_interval);
+
+const mp_obj_property_t telemetry_buffer_interval_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&telemetry_buffer_get_interval_obj,
+              (mp_obj_t)&telemetry_buffer_set_interval_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     keys: Tuple[str, ...]
+//|     """The key names (read-only)"""
+//|
+STATIC mp_obj_t telemetry_buffer_get_keys(mp_obj_t self_in) {
+    return common_hal_telemetry_buffer_get_keys(get_buffer(self_in));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(telemetry_buffer_get_keys_obj, telemetry_buffer_get_keys);
+
+const mp_obj_property_t telemetry_buffer_keys_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&telemetry_buffer_get_keys_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|     stats: Tuple[int, int, int, int]
+//|     """(batches, bytes_sent, dropped, errors): the batches made, the bytes
+//|     written to the stream, the samples dropped because the buffer was full
+//|     and the writes that failed (read-only)"""
+//|
+STATIC mp_obj_t telemetry_buffer_get_stats(mp_obj_t self_in) {
+    uint32_t batches, bytes_sent, dropped, errors;
+    common_hal_telemetry_buffer_get_stats(get_buffer(self_in), &batches, &bytes_sent, &dropped, &errors);
+    mp_obj_t items[4] = {
+        mp_obj_new_int_from_uint(batches),
+        mp_obj_new_int_from_uint(bytes_sent),
+        mp_obj_new_int_from_uint(dropped),
+        mp_obj_new_int_from_uint(errors),
+    };
+    return mp_obj_new_tuple(4, items);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(telemetry_buffer_get_stats_obj, telemetry_buffer_get_stats);
+
+const mp_obj_property_t telemetry_buffer_stats_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&telemetry_buffer_get_stats_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC const mp_rom_map_elem_t telemetry_buffer_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&telemetry_buffer_deinit_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&default___enter___obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&telemetry_buffer___exit___obj) },
+    { MP_ROM_QSTR(MP_QSTR_record), MP_ROM_PTR(&telemetry_buffer_record_obj) },
+    { MP_ROM_QSTR(MP_QSTR_count), MP_ROM_PTR(&telemetry_buffer_count_obj) },
+    { MP_ROM_QSTR(MP_QSTR_observe), MP_ROM_PTR(&telemetry_buffer_observe_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&telemetry_buffer_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stream), MP_ROM_PTR(&telemetry_buffer_stream_obj) },
+    { MP_ROM_QSTR(MP_QSTR_interval), MP_ROM_PTR(&telemetry_buffer_interval_obj) },
+    { MP_ROM_QSTR(MP_QSTR_keys), MP_ROM_PTR(&telemetry_buffer_keys_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&telemetry_buffer_stats_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(telemetry_buffer_locals_dict, telemetry_buffer_locals_dict_table);
+
+const mp_obj_type_t telemetry_buffer_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Buffer,
+    .make_new = telemetry_buffer_make_new,
+    .locals_dict = (mp_obj_dict_t*)&telemetry_buffer_locals_dict,
+};
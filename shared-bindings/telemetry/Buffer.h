@@ -0,0 +1,49 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_BINDINGS_TELEMETRY_BUFFER_H
+#define MICROPY_INCLUDED_SHARED_BINDINGS_TELEMETRY_BUFFER_H
+
+#include "shared-module/telemetry/Buffer.h"
+
+extern const mp_obj_type_t telemetry_buffer_type;
+
+void common_hal_telemetry_buffer_construct(telemetry_buffer_obj_t *self, mp_obj_t stream, mp_obj_t keys, size_t capacity, uint32_t interval_ms, uint8_t n_buckets);
+void common_hal_telemetry_buffer_deinit(telemetry_buffer_obj_t *self);
+bool common_hal_telemetry_buffer_deinited(telemetry_buffer_obj_t *self);
+void common_hal_telemetry_buffer_record_int(telemetry_buffer_obj_t *self, size_t key, mp_int_t value);
+void common_hal_telemetry_buffer_record_float(telemetry_buffer_obj_t *self, size_t key, mp_float_t value);
+void common_hal_telemetry_buffer_count(telemetry_buffer_obj_t *self, size_t key, mp_int_t n);
+void common_hal_telemetry_buffer_observe(telemetry_buffer_obj_t *self, size_t key, mp_int_t value);
+bool common_hal_telemetry_buffer_flush(telemetry_buffer_obj_t *self);
+mp_obj_t common_hal_telemetry_buffer_get_stream(telemetry_buffer_obj_t *self);
+void common_hal_telemetry_buffer_set_stream(telemetry_buffer_obj_t *self, mp_obj_t stream);
+mp_float_t common_hal_telemetry_buffer_get_interval(telemetry_buffer_obj_t *self);
+void common_hal_telemetry_buffer_set_interval(telemetry_buffer_obj_t *self, uint32_t interval_ms);
+mp_obj_t common_hal_telemetry_buffer_get_keys(telemetry_buffer_obj_t *self);
+void common_hal_telemetry_buffer_get_stats(telemetry_buffer_obj_t *self, uint32_t *batches, uint32_t *bytes_sent, uint32_t *dropped, uint32_t *errors);
+
+#endif // MICROPY_INCLUDED_SHARED_BINDINGS_TELEMETRY_BUFFER_H
@@ -0,0 +1,60 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/obj.h"
+#include "py/runtime.h"
+
+#include "shared-bindings/telemetry/Buffer.h"
+
+//| """Batched binary telemetry
+//|
+//| The `telemetry` module gathers samples, counters and histograms in C and
+//| sends them to a stream in compact batches, instead of formatting and
+//| sending a message per sample.  For example::
+//|
+//|   import telemetry
+//|
+//|   KEYPRESSES, BATTERY, LATENCY = range(3)
+//|   t = telemetry.Buffer(uart, ("keypresses", "battery", "latency"), interval=5)
+//|   t.count(KEYPRESSES)
+//|   t.record(BATTERY, 3.91)
+//|   t.observe(LATENCY, 12)
+//|
+//| On CircuitPython batches are sent from the background as well as when
+//| samples are recorded, so a quiet device still reports on time."""
+//|
+
+STATIC const mp_rom_map_elem_t telemetry_module_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_telemetry) },
+    { MP_ROM_QSTR(MP_QSTR_Buffer), MP_ROM_PTR(&telemetry_buffer_type) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(telemetry_module_globals, telemetry_module_globals_table);
+
+const mp_obj_module_t telemetry_module = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&telemetry_module_globals,
+};
@@ -0,0 +1,96 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "shared-module/_bleio/PacketQueue.h"
+
+void bleio_packet_queue_init(bleio_packet_queue_t *queue) {
+    memset(queue, 0, sizeof(*queue));
+}
+
+// Room for packets records of max_packet_length bytes, plus one more for the
+// space a record can waste when it doesn't fit before the end of the ring.
+bool bleio_packet_queue_alloc(bleio_packet_queue_t *queue, size_t packets, size_t max_packet_length) {
+    size_t record_size = sizeof(uint32_t) + ((max_packet_length + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1));
+    return ringbuf_alloc(&queue->ring, (packets + 1) * record_size, false);
+}
+
+bool bleio_packet_queue_allocated(bleio_packet_queue_t *queue) {
+    return queue->ring.buf != NULL;
+}
+
+bool bleio_packet_queue_is_empty(bleio_packet_queue_t *queue) {
+    size_t len;
+    return ringbuf_record_peek(&queue->ring, &len) == NULL;
+}
+
+// Queue one packet made of header followed by data. Returns false if there
+// isn't room for it.
+bool bleio_packet_queue_put(bleio_packet_queue_t *queue, const uint8_t *header, size_t header_len, const uint8_t *data, size_t len) {
+    uint8_t *p = ringbuf_record_reserve(&queue->ring, header_len + len);
+    if (p == NULL) {
+        return false;
+    }
+    memcpy(p, header, header_len);
+    memcpy(p + header_len, data, len);
+    ringbuf_record_commit(&queue->ring, header_len + len);
+    queue->queued++;
+    return true;
+}
+
+// Hand queued packets to the stack, oldest first, until it runs out of
+// transmit buffers or the queue is empty. Calling this from every TX complete
+// event fills all the buffers the stack has free in each connection event.
+// Only one caller may flush at a time. Returns the number of packets sent.
+size_t bleio_packet_queue_flush(bleio_packet_queue_t *queue, bleio_packet_queue_send_t send, void *context) {
+    size_t sent = 0;
+    size_t len;
+    const uint8_t *p;
+    while ((p = ringbuf_record_peek(&queue->ring, &len)) != NULL) {
+        bleio_packet_send_result_t result = send(context, p, len);
+        if (result == BLEIO_PACKET_BUSY) {
+            break;
+        }
+        ringbuf_record_release(&queue->ring);
+        if (result == BLEIO_PACKET_SENT) {
+            queue->sent++;
+            sent++;
+        } else {
+            queue->dropped++;
+        }
+    }
+    return sent;
+}
+
+// Drop everything still queued, e.g. on disconnect.
+void bleio_packet_queue_clear(bleio_packet_queue_t *queue) {
+    size_t len;
+    while (ringbuf_record_peek(&queue->ring, &len) != NULL) {
+        ringbuf_record_release(&queue->ring);
+        queue->dropped++;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_BLEIO_PACKETQUEUE_H
+#define MICROPY_INCLUDED_SHARED_MODULE_BLEIO_PACKETQUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "py/ringbuf.h"
+
+// Outgoing packets waiting for a free transmit buffer in the BLE stack. Each
+// packet is one ringbuf record, so it can be handed to the stack in place.
+typedef struct {
+    ringbuf_t ring;
+    // Packets accepted by bleio_packet_queue_put, handed to the stack, and
+    // thrown away because the stack rejected them or the queue was cleared.
+    volatile uint32_t queued;
+    volatile uint32_t sent;
+    volatile uint32_t dropped;
+} bleio_packet_queue_t;
+
+typedef enum {
+    BLEIO_PACKET_SENT,
+    // No transmit buffer is free. Try again after the next TX complete event.
+    BLEIO_PACKET_BUSY,
+    BLEIO_PACKET_FAILED,
+} bleio_packet_send_result_t;
+
+typedef bleio_packet_send_result_t (*bleio_packet_queue_send_t)(void *context, const uint8_t *data, size_t len);
+
+void bleio_packet_queue_init(bleio_packet_queue_t *queue);
+bool bleio_packet_queue_alloc(bleio_packet_queue_t *queue, size_t packets, size_t max_packet_length);
+bool bleio_packet_queue_allocated(bleio_packet_queue_t *queue);
+bool bleio_packet_queue_is_empty(bleio_packet_queue_t *queue);
+bool bleio_packet_queue_put(bleio_packet_queue_t *queue, const uint8_t *header, size_t header_len, const uint8_t *data, size_t len);
+size_t bleio_packet_queue_flush(bleio_packet_queue_t *queue, bleio_packet_queue_send_t send, void *context);
+void bleio_packet_queue_clear(bleio_packet_queue_t *queue);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_BLEIO_PACKETQUEUE_H
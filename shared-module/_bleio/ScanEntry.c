@@ -28,6 +28,7 @@
 
 #include <string.h>
 
+#include "py/runtime.h"
 #include "shared-bindings/_bleio/Address.h"
 #include "shared-module/_bleio/Address.h"
 #include "shared-module/_bleio/ScanEntry.h"
@@ -37,7 +38,7 @@ mp_obj_t common_hal_bleio_scanentry_get_address(bleio_scanentry_obj_t *self) {
 }
 
 mp_obj_t common_hal_bleio_scanentry_get_advertisement_bytes(bleio_scanentry_obj_t *self) {
-    return MP_OBJ_FROM_PTR(self->data);
+    return self->data;
 }
 
 mp_int_t common_hal_bleio_scanentry_get_rssi(bleio_scanentry_obj_t *self) {
@@ -92,5 +93,7 @@ bool bleio_scanentry_data_matches(const uint8_t* data, size_t len, const uint8_t
 }
 
 bool common_hal_bleio_scanentry_matches(bleio_scanentry_obj_t *self, const uint8_t* prefixes, size_t prefixes_len, bool all) {
-    return bleio_scanentry_data_matches(self->data->data, self->data->len, prefixes, prefixes_len, !all);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(self->data, &bufinfo, MP_BUFFER_READ);
+    return bleio_scanentry_data_matches(bufinfo.buf, bufinfo.len, prefixes, prefixes_len, !all);
 }
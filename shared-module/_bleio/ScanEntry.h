@@ -38,7 +38,9 @@ typedef struct {
     bool scan_response;
     int8_t rssi;
     bleio_address_obj_t *address;
-    mp_obj_str_t *data;
+    // A bytes object, or a memoryview into data_buffer for a reused entry.
+    mp_obj_t data;
+    void *data_buffer;
     uint64_t time_received;
 } bleio_scanentry_obj_t;
 
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/misc.h"
+#include "py/runtime.h"
+#include "shared-module/_bleio/ScanFilter.h"
+#include "supervisor/shared/translate.h"
+
+bleio_scanfilter_t *bleio_scanfilter_new(const uint8_t *prefixes, size_t prefixes_len) {
+    if (prefixes_len == 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < prefixes_len; i += 1 + prefixes[i]) {
+        if (prefixes[i] >= prefixes_len - i) {
+            mp_raise_ValueError_varg(translate("Invalid %q"), MP_QSTR_prefixes);
+        }
+    }
+    // One node per prefix byte at most, plus the root.
+    size_t max_nodes = 1 + prefixes_len;
+    if (max_nodes > UINT16_MAX) {
+        mp_raise_ValueError_varg(translate("Invalid %q"), MP_QSTR_prefixes);
+    }
+    bleio_scanfilter_t *filter = m_new_obj_var(bleio_scanfilter_t, bleio_scanfilter_node_t, max_nodes);
+    bleio_scanfilter_node_t *nodes = filter->nodes;
+    nodes[0] = (bleio_scanfilter_node_t) { 0 };
+    size_t n_nodes = 1;
+
+    size_t i = 0;
+    while (i < prefixes_len) {
+        size_t prefix_len = prefixes[i++];
+        const uint8_t *prefix = prefixes + i;
+        i += prefix_len;
+
+        size_t node = 0;
+        for (size_t k = 0; k < prefix_len && !nodes[node].match; k++) {
+            size_t child = nodes[node].child;
+            while (child != 0 && nodes[child].byte != prefix[k]) {
+                child = nodes[child].sibling;
+            }
+            if (child == 0) {
+                child = n_nodes++;
+                nodes[child] = (bleio_scanfilter_node_t) {
+                    .byte = prefix[k],
+                    .sibling = nodes[node].child,
+                };
+                nodes[node].child = child;
+            }
+            node = child;
+        }
+        // A shorter prefix already covers anything this one would match.
+        if (!nodes[node].match) {
+            nodes[node].match = true;
+            nodes[node].child = 0;
+        }
+    }
+    filter->n_nodes = n_nodes;
+    return filter;
+}
+
+bool bleio_scanfilter_matches(const bleio_scanfilter_t *filter, const uint8_t *data, size_t len) {
+    if (filter == NULL) {
+        return true;
+    }
+    const bleio_scanfilter_node_t *nodes = filter->nodes;
+    size_t j = 0;
+    while (j < len) {
+        size_t structure_length = data[j++];
+        if (structure_length == 0) {
+            break;
+        }
+        // Walk the trie over the structure, which may be cut short by the end of the packet.
+        size_t end = MIN(j + structure_length, len);
+        const bleio_scanfilter_node_t *node = &nodes[0];
+        for (size_t k = j; !node->match; k++) {
+            if (k == end) {
+                break;
+            }
+            size_t child = node->child;
+            while (child != 0 && nodes[child].byte != data[k]) {
+                child = nodes[child].sibling;
+            }
+            if (child == 0) {
+                break;
+            }
+            node = &nodes[child];
+        }
+        if (node->match) {
+            return true;
+        }
+        j += structure_length;
+    }
+    return false;
+}
@@ -0,0 +1,55 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_BLEIO_SCANFILTER_H
+#define MICROPY_INCLUDED_SHARED_MODULE_BLEIO_SCANFILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Scan prefixes compiled into a trie keyed first on the AD type byte. Node 0
+// is the root; child and sibling are node indices, with 0 meaning none.
+typedef struct {
+    uint16_t child;
+    uint16_t sibling;
+    uint8_t byte;
+    // A prefix ends at this node.
+    bool match;
+} bleio_scanfilter_node_t;
+
+typedef struct {
+    size_t n_nodes;
+    bleio_scanfilter_node_t nodes[];
+} bleio_scanfilter_t;
+
+// prefixes is a length byte followed by that many bytes, repeated. Returns
+// NULL, which matches everything, when there are no prefixes.
+bleio_scanfilter_t *bleio_scanfilter_new(const uint8_t *prefixes, size_t prefixes_len);
+// True if any advertising structure in data starts with one of the prefixes.
+bool bleio_scanfilter_matches(const bleio_scanfilter_t *filter, const uint8_t *data, size_t len);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_BLEIO_SCANFILTER_H
@@ -29,59 +29,105 @@
 #include <string.h>
 
 #include "lib/utils/interrupt_char.h"
+#include "py/objarray.h"
 #include "py/objstr.h"
 #include "py/runtime.h"
+#include "shared-bindings/_bleio/Address.h"
 #include "shared-bindings/_bleio/ScanEntry.h"
 #include "shared-bindings/_bleio/ScanResults.h"
 
-bleio_scanresults_obj_t* shared_module_bleio_new_scanresults(size_t buffer_size, uint8_t* prefixes, size_t prefixes_len, mp_int_t minimum_rssi) {
+// Each packet is one ringbuf record: this header followed by the
+// advertisement data. Records are only 4-byte aligned, hence the split ticks.
+typedef struct {
+    uint32_t ticks_ms_low;
+    uint32_t ticks_ms_high;
+    int8_t rssi;
+    uint8_t flags;
+    uint8_t addr_type;
+    uint8_t peer_addr[NUM_BLEIO_ADDRESS_BYTES];
+} bleio_scanrecord_t;
+
+#define SCANRECORD_CONNECTABLE (1 << 0)
+#define SCANRECORD_SCAN_RESPONSE (1 << 1)
+
+bleio_scanresults_obj_t* shared_module_bleio_new_scanresults(size_t buffer_size, uint8_t* prefixes, size_t prefixes_len, mp_int_t minimum_rssi, bool reuse_entry) {
+    bleio_scanfilter_t *filter = bleio_scanfilter_new(prefixes, prefixes_len);
     bleio_scanresults_obj_t* self = m_new_obj(bleio_scanresults_obj_t);
     self->base.type = &bleio_scanresults_type;
     ringbuf_alloc(&self->buf, buffer_size, false);
-    self->prefixes = prefixes;
-    self->prefix_length = prefixes_len;
+    self->filter = filter;
     self->minimum_rssi = minimum_rssi;
+    self->entry = NULL;
+    self->record_held = false;
+    if (reuse_entry) {
+        bleio_scanentry_obj_t *entry = m_new_obj(bleio_scanentry_obj_t);
+        entry->base.type = &bleio_scanentry_type;
+        entry->address = NULL;
+        entry->data = mp_obj_new_memoryview('B', 0, self->buf.buf);
+        entry->data_buffer = self->buf.buf;
+        self->entry = entry;
+    }
     return self;
 }
 
+// Reuse the entry's address object while the same device keeps advertising.
+STATIC bleio_address_obj_t *scanresults_address(bleio_address_obj_t *address, const bleio_scanrecord_t *record) {
+    if (address != NULL && address->type == record->addr_type) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(address->bytes, &bufinfo, MP_BUFFER_READ);
+        if (memcmp(bufinfo.buf, record->peer_addr, NUM_BLEIO_ADDRESS_BYTES) == 0) {
+            return address;
+        }
+    }
+    address = m_new_obj(bleio_address_obj_t);
+    address->base.type = &bleio_address_type;
+    common_hal_bleio_address_construct(address, (uint8_t *)record->peer_addr, record->addr_type);
+    return address;
+}
+
 mp_obj_t common_hal_bleio_scanresults_next(bleio_scanresults_obj_t *self) {
-    while (ringbuf_num_filled(&self->buf) == 0 && !self->done && !mp_hal_is_interrupted()) {
+    // The previous result's data isn't needed any more.
+    if (self->record_held) {
+        self->record_held = false;
+        ringbuf_record_release(&self->buf);
+    }
+
+    size_t len;
+    const uint8_t *p;
+    while ((p = ringbuf_record_peek(&self->buf, &len)) == NULL && !self->done && !mp_hal_is_interrupted()) {
         RUN_BACKGROUND_TASKS;
     }
-    if (ringbuf_num_filled(&self->buf) == 0 || mp_hal_is_interrupted()) {
+    if (p == NULL || mp_hal_is_interrupted()) {
         return mp_const_none;
     }
 
-    // Create a ScanEntry out of the data on the buffer.
-    uint8_t type = ringbuf_get(&self->buf);
-    bool connectable = (type & (1 << 0)) != 0;
-    bool scan_response = (type & (1 << 1)) != 0;
-    uint64_t ticks_ms;
-    ringbuf_get_n(&self->buf, (uint8_t*) &ticks_ms, sizeof(ticks_ms));
-    uint8_t rssi = ringbuf_get(&self->buf);
-    uint8_t peer_addr[NUM_BLEIO_ADDRESS_BYTES];
-    ringbuf_get_n(&self->buf, peer_addr, sizeof(peer_addr));
-    uint8_t addr_type = ringbuf_get(&self->buf);
-    uint16_t len;
-    ringbuf_get_n(&self->buf, (uint8_t*) &len, sizeof(len));
-
-    mp_obj_str_t *o = MP_OBJ_TO_PTR(mp_obj_new_bytes_of_zeros(len));
-    ringbuf_get_n(&self->buf, (uint8_t*) o->data, len);
-
-    bleio_scanentry_obj_t *entry = m_new_obj(bleio_scanentry_obj_t);
-    entry->base.type = &bleio_scanentry_type;
-    entry->rssi = rssi;
-
-    bleio_address_obj_t *address = m_new_obj(bleio_address_obj_t);
-    address->base.type = &bleio_address_type;
-    common_hal_bleio_address_construct(MP_OBJ_TO_PTR(address), peer_addr, addr_type);
-    entry->address = address;
-
-    entry->data = o;
-    entry->time_received = ticks_ms;
-    entry->connectable = connectable;
-    entry->scan_response = scan_response;
-
+    const bleio_scanrecord_t *record = (const bleio_scanrecord_t *)p;
+    const uint8_t *data = p + sizeof(bleio_scanrecord_t);
+    size_t data_len = len - sizeof(bleio_scanrecord_t);
+
+    bleio_scanentry_obj_t *entry = self->entry;
+    if (entry != NULL) {
+        mp_obj_array_t *view = MP_OBJ_TO_PTR(entry->data);
+        view->items = (void *)data;
+        view->len = data_len;
+        entry->address = scanresults_address(entry->address, record);
+    } else {
+        entry = m_new_obj(bleio_scanentry_obj_t);
+        entry->base.type = &bleio_scanentry_type;
+        entry->address = scanresults_address(NULL, record);
+        entry->data = mp_obj_new_bytes(data, data_len);
+        entry->data_buffer = NULL;
+    }
+    entry->rssi = record->rssi;
+    entry->time_received = (uint64_t)record->ticks_ms_high << 32 | record->ticks_ms_low;
+    entry->connectable = (record->flags & SCANRECORD_CONNECTABLE) != 0;
+    entry->scan_response = (record->flags & SCANRECORD_SCAN_RESPONSE) != 0;
+
+    if (entry == self->entry) {
+        self->record_held = true;
+    } else {
+        ringbuf_record_release(&self->buf);
+    }
     return MP_OBJ_FROM_PTR(entry);
 }
 
@@ -95,38 +141,30 @@ void shared_module_bleio_scanresults_append(bleio_scanresults_obj_t* self,
                                             uint8_t addr_type,
                                             uint8_t *data,
                                             uint16_t len) {
-    int32_t packet_size = sizeof(uint8_t) + sizeof(ticks_ms) + sizeof(rssi) + NUM_BLEIO_ADDRESS_BYTES +
-        sizeof(addr_type) + sizeof(len) + len;
-    int32_t empty_space = self->buf.size - ringbuf_num_filled(&self->buf);
-    if (packet_size >= empty_space) {
-        // We can't fit the packet so skip it.
-        return;
-    }
     // Filter the packet.
     if (rssi < self->minimum_rssi) {
         return;
     }
 
     // If any prefixes are provided, then only include packets that include at least one of them.
-    if (!bleio_scanentry_data_matches(data, len, self->prefixes, self->prefix_length, true)) {
+    if (!bleio_scanfilter_matches(self->filter, data, len)) {
         return;
     }
-    uint8_t type = 0;
-    if (connectable) {
-        type |= 1 << 0;
-    }
-    if (scan_response) {
-        type |= 1 << 1;
-    }
 
-    // Add the packet to the buffer.
-    ringbuf_put(&self->buf, type);
-    ringbuf_put_n(&self->buf, (uint8_t*) &ticks_ms, sizeof(ticks_ms));
-    ringbuf_put(&self->buf, rssi);
-    ringbuf_put_n(&self->buf, peer_addr, NUM_BLEIO_ADDRESS_BYTES);
-    ringbuf_put(&self->buf, addr_type);
-    ringbuf_put_n(&self->buf, (uint8_t*) &len, sizeof(len));
-    ringbuf_put_n(&self->buf, data, len);
+    size_t record_len = sizeof(bleio_scanrecord_t) + len;
+    bleio_scanrecord_t *record = (bleio_scanrecord_t *)ringbuf_record_reserve(&self->buf, record_len);
+    if (record == NULL) {
+        // We can't fit the packet so skip it.
+        return;
+    }
+    record->ticks_ms_low = (uint32_t)ticks_ms;
+    record->ticks_ms_high = (uint32_t)(ticks_ms >> 32);
+    record->rssi = rssi;
+    record->flags = (connectable ? SCANRECORD_CONNECTABLE : 0) | (scan_response ? SCANRECORD_SCAN_RESPONSE : 0);
+    record->addr_type = addr_type;
+    memcpy(record->peer_addr, peer_addr, NUM_BLEIO_ADDRESS_BYTES);
+    memcpy(record + 1, data, len);
+    ringbuf_record_commit(&self->buf, record_len);
 }
 
 bool shared_module_bleio_scanresults_get_done(bleio_scanresults_obj_t* self) {
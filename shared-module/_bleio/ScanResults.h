@@ -32,21 +32,26 @@
 
 #include "py/obj.h"
 #include "py/ringbuf.h"
+#include "shared-module/_bleio/ScanEntry.h"
+#include "shared-module/_bleio/ScanFilter.h"
 
 typedef struct {
     mp_obj_base_t base;
     // Pointers that needs to live until the scan is done.
     void* common_hal_data;
+    // One ringbuf record per packet, see ScanResults.c.
     ringbuf_t buf;
-    // Prefixes is a length encoded array of prefixes.
-    uint8_t* prefixes;
-    size_t prefix_length;
+    bleio_scanfilter_t *filter;
     mp_int_t minimum_rssi;
+    // When not NULL, every result is returned in this entry, and its data is
+    // a view of the record at the front of buf until the next result.
+    bleio_scanentry_obj_t *entry;
+    bool record_held;
     bool active;
     bool done;
 } bleio_scanresults_obj_t;
 
-bleio_scanresults_obj_t* shared_module_bleio_new_scanresults(size_t buffer_size, uint8_t* prefixes, size_t prefixes_len, mp_int_t minimum_rssi);
+bleio_scanresults_obj_t* shared_module_bleio_new_scanresults(size_t buffer_size, uint8_t* prefixes, size_t prefixes_len, mp_int_t minimum_rssi, bool reuse_entry);
 
 bool shared_module_bleio_scanresults_get_done(bleio_scanresults_obj_t* self);
 void shared_module_bleio_scanresults_set_done(bleio_scanresults_obj_t* self, bool done);
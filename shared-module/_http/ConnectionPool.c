@@ -0,0 +1,129 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/runtime.h"
+#include "shared-bindings/_http/ConnectionPool.h"
+
+STATIC void close_socket(mp_obj_t socket) {
+    mp_obj_t dest[2];
+    mp_load_method(socket, MP_QSTR_close, dest);
+    mp_call_method_n_kw(0, 0, dest);
+}
+
+STATIC mp_obj_t pool_key(mp_obj_t host, mp_int_t port) {
+    mp_obj_t items[2] = { host, MP_OBJ_NEW_SMALL_INT(port) };
+    return mp_obj_new_tuple(2, items);
+}
+
+void common_hal__http_connectionpool_construct(http_connectionpool_obj_t *self, mp_obj_t socket_source, size_t max_idle) {
+    self->socket_source = socket_source;
+    self->idle = mp_obj_new_dict(0);
+    self->max_idle = max_idle;
+}
+
+mp_obj_t common_hal__http_connectionpool_connect(http_connectionpool_obj_t *self, mp_obj_t host, mp_int_t port) {
+    mp_map_elem_t *elem = mp_map_lookup(mp_obj_dict_get_map(self->idle), pool_key(host, port), MP_MAP_LOOKUP);
+    if (elem != NULL) {
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_list_get(elem->value, &len, &items);
+        if (len > 0) {
+            // Hand out the most recently used socket, the least likely to
+            // have been timed out by the server.
+            mp_obj_t socket = items[len - 1];
+            mp_obj_list_remove(elem->value, socket);
+            return socket;
+        }
+    }
+
+    mp_obj_t dest[4];
+    mp_load_method(self->socket_source, MP_QSTR_getaddrinfo, dest);
+    dest[2] = host;
+    dest[3] = MP_OBJ_NEW_SMALL_INT(port);
+    mp_obj_t info = mp_obj_subscr(mp_call_method_n_kw(2, 0, dest), MP_OBJ_NEW_SMALL_INT(0), MP_OBJ_SENTINEL);
+    mp_obj_t *info_items;
+    mp_obj_get_array_fixed_n(info, 5, &info_items);
+
+    mp_obj_t socket_dest[5];
+    mp_load_method(self->socket_source, MP_QSTR_socket, socket_dest);
+    socket_dest[2] = info_items[0];
+    socket_dest[3] = info_items[1];
+    socket_dest[4] = info_items[2];
+    mp_obj_t socket = mp_call_method_n_kw(3, 0, socket_dest);
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_load_method(socket, MP_QSTR_connect, dest);
+        dest[2] = info_items[4];
+        mp_call_method_n_kw(1, 0, dest);
+        nlr_pop();
+    } else {
+        close_socket(socket);
+        nlr_jump(nlr.ret_val);
+    }
+    return socket;
+}
+
+void common_hal__http_connectionpool_release(http_connectionpool_obj_t *self, mp_obj_t host, mp_int_t port, mp_obj_t socket, bool reuse) {
+    if (!reuse || common_hal__http_connectionpool_get_idle_count(self) >= self->max_idle) {
+        close_socket(socket);
+        return;
+    }
+    mp_map_elem_t *elem = mp_map_lookup(mp_obj_dict_get_map(self->idle), pool_key(host, port), MP_MAP_LOOKUP_ADD_IF_NOT_FOUND);
+    if (elem->value == MP_OBJ_NULL) {
+        elem->value = mp_obj_new_list(0, NULL);
+    }
+    mp_obj_list_append(elem->value, socket);
+}
+
+size_t common_hal__http_connectionpool_get_idle_count(http_connectionpool_obj_t *self) {
+    mp_map_t *map = mp_obj_dict_get_map(self->idle);
+    size_t count = 0;
+    for (size_t i = 0; i < map->alloc; i++) {
+        if (MP_MAP_SLOT_IS_FILLED(map, i)) {
+            size_t len;
+            mp_obj_t *items;
+            mp_obj_list_get(map->table[i].value, &len, &items);
+            count += len;
+        }
+    }
+    return count;
+}
+
+void common_hal__http_connectionpool_close(http_connectionpool_obj_t *self) {
+    mp_map_t *map = mp_obj_dict_get_map(self->idle);
+    for (size_t i = 0; i < map->alloc; i++) {
+        if (MP_MAP_SLOT_IS_FILLED(map, i)) {
+            size_t len;
+            mp_obj_t *items;
+            mp_obj_list_get(map->table[i].value, &len, &items);
+            for (size_t j = 0; j < len; j++) {
+                close_socket(items[j]);
+            }
+        }
+    }
+    self->idle = mp_obj_new_dict(0);
+}
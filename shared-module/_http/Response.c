@@ -0,0 +1,424 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/binary.h"
+#include "py/mperrno.h"
+#include "py/runtime.h"
+#include "py/smallint.h"
+#include "shared-bindings/_http/Response.h"
+#include "supervisor/shared/translate.h"
+
+STATIC NORETURN void raise_invalid(void) {
+    mp_raise_ValueError(translate("Invalid HTTP response"));
+}
+
+STATIC uint8_t ascii_lower(uint8_t c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+STATIC bool name_is(const uint8_t *name, size_t len, const char *lower) {
+    return len == strlen(lower) && memcmp(name, lower, len) == 0;
+}
+
+// True if the comma separated header value contains token, ignoring case.
+STATIC bool value_has_token(const uint8_t *value, size_t len, const char *token) {
+    size_t token_len = strlen(token);
+    size_t i = 0;
+    while (i < len) {
+        while (i < len && (value[i] == ' ' || value[i] == '\t' || value[i] == ',')) {
+            i++;
+        }
+        size_t j = 0;
+        while (j < token_len && i + j < len && ascii_lower(value[i + j]) == (uint8_t)token[j]) {
+            j++;
+        }
+        size_t end = i + j;
+        while (end < len && (value[end] == ' ' || value[end] == '\t')) {
+            end++;
+        }
+        if (j == token_len && (end == len || value[end] == ',')) {
+            return true;
+        }
+        while (i < len && value[i] != ',') {
+            i++;
+        }
+    }
+    return false;
+}
+
+// Receives up to len bytes into data through the socket's recv_into(). Returns
+// 0 at the end of the stream.
+STATIC size_t response_recv(http_response_obj_t *self, uint8_t *data, size_t len) {
+    self->view.items = data;
+    self->view.len = len;
+    mp_obj_t result = mp_call_method_n_kw(1, 0, self->recv_into);
+    self->view.items = NULL;
+    self->view.len = 0;
+    if (result == mp_const_none) {
+        // non-blocking socket with nothing to read
+        mp_raise_OSError(MP_EAGAIN);
+    }
+    mp_int_t n = mp_obj_get_int(result);
+    if (n < 0 || (size_t)n > len) {
+        raise_invalid();
+    }
+    return n;
+}
+
+// Reads more of the response into the line buffer. Returns false at the end
+// of the stream.
+STATIC bool response_fill(http_response_obj_t *self) {
+    if (self->start == self->end) {
+        self->start = self->end = 0;
+    } else if (self->end == self->buf_size && self->start > 0) {
+        memmove(self->buf, self->buf + self->start, self->end - self->start);
+        self->end -= self->start;
+        self->start = 0;
+    }
+    if (self->end == self->buf_size) {
+        mp_raise_ValueError(translate("HTTP header line too long"));
+    }
+    size_t n = response_recv(self, self->buf + self->end, self->buf_size - self->end);
+    self->end += n;
+    return n > 0;
+}
+
+// Returns the next line without its line ending. The line stays valid until
+// the buffer is next filled. The connection closing first is reported as a
+// reset, which is what a stale keep-alive connection looks like.
+STATIC uint8_t *response_read_line(http_response_obj_t *self, size_t *len) {
+    while (true) {
+        uint8_t *line = self->buf + self->start;
+        uint8_t *newline = memchr(line, '\n', self->end - self->start);
+        if (newline != NULL) {
+            size_t n = newline - line;
+            if (n > 0 && line[n - 1] == '\r') {
+                n--;
+            }
+            self->start = newline + 1 - self->buf;
+            *len = n;
+            return line;
+        }
+        if (!response_fill(self)) {
+            mp_raise_OSError(MP_ECONNRESET);
+        }
+    }
+}
+
+// Header bytes are ISO-8859-1, as in CPython's http.client, so anything
+// outside ASCII is re-encoded rather than passed through as invalid UTF-8.
+STATIC void vstr_add_latin1(vstr_t *vstr, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        vstr_add_char(vstr, data[i]);
+    }
+}
+
+STATIC mp_obj_t response_new_str(const uint8_t *data, size_t len) {
+    size_t i = 0;
+    while (i < len && data[i] < 0x80) {
+        i++;
+    }
+    if (i == len) {
+        return mp_obj_new_str((const char *)data, len);
+    }
+    vstr_t vstr;
+    vstr_init(&vstr, len + 8);
+    vstr_add_latin1(&vstr, data, len);
+    return mp_obj_new_str_from_vstr(&mp_type_str, &vstr);
+}
+
+// Parses "HTTP/1.x nnn reason". Returns the status code.
+STATIC void response_read_status(http_response_obj_t *self) {
+    size_t len;
+    const uint8_t *line = response_read_line(self, &len);
+    if (len < 12 || memcmp(line, "HTTP/1.", 7) != 0 || (line[7] != '0' && line[7] != '1') || line[8] != ' ') {
+        raise_invalid();
+    }
+    uint16_t status = 0;
+    for (size_t i = 9; i < 12; i++) {
+        if (line[i] < '0' || line[i] > '9') {
+            raise_invalid();
+        }
+        status = status * 10 + line[i] - '0';
+    }
+    if (len > 12 && line[12] != ' ') {
+        raise_invalid();
+    }
+    self->version = line[7] == '1' ? 11 : 10;
+    self->status_code = status;
+    self->reason = len > 13 ? response_new_str(line + 13, len - 13) : MP_OBJ_NEW_QSTR(MP_QSTR_);
+}
+
+STATIC void response_store_header(http_response_obj_t *self, const uint8_t *name, size_t name_len, const uint8_t *value, size_t value_len) {
+    mp_obj_t key = response_new_str(name, name_len);
+    mp_map_elem_t *elem = mp_map_lookup(mp_obj_dict_get_map(self->headers), key, MP_MAP_LOOKUP_ADD_IF_NOT_FOUND);
+    if (elem->value == MP_OBJ_NULL) {
+        elem->value = response_new_str(value, value_len);
+    } else {
+        // Repeated headers are joined, as CPython's http.client does.
+        vstr_t vstr;
+        size_t old_len;
+        const char *old = mp_obj_str_get_data(elem->value, &old_len);
+        vstr_init(&vstr, old_len + 2 + value_len);
+        vstr_add_strn(&vstr, old, old_len);
+        vstr_add_strn(&vstr, ", ", 2);
+        vstr_add_latin1(&vstr, value, value_len);
+        elem->value = mp_obj_new_str_from_vstr(&mp_type_str, &vstr);
+    }
+}
+
+// Reads the header lines up to the blank line. Names are lower-cased in the
+// buffer before being stored, so lookups don't depend on the server's case.
+STATIC void response_read_headers(http_response_obj_t *self, mp_int_t *content_length, bool *chunked) {
+    bool close = false;
+    bool keep_alive = false;
+    while (true) {
+        size_t len;
+        uint8_t *line = response_read_line(self, &len);
+        if (len == 0) {
+            break;
+        }
+        uint8_t *colon = memchr(line, ':', len);
+        if (colon == NULL || colon == line) {
+            raise_invalid();
+        }
+        size_t name_len = colon - line;
+        for (size_t i = 0; i < name_len; i++) {
+            line[i] = ascii_lower(line[i]);
+        }
+        const uint8_t *value = colon + 1;
+        size_t value_len = len - name_len - 1;
+        while (value_len > 0 && (value[0] == ' ' || value[0] == '\t')) {
+            value++;
+            value_len--;
+        }
+        while (value_len > 0 && (value[value_len - 1] == ' ' || value[value_len - 1] == '\t')) {
+            value_len--;
+        }
+
+        if (name_is(line, name_len, "content-length")) {
+            mp_int_t n = 0;
+            if (value_len == 0) {
+                raise_invalid();
+            }
+            for (size_t i = 0; i < value_len; i++) {
+                if (value[i] < '0' || value[i] > '9' || n > (MP_SMALL_INT_MAX - 9) / 10) {
+                    raise_invalid();
+                }
+                n = n * 10 + value[i] - '0';
+            }
+            // Conflicting lengths leave the end of the body ambiguous, which
+            // would desync a reused connection (RFC 7230 section 3.3.3).
+            if (*content_length >= 0 && *content_length != n) {
+                raise_invalid();
+            }
+            *content_length = n;
+        } else if (name_is(line, name_len, "transfer-encoding")) {
+            *chunked = value_has_token(value, value_len, "chunked");
+        } else if (name_is(line, name_len, "connection")) {
+            close = value_has_token(value, value_len, "close");
+            keep_alive = value_has_token(value, value_len, "keep-alive");
+        }
+
+        if (self->headers != mp_const_none) {
+            response_store_header(self, line, name_len, value, value_len);
+        }
+    }
+    self->keep_alive = self->version == 11 ? !close : keep_alive;
+}
+
+void common_hal__http_response_construct(http_response_obj_t *self, mp_obj_t socket, mp_obj_t buffer, mp_obj_t headers, bool head) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer, &bufinfo, MP_BUFFER_WRITE);
+    if (bufinfo.len < 16) {
+        mp_raise_ValueError(translate("Buffer is too small"));
+    }
+    mp_load_method(socket, MP_QSTR_recv_into, self->recv_into);
+    self->view.base.type = &mp_type_bytearray;
+    self->view.typecode = BYTEARRAY_TYPECODE;
+    self->view.free = 0;
+    self->view.len = 0;
+    self->view.items = NULL;
+    self->recv_into[2] = MP_OBJ_FROM_PTR(&self->view);
+    self->buffer = buffer;
+    self->buf = bufinfo.buf;
+    self->buf_size = bufinfo.len;
+    self->start = self->end = 0;
+    self->headers = headers;
+    if (headers != mp_const_none) {
+        // Empty the dict but keep its table, so a dict reused across
+        // responses doesn't allocate once it has grown to fit.
+        mp_map_t *map = mp_obj_dict_get_map(headers);
+        if (map->alloc > 0) {
+            memset(map->table, 0, map->alloc * sizeof(mp_map_elem_t));
+        }
+        map->used = 0;
+    }
+
+    mp_int_t content_length = -1;
+    bool chunked = false;
+    do {
+        // Skip interim responses: 100 Continue, 102 Processing and 103 Early
+        // Hints.
+        response_read_status(self);
+        content_length = -1;
+        chunked = false;
+        response_read_headers(self, &content_length, &chunked);
+    } while (self->status_code == 100 || self->status_code == 102 || self->status_code == 103);
+
+    if (self->status_code == 101) {
+        // The connection now speaks another protocol. Everything after the
+        // headers, including what is already buffered, is read as the body.
+        self->remaining = -1;
+        self->state = HTTP_RESPONSE_BODY;
+        self->keep_alive = false;
+    } else if (head || self->status_code == 204 || self->status_code == 304) {
+        self->state = HTTP_RESPONSE_DONE;
+    } else if (chunked) {
+        self->state = HTTP_RESPONSE_CHUNK_SIZE;
+    } else if (content_length >= 0) {
+        self->remaining = content_length;
+        self->state = content_length > 0 ? HTTP_RESPONSE_BODY : HTTP_RESPONSE_DONE;
+    } else {
+        // The body ends when the server closes the connection.
+        self->remaining = -1;
+        self->state = HTTP_RESPONSE_BODY;
+        self->keep_alive = false;
+    }
+}
+
+// Parses a chunk size line: hex digits, optionally followed by extensions.
+STATIC mp_int_t response_read_chunk_size(http_response_obj_t *self) {
+    size_t len;
+    const uint8_t *line = response_read_line(self, &len);
+    mp_int_t size = 0;
+    size_t i = 0;
+    for (; i < len; i++) {
+        uint8_t c = ascii_lower(line[i]);
+        int digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else {
+            break;
+        }
+        if (size > MP_SMALL_INT_MAX >> 4) {
+            raise_invalid();
+        }
+        size = size << 4 | digit;
+    }
+    if (i == 0 || (i < len && line[i] != ';' && line[i] != ' ' && line[i] != '\t')) {
+        raise_invalid();
+    }
+    return size;
+}
+
+size_t common_hal__http_response_readinto(http_response_obj_t *self, uint8_t *data, size_t len) {
+    while (len > 0) {
+        switch (self->state) {
+            case HTTP_RESPONSE_DONE:
+                return 0;
+            case HTTP_RESPONSE_CHUNK_SIZE:
+                self->remaining = response_read_chunk_size(self);
+                self->state = self->remaining > 0 ? HTTP_RESPONSE_CHUNK_DATA : HTTP_RESPONSE_TRAILERS;
+                break;
+            case HTTP_RESPONSE_CHUNK_END: {
+                size_t line_len;
+                response_read_line(self, &line_len);
+                if (line_len != 0) {
+                    raise_invalid();
+                }
+                self->state = HTTP_RESPONSE_CHUNK_SIZE;
+                break;
+            }
+            case HTTP_RESPONSE_TRAILERS: {
+                size_t line_len;
+                response_read_line(self, &line_len);
+                if (line_len == 0) {
+                    self->state = HTTP_RESPONSE_DONE;
+                }
+                break;
+            }
+            default: {
+                size_t want = len;
+                if (self->remaining >= 0 && want > (size_t)self->remaining) {
+                    want = self->remaining;
+                }
+                size_t n;
+                if (self->start < self->end) {
+                    // Hand over what came in with the headers first.
+                    n = MIN(want, self->end - self->start);
+                    memcpy(data, self->buf + self->start, n);
+                    self->start += n;
+                } else {
+                    n = response_recv(self, data, want);
+                    if (n == 0) {
+                        if (self->remaining < 0) {
+                            self->state = HTTP_RESPONSE_DONE;
+                            return 0;
+                        }
+                        mp_raise_OSError(MP_ECONNRESET);
+                    }
+                }
+                if (self->remaining >= 0) {
+                    self->remaining -= n;
+                    if (self->remaining == 0) {
+                        self->state = self->state == HTTP_RESPONSE_BODY ? HTTP_RESPONSE_DONE : HTTP_RESPONSE_CHUNK_END;
+                    }
+                }
+                return n;
+            }
+        }
+    }
+    return 0;
+}
+
+int common_hal__http_response_get_status_code(http_response_obj_t *self) {
+    return self->status_code;
+}
+
+mp_obj_t common_hal__http_response_get_reason(http_response_obj_t *self) {
+    return self->reason;
+}
+
+int common_hal__http_response_get_version(http_response_obj_t *self) {
+    return self->version;
+}
+
+mp_obj_t common_hal__http_response_get_headers(http_response_obj_t *self) {
+    return self->headers;
+}
+
+bool common_hal__http_response_get_keep_alive(http_response_obj_t *self) {
+    return self->keep_alive;
+}
+
+bool common_hal__http_response_get_done(http_response_obj_t *self) {
+    return self->state == HTTP_RESPONSE_DONE;
+}
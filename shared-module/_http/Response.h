@@ -0,0 +1,68 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE__HTTP_RESPONSE_H
+#define MICROPY_INCLUDED_SHARED_MODULE__HTTP_RESPONSE_H
+
+#include "py/obj.h"
+#include "py/objarray.h"
+
+typedef enum {
+    HTTP_RESPONSE_BODY,
+    HTTP_RESPONSE_CHUNK_SIZE,
+    HTTP_RESPONSE_CHUNK_DATA,
+    HTTP_RESPONSE_CHUNK_END,
+    HTTP_RESPONSE_TRAILERS,
+    HTTP_RESPONSE_DONE,
+} http_response_state_t;
+
+typedef struct {
+    mp_obj_base_t base;
+    // The socket's recv_into method and its argument, ready for
+    // mp_call_method_n_kw().
+    mp_obj_t recv_into[3];
+    // A bytearray aliasing whatever is being received into, so receiving
+    // allocates nothing.
+    mp_obj_array_t view;
+    mp_obj_t buffer;
+    mp_obj_t headers;
+    mp_obj_t reason;
+    // Status line, headers and chunk framing are parsed in place in
+    // buf[start:end]; body bytes go straight to the caller once it is empty.
+    uint8_t *buf;
+    size_t buf_size;
+    size_t start;
+    size_t end;
+    // Bytes left in the body or the current chunk; -1 reads until the server
+    // closes the connection.
+    mp_int_t remaining;
+    uint16_t status_code;
+    uint8_t version;
+    uint8_t state;
+    bool keep_alive;
+} http_response_obj_t;
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE__HTTP_RESPONSE_H
@@ -5,54 +5,147 @@
 #include "shared-bindings/aesio/__init__.h"
 #include "shared-module/aesio/__init__.h"
 
+// Starts a new message in the authenticated modes.
+STATIC void start_message(aesio_aes_obj_t *self) {
+  self->auth_state = AES_AUTH_AAD;
+  self->ccm_aad = MP_OBJ_NULL;
+  if (self->mode == AES_MODE_GCM) {
+    if (self->gcm == NULL) {
+      self->gcm = m_new(struct AES_GCM_ctx, 1);
+    }
+    AES_GCM_init(self->gcm, &self->ctx, self->iv, self->iv_length);
+  }
+}
+
 void common_hal_aesio_aes_construct(aesio_aes_obj_t *self, const uint8_t *key,
                                     uint32_t key_length, const uint8_t *iv,
-                                    int mode, int counter) {
+                                    uint32_t iv_length, int mode, int counter,
+                                    uint32_t mac_len) {
   self->mode = mode;
   self->counter = counter;
-  common_hal_aesio_aes_rekey(self, key, key_length, iv);
+  self->mac_len = mac_len;
+  self->gcm = NULL;
+  common_hal_aesio_aes_rekey(self, key, key_length, iv, iv_length);
 }
 
 void common_hal_aesio_aes_rekey(aesio_aes_obj_t *self, const uint8_t *key,
-                                uint32_t key_length, const uint8_t *iv) {
+                                uint32_t key_length, const uint8_t *iv,
+                                uint32_t iv_length) {
   memset(&self->ctx, 0, sizeof(self->ctx));
-  if (iv != NULL) {
+  if (iv_length == AES_BLOCKLEN) {
     AES_init_ctx_iv(&self->ctx, key, key_length, iv);
   } else {
     AES_init_ctx(&self->ctx, key, key_length);
   }
+  if (iv_length != 0) {
+    memcpy(self->iv, iv, iv_length);
+  }
+  self->iv_length = iv_length;
+  start_message(self);
 }
 
 void common_hal_aesio_aes_set_mode(aesio_aes_obj_t *self, int mode) {
   self->mode = mode;
+  start_message(self);
 }
 
-void common_hal_aesio_aes_encrypt(aesio_aes_obj_t *self, uint8_t *buffer,
-                            size_t length) {
+// CCM is done in one go, once the message is known.
+STATIC void ccm_crypt(aesio_aes_obj_t *self, const uint8_t *src, uint8_t *dest,
+                      size_t length, bool decrypt) {
+  mp_buffer_info_t aad = { .buf = NULL, .len = 0 };
+  if (self->ccm_aad != MP_OBJ_NULL) {
+    mp_get_buffer_raise(self->ccm_aad, &aad, MP_BUFFER_READ);
+  }
+  if (decrypt) {
+    AES_CCM_decrypt(&self->ctx, self->iv, self->iv_length, aad.buf, aad.len,
+                    src, dest, length, self->tag, self->mac_len);
+  } else {
+    AES_CCM_encrypt(&self->ctx, self->iv, self->iv_length, aad.buf, aad.len,
+                    src, dest, length, self->tag, self->mac_len);
+  }
+  self->ccm_aad = MP_OBJ_NULL;
+  self->auth_state = AES_AUTH_DONE;
+}
+
+void common_hal_aesio_aes_update(aesio_aes_obj_t *self, mp_obj_t aad) {
+  mp_buffer_info_t bufinfo;
+  mp_get_buffer_raise(aad, &bufinfo, MP_BUFFER_READ);
+  if (self->mode == AES_MODE_GCM) {
+    AES_GCM_update_aad(self->gcm, bufinfo.buf, bufinfo.len);
+    return;
+  }
+  // Keep a copy, so changing the caller's buffer afterwards doesn't change
+  // what is authenticated. Later pieces are appended to what came before.
+  mp_buffer_info_t prev = { .buf = NULL, .len = 0 };
+  if (self->ccm_aad != MP_OBJ_NULL) {
+    mp_get_buffer_raise(self->ccm_aad, &prev, MP_BUFFER_READ);
+  }
+  vstr_t vstr;
+  vstr_init_len(&vstr, prev.len + bufinfo.len);
+  if (prev.len > 0) {
+    memcpy(vstr.buf, prev.buf, prev.len);
+  }
+  memcpy(vstr.buf + prev.len, bufinfo.buf, bufinfo.len);
+  self->ccm_aad = mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+
+void common_hal_aesio_aes_encrypt(aesio_aes_obj_t *self, const uint8_t *src,
+                                  uint8_t *dest, size_t length) {
   switch (self->mode) {
   case AES_MODE_ECB:
-    AES_ECB_encrypt(&self->ctx, buffer);
+    memmove(dest, src, length);
+    AES_ECB_encrypt(&self->ctx, dest);
     break;
   case AES_MODE_CBC:
-    AES_CBC_encrypt_buffer(&self->ctx, buffer, length);
+    memmove(dest, src, length);
+    AES_CBC_encrypt_buffer(&self->ctx, dest, length);
     break;
   case AES_MODE_CTR:
-    AES_CTR_xcrypt_buffer(&self->ctx, buffer, length);
+    AES_CTR_xcrypt(&self->ctx, src, dest, length);
+    break;
+  case AES_MODE_GCM:
+    AES_GCM_encrypt(self->gcm, &self->ctx, src, dest, length);
+    self->auth_state = AES_AUTH_MESSAGE;
+    break;
+  case AES_MODE_CCM:
+    ccm_crypt(self, src, dest, length, false);
     break;
   }
 }
 
-void common_hal_aesio_aes_decrypt(aesio_aes_obj_t *self, uint8_t *buffer,
-                                  size_t length) {
+void common_hal_aesio_aes_decrypt(aesio_aes_obj_t *self, const uint8_t *src,
+                                  uint8_t *dest, size_t length) {
   switch (self->mode) {
   case AES_MODE_ECB:
-    AES_ECB_decrypt(&self->ctx, buffer);
+    memmove(dest, src, length);
+    AES_ECB_decrypt(&self->ctx, dest);
     break;
   case AES_MODE_CBC:
-    AES_CBC_decrypt_buffer(&self->ctx, buffer, length);
+    memmove(dest, src, length);
+    AES_CBC_decrypt_buffer(&self->ctx, dest, length);
     break;
   case AES_MODE_CTR:
-    AES_CTR_xcrypt_buffer(&self->ctx, buffer, length);
+    AES_CTR_xcrypt(&self->ctx, src, dest, length);
     break;
+  case AES_MODE_GCM:
+    AES_GCM_decrypt(self->gcm, &self->ctx, src, dest, length);
+    self->auth_state = AES_AUTH_MESSAGE;
+    break;
+  case AES_MODE_CCM:
+    ccm_crypt(self, src, dest, length, true);
+    break;
+  }
+}
+
+void common_hal_aesio_aes_digest(aesio_aes_obj_t *self, uint8_t *tag) {
+  if (self->auth_state != AES_AUTH_DONE) {
+    if (self->mode == AES_MODE_GCM) {
+      AES_GCM_finish(self->gcm, &self->ctx, self->tag);
+      self->auth_state = AES_AUTH_DONE;
+    } else {
+      // A CCM message with no data only authenticates the associated data.
+      ccm_crypt(self, NULL, NULL, 0, false);
+    }
   }
+  memcpy(tag, self->tag, self->mac_len);
 }
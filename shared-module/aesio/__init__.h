@@ -41,6 +41,15 @@ enum AES_MODE {
     AES_MODE_ECB = 1,
     AES_MODE_CBC = 2,
     AES_MODE_CTR = 6,
+    AES_MODE_CCM = 8,
+    AES_MODE_GCM = 11,
+};
+
+// Progress through a GCM or CCM message.
+enum AES_AUTH_STATE {
+    AES_AUTH_AAD,       // accepting associated data
+    AES_AUTH_MESSAGE,   // data has been encrypted or decrypted
+    AES_AUTH_DONE,      // the tag has been computed
 };
 
 typedef struct {
@@ -54,6 +63,23 @@ typedef struct {
 
     // Counter for running in CTR mode
     uint32_t counter;
+
+    // IV as given, kept so the authenticated modes can restart a message
+    uint8_t iv[AES_BLOCKLEN];
+    uint8_t iv_length;
+
+    // Tag length for GCM and CCM
+    uint8_t mac_len;
+
+    enum AES_AUTH_STATE auth_state;
+    uint8_t tag[AES_BLOCKLEN];
+
+    // GHASH state, allocated the first time GCM is used
+    struct AES_GCM_ctx *gcm;
+
+    // CCM needs the message length before the associated data, so the
+    // associated data is held until the message arrives
+    mp_obj_t ccm_aad;
 } aesio_aes_obj_t;
 
 #endif // MICROPY_INCLUDED_SHARED_MODULE_AESIO__INIT__H
@@ -1,6 +1,7 @@
 /*
 
-This is an implementation of the AES algorithm, specifically ECB, CTR and CBC mode.
+This is an implementation of the AES algorithm, specifically ECB, CTR and CBC mode,
+and the authenticated GCM and CCM modes.
 Block size can be chosen in aes.h - available choices are AES128, AES192, AES256.
 
 The implementation is verified against the test vectors in:
@@ -37,6 +38,13 @@ NOTE:   String length must be evenly divisible by 16byte (str_len % 16 == 0)
 #include <string.h> // CBC mode, for memset
 #include "aes.h"
 
+#if AES_NI
+#include <immintrin.h>
+#endif
+#if AES_NI && !AES_TTABLE
+#error AES_NI needs AES_TTABLE
+#endif
+
 /*****************************************************************************/
 /* Defines:                                                                  */
 /*****************************************************************************/
@@ -135,6 +143,119 @@ static const uint8_t Rcon[11] = {
  */
 
 
+#if AES_TTABLE
+// Round tables in the layout used by mbed TLS: FT0[x] is the MixColumns column
+// of sbox[x] and RT0[x] the InvMixColumns column of rsbox[x], both as
+// little-endian words. The tables for the other three rows are rotations of
+// these, which costs nothing on ARM and keeps them to 2 KiB in total.
+static const uint32_t FT0[256] = {
+  0xa56363c6, 0x847c7cf8, 0x997777ee, 0x8d7b7bf6, 0x0df2f2ff, 0xbd6b6bd6,
+  0xb16f6fde, 0x54c5c591, 0x50303060, 0x03010102, 0xa96767ce, 0x7d2b2b56,
+  0x19fefee7, 0x62d7d7b5, 0xe6abab4d, 0x9a7676ec, 0x45caca8f, 0x9d82821f,
+  0x40c9c989, 0x877d7dfa, 0x15fafaef, 0xeb5959b2, 0xc947478e, 0x0bf0f0fb,
+  0xecadad41, 0x67d4d4b3, 0xfda2a25f, 0xeaafaf45, 0xbf9c9c23, 0xf7a4a453,
+  0x967272e4, 0x5bc0c09b, 0xc2b7b775, 0x1cfdfde1, 0xae93933d, 0x6a26264c,
+  0x5a36366c, 0x413f3f7e, 0x02f7f7f5, 0x4fcccc83, 0x5c343468, 0xf4a5a551,
+  0x34e5e5d1, 0x08f1f1f9, 0x937171e2, 0x73d8d8ab, 0x53313162, 0x3f15152a,
+  0x0c040408, 0x52c7c795, 0x65232346, 0x5ec3c39d, 0x28181830, 0xa1969637,
+  0x0f05050a, 0xb59a9a2f, 0x0907070e, 0x36121224, 0x9b80801b, 0x3de2e2df,
+  0x26ebebcd, 0x6927274e, 0xcdb2b27f, 0x9f7575ea, 0x1b090912, 0x9e83831d,
+  0x742c2c58, 0x2e1a1a34, 0x2d1b1b36, 0xb26e6edc, 0xee5a5ab4, 0xfba0a05b,
+  0xf65252a4, 0x4d3b3b76, 0x61d6d6b7, 0xceb3b37d, 0x7b292952, 0x3ee3e3dd,
+  0x712f2f5e, 0x97848413, 0xf55353a6, 0x68d1d1b9, 0x00000000, 0x2cededc1,
+  0x60202040, 0x1ffcfce3, 0xc8b1b179, 0xed5b5bb6, 0xbe6a6ad4, 0x46cbcb8d,
+  0xd9bebe67, 0x4b393972, 0xde4a4a94, 0xd44c4c98, 0xe85858b0, 0x4acfcf85,
+  0x6bd0d0bb, 0x2aefefc5, 0xe5aaaa4f, 0x16fbfbed, 0xc5434386, 0xd74d4d9a,
+  0x55333366, 0x94858511, 0xcf45458a, 0x10f9f9e9, 0x06020204, 0x817f7ffe,
+  0xf05050a0, 0x443c3c78, 0xba9f9f25, 0xe3a8a84b, 0xf35151a2, 0xfea3a35d,
+  0xc0404080, 0x8a8f8f05, 0xad92923f, 0xbc9d9d21, 0x48383870, 0x04f5f5f1,
+  0xdfbcbc63, 0xc1b6b677, 0x75dadaaf, 0x63212142, 0x30101020, 0x1affffe5,
+  0x0ef3f3fd, 0x6dd2d2bf, 0x4ccdcd81, 0x140c0c18, 0x35131326, 0x2fececc3,
+  0xe15f5fbe, 0xa2979735, 0xcc444488, 0x3917172e, 0x57c4c493, 0xf2a7a755,
+  0x827e7efc, 0x473d3d7a, 0xac6464c8, 0xe75d5dba, 0x2b191932, 0x957373e6,
+  0xa06060c0, 0x98818119, 0xd14f4f9e, 0x7fdcdca3, 0x66222244, 0x7e2a2a54,
+  0xab90903b, 0x8388880b, 0xca46468c, 0x29eeeec7, 0xd3b8b86b, 0x3c141428,
+  0x79dedea7, 0xe25e5ebc, 0x1d0b0b16, 0x76dbdbad, 0x3be0e0db, 0x56323264,
+  0x4e3a3a74, 0x1e0a0a14, 0xdb494992, 0x0a06060c, 0x6c242448, 0xe45c5cb8,
+  0x5dc2c29f, 0x6ed3d3bd, 0xefacac43, 0xa66262c4, 0xa8919139, 0xa4959531,
+  0x37e4e4d3, 0x8b7979f2, 0x32e7e7d5, 0x43c8c88b, 0x5937376e, 0xb76d6dda,
+  0x8c8d8d01, 0x64d5d5b1, 0xd24e4e9c, 0xe0a9a949, 0xb46c6cd8, 0xfa5656ac,
+  0x07f4f4f3, 0x25eaeacf, 0xaf6565ca, 0x8e7a7af4, 0xe9aeae47, 0x18080810,
+  0xd5baba6f, 0x887878f0, 0x6f25254a, 0x722e2e5c, 0x241c1c38, 0xf1a6a657,
+  0xc7b4b473, 0x51c6c697, 0x23e8e8cb, 0x7cdddda1, 0x9c7474e8, 0x211f1f3e,
+  0xdd4b4b96, 0xdcbdbd61, 0x868b8b0d, 0x858a8a0f, 0x907070e0, 0x423e3e7c,
+  0xc4b5b571, 0xaa6666cc, 0xd8484890, 0x05030306, 0x01f6f6f7, 0x120e0e1c,
+  0xa36161c2, 0x5f35356a, 0xf95757ae, 0xd0b9b969, 0x91868617, 0x58c1c199,
+  0x271d1d3a, 0xb99e9e27, 0x38e1e1d9, 0x13f8f8eb, 0xb398982b, 0x33111122,
+  0xbb6969d2, 0x70d9d9a9, 0x898e8e07, 0xa7949433, 0xb69b9b2d, 0x221e1e3c,
+  0x92878715, 0x20e9e9c9, 0x49cece87, 0xff5555aa, 0x78282850, 0x7adfdfa5,
+  0x8f8c8c03, 0xf8a1a159, 0x80898909, 0x170d0d1a, 0xdabfbf65, 0x31e6e6d7,
+  0xc6424284, 0xb86868d0, 0xc3414182, 0xb0999929, 0x772d2d5a, 0x110f0f1e,
+  0xcbb0b07b, 0xfc5454a8, 0xd6bbbb6d, 0x3a16162c
+};
+static const uint32_t RT0[256] = {
+  0x50a7f451, 0x5365417e, 0xc3a4171a, 0x965e273a, 0xcb6bab3b, 0xf1459d1f,
+  0xab58faac, 0x9303e34b, 0x55fa3020, 0xf66d76ad, 0x9176cc88, 0x254c02f5,
+  0xfcd7e54f, 0xd7cb2ac5, 0x80443526, 0x8fa362b5, 0x495ab1de, 0x671bba25,
+  0x980eea45, 0xe1c0fe5d, 0x02752fc3, 0x12f04c81, 0xa397468d, 0xc6f9d36b,
+  0xe75f8f03, 0x959c9215, 0xeb7a6dbf, 0xda595295, 0x2d83bed4, 0xd3217458,
+  0x2969e049, 0x44c8c98e, 0x6a89c275, 0x78798ef4, 0x6b3e5899, 0xdd71b927,
+  0xb64fe1be, 0x17ad88f0, 0x66ac20c9, 0xb43ace7d, 0x184adf63, 0x82311ae5,
+  0x60335197, 0x457f5362, 0xe07764b1, 0x84ae6bbb, 0x1ca081fe, 0x942b08f9,
+  0x58684870, 0x19fd458f, 0x876cde94, 0xb7f87b52, 0x23d373ab, 0xe2024b72,
+  0x578f1fe3, 0x2aab5566, 0x0728ebb2, 0x03c2b52f, 0x9a7bc586, 0xa50837d3,
+  0xf2872830, 0xb2a5bf23, 0xba6a0302, 0x5c8216ed, 0x2b1ccf8a, 0x92b479a7,
+  0xf0f207f3, 0xa1e2694e, 0xcdf4da65, 0xd5be0506, 0x1f6234d1, 0x8afea6c4,
+  0x9d532e34, 0xa055f3a2, 0x32e18a05, 0x75ebf6a4, 0x39ec830b, 0xaaef6040,
+  0x069f715e, 0x51106ebd, 0xf98a213e, 0x3d06dd96, 0xae053edd, 0x46bde64d,
+  0xb58d5491, 0x055dc471, 0x6fd40604, 0xff155060, 0x24fb9819, 0x97e9bdd6,
+  0xcc434089, 0x779ed967, 0xbd42e8b0, 0x888b8907, 0x385b19e7, 0xdbeec879,
+  0x470a7ca1, 0xe90f427c, 0xc91e84f8, 0x00000000, 0x83868009, 0x48ed2b32,
+  0xac70111e, 0x4e725a6c, 0xfbff0efd, 0x5638850f, 0x1ed5ae3d, 0x27392d36,
+  0x64d90f0a, 0x21a65c68, 0xd1545b9b, 0x3a2e3624, 0xb1670a0c, 0x0fe75793,
+  0xd296eeb4, 0x9e919b1b, 0x4fc5c080, 0xa220dc61, 0x694b775a, 0x161a121c,
+  0x0aba93e2, 0xe52aa0c0, 0x43e0223c, 0x1d171b12, 0x0b0d090e, 0xadc78bf2,
+  0xb9a8b62d, 0xc8a91e14, 0x8519f157, 0x4c0775af, 0xbbdd99ee, 0xfd607fa3,
+  0x9f2601f7, 0xbcf5725c, 0xc53b6644, 0x347efb5b, 0x7629438b, 0xdcc623cb,
+  0x68fcedb6, 0x63f1e4b8, 0xcadc31d7, 0x10856342, 0x40229713, 0x2011c684,
+  0x7d244a85, 0xf83dbbd2, 0x1132f9ae, 0x6da129c7, 0x4b2f9e1d, 0xf330b2dc,
+  0xec52860d, 0xd0e3c177, 0x6c16b32b, 0x99b970a9, 0xfa489411, 0x2264e947,
+  0xc48cfca8, 0x1a3ff0a0, 0xd82c7d56, 0xef903322, 0xc74e4987, 0xc1d138d9,
+  0xfea2ca8c, 0x360bd498, 0xcf81f5a6, 0x28de7aa5, 0x268eb7da, 0xa4bfad3f,
+  0xe49d3a2c, 0x0d927850, 0x9bcc5f6a, 0x62467e54, 0xc2138df6, 0xe8b8d890,
+  0x5ef7392e, 0xf5afc382, 0xbe805d9f, 0x7c93d069, 0xa92dd56f, 0xb31225cf,
+  0x3b99acc8, 0xa77d1810, 0x6e639ce8, 0x7bbb3bdb, 0x097826cd, 0xf418596e,
+  0x01b79aec, 0xa89a4f83, 0x656e95e6, 0x7ee6ffaa, 0x08cfbc21, 0xe6e815ef,
+  0xd99be7ba, 0xce366f4a, 0xd4099fea, 0xd67cb029, 0xafb2a431, 0x31233f2a,
+  0x3094a5c6, 0xc066a235, 0x37bc4e74, 0xa6ca82fc, 0xb0d090e0, 0x15d8a733,
+  0x4a9804f1, 0xf7daec41, 0x0e50cd7f, 0x2ff69117, 0x8dd64d76, 0x4db0ef43,
+  0x544daacc, 0xdf0496e4, 0xe3b5d19e, 0x1b886a4c, 0xb81f2cc1, 0x7f516546,
+  0x04ea5e9d, 0x5d358c01, 0x737487fa, 0x2e410bfb, 0x5a1d67b3, 0x52d2db92,
+  0x335610e9, 0x1347d66d, 0x8c61d79a, 0x7a0ca137, 0x8e14f859, 0x893c13eb,
+  0xee27a9ce, 0x35c961b7, 0xede51ce1, 0x3cb1477a, 0x59dfd29c, 0x3f73f255,
+  0x79ce1418, 0xbf37c773, 0xeacdf753, 0x5baafd5f, 0x146f3ddf, 0x86db4478,
+  0x81f3afca, 0x3ec468b9, 0x2c342438, 0x5f40a3c2, 0x72c31d16, 0x0c25e2bc,
+  0x8b493c28, 0x41950dff, 0x7101a839, 0xdeb30c08, 0x9ce4b4d8, 0x90c15664,
+  0x6184cb7b, 0x70b632d5, 0x745c6c48, 0x4257b8d0
+};
+
+#define ROTL8(x)  (((x) << 8) | ((x) >> 24))
+#define ROTL16(x) (((x) << 16) | ((x) >> 16))
+#define ROTL24(x) (((x) << 24) | ((x) >> 8))
+
+// One column of a full round, taking row r of the column from word r.
+#define FT(a, b, c, d) (FT0[(a) & 0xff] ^ ROTL8(FT0[((b) >> 8) & 0xff]) ^ \
+                        ROTL16(FT0[((c) >> 16) & 0xff]) ^ ROTL24(FT0[(d) >> 24]))
+#define RT(a, b, c, d) (RT0[(a) & 0xff] ^ ROTL8(RT0[((b) >> 8) & 0xff]) ^ \
+                        ROTL16(RT0[((c) >> 16) & 0xff]) ^ ROTL24(RT0[(d) >> 24]))
+// The same for the last round, which has no (Inv)MixColumns.
+#define FSB(a, b, c, d) ((uint32_t)sbox[(a) & 0xff] ^ ((uint32_t)sbox[((b) >> 8) & 0xff] << 8) ^ \
+                         ((uint32_t)sbox[((c) >> 16) & 0xff] << 16) ^ ((uint32_t)sbox[(d) >> 24] << 24))
+#define RSB(a, b, c, d) ((uint32_t)rsbox[(a) & 0xff] ^ ((uint32_t)rsbox[((b) >> 8) & 0xff] << 8) ^ \
+                         ((uint32_t)rsbox[((c) >> 16) & 0xff] << 16) ^ ((uint32_t)rsbox[(d) >> 24] << 24))
+#endif // #if AES_TTABLE
+
+
 /*****************************************************************************/
 /* Private functions:                                                        */
 /*****************************************************************************/
@@ -248,6 +369,45 @@ static void KeyExpansion(struct AES_ctx* ctx, const uint8_t* Key)
   }
 }
 
+#if AES_TTABLE
+static uint32_t GetU32(const uint8_t* p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void PutU32(uint8_t* p, uint32_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+// Builds the decryption schedule: the encryption round keys in reverse order,
+// with InvMixColumns applied to all but the first and last. This is also the
+// layout AESDEC expects.
+static void InvKeyExpansion(struct AES_ctx* ctx)
+{
+  uint32_t* drk = ctx->InvRoundKeyWords;
+  unsigned round, i;
+
+  for (round = 0; round <= ctx->Nr; ++round)
+  {
+    const uint32_t* rk = ctx->RoundKeyWords + (ctx->Nr - round) * Nb;
+    for (i = 0; i < Nb; ++i)
+    {
+      uint32_t w = rk[i];
+      if (round != 0 && round != ctx->Nr)
+      {
+        w = RT0[sbox[w & 0xff]] ^ ROTL8(RT0[sbox[(w >> 8) & 0xff]]) ^
+            ROTL16(RT0[sbox[(w >> 16) & 0xff]]) ^ ROTL24(RT0[sbox[w >> 24]]);
+      }
+      *drk++ = w;
+    }
+  }
+}
+#endif // #if AES_TTABLE
+
 void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key, uint32_t keylen)
 {
   ctx->KeyLength = keylen;
@@ -264,6 +424,20 @@ void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key, uint32_t keylen)
   default: ctx->Nr = 0; ctx->Nk = 0; break;
   }
   KeyExpansion(ctx, key);
+#if AES_TTABLE
+  {
+    // Reinterpret the byte schedule as little-endian words, in place.
+    unsigned i;
+    for (i = 0; i < Nb * (ctx->Nr + 1); ++i)
+    {
+      ctx->RoundKeyWords[i] = GetU32((const uint8_t*)&ctx->RoundKeyWords[i]);
+    }
+  }
+  InvKeyExpansion(ctx);
+#endif
+#if AES_NI
+  ctx->UseAesNi = __builtin_cpu_supports("aes") != 0;
+#endif
 }
 #if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1))
 void AES_init_ctx_iv(struct AES_ctx* ctx, const uint8_t* key, uint32_t keylen, const uint8_t* iv)
@@ -277,6 +451,7 @@ void AES_ctx_set_iv(struct AES_ctx* ctx, const uint8_t* iv)
 }
 #endif
 
+#if !AES_TTABLE
 // This function adds the round key to state. The round key is added to the
 // state by an XOR function.
 static void AddRoundKey(uint8_t round, state_t* state, const uint8_t* RoundKey)
@@ -496,6 +671,222 @@ static void InvCipher(state_t* state, const struct AES_ctx* ctx)
 }
 #endif // #if (defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1)
 
+#endif // #if !AES_TTABLE
+
+#if AES_NI
+// AES-NI versions of the block functions, compiled for the instructions
+// regardless of the global target flags and only called when the CPU has them.
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+
+AESNI_TARGET
+static void AesNiEncrypt(const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out)
+{
+  const __m128i* rk = (const __m128i*)ctx->RoundKeyWords;
+  __m128i m = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), _mm_loadu_si128(rk));
+  unsigned round;
+  for (round = 1; round < ctx->Nr; ++round)
+  {
+    m = _mm_aesenc_si128(m, _mm_loadu_si128(rk + round));
+  }
+  m = _mm_aesenclast_si128(m, _mm_loadu_si128(rk + ctx->Nr));
+  _mm_storeu_si128((__m128i*)out, m);
+}
+
+#if (defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1)
+AESNI_TARGET
+static void AesNiDecrypt(const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out)
+{
+  const __m128i* rk = (const __m128i*)ctx->InvRoundKeyWords;
+  __m128i m = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), _mm_loadu_si128(rk));
+  unsigned round;
+  for (round = 1; round < ctx->Nr; ++round)
+  {
+    m = _mm_aesdec_si128(m, _mm_loadu_si128(rk + round));
+  }
+  m = _mm_aesdeclast_si128(m, _mm_loadu_si128(rk + ctx->Nr));
+  _mm_storeu_si128((__m128i*)out, m);
+}
+#endif
+#endif // #if AES_NI
+
+// Encrypts one block from in to out, which may be the same buffer.
+static void EncryptBlock(const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out)
+{
+#if AES_NI
+  if (ctx->UseAesNi)
+  {
+    AesNiEncrypt(ctx, in, out);
+    return;
+  }
+#endif
+#if AES_TTABLE
+  const uint32_t* rk = ctx->RoundKeyWords;
+  uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+  unsigned round;
+
+  s0 = GetU32(in) ^ rk[0];
+  s1 = GetU32(in + 4) ^ rk[1];
+  s2 = GetU32(in + 8) ^ rk[2];
+  s3 = GetU32(in + 12) ^ rk[3];
+  for (round = 1; round < ctx->Nr; ++round)
+  {
+    rk += Nb;
+    t0 = rk[0] ^ FT(s0, s1, s2, s3);
+    t1 = rk[1] ^ FT(s1, s2, s3, s0);
+    t2 = rk[2] ^ FT(s2, s3, s0, s1);
+    t3 = rk[3] ^ FT(s3, s0, s1, s2);
+    s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+  }
+  rk += Nb;
+  PutU32(out, rk[0] ^ FSB(s0, s1, s2, s3));
+  PutU32(out + 4, rk[1] ^ FSB(s1, s2, s3, s0));
+  PutU32(out + 8, rk[2] ^ FSB(s2, s3, s0, s1));
+  PutU32(out + 12, rk[3] ^ FSB(s3, s0, s1, s2));
+#else
+  if (in != out)
+  {
+    memcpy(out, in, AES_BLOCKLEN);
+  }
+  Cipher((state_t*)out, ctx);
+#endif
+}
+
+#if (defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1)
+static void DecryptBlock(const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out)
+{
+#if AES_NI
+  if (ctx->UseAesNi)
+  {
+    AesNiDecrypt(ctx, in, out);
+    return;
+  }
+#endif
+#if AES_TTABLE
+  const uint32_t* rk = ctx->InvRoundKeyWords;
+  uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+  unsigned round;
+
+  s0 = GetU32(in) ^ rk[0];
+  s1 = GetU32(in + 4) ^ rk[1];
+  s2 = GetU32(in + 8) ^ rk[2];
+  s3 = GetU32(in + 12) ^ rk[3];
+  for (round = 1; round < ctx->Nr; ++round)
+  {
+    rk += Nb;
+    t0 = rk[0] ^ RT(s0, s3, s2, s1);
+    t1 = rk[1] ^ RT(s1, s0, s3, s2);
+    t2 = rk[2] ^ RT(s2, s1, s0, s3);
+    t3 = rk[3] ^ RT(s3, s2, s1, s0);
+    s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+  }
+  rk += Nb;
+  PutU32(out, rk[0] ^ RSB(s0, s3, s2, s1));
+  PutU32(out + 4, rk[1] ^ RSB(s1, s0, s3, s2));
+  PutU32(out + 8, rk[2] ^ RSB(s2, s1, s0, s3));
+  PutU32(out + 12, rk[3] ^ RSB(s3, s2, s1, s0));
+#else
+  if (in != out)
+  {
+    memcpy(out, in, AES_BLOCKLEN);
+  }
+  InvCipher((state_t*)out, ctx);
+#endif
+}
+#endif // #if (defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1)
+
+#if (defined(CTR) && CTR == 1) || (defined(GCM) && GCM == 1) || (defined(CCM) && CCM == 1)
+// Increments the big-endian counter held in the last width bytes of the block.
+static void IncrementCounter(uint8_t* ctr, int width)
+{
+  int bi;
+  for (bi = AES_BLOCKLEN - 1; bi >= AES_BLOCKLEN - width; --bi)
+  {
+    if (++ctr[bi] != 0)
+    {
+      break;
+    }
+  }
+}
+
+#if AES_NI
+// Counter mode four blocks at a time, so the AESENC latency of one block is
+// hidden behind the others.
+AESNI_TARGET
+static void AesNiCtrBlocks(const struct AES_ctx* ctx, uint8_t* ctr, int width,
+                           const uint8_t* in, uint8_t* out, uint32_t blocks)
+{
+  const __m128i* rk = (const __m128i*)ctx->RoundKeyWords;
+  uint8_t cb[4][AES_BLOCKLEN];
+  __m128i k, b0, b1, b2, b3;
+  unsigned round, j;
+
+  for (; blocks >= 4; blocks -= 4, in += 4 * AES_BLOCKLEN, out += 4 * AES_BLOCKLEN)
+  {
+    for (j = 0; j < 4; ++j)
+    {
+      memcpy(cb[j], ctr, AES_BLOCKLEN);
+      IncrementCounter(ctr, width);
+    }
+    k = _mm_loadu_si128(rk);
+    b0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)cb[0]), k);
+    b1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)cb[1]), k);
+    b2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)cb[2]), k);
+    b3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)cb[3]), k);
+    for (round = 1; round < ctx->Nr; ++round)
+    {
+      k = _mm_loadu_si128(rk + round);
+      b0 = _mm_aesenc_si128(b0, k);
+      b1 = _mm_aesenc_si128(b1, k);
+      b2 = _mm_aesenc_si128(b2, k);
+      b3 = _mm_aesenc_si128(b3, k);
+    }
+    k = _mm_loadu_si128(rk + ctx->Nr);
+    b0 = _mm_aesenclast_si128(b0, k);
+    b1 = _mm_aesenclast_si128(b1, k);
+    b2 = _mm_aesenclast_si128(b2, k);
+    b3 = _mm_aesenclast_si128(b3, k);
+    _mm_storeu_si128((__m128i*)out, _mm_xor_si128(b0, _mm_loadu_si128((const __m128i*)in)));
+    _mm_storeu_si128((__m128i*)(out + 16), _mm_xor_si128(b1, _mm_loadu_si128((const __m128i*)(in + 16))));
+    _mm_storeu_si128((__m128i*)(out + 32), _mm_xor_si128(b2, _mm_loadu_si128((const __m128i*)(in + 32))));
+    _mm_storeu_si128((__m128i*)(out + 48), _mm_xor_si128(b3, _mm_loadu_si128((const __m128i*)(in + 48))));
+  }
+  for (; blocks > 0; --blocks, in += AES_BLOCKLEN, out += AES_BLOCKLEN)
+  {
+    AesNiEncrypt(ctx, ctr, cb[0]);
+    IncrementCounter(ctr, width);
+    _mm_storeu_si128((__m128i*)out, _mm_xor_si128(_mm_loadu_si128((const __m128i*)cb[0]),
+                                                 _mm_loadu_si128((const __m128i*)in)));
+  }
+}
+#endif // #if AES_NI
+
+// Counter mode over whole blocks from in to out, which may be the same buffer.
+// ctr is left holding the next counter block.
+static void CtrBlocks(const struct AES_ctx* ctx, uint8_t* ctr, int width,
+                      const uint8_t* in, uint8_t* out, uint32_t blocks)
+{
+  uint8_t buffer[AES_BLOCKLEN];
+  unsigned i;
+
+#if AES_NI
+  if (ctx->UseAesNi)
+  {
+    AesNiCtrBlocks(ctx, ctr, width, in, out, blocks);
+    return;
+  }
+#endif
+  for (; blocks > 0; --blocks, in += AES_BLOCKLEN, out += AES_BLOCKLEN)
+  {
+    EncryptBlock(ctx, ctr, buffer);
+    IncrementCounter(ctr, width);
+    for (i = 0; i < AES_BLOCKLEN; ++i)
+    {
+      out[i] = in[i] ^ buffer[i];
+    }
+  }
+}
+#endif // #if (defined(CTR) && CTR == 1) || (defined(GCM) && GCM == 1) || (defined(CCM) && CCM == 1)
+
 /*****************************************************************************/
 /* Public functions:                                                         */
 /*****************************************************************************/
@@ -506,14 +897,14 @@ void AES_ECB_encrypt(const struct AES_ctx* ctx, uint8_t* buf)
 {
   // The next function call encrypts the PlainText with the Key using AES
   // algorithm.
-  Cipher((state_t*)buf, ctx);
+  EncryptBlock(ctx, buf, buf);
 }
 
 void AES_ECB_decrypt(const struct AES_ctx* ctx, uint8_t* buf)
 {
   // The next function call decrypts the PlainText with the Key using AES
   // algorithm.
-  InvCipher((state_t*)buf, ctx);
+  DecryptBlock(ctx, buf, buf);
 }
 
 
@@ -542,7 +933,7 @@ void AES_CBC_encrypt_buffer(struct AES_ctx *ctx, uint8_t* buf, uint32_t length)
   for (i = 0; i < length; i += AES_BLOCKLEN)
   {
     XorWithIv(buf, Iv);
-    Cipher((state_t*)buf, ctx);
+    EncryptBlock(ctx, buf, buf);
     Iv = buf;
     buf += AES_BLOCKLEN;
   }
@@ -557,7 +948,7 @@ void AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf,  uint32_t length)
   for (i = 0; i < length; i += AES_BLOCKLEN)
   {
     memcpy(storeNextIv, buf, AES_BLOCKLEN);
-    InvCipher((state_t*)buf, ctx);
+    DecryptBlock(ctx, buf, buf);
     XorWithIv(buf, ctx->Iv);
     memcpy(ctx->Iv, storeNextIv, AES_BLOCKLEN);
     buf += AES_BLOCKLEN;
@@ -573,36 +964,512 @@ void AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf,  uint32_t length)
 
 /* Symmetrical operation: same function for encrypting as for decrypting. Note
 any IV/nonce should never be reused with the same key */
-void AES_CTR_xcrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length)
+void AES_CTR_xcrypt(struct AES_ctx* ctx, const uint8_t* in, uint8_t* out, uint32_t length)
 {
   uint8_t buffer[AES_BLOCKLEN];
+  uint32_t blocks = length / AES_BLOCKLEN;
+  unsigned i;
+
+  CtrBlocks(ctx, ctx->Iv, AES_BLOCKLEN, in, out, blocks);
+  in += blocks * AES_BLOCKLEN;
+  out += blocks * AES_BLOCKLEN;
+  length %= AES_BLOCKLEN;
+  if (length != 0)
+  {
+    /* A trailing partial block still uses up a whole counter value */
+    EncryptBlock(ctx, ctx->Iv, buffer);
+    IncrementCounter(ctx->Iv, AES_BLOCKLEN);
+    for (i = 0; i < length; ++i)
+    {
+      out[i] = in[i] ^ buffer[i];
+    }
+  }
+}
+
+void AES_CTR_xcrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length)
+{
+  AES_CTR_xcrypt(ctx, buf, buf, length);
+}
+
+#endif // #if defined(CTR) && (CTR == 1)
+
+
+
+#if (defined(GCM) && (GCM == 1)) || (defined(CCM) && (CCM == 1))
+#if defined(GCM) && (GCM == 1)
+static uint32_t GetBE32(const uint8_t* p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+#endif
+
+static void PutBE32(uint8_t* p, uint32_t v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+
+#endif
+
+
+
+#if defined(GCM) && (GCM == 1)
+
+// Reduction constants for shifting a GF(2^128) element right by 4 bits.
+static const uint16_t last4[16] = {
+  0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+  0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0 };
+
+// Precomputes the multiples of H by every 4-bit value (Shoup's method), so
+// that GHASH costs 32 table lookups per block instead of 128 shifts.
+static void GcmGenTable(struct AES_GCM_ctx* gcm)
+{
+  uint64_t vh, vl;
+  unsigned i, j;
+
+  vh = ((uint64_t)GetBE32(gcm->H) << 32) | GetBE32(gcm->H + 4);
+  vl = ((uint64_t)GetBE32(gcm->H + 8) << 32) | GetBE32(gcm->H + 12);
+  gcm->HL[8] = vl;
+  gcm->HH[8] = vh;
+  gcm->HL[0] = 0;
+  gcm->HH[0] = 0;
+  for (i = 4; i > 0; i >>= 1)
+  {
+    uint32_t T = (vl & 1) * 0xe1000000U;
+    vl = (vh << 63) | (vl >> 1);
+    vh = (vh >> 1) ^ ((uint64_t)T << 32);
+    gcm->HL[i] = vl;
+    gcm->HH[i] = vh;
+  }
+  for (i = 2; i <= 8; i *= 2)
+  {
+    vh = gcm->HH[i];
+    vl = gcm->HL[i];
+    for (j = 1; j < i; ++j)
+    {
+      gcm->HH[i + j] = vh ^ gcm->HH[j];
+      gcm->HL[i + j] = vl ^ gcm->HL[j];
+    }
+  }
+}
 
+// Y = Y * H in GF(2^128).
+static void GcmMult(struct AES_GCM_ctx* gcm)
+{
+  const uint8_t* x = gcm->Y;
+  uint64_t zh, zl;
+  uint8_t lo, hi, rem;
+  int i;
+
+  lo = x[15] & 0xf;
+  zh = gcm->HH[lo];
+  zl = gcm->HL[lo];
+  for (i = 15; i >= 0; --i)
+  {
+    lo = x[i] & 0xf;
+    hi = x[i] >> 4;
+    if (i != 15)
+    {
+      rem = zl & 0xf;
+      zl = (zh << 60) | (zl >> 4);
+      zh = (zh >> 4) ^ ((uint64_t)last4[rem] << 48);
+      zh ^= gcm->HH[lo];
+      zl ^= gcm->HL[lo];
+    }
+    rem = zl & 0xf;
+    zl = (zh << 60) | (zl >> 4);
+    zh = (zh >> 4) ^ ((uint64_t)last4[rem] << 48);
+    zh ^= gcm->HH[hi];
+    zl ^= gcm->HL[hi];
+  }
+  PutBE32(gcm->Y, zh >> 32);
+  PutBE32(gcm->Y + 4, zh);
+  PutBE32(gcm->Y + 8, zl >> 32);
+  PutBE32(gcm->Y + 12, zl);
+}
+
+#if AES_NI
+#define CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+
+// Carry-less multiply and reduce of two byte-reversed field elements, from
+// Intel's "Carry-Less Multiplication and Its Usage for Computing the GCM
+// Mode" white paper (algorithm 1 with the shift-based reduction).
+CLMUL_TARGET
+static __m128i ClmulGfMul(__m128i a, __m128i b)
+{
+  __m128i t3, t4, t5, t6, t7, t8, t9;
+
+  t3 = _mm_clmulepi64_si128(a, b, 0x00);
+  t4 = _mm_clmulepi64_si128(a, b, 0x10);
+  t5 = _mm_clmulepi64_si128(a, b, 0x01);
+  t6 = _mm_clmulepi64_si128(a, b, 0x11);
+  t4 = _mm_xor_si128(t4, t5);
+  t5 = _mm_slli_si128(t4, 8);
+  t4 = _mm_srli_si128(t4, 8);
+  t3 = _mm_xor_si128(t3, t5);
+  t6 = _mm_xor_si128(t6, t4);
+
+  // Shift the 256-bit product left by one to undo the bit reflection.
+  t7 = _mm_srli_epi32(t3, 31);
+  t8 = _mm_srli_epi32(t6, 31);
+  t3 = _mm_slli_epi32(t3, 1);
+  t6 = _mm_slli_epi32(t6, 1);
+  t9 = _mm_srli_si128(t7, 12);
+  t8 = _mm_slli_si128(t8, 4);
+  t7 = _mm_slli_si128(t7, 4);
+  t3 = _mm_or_si128(t3, t7);
+  t6 = _mm_or_si128(t6, t8);
+  t6 = _mm_or_si128(t6, t9);
+
+  // Reduce modulo x^128 + x^7 + x^2 + x + 1.
+  t7 = _mm_slli_epi32(t3, 31);
+  t8 = _mm_slli_epi32(t3, 30);
+  t9 = _mm_slli_epi32(t3, 25);
+  t7 = _mm_xor_si128(t7, t8);
+  t7 = _mm_xor_si128(t7, t9);
+  t8 = _mm_srli_si128(t7, 4);
+  t7 = _mm_slli_si128(t7, 12);
+  t3 = _mm_xor_si128(t3, t7);
+  t4 = _mm_srli_epi32(t3, 1);
+  t5 = _mm_srli_epi32(t3, 2);
+  t9 = _mm_srli_epi32(t3, 7);
+  t4 = _mm_xor_si128(t4, t5);
+  t4 = _mm_xor_si128(t4, t9);
+  t4 = _mm_xor_si128(t4, t8);
+  t3 = _mm_xor_si128(t3, t4);
+  return _mm_xor_si128(t6, t3);
+}
+
+CLMUL_TARGET
+static void ClmulGhashBlocks(struct AES_GCM_ctx* gcm, const uint8_t* data, uint32_t blocks)
+{
+  const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  __m128i h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)gcm->H), bswap);
+  __m128i y = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)gcm->Y), bswap);
+
+  for (; blocks > 0; --blocks, data += AES_BLOCKLEN)
+  {
+    y = _mm_xor_si128(y, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), bswap));
+    y = ClmulGfMul(y, h);
+  }
+  _mm_storeu_si128((__m128i*)gcm->Y, _mm_shuffle_epi8(y, bswap));
+}
+#endif // #if AES_NI
+
+// Folds whole blocks into the running GHASH.
+static void GhashBlocks(struct AES_GCM_ctx* gcm, const uint8_t* data, uint32_t blocks)
+{
   unsigned i;
-  int bi;
-  for (i = 0, bi = AES_BLOCKLEN; i < length; ++i, ++bi)
+
+#if AES_NI
+  if (gcm->UseClmul)
+  {
+    ClmulGhashBlocks(gcm, data, blocks);
+    return;
+  }
+#endif
+  for (; blocks > 0; --blocks, data += AES_BLOCKLEN)
+  {
+    for (i = 0; i < AES_BLOCKLEN; ++i)
+    {
+      gcm->Y[i] ^= data[i];
+    }
+    GcmMult(gcm);
+  }
+}
+
+// Finishes a block that was partly xor-ed into Y, as if padded with zeros.
+static void GhashPad(struct AES_GCM_ctx* gcm)
+{
+  static const uint8_t zeros[AES_BLOCKLEN];
+  GhashBlocks(gcm, zeros, 1);
+}
+
+void AES_GCM_init(struct AES_GCM_ctx* gcm, const struct AES_ctx* ctx, const uint8_t* iv, uint32_t iv_len)
+{
+  uint8_t block[AES_BLOCKLEN];
+
+  memset(gcm, 0, sizeof(*gcm));
+  EncryptBlock(ctx, gcm->H, gcm->H);
+  GcmGenTable(gcm);
+#if AES_NI
+  gcm->UseClmul = ctx->UseAesNi && __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#endif
+
+  if (iv_len == 12)
+  {
+    memcpy(gcm->J0, iv, 12);
+    gcm->J0[15] = 1;
+  }
+  else
+  {
+    // J0 = GHASH(IV || zero padding || 64-bit bit length of IV)
+    GhashBlocks(gcm, iv, iv_len / AES_BLOCKLEN);
+    if (iv_len % AES_BLOCKLEN != 0)
+    {
+      memset(block, 0, AES_BLOCKLEN);
+      memcpy(block, iv + iv_len - iv_len % AES_BLOCKLEN, iv_len % AES_BLOCKLEN);
+      GhashBlocks(gcm, block, 1);
+    }
+    memset(block, 0, AES_BLOCKLEN);
+    PutBE32(block + 8, iv_len >> 29);
+    PutBE32(block + 12, iv_len << 3);
+    GhashBlocks(gcm, block, 1);
+    memcpy(gcm->J0, gcm->Y, AES_BLOCKLEN);
+    memset(gcm->Y, 0, AES_BLOCKLEN);
+  }
+  memcpy(gcm->Ctr, gcm->J0, AES_BLOCKLEN);
+  IncrementCounter(gcm->Ctr, 4);
+}
+
+void AES_GCM_update_aad(struct AES_GCM_ctx* gcm, const uint8_t* aad, uint32_t length)
+{
+  unsigned used = gcm->AadLen % AES_BLOCKLEN;
+
+  gcm->AadLen += length;
+  for (; length > 0 && used != 0; --length)
   {
-    if (bi == AES_BLOCKLEN) /* we need to regen xor compliment in buffer */
+    gcm->Y[used] ^= *aad++;
+    used = (used + 1) % AES_BLOCKLEN;
+    if (used == 0)
     {
-      memcpy(buffer, ctx->Iv, AES_BLOCKLEN);
-      Cipher((state_t*)buffer, ctx);
+      GcmMult(gcm);
+    }
+  }
+  GhashBlocks(gcm, aad, length / AES_BLOCKLEN);
+  aad += length - length % AES_BLOCKLEN;
+  for (used = 0; used < length % AES_BLOCKLEN; ++used)
+  {
+    gcm->Y[used] ^= aad[used];
+  }
+}
+
+static void GcmCrypt(struct AES_GCM_ctx* gcm, const struct AES_ctx* ctx, const uint8_t* in,
+                     uint8_t* out, uint32_t length, int decrypt)
+{
+  unsigned used = gcm->TextLen % AES_BLOCKLEN;
+  uint32_t blocks;
+  uint8_t c;
+
+  if (length == 0)
+  {
+    return;
+  }
+  if (gcm->TextLen == 0 && gcm->AadLen % AES_BLOCKLEN != 0)
+  {
+    GhashPad(gcm);
+  }
+  gcm->TextLen += length;
+
+  // Use up the keystream of a block left partial by the previous call.
+  for (; length > 0 && used != 0; --length)
+  {
+    c = *in++ ^ gcm->Ks[used];
+    gcm->Y[used] ^= decrypt ? (c ^ gcm->Ks[used]) : c;
+    *out++ = c;
+    used = (used + 1) % AES_BLOCKLEN;
+    if (used == 0)
+    {
+      GcmMult(gcm);
+    }
+  }
+
+  // GHASH always runs over the ciphertext.
+  blocks = length / AES_BLOCKLEN;
+  if (decrypt)
+  {
+    GhashBlocks(gcm, in, blocks);
+    CtrBlocks(ctx, gcm->Ctr, 4, in, out, blocks);
+  }
+  else
+  {
+    CtrBlocks(ctx, gcm->Ctr, 4, in, out, blocks);
+    GhashBlocks(gcm, out, blocks);
+  }
+  in += blocks * AES_BLOCKLEN;
+  out += blocks * AES_BLOCKLEN;
+  length %= AES_BLOCKLEN;
 
-      /* Increment Iv and handle overflow */
-      for (bi = (AES_BLOCKLEN - 1); bi >= 0; --bi)
+  if (length != 0)
+  {
+    EncryptBlock(ctx, gcm->Ctr, gcm->Ks);
+    IncrementCounter(gcm->Ctr, 4);
+    for (used = 0; used < length; ++used)
+    {
+      c = in[used] ^ gcm->Ks[used];
+      gcm->Y[used] ^= decrypt ? in[used] : c;
+      out[used] = c;
+    }
+  }
+}
+
+void AES_GCM_encrypt(struct AES_GCM_ctx* gcm, const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out, uint32_t length)
+{
+  GcmCrypt(gcm, ctx, in, out, length, 0);
+}
+
+void AES_GCM_decrypt(struct AES_GCM_ctx* gcm, const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out, uint32_t length)
+{
+  GcmCrypt(gcm, ctx, in, out, length, 1);
+}
+
+void AES_GCM_finish(struct AES_GCM_ctx* gcm, const struct AES_ctx* ctx, uint8_t* tag)
+{
+  uint8_t block[AES_BLOCKLEN];
+  unsigned i;
+
+  if ((gcm->TextLen != 0 ? gcm->TextLen : gcm->AadLen) % AES_BLOCKLEN != 0)
+  {
+    GhashPad(gcm);
+  }
+  PutBE32(block, gcm->AadLen >> 29);
+  PutBE32(block + 4, gcm->AadLen << 3);
+  PutBE32(block + 8, gcm->TextLen >> 29);
+  PutBE32(block + 12, gcm->TextLen << 3);
+  GhashBlocks(gcm, block, 1);
+
+  EncryptBlock(ctx, gcm->J0, tag);
+  for (i = 0; i < AES_BLOCKLEN; ++i)
+  {
+    tag[i] ^= gcm->Y[i];
+  }
+}
+
+#endif // #if defined(GCM) && (GCM == 1)
+
+
+
+#if defined(CCM) && (CCM == 1)
+
+// Folds data into the CBC-MAC state x, of which the first *used bytes have
+// already been taken.
+static void CbcMacUpdate(const struct AES_ctx* ctx, uint8_t* x, unsigned* used, const uint8_t* data, uint32_t length)
+{
+  unsigned i;
+
+  while (length > 0)
+  {
+    if (*used == 0 && length >= AES_BLOCKLEN)
+    {
+      for (i = 0; i < AES_BLOCKLEN; ++i)
       {
-        /* inc will overflow */
-        if (ctx->Iv[bi] == 255)
-	      {
-          ctx->Iv[bi] = 0;
-          continue;
-        }
-        ctx->Iv[bi] += 1;
-        break;
+        x[i] ^= data[i];
       }
-      bi = 0;
+      EncryptBlock(ctx, x, x);
+      data += AES_BLOCKLEN;
+      length -= AES_BLOCKLEN;
+      continue;
     }
+    x[(*used)++] ^= *data++;
+    --length;
+    if (*used == AES_BLOCKLEN)
+    {
+      EncryptBlock(ctx, x, x);
+      *used = 0;
+    }
+  }
+}
 
-    buf[i] = (buf[i] ^ buffer[bi]);
+static void CcmCrypt(const struct AES_ctx* ctx, const uint8_t* nonce, uint32_t nonce_len,
+                     const uint8_t* aad, uint32_t aad_len, const uint8_t* in, uint8_t* out,
+                     uint32_t length, uint8_t* tag, uint32_t tag_len, int decrypt)
+{
+  const unsigned L = 15 - nonce_len;
+  uint8_t x[AES_BLOCKLEN];
+  uint8_t ctr[AES_BLOCKLEN];
+  uint8_t s0[AES_BLOCKLEN];
+  uint8_t buffer[AES_BLOCKLEN];
+  unsigned used, i;
+  uint32_t blocks;
+
+  // B0: flags, nonce and message length.
+  memset(x, 0, AES_BLOCKLEN);
+  x[0] = (aad_len != 0 ? 0x40 : 0) | (((tag_len - 2) / 2) << 3) | (L - 1);
+  memcpy(x + 1, nonce, nonce_len);
+  for (i = 0; i < L && i < 4; ++i)
+  {
+    x[15 - i] = length >> (8 * i);
+  }
+  EncryptBlock(ctx, x, x);
+
+  // The associated data, prefixed with its encoded length and zero padded.
+  used = 0;
+  if (aad_len != 0)
+  {
+    if (aad_len < 0xff00)
+    {
+      buffer[0] = aad_len >> 8;
+      buffer[1] = aad_len;
+      i = 2;
+    }
+    else
+    {
+      buffer[0] = 0xff;
+      buffer[1] = 0xfe;
+      PutBE32(buffer + 2, aad_len);
+      i = 6;
+    }
+    CbcMacUpdate(ctx, x, &used, buffer, i);
+    CbcMacUpdate(ctx, x, &used, aad, aad_len);
+    if (used != 0)
+    {
+      EncryptBlock(ctx, x, x);
+      used = 0;
+    }
+  }
+
+  // Counter blocks: flags, nonce and a counter that starts at 0 for the tag.
+  memset(ctr, 0, AES_BLOCKLEN);
+  ctr[0] = L - 1;
+  memcpy(ctr + 1, nonce, nonce_len);
+  EncryptBlock(ctx, ctr, s0);
+  IncrementCounter(ctr, L);
+
+  // The MAC is over the plaintext, so it comes before encryption and after
+  // decryption.
+  if (!decrypt)
+  {
+    CbcMacUpdate(ctx, x, &used, in, length);
+  }
+  blocks = length / AES_BLOCKLEN;
+  CtrBlocks(ctx, ctr, L, in, out, blocks);
+  if (length % AES_BLOCKLEN != 0)
+  {
+    EncryptBlock(ctx, ctr, buffer);
+    for (i = 0; i < length % AES_BLOCKLEN; ++i)
+    {
+      out[blocks * AES_BLOCKLEN + i] = in[blocks * AES_BLOCKLEN + i] ^ buffer[i];
+    }
+  }
+  if (decrypt)
+  {
+    CbcMacUpdate(ctx, x, &used, out, length);
+  }
+  if (used != 0)
+  {
+    EncryptBlock(ctx, x, x);
+  }
+
+  for (i = 0; i < tag_len; ++i)
+  {
+    tag[i] = x[i] ^ s0[i];
   }
 }
 
-#endif // #if defined(CTR) && (CTR == 1)
+void AES_CCM_encrypt(const struct AES_ctx* ctx, const uint8_t* nonce, uint32_t nonce_len,
+                     const uint8_t* aad, uint32_t aad_len, const uint8_t* in, uint8_t* out,
+                     uint32_t length, uint8_t* tag, uint32_t tag_len)
+{
+  CcmCrypt(ctx, nonce, nonce_len, aad, aad_len, in, out, length, tag, tag_len, 0);
+}
+
+void AES_CCM_decrypt(const struct AES_ctx* ctx, const uint8_t* nonce, uint32_t nonce_len,
+                     const uint8_t* aad, uint32_t aad_len, const uint8_t* in, uint8_t* out,
+                     uint32_t length, uint8_t* tag, uint32_t tag_len)
+{
+  CcmCrypt(ctx, nonce, nonce_len, aad, aad_len, in, out, length, tag, tag_len, 1);
+}
+
+#endif // #if defined(CCM) && (CCM == 1)
@@ -1,13 +1,25 @@
 #ifndef _AES_H_
 #define _AES_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 // #define the macros below to 1/0 to enable/disable the mode of operation.
 //
 // CBC enables AES encryption in CBC-mode of operation.
 // CTR enables encryption in counter-mode.
-// ECB enables the basic ECB 16-byte block algorithm. All can be enabled simultaneously.
+// ECB enables the basic ECB 16-byte block algorithm.
+// GCM enables the Galois/Counter authenticated mode (NIST SP 800-38D).
+// CCM enables the counter with CBC-MAC authenticated mode (NIST SP 800-38C).
+// All can be enabled simultaneously.
+//
+// AES_TTABLE selects the cipher core: 1 uses 32-bit table lookups (two 1 KiB
+// tables, several times faster), 0 uses the original byte-oriented rounds for
+// builds where flash is tight. Neither is constant-time with respect to cache
+// timing.
+//
+// AES_NI adds an AES-NI/PCLMULQDQ backend on x86-64 hosts, picked at run time
+// when the CPU supports it. It needs AES_TTABLE for the round key layout.
 
 // The #ifndef-guard allows it to be configured before #include'ing or at compile time.
 #ifndef CBC
@@ -22,6 +34,26 @@
   #define CTR 1
 #endif
 
+#ifndef GCM
+  #define GCM 1
+#endif
+
+#ifndef CCM
+  #define CCM 1
+#endif
+
+#ifndef AES_TTABLE
+  #define AES_TTABLE 1
+#endif
+
+#ifndef AES_NI
+  #if defined(__x86_64__) && defined(__GNUC__) && AES_TTABLE
+    #define AES_NI 1
+  #else
+    #define AES_NI 0
+  #endif
+#endif
+
 
 #define AES128 1
 #define AES192 1
@@ -42,6 +74,14 @@
     #define AES_keyExpSize128 176
 #endif
 
+#if defined(AES256) && (AES256 == 1)
+    #define AES_keyExpSizeMax AES_keyExpSize256
+#elif defined(AES192) && (AES192 == 1)
+    #define AES_keyExpSizeMax AES_keyExpSize192
+#else
+    #define AES_keyExpSizeMax AES_keyExpSize128
+#endif
+
 struct AES_ctx
 {
   union {
@@ -53,16 +93,46 @@ struct AES_ctx
 #endif
 #if defined(AES128) && (AES128 == 1)
     uint8_t RoundKey128[AES_keyExpSize128];
+#endif
+#if AES_TTABLE
+    // The same schedule read as little-endian words.
+    uint32_t RoundKeyWords[AES_keyExpSizeMax / 4];
 #endif
   };
+#if AES_TTABLE
+  // Decryption schedule for the equivalent inverse cipher (FIPS-197 5.3.5).
+  uint32_t InvRoundKeyWords[AES_keyExpSizeMax / 4];
+#endif
 #if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1))
   uint8_t Iv[AES_BLOCKLEN];
 #endif
   uint32_t KeyLength;
   uint8_t Nr;
   uint8_t Nk;
+#if AES_NI
+  uint8_t UseAesNi;
+#endif
 };
 
+#if defined(GCM) && (GCM == 1)
+struct AES_GCM_ctx
+{
+  // 4-bit multiplication table for the hash subkey H
+  uint64_t HL[16];
+  uint64_t HH[16];
+  uint8_t H[AES_BLOCKLEN];
+  uint8_t J0[AES_BLOCKLEN];   // pre-counter block, masks the tag
+  uint8_t Ctr[AES_BLOCKLEN];  // next counter block
+  uint8_t Y[AES_BLOCKLEN];    // running GHASH value
+  uint8_t Ks[AES_BLOCKLEN];   // keystream of a partially used block
+  uint64_t AadLen;
+  uint64_t TextLen;
+#if AES_NI
+  uint8_t UseClmul;
+#endif
+};
+#endif
+
 void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key, uint32_t keylen);
 #if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1))
 void AES_init_ctx_iv(struct AES_ctx* ctx, const uint8_t* key, uint32_t keylen, const uint8_t* iv);
@@ -98,8 +168,41 @@ void AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length);
 // NOTES: you need to set IV in ctx with AES_init_ctx_iv() or AES_ctx_set_iv()
 //        no IV should ever be reused with the same key
 void AES_CTR_xcrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length);
+// As above, reading from in and writing to out, which may be the same buffer.
+void AES_CTR_xcrypt(struct AES_ctx* ctx, const uint8_t* in, uint8_t* out, uint32_t length);
 
 #endif // #if defined(CTR) && (CTR == 1)
 
 
+#if defined(GCM) && (GCM == 1)
+
+// Start a message. Any IV length is accepted, 12 bytes is the fast path.
+// Then feed all of the associated data, then the text in pieces of any size,
+// and finally produce the 16 byte tag. in and out may be the same buffer.
+void AES_GCM_init(struct AES_GCM_ctx* gcm, const struct AES_ctx* ctx, const uint8_t* iv, uint32_t iv_len);
+void AES_GCM_update_aad(struct AES_GCM_ctx* gcm, const uint8_t* aad, uint32_t length);
+void AES_GCM_encrypt(struct AES_GCM_ctx* gcm, const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out, uint32_t length);
+void AES_GCM_decrypt(struct AES_GCM_ctx* gcm, const struct AES_ctx* ctx, const uint8_t* in, uint8_t* out, uint32_t length);
+void AES_GCM_finish(struct AES_GCM_ctx* gcm, const struct AES_ctx* ctx, uint8_t* tag);
+
+#endif // #if defined(GCM) && (GCM == 1)
+
+
+#if defined(CCM) && (CCM == 1)
+
+// CCM needs the message length before the associated data, so a message is
+// processed in one call. nonce_len is 7 to 13 and the message must fit in
+// 15 - nonce_len bytes of length; tag_len is even, 4 to 16. On decryption the
+// tag written is the one computed over the plaintext, for the caller to
+// compare.
+void AES_CCM_encrypt(const struct AES_ctx* ctx, const uint8_t* nonce, uint32_t nonce_len,
+                     const uint8_t* aad, uint32_t aad_len, const uint8_t* in, uint8_t* out,
+                     uint32_t length, uint8_t* tag, uint32_t tag_len);
+void AES_CCM_decrypt(const struct AES_ctx* ctx, const uint8_t* nonce, uint32_t nonce_len,
+                     const uint8_t* aad, uint32_t aad_len, const uint8_t* in, uint8_t* out,
+                     uint32_t length, uint8_t* tag, uint32_t tag_len);
+
+#endif // #if defined(CCM) && (CCM == 1)
+
+
 #endif // _AES_H_
@@ -0,0 +1,126 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/misc.h"
+
+#include "shared-module/canio/Filter.h"
+
+#define KEY_EXTENDED (1u << 31)
+
+typedef struct {
+    uint32_t mask;
+    uint32_t key;
+} filter_entry_t;
+
+STATIC bool entry_less(const filter_entry_t *a, const filter_entry_t *b) {
+    return a->mask < b->mask || (a->mask == b->mask && a->key < b->key);
+}
+
+canio_filter_t *canio_filter_new(size_t nmatch, canio_match_obj_t **matches) {
+    if (nmatch == 0) {
+        return NULL;
+    }
+
+    // Sort by mask then masked id, dropping duplicates. Long match lists are
+    // the reason for the software filter, so sort on the heap rather than the
+    // stack. Lists are built once per listen(), so an insertion sort is fine.
+    filter_entry_t *entries = m_new(filter_entry_t, nmatch);
+    size_t n = 0;
+    for (size_t i = 0; i < nmatch; i++) {
+        uint32_t mask = (uint32_t)matches[i]->mask | KEY_EXTENDED;
+        filter_entry_t entry = {
+            .mask = mask,
+            .key = ((uint32_t)matches[i]->id | (matches[i]->extended ? KEY_EXTENDED : 0)) & mask,
+        };
+        size_t j = n;
+        while (j > 0 && entry_less(&entry, &entries[j - 1])) {
+            j--;
+        }
+        if (j > 0 && entries[j - 1].mask == entry.mask && entries[j - 1].key == entry.key) {
+            continue;
+        }
+        for (size_t k = n; k > j; k--) {
+            entries[k] = entries[k - 1];
+        }
+        entries[j] = entry;
+        n++;
+    }
+
+    size_t n_groups = 1;
+    for (size_t i = 1; i < n; i++) {
+        if (entries[i].mask != entries[i - 1].mask) {
+            n_groups++;
+        }
+    }
+
+    // Header, groups and ids share one allocation.
+    canio_filter_t *filter = m_malloc(sizeof(canio_filter_t) + n_groups * sizeof(canio_filter_group_t) + n * sizeof(uint32_t), false);
+    filter->n_groups = n_groups;
+    filter->groups = (canio_filter_group_t *)(filter + 1);
+    filter->ids = (uint32_t *)(filter->groups + n_groups);
+
+    canio_filter_group_t *group = filter->groups;
+    group->mask = entries[0].mask;
+    group->start = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (entries[i].mask != group->mask) {
+            group->end = i;
+            group++;
+            group->mask = entries[i].mask;
+            group->start = i;
+        }
+        filter->ids[i] = entries[i].key;
+    }
+    group->end = n;
+    m_del(filter_entry_t, entries, nmatch);
+    return filter;
+}
+
+bool canio_filter_matches(const canio_filter_t *filter, uint32_t id, bool extended) {
+    if (filter == NULL) {
+        return true;
+    }
+    uint32_t key = id | (extended ? KEY_EXTENDED : 0);
+    for (size_t g = 0; g < filter->n_groups; g++) {
+        const canio_filter_group_t *group = &filter->groups[g];
+        uint32_t masked = key & group->mask;
+        size_t lo = group->start;
+        size_t hi = group->end;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            uint32_t value = filter->ids[mid];
+            if (value == masked) {
+                return true;
+            }
+            if (value < masked) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,53 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "shared-module/canio/Match.h"
+
+// Matches compiled into groups that share a mask. Within a group the masked
+// ids are sorted, so a frame costs one binary search per distinct mask rather
+// than a compare per Match. Keys carry the extended flag in bit 31 so standard
+// and extended ids never match each other.
+typedef struct {
+    uint32_t mask;
+    uint32_t start;
+    uint32_t end;
+} canio_filter_group_t;
+
+typedef struct {
+    size_t n_groups;
+    canio_filter_group_t *groups;
+    uint32_t *ids;
+} canio_filter_t;
+
+// Returns NULL, which matches everything, when there are no matches.
+canio_filter_t *canio_filter_new(size_t nmatch, canio_match_obj_t **matches);
+bool canio_filter_matches(const canio_filter_t *filter, uint32_t id, bool extended);
@@ -25,6 +25,7 @@
  */
 
 #include "shared-module/canio/Message.h"
+#include "shared-bindings/canio/Message.h"
 
 #include <string.h>
 
@@ -75,3 +76,17 @@ void common_hal_canio_message_set_extended(canio_message_obj_t *self, bool exten
 {
     self->extended = extended;
 }
+
+mp_obj_t canio_message_new_from_frame(const canio_frame_t *frame)
+{
+    bool rtr = frame->flags & CANIO_FRAME_RTR;
+    canio_message_obj_t *message = m_new_obj(canio_message_obj_t);
+    message->base.type = rtr ? &canio_remote_transmission_request_type : &canio_message_type;
+    message->id = frame->id;
+    message->size = frame->dlc;
+    message->extended = frame->flags & CANIO_FRAME_EXTENDED;
+    if (!rtr) {
+        memcpy(message->data, frame->data, sizeof(message->data));
+    }
+    return message;
+}
@@ -27,6 +27,7 @@
 #pragma once
 
 #include "py/obj.h"
+#include "shared-module/canio/Frame.h"
 
 typedef struct {
     mp_obj_base_t base;
@@ -35,3 +36,7 @@ typedef struct {
     size_t size:4;
     bool extended:1;
 } canio_message_obj_t;
+
+// Allocates the Message or RemoteTransmissionRequest that Listener.receive()
+// returns for a received frame.
+mp_obj_t canio_message_new_from_frame(const canio_frame_t *frame);
@@ -0,0 +1,200 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+#include "shared-bindings/os/__init__.h"
+#include "shared-bindings/random/Random.h"
+#include "shared-bindings/time/__init__.h"
+#include "supervisor/shared/translate.h"
+
+// xoshiro128++ 1.0 by David Blackman and Sebastiano Vigna
+// https://prng.di.unimi.it/xoshiro128plusplus.c
+// Public Domain
+
+STATIC inline uint32_t rotl(const uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+STATIC inline uint32_t xoshiro128pp(uint32_t *s) {
+    const uint32_t result = rotl(s[0] + s[3], 7) + s[0];
+    const uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 11);
+    return result;
+}
+
+// End of xoshiro128++
+
+// The state is expanded from a seed with SplitMix64, as the xoshiro authors
+// recommend, so that similar seeds give unrelated sequences.
+STATIC uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+void shared_modules_random_random_seed(random_random_obj_t *self, mp_uint_t seed) {
+    uint64_t x = seed;
+    for (size_t i = 0; i < 4; i += 2) {
+        uint64_t z = splitmix64(&x);
+        self->s[i] = (uint32_t)z;
+        self->s[i + 1] = (uint32_t)(z >> 32);
+    }
+}
+
+// Seed from os.urandom() when available or the uptime otherwise.
+void shared_modules_random_random_seed_urandom(random_random_obj_t *self) {
+    if (!common_hal_os_urandom((uint8_t *)self->s, sizeof(self->s)) ||
+        (self->s[0] | self->s[1] | self->s[2] | self->s[3]) == 0) {
+        shared_modules_random_random_seed(self, common_hal_time_monotonic());
+    }
+}
+
+STATIC inline uint32_t random_next(random_random_obj_t *self) {
+    if ((self->s[0] | self->s[1] | self->s[2] | self->s[3]) == 0) {
+        shared_modules_random_random_seed_urandom(self);
+    }
+    return xoshiro128pp(self->s);
+}
+
+// n must be between 1 and 32.
+mp_uint_t shared_modules_random_random_getrandbits(random_random_obj_t *self, uint8_t n) {
+    return random_next(self) >> (32 - n);
+}
+
+// Returns an unsigned integer below n, which must not be zero, without bias.
+// Lemire's method needs a division only for the rare rejected values.
+STATIC mp_uint_t random_below(random_random_obj_t *self, mp_uint_t n) {
+    #if MP_SSIZE_MAX > 0x7fffffff
+    if (n > 0xffffffff) {
+        mp_uint_t mask = n - 1;
+        mask |= mask >> 1;
+        mask |= mask >> 2;
+        mask |= mask >> 4;
+        mask |= mask >> 8;
+        mask |= mask >> 16;
+        mask |= mask >> 32;
+        mp_uint_t r;
+        do {
+            r = (((mp_uint_t)random_next(self) << 32) | random_next(self)) & mask;
+        } while (r >= n);
+        return r;
+    }
+    #endif
+    uint64_t m = (uint64_t)random_next(self) * (uint32_t)n;
+    if ((uint32_t)m < (uint32_t)n) {
+        uint32_t threshold = -(uint32_t)n % (uint32_t)n;
+        while ((uint32_t)m < threshold) {
+            m = (uint64_t)random_next(self) * (uint32_t)n;
+        }
+    }
+    return m >> 32;
+}
+
+mp_int_t shared_modules_random_random_randrange(random_random_obj_t *self, mp_int_t start, mp_int_t stop, mp_int_t step) {
+    mp_int_t n;
+    if (step > 0) {
+        n = (stop - start + step - 1) / step;
+    } else if (step < 0) {
+        n = (stop - start + step + 1) / step;
+    } else {
+        mp_raise_ValueError(translate("step must be non-zero"));
+    }
+    if (n <= 0) {
+        if (step == 1) {
+            mp_raise_ValueError(translate("stop not reachable from start"));
+        }
+        mp_raise_ValueError(translate("invalid step"));
+    }
+    return start + step * (mp_int_t)random_below(self, n);
+}
+
+// Floats in [0, 1) from the top bits, which are the best ones for xoshiro.
+STATIC inline float random_next_float(random_random_obj_t *self) {
+    return (random_next(self) >> 8) * (1.0f / (1 << 24));
+}
+
+STATIC inline double random_next_double(random_random_obj_t *self) {
+    uint64_t high = random_next(self) >> 5;
+    uint64_t low = random_next(self) >> 6;
+    return ((high << 26) | low) * (1.0 / ((uint64_t)1 << 53));
+}
+
+mp_float_t shared_modules_random_random_random(random_random_obj_t *self) {
+    #if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_DOUBLE
+    return random_next_double(self);
+    #else
+    return random_next_float(self);
+    #endif
+}
+
+mp_float_t shared_modules_random_random_uniform(random_random_obj_t *self, mp_float_t a, mp_float_t b) {
+    return a + (b - a) * shared_modules_random_random_random(self);
+}
+
+void shared_modules_random_random_fill_bytes(random_random_obj_t *self, uint8_t *buf, size_t len) {
+    while (len >= sizeof(uint32_t)) {
+        uint32_t r = random_next(self);
+        memcpy(buf, &r, sizeof(r));
+        buf += sizeof(r);
+        len -= sizeof(r);
+    }
+    if (len > 0) {
+        uint32_t r = random_next(self);
+        memcpy(buf, &r, len);
+    }
+}
+
+// Fill a buffer according to its typecode: floats in [0, 1) for 'f' and 'd'
+// arrays, and random bits for everything else.
+void shared_modules_random_random_fill(random_random_obj_t *self, void *buf, size_t len, char typecode) {
+    switch (typecode) {
+        case 'f': {
+            float *f = buf;
+            for (size_t i = len / sizeof(float); i > 0; --i) {
+                *f++ = random_next_float(self);
+            }
+            break;
+        }
+        case 'd': {
+            double *d = buf;
+            for (size_t i = len / sizeof(double); i > 0; --i) {
+                *d++ = random_next_double(self);
+            }
+            break;
+        }
+        default:
+            shared_modules_random_random_fill_bytes(self, buf, len);
+            break;
+    }
+}
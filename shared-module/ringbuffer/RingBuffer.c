@@ -0,0 +1,209 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+#include "shared-bindings/ringbuffer/RingBuffer.h"
+
+// The storage a record takes, as laid out by ringbuf_record_reserve().
+STATIC size_t record_storage(size_t record_size) {
+    return sizeof(uint32_t) + ((record_size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1));
+}
+
+STATIC mp_obj_array_t *new_view(bool writable) {
+    mp_obj_array_t *view = MP_OBJ_TO_PTR(mp_obj_new_memoryview('B', 0, NULL));
+    if (writable) {
+        view->typecode |= MP_OBJ_ARRAY_TYPECODE_FLAG_RW;
+    }
+    return view;
+}
+
+// Points view at data within the ring's storage.  The view holds the start of
+// the storage and the offset to data, so it keeps the storage alive on its
+// own: the GC only follows pointers to the start of a block.
+STATIC void view_set(mp_obj_array_t *view, ringbuf_t *ring, uint8_t *data, size_t len) {
+    view->items = ring->buf;
+    view->free = data - ring->buf;
+    view->len = len;
+}
+
+STATIC void view_clear(mp_obj_array_t *view) {
+    view->items = NULL;
+    view->free = 0;
+    view->len = 0;
+}
+
+void common_hal_ringbuffer_ringbuffer_construct(ringbuffer_ringbuffer_obj_t *self, size_t size, size_t record_size) {
+    size_t capacity = size;
+    if (record_size > 0) {
+        // A record that doesn't fit before the end of the storage starts again
+        // at the beginning, which can waste up to one record per lap.
+        capacity = (size + 1) * record_storage(record_size);
+    }
+    if (!ringbuf_alloc(&self->ring, capacity, false)) {
+        m_malloc_fail(capacity);
+    }
+    self->record_size = record_size;
+    self->records_put = 0;
+    self->records_got = 0;
+    self->read_view = new_view(false);
+    self->write_view = new_view(true);
+}
+
+size_t common_hal_ringbuffer_ringbuffer_get_capacity(ringbuffer_ringbuffer_obj_t *self) {
+    return ringbuf_capacity(&self->ring);
+}
+
+size_t common_hal_ringbuffer_ringbuffer_get_record_size(ringbuffer_ringbuffer_obj_t *self) {
+    return self->record_size;
+}
+
+size_t common_hal_ringbuffer_ringbuffer_get_in_waiting(ringbuffer_ringbuffer_obj_t *self) {
+    if (self->record_size > 0) {
+        return self->records_put - self->records_got;
+    }
+    return ringbuf_num_filled(&self->ring);
+}
+
+bool common_hal_ringbuffer_ringbuffer_can_put(ringbuffer_ringbuffer_obj_t *self) {
+    if (self->record_size > 0) {
+        // Room for the largest record wherever the next one lands.
+        return ringbuf_num_empty(&self->ring) >= 2 * record_storage(self->record_size);
+    }
+    return ringbuf_num_empty(&self->ring) > 0;
+}
+
+size_t common_hal_ringbuffer_ringbuffer_put_from(ringbuffer_ringbuffer_obj_t *self, const uint8_t *data, size_t len) {
+    if (self->record_size == 0) {
+        return ringbuf_put_n(&self->ring, data, len);
+    }
+    if (!ringbuf_record_put(&self->ring, data, len)) {
+        return 0;
+    }
+    self->records_put++;
+    return len;
+}
+
+// Returns the number of bytes read. In record mode a record longer than len
+// is left in place and *too_small is set.
+size_t common_hal_ringbuffer_ringbuffer_get_into(ringbuffer_ringbuffer_obj_t *self, uint8_t *data, size_t len, bool *too_small) {
+    *too_small = false;
+    if (self->record_size == 0) {
+        return ringbuf_get_n(&self->ring, data, len);
+    }
+    size_t record_len;
+    const uint8_t *record = ringbuf_record_peek(&self->ring, &record_len);
+    if (record == NULL) {
+        return 0;
+    }
+    if (record_len > len) {
+        *too_small = true;
+        return 0;
+    }
+    memcpy(data, record, record_len);
+    ringbuf_record_release(&self->ring);
+    self->records_got++;
+    return record_len;
+}
+
+mp_obj_t common_hal_ringbuffer_ringbuffer_peek(ringbuffer_ringbuffer_obj_t *self) {
+    size_t len;
+    uint8_t *data;
+    if (self->record_size == 0) {
+        data = ringbuf_peek_n(&self->ring, &len);
+    } else {
+        data = ringbuf_record_peek(&self->ring, &len);
+    }
+    if (data == NULL || len == 0) {
+        view_clear(self->read_view);
+        return mp_const_none;
+    }
+    view_set(self->read_view, &self->ring, data, len);
+    return MP_OBJ_FROM_PTR(self->read_view);
+}
+
+// Releases len bytes of what peek() returned, or the whole record.
+void common_hal_ringbuffer_ringbuffer_release(ringbuffer_ringbuffer_obj_t *self, size_t len) {
+    if (self->record_size == 0) {
+        ringbuf_release_n(&self->ring, len);
+    } else {
+        ringbuf_record_release(&self->ring);
+        self->records_got++;
+    }
+    view_clear(self->read_view);
+}
+
+size_t common_hal_ringbuffer_ringbuffer_get_peeked(ringbuffer_ringbuffer_obj_t *self) {
+    return self->read_view->len;
+}
+
+mp_obj_t common_hal_ringbuffer_ringbuffer_reserve(ringbuffer_ringbuffer_obj_t *self, size_t len) {
+    uint8_t *data;
+    if (self->record_size == 0) {
+        size_t available;
+        data = ringbuf_reserve_n(&self->ring, &available);
+        if (len > available) {
+            len = available;
+        }
+    } else {
+        data = ringbuf_record_reserve(&self->ring, len);
+    }
+    if (data == NULL || len == 0) {
+        view_clear(self->write_view);
+        return mp_const_none;
+    }
+    view_set(self->write_view, &self->ring, data, len);
+    return MP_OBJ_FROM_PTR(self->write_view);
+}
+
+void common_hal_ringbuffer_ringbuffer_commit(ringbuffer_ringbuffer_obj_t *self, size_t len) {
+    if (self->record_size == 0) {
+        ringbuf_commit_n(&self->ring, len);
+    } else {
+        ringbuf_record_commit(&self->ring, len);
+        self->records_put++;
+    }
+    view_clear(self->write_view);
+}
+
+size_t common_hal_ringbuffer_ringbuffer_get_reserved(ringbuffer_ringbuffer_obj_t *self) {
+    return self->write_view->len;
+}
+
+void common_hal_ringbuffer_ringbuffer_clear(ringbuffer_ringbuffer_obj_t *self) {
+    if (self->record_size == 0) {
+        ringbuf_clear(&self->ring);
+    } else {
+        // One at a time, so the count stays right if the producer is running.
+        size_t len;
+        while (ringbuf_record_peek(&self->ring, &len) != NULL) {
+            ringbuf_record_release(&self->ring);
+            self->records_got++;
+        }
+    }
+    view_clear(self->read_view);
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_RINGBUFFER_RINGBUFFER_H
+#define MICROPY_INCLUDED_SHARED_MODULE_RINGBUFFER_RINGBUFFER_H
+
+#include "py/obj.h"
+#include "py/objarray.h"
+#include "py/ringbuf.h"
+
+typedef struct {
+    mp_obj_base_t base;
+    ringbuf_t ring;
+    // 0 for a byte stream, else the largest record.
+    size_t record_size;
+    // Each written by one side only, so counting records needs no lock.
+    uint32_t records_put;
+    uint32_t records_got;
+    // The memoryviews returned by peek() and reserve(). They are reused, and
+    // emptied once released or committed so a stale one can't be used.
+    mp_obj_array_t *read_view;
+    mp_obj_array_t *write_view;
+} ringbuffer_ringbuffer_obj_t;
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_RINGBUFFER_RINGBUFFER_H
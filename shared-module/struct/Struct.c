@@ -0,0 +1,399 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/binary.h"
+#include "py/mpstate.h"
+#include "py/objint.h"
+#include "py/runtime.h"
+#include "py/smallint.h"
+#include "shared-bindings/struct/Struct.h"
+#include "shared-module/struct/__init__.h"
+#include "supervisor/shared/translate.h"
+
+// A format is parsed once into runs of fields at fixed offsets, so packing
+// and unpacking is a walk over the runs with the byte order already decided.
+
+struct_struct_obj_t *shared_modules_struct_struct_compile(mp_obj_t fmt_in) {
+    const char *fmt = mp_obj_str_get_str(fmt_in);
+    char fmt_type = get_fmt_type(&fmt);
+
+    // Every run needs at least one typecode character.
+    size_t max_fields = 0;
+    for (const char *f = fmt; *f; f++) {
+        if (!unichar_isdigit(*f)) {
+            max_fields++;
+        }
+    }
+
+    struct_struct_obj_t *self = m_new_obj_var(struct_struct_obj_t, struct_field_t, max_fields);
+    self->base.type = &struct_struct_type;
+    self->format = fmt_in;
+    if (fmt_type == '@' || fmt_type == '=') {
+        self->big_endian = MP_ENDIANNESS_BIG;
+    } else {
+        self->big_endian = fmt_type == '>';
+    }
+    // Only native mode uses native sizes and alignment.
+    char size_type = fmt_type == '@' ? '@' : '<';
+
+    mp_uint_t offset = 0;
+    mp_uint_t n_items = 0;
+    size_t n_fields = 0;
+    while (*fmt) {
+        mp_uint_t cnt = 1;
+        if (unichar_isdigit(*fmt)) {
+            cnt = get_fmt_num(&fmt);
+        }
+        char typecode = *fmt;
+        struct_validate_format(typecode);
+
+        mp_uint_t size = 1;
+        mp_uint_t align = 1;
+        if (typecode == 's') {
+            n_items++;
+        } else {
+            // Raises on an unknown typecode, including a trailing count.
+            size = mp_binary_get_size(size_type, typecode, &align);
+            if (typecode != 'x') {
+                n_items += cnt;
+            }
+            if (cnt == 0) {
+                fmt++;
+                continue;
+            }
+            offset = (offset + align - 1) & ~(align - 1);
+        }
+        fmt++;
+
+        struct_field_t *prev = n_fields > 0 ? &self->fields[n_fields - 1] : NULL;
+        if (prev != NULL && typecode != 's' && prev->typecode == typecode
+            && prev->offset + prev->count * prev->size == offset) {
+            // "HH" and "2H" compile to the same run.
+            prev->count += cnt;
+        } else {
+            struct_field_t *field = &self->fields[n_fields++];
+            field->offset = offset;
+            field->count = cnt;
+            field->size = size;
+            field->typecode = typecode;
+        }
+        offset += cnt * size;
+    }
+
+    self->size = offset;
+    self->n_items = n_items;
+    self->n_fields = n_fields;
+    return self;
+}
+
+struct_struct_obj_t *shared_modules_struct_struct_lookup(mp_obj_t fmt_in) {
+    #if MICROPY_PY_STRUCT_FORMAT_CACHE
+    mp_obj_t *cache = MP_STATE_VM(struct_format_cache);
+    size_t len;
+    const char *fmt = mp_obj_str_get_data(fmt_in, &len);
+    size_t i;
+    for (i = 0; i < MICROPY_PY_STRUCT_FORMAT_CACHE; i++) {
+        struct_struct_obj_t *s = cache[i];
+        if (s == NULL) {
+            break;
+        }
+        if (s->format != fmt_in) {
+            size_t s_len;
+            const char *s_fmt = mp_obj_str_get_data(s->format, &s_len);
+            if (s_len != len || memcmp(s_fmt, fmt, len) != 0) {
+                continue;
+            }
+        }
+        // Keep the most recently used formats at the front.
+        memmove(&cache[1], &cache[0], i * sizeof(mp_obj_t));
+        cache[0] = s;
+        return s;
+    }
+    // Miss: evict the least recently used entry if the cache is full.
+    struct_struct_obj_t *s = shared_modules_struct_struct_compile(fmt_in);
+    memmove(&cache[1], &cache[0], MIN(i, MICROPY_PY_STRUCT_FORMAT_CACHE - 1) * sizeof(mp_obj_t));
+    cache[0] = s;
+    return s;
+    #else
+    return shared_modules_struct_struct_compile(fmt_in);
+    #endif
+}
+
+STATIC void put_uint(byte *p, size_t size, bool big_endian, uint64_t val) {
+    if (big_endian) {
+        while (size--) {
+            p[size] = val;
+            val >>= 8;
+        }
+    } else {
+        while (size--) {
+            *p++ = val;
+            val >>= 8;
+        }
+    }
+}
+
+STATIC uint64_t get_uint(const byte *p, size_t size, bool big_endian) {
+    uint64_t val = 0;
+    if (big_endian) {
+        for (size_t i = 0; i < size; i++) {
+            val = (val << 8) | p[i];
+        }
+    } else {
+        while (size--) {
+            val = (val << 8) | p[size];
+        }
+    }
+    return val;
+}
+
+STATIC void pack_int(mp_obj_t val_in, byte *p, size_t size, bool is_signed, bool big_endian) {
+    mp_int_t val;
+    if (MP_OBJ_IS_SMALL_INT(val_in)) {
+        val = MP_OBJ_SMALL_INT_VALUE(val_in);
+    } else {
+        #if MICROPY_LONGINT_IMPL != MICROPY_LONGINT_IMPL_NONE
+        if (MP_OBJ_IS_TYPE(val_in, &mp_type_int)) {
+            mp_obj_int_buffer_overflow_check(val_in, size, is_signed);
+            mp_obj_int_to_bytes_impl(val_in, big_endian, size, p);
+            return;
+        }
+        #endif
+        val = mp_obj_get_int(val_in);
+    }
+    mp_small_int_buffer_overflow_check(val, size, is_signed);
+    // The common sizes are stored directly; wider ones are sign extended.
+    switch (size) {
+        case 1:
+            p[0] = val;
+            break;
+        case 2:
+            if (big_endian) {
+                p[0] = val >> 8;
+                p[1] = val;
+            } else {
+                p[0] = val;
+                p[1] = val >> 8;
+            }
+            break;
+        case 4:
+            if (big_endian) {
+                p[0] = val >> 24;
+                p[1] = val >> 16;
+                p[2] = val >> 8;
+                p[3] = val;
+            } else {
+                p[0] = val;
+                p[1] = val >> 8;
+                p[2] = val >> 16;
+                p[3] = val >> 24;
+            }
+            break;
+        default:
+            put_uint(p, size, big_endian, (uint64_t)(int64_t)val);
+            break;
+    }
+}
+
+STATIC mp_obj_t unpack_int(const byte *p, size_t size, bool is_signed, bool big_endian) {
+    switch (size) {
+        case 1:
+            return MP_OBJ_NEW_SMALL_INT(is_signed ? (int8_t)p[0] : p[0]);
+        case 2: {
+            uint16_t val = big_endian ? (p[0] << 8 | p[1]) : (p[1] << 8 | p[0]);
+            return MP_OBJ_NEW_SMALL_INT(is_signed ? (int16_t)val : val);
+        }
+        case 4: {
+            uint32_t val = big_endian
+                ? ((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | p[2] << 8 | p[3])
+                : ((uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | p[1] << 8 | p[0]);
+            if (is_signed) {
+                return mp_obj_new_int((int32_t)val);
+            }
+            return mp_obj_new_int_from_uint(val);
+        }
+    }
+    long long val = mp_binary_get_int(size, is_signed, big_endian, p);
+    if (is_signed) {
+        if ((long long)MP_SMALL_INT_MIN <= val && val <= (long long)MP_SMALL_INT_MAX) {
+            return MP_OBJ_NEW_SMALL_INT((mp_int_t)val);
+        }
+        return mp_obj_new_int_from_ll(val);
+    }
+    if ((unsigned long long)val <= (unsigned long long)MP_SMALL_INT_MAX) {
+        return MP_OBJ_NEW_SMALL_INT((mp_int_t)val);
+    }
+    return mp_obj_new_int_from_ull(val);
+}
+
+void shared_modules_struct_struct_pack_into(struct_struct_obj_t *self, byte *p, byte *end_p, size_t n_args, const mp_obj_t *args) {
+    if (p + self->size > end_p) {
+        mp_raise_RuntimeError(translate("buffer too small"));
+    }
+    if (n_args > self->n_items) {
+        // more arguments given than used by format string; CPython raises struct.error here
+        mp_raise_RuntimeError(translate("too many arguments provided with the given format"));
+    }
+
+    const mp_obj_t *args_end = args + n_args;
+    const bool big_endian = self->big_endian;
+    const struct_field_t *field = self->fields;
+    const struct_field_t *fields_end = field + self->n_fields;
+    // Like the format-string walk this replaces, stop once the values run out.
+    for (; field < fields_end && args < args_end; field++) {
+        byte *q = p + field->offset;
+        mp_uint_t cnt = field->count;
+        switch (field->typecode) {
+            case 'x':
+                memset(q, 0, cnt);
+                break;
+            case 's': {
+                mp_buffer_info_t bufinfo;
+                mp_get_buffer_raise(*args++, &bufinfo, MP_BUFFER_READ);
+                mp_uint_t to_copy = MIN(cnt, bufinfo.len);
+                memcpy(q, bufinfo.buf, to_copy);
+                memset(q + to_copy, 0, cnt - to_copy);
+                break;
+            }
+            #if MICROPY_PY_BUILTINS_FLOAT
+            case 'f':
+                for (; cnt-- && args < args_end; q += sizeof(float)) {
+                    union { uint32_t i; float f; } fp_sp;
+                    fp_sp.f = mp_obj_get_float(*args++);
+                    put_uint(q, sizeof(float), big_endian, fp_sp.i);
+                }
+                break;
+            case 'd':
+                for (; cnt-- && args < args_end; q += sizeof(double)) {
+                    union { uint64_t i; double f; } fp_dp;
+                    fp_dp.f = mp_obj_get_float(*args++);
+                    put_uint(q, sizeof(double), big_endian, fp_dp.i);
+                }
+                break;
+            #endif
+            default: {
+                const size_t size = field->size;
+                const bool is_signed = field->typecode > 'Z';
+                for (; cnt-- && args < args_end; q += size) {
+                    pack_int(*args++, q, size, is_signed, big_endian);
+                }
+                break;
+            }
+        }
+    }
+}
+
+mp_obj_tuple_t *shared_modules_struct_struct_unpack_from(struct_struct_obj_t *self, const byte *p, const byte *end_p, bool exact_size) {
+    // If exact_size, make sure the buffer is exactly the right size.
+    // Otherwise just make sure it's big enough.
+    if (exact_size) {
+        if (p + self->size != end_p) {
+            mp_raise_RuntimeError(translate("buffer size must match format"));
+        }
+    } else {
+        if (p + self->size > end_p) {
+            mp_raise_RuntimeError(translate("buffer too small"));
+        }
+    }
+
+    mp_obj_tuple_t *res = MP_OBJ_TO_PTR(mp_obj_new_tuple(self->n_items, NULL));
+    mp_obj_t *item = res->items;
+    const bool big_endian = self->big_endian;
+    const struct_field_t *field = self->fields;
+    const struct_field_t *fields_end = field + self->n_fields;
+    for (; field < fields_end; field++) {
+        const byte *q = p + field->offset;
+        mp_uint_t cnt = field->count;
+        switch (field->typecode) {
+            case 'x':
+                break;
+            case 's':
+                *item++ = mp_obj_new_bytes(q, cnt);
+                break;
+            #if MICROPY_PY_BUILTINS_FLOAT
+            case 'f':
+                for (; cnt--; q += sizeof(float)) {
+                    union { uint32_t i; float f; } fp_sp;
+                    fp_sp.i = get_uint(q, sizeof(float), big_endian);
+                    *item++ = mp_obj_new_float((mp_float_t)fp_sp.f);
+                }
+                break;
+            case 'd':
+                for (; cnt--; q += sizeof(double)) {
+                    union { uint64_t i; double f; } fp_dp;
+                    fp_dp.i = get_uint(q, sizeof(double), big_endian);
+                    *item++ = mp_obj_new_float(fp_dp.f);
+                }
+                break;
+            #endif
+            default: {
+                const size_t size = field->size;
+                const bool is_signed = field->typecode > 'Z';
+                for (; cnt--; q += size) {
+                    *item++ = unpack_int(q, size, is_signed, big_endian);
+                }
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+STATIC mp_obj_t struct_unpack_iter_iternext(mp_obj_t self_in) {
+    struct_unpack_iter_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    // The buffer may have been resized since the last item.
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(self->buffer, &bufinfo, MP_BUFFER_READ);
+    if (self->offset + self->s->size > bufinfo.len) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    const byte *p = (const byte *)bufinfo.buf + self->offset;
+    self->offset += self->s->size;
+    return MP_OBJ_FROM_PTR(shared_modules_struct_struct_unpack_from(self->s, p, p + self->s->size, true));
+}
+
+STATIC const mp_obj_type_t struct_unpack_iter_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_iterator,
+    .getiter = mp_identity_getiter,
+    .iternext = struct_unpack_iter_iternext,
+};
+
+mp_obj_t shared_modules_struct_struct_iter_unpack(struct_struct_obj_t *self, mp_obj_t buffer) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer, &bufinfo, MP_BUFFER_READ);
+    if (self->size == 0 || bufinfo.len % self->size != 0) {
+        mp_raise_RuntimeError(translate("bytes length not a multiple of item size"));
+    }
+    struct_unpack_iter_obj_t *iter = m_new_obj(struct_unpack_iter_obj_t);
+    iter->base.type = &struct_unpack_iter_type;
+    iter->s = self;
+    iter->buffer = buffer;
+    iter->offset = 0;
+    return MP_OBJ_FROM_PTR(iter);
+}
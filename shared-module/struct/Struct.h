@@ -0,0 +1,58 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_STRUCT_STRUCT_H
+#define MICROPY_INCLUDED_SHARED_MODULE_STRUCT_STRUCT_H
+
+#include "py/obj.h"
+
+// One run of identical fields at a fixed offset. 's' and 'x' runs are a
+// single field of count bytes; other typecodes are count items of size bytes.
+typedef struct {
+    mp_uint_t offset;
+    mp_uint_t count;
+    uint8_t size;
+    char typecode;
+} struct_field_t;
+
+typedef struct {
+    mp_obj_base_t base;
+    mp_obj_t format;
+    mp_uint_t size;
+    mp_uint_t n_items;
+    size_t n_fields;
+    bool big_endian;
+    struct_field_t fields[];
+} struct_struct_obj_t;
+
+typedef struct {
+    mp_obj_base_t base;
+    struct_struct_obj_t *s;
+    mp_obj_t buffer;
+    mp_uint_t offset;
+} struct_unpack_iter_obj_t;
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_STRUCT_STRUCT_H
@@ -0,0 +1,448 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/binary.h"
+#include "py/mperrno.h"
+#include "py/mphal.h"
+#include "py/mpstate.h"
+#include "py/objarray.h"
+#include "py/runtime.h"
+#include "shared-bindings/telemetry/Buffer.h"
+
+// The longest record a sample can make: a 3 byte header, a 5 byte time delta
+// and a 10 byte value.
+#define MAX_SAMPLE_LEN (18)
+// 'B' plus three varints.
+#define MAX_BATCH_HEADER_LEN (16)
+
+STATIC size_t put_varint(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+STATIC uint64_t zigzag(uint64_t v) {
+    return (v << 1) ^ (uint64_t)((int64_t)v >> 63);
+}
+
+STATIC size_t schema_len(mp_obj_t keys) {
+    size_t n_keys;
+    mp_obj_t *items;
+    mp_obj_tuple_get(keys, &n_keys, &items);
+    size_t len = 1 + 5 + 5;
+    for (size_t i = 0; i < n_keys; i++) {
+        size_t name_len;
+        mp_obj_str_get_data(items[i], &name_len);
+        len += 5 + name_len;
+    }
+    return len;
+}
+
+STATIC size_t put_schema(telemetry_buffer_obj_t *self, uint8_t *p) {
+    size_t n_keys;
+    mp_obj_t *items;
+    mp_obj_tuple_get(self->keys, &n_keys, &items);
+    size_t n = 0;
+    p[n++] = 'S';
+    n += put_varint(p + n, n_keys);
+    n += put_varint(p + n, self->n_buckets);
+    for (size_t i = 0; i < n_keys; i++) {
+        size_t name_len;
+        const char *name = mp_obj_str_get_data(items[i], &name_len);
+        n += put_varint(p + n, name_len);
+        memcpy(p + n, name, name_len);
+        n += name_len;
+    }
+    return n;
+}
+
+// Adds the buffer to those polled in the background, if it isn't already.
+STATIC void buffer_link(telemetry_buffer_obj_t *self) {
+    #if CIRCUITPY
+    telemetry_buffer_obj_t *buffer = MP_STATE_VM(active_telemetry_buffers);
+    while (buffer != NULL) {
+        if (buffer == self) {
+            return;
+        }
+        buffer = buffer->next;
+    }
+    self->next = MP_STATE_VM(active_telemetry_buffers);
+    MP_STATE_VM(active_telemetry_buffers) = self;
+    #else
+    (void)self;
+    #endif
+}
+
+STATIC void buffer_unlink(telemetry_buffer_obj_t *self) {
+    #if CIRCUITPY
+    telemetry_buffer_obj_t **link = (telemetry_buffer_obj_t **)&MP_STATE_VM(active_telemetry_buffers);
+    while (*link != NULL && *link != self) {
+        link = &(*link)->next;
+    }
+    if (*link == self) {
+        *link = self->next;
+    }
+    #endif
+    self->next = NULL;
+}
+
+STATIC void buffer_set_stream(telemetry_buffer_obj_t *self, mp_obj_t stream) {
+    const mp_stream_p_t *stream_p = mp_proto_get(MP_QSTR_protocol_stream, stream);
+    if (stream_p == NULL || stream_p->write == NULL) {
+        // Sockets from socketpool have send() but no stream protocol.
+        mp_obj_t dest[2];
+        mp_load_method_maybe(stream, MP_QSTR_send, dest);
+        if (dest[0] == MP_OBJ_NULL) {
+            mp_load_method(stream, MP_QSTR_write, dest);
+        }
+        stream_p = NULL;
+    }
+    self->stream = stream;
+    self->stream_p = stream_p;
+    // Whatever is on its way to the old stream is dropped, and the new one
+    // needs the schema before it can decode anything.
+    self->out_start = self->out_end = 0;
+    self->send_schema = true;
+    buffer_link(self);
+}
+
+void common_hal_telemetry_buffer_construct(telemetry_buffer_obj_t *self, mp_obj_t stream, mp_obj_t keys, size_t capacity, uint32_t interval_ms, uint8_t n_buckets) {
+    size_t n_keys;
+    mp_obj_t *items;
+    mp_obj_tuple_get(keys, &n_keys, &items);
+
+    self->keys = keys;
+    self->n_keys = n_keys;
+    self->n_buckets = n_buckets;
+    self->key_state = m_new0(telemetry_key_t, n_keys);
+    self->histograms = n_buckets > 0 ? m_new0(uint32_t, n_keys * n_buckets) : NULL;
+    if (!ringbuf_alloc(&self->ring, capacity, false)) {
+        m_malloc_fail(capacity);
+    }
+    capacity = ringbuf_capacity(&self->ring);
+    self->out_size = schema_len(keys) + MAX_BATCH_HEADER_LEN + capacity +
+        n_keys * (5 + 10) + (n_buckets > 0 ? n_keys * (5 + 5 + 5 + n_buckets * 5) : 0);
+    self->out = m_new(uint8_t, self->out_size);
+    self->view.base.type = &mp_type_bytearray;
+    self->view.typecode = BYTEARRAY_TYPECODE;
+    self->view.free = 0;
+
+    uint32_t now = mp_hal_ticks_ms();
+    self->interval_ms = interval_ms;
+    self->last_flush_ms = now;
+    self->batch_start_ms = now;
+    self->last_sample_ms = now;
+    self->seq = 0;
+    self->bytes_sent = 0;
+    self->dropped = 0;
+    self->errors = 0;
+    self->writing = false;
+    self->next = NULL;
+    buffer_set_stream(self, stream);
+}
+
+bool common_hal_telemetry_buffer_deinited(telemetry_buffer_obj_t *self) {
+    return self->stream == MP_OBJ_NULL;
+}
+
+void common_hal_telemetry_buffer_deinit(telemetry_buffer_obj_t *self) {
+    if (common_hal_telemetry_buffer_deinited(self)) {
+        return;
+    }
+    buffer_unlink(self);
+    self->stream = MP_OBJ_NULL;
+    self->stream_p = NULL;
+    ringbuf_free(&self->ring);
+    m_del(uint8_t, self->out, self->out_size);
+    self->out = NULL;
+}
+
+// Drops the frame being written after the stream failed. A closed or deinited
+// stream will keep failing, so it is no longer polled in the background.
+STATIC void buffer_write_failed(telemetry_buffer_obj_t *self, bool closed) {
+    self->out_start = self->out_end = 0;
+    self->errors++;
+    if (closed) {
+        buffer_unlink(self);
+    }
+}
+
+// Writes out[out_start:out_end]. Returns false if the stream can't take all of
+// it now. A frame that fails to write is dropped, and the error is raised if
+// raise is true.
+STATIC bool buffer_write_out(telemetry_buffer_obj_t *self, bool raise) {
+    while (self->out_start < self->out_end) {
+        const uint8_t *data = self->out + self->out_start;
+        size_t len = self->out_end - self->out_start;
+        mp_uint_t written;
+        int errcode = 0;
+        self->view.items = (void *)data;
+        self->view.len = len;
+        // Stream writes may raise too, such as when the stream is deinited,
+        // and may run background tasks while they wait.
+        self->writing = true;
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0) {
+            if (self->stream_p != NULL) {
+                written = self->stream_p->write(self->stream, data, len, &errcode);
+            } else {
+                mp_obj_t dest[3];
+                mp_load_method_maybe(self->stream, MP_QSTR_send, dest);
+                if (dest[0] == MP_OBJ_NULL) {
+                    mp_load_method(self->stream, MP_QSTR_write, dest);
+                }
+                dest[2] = MP_OBJ_FROM_PTR(&self->view);
+                mp_obj_t result = mp_call_method_n_kw(1, 0, dest);
+                written = result == mp_const_none ? 0 : mp_obj_get_int(result);
+            }
+            nlr_pop();
+        } else {
+            self->writing = false;
+            self->view.items = NULL;
+            self->view.len = 0;
+            buffer_write_failed(self, true);
+            if (raise) {
+                nlr_jump(nlr.ret_val);
+            }
+            return true;
+        }
+        self->writing = false;
+        self->view.items = NULL;
+        self->view.len = 0;
+        if (written == MP_STREAM_ERROR) {
+            if (mp_is_nonblocking_error(errcode)) {
+                return false;
+            }
+            buffer_write_failed(self, errcode == MP_EBADF);
+            if (raise) {
+                mp_raise_OSError(errcode);
+            }
+            return true;
+        }
+        if (written == 0) {
+            return false;
+        }
+        self->out_start += written;
+        self->bytes_sent += written;
+    }
+    self->out_start = self->out_end = 0;
+    return true;
+}
+
+// Moves the recorded samples and the aggregates into a batch frame in out,
+// preceded by the schema if it is due.
+STATIC void buffer_seal(telemetry_buffer_obj_t *self) {
+    uint8_t *out = self->out;
+    size_t pos = 0;
+    if (self->send_schema) {
+        pos = put_schema(self, out);
+        self->send_schema = false;
+    }
+
+    // Build the payload after room for the header, which needs its length.
+    size_t payload_start = pos + MAX_BATCH_HEADER_LEN;
+    size_t p = payload_start;
+    p += ringbuf_get_n(&self->ring, out + p, ringbuf_num_filled(&self->ring));
+    for (size_t key = 0; key < self->n_keys; key++) {
+        telemetry_key_t *state = &self->key_state[key];
+        state->last_value = 0;
+        if (state->counted) {
+            p += put_varint(out + p, key << 2 | TELEMETRY_COUNTER);
+            p += put_varint(out + p, zigzag(state->count));
+            state->count = 0;
+            state->counted = false;
+        }
+        if (self->histograms == NULL) {
+            continue;
+        }
+        uint32_t *counts = self->histograms + key * self->n_buckets;
+        size_t first = 0;
+        size_t end = self->n_buckets;
+        while (first < end && counts[first] == 0) {
+            first++;
+        }
+        while (end > first && counts[end - 1] == 0) {
+            end--;
+        }
+        if (first < end) {
+            p += put_varint(out + p, key << 2 | TELEMETRY_HISTOGRAM);
+            p += put_varint(out + p, first);
+            p += put_varint(out + p, end - first);
+            for (size_t b = first; b < end; b++) {
+                p += put_varint(out + p, counts[b]);
+            }
+            memset(counts + first, 0, (end - first) * sizeof(uint32_t));
+        }
+    }
+
+    size_t payload_len = p - payload_start;
+    if (payload_len > 0) {
+        uint8_t *header = out + pos;
+        size_t n = 0;
+        header[n++] = 'B';
+        n += put_varint(header + n, self->seq++);
+        n += put_varint(header + n, self->batch_start_ms);
+        n += put_varint(header + n, payload_len);
+        memmove(header + n, out + payload_start, payload_len);
+        pos += n + payload_len;
+    }
+
+    uint32_t now = mp_hal_ticks_ms();
+    self->batch_start_ms = now;
+    self->last_sample_ms = now;
+    self->out_start = 0;
+    self->out_end = pos;
+}
+
+STATIC bool buffer_flush(telemetry_buffer_obj_t *self, bool raise) {
+    self->last_flush_ms = mp_hal_ticks_ms();
+    // Let an earlier batch finish before starting another.
+    if (!buffer_write_out(self, raise)) {
+        return false;
+    }
+    buffer_seal(self);
+    return buffer_write_out(self, raise);
+}
+
+bool common_hal_telemetry_buffer_flush(telemetry_buffer_obj_t *self) {
+    return buffer_flush(self, true);
+}
+
+STATIC void buffer_poll(telemetry_buffer_obj_t *self, uint32_t now) {
+    if (self->writing) {
+        return;
+    }
+    if (self->out_start < self->out_end) {
+        buffer_write_out(self, false);
+    } else if (self->interval_ms > 0 && now - self->last_flush_ms >= self->interval_ms) {
+        buffer_flush(self, false);
+    }
+}
+
+void telemetry_buffer_poll(telemetry_buffer_obj_t *self) {
+    buffer_poll(self, mp_hal_ticks_ms());
+}
+
+// Flushes early, rather than drop samples, when the ring is nearly full. This
+// must come before a sample is encoded, because flushing restarts the deltas.
+STATIC void buffer_make_room(telemetry_buffer_obj_t *self) {
+    if (ringbuf_num_empty(&self->ring) < MAX_SAMPLE_LEN) {
+        buffer_flush(self, false);
+    }
+}
+
+STATIC bool buffer_put_sample(telemetry_buffer_obj_t *self, size_t key, uint8_t type, const uint8_t *value, size_t value_len, uint32_t now) {
+    uint8_t record[MAX_SAMPLE_LEN];
+    size_t n = put_varint(record, key << 2 | type);
+    n += put_varint(record + n, (uint32_t)(now - self->last_sample_ms));
+    memcpy(record + n, value, value_len);
+    n += value_len;
+    if (ringbuf_num_empty(&self->ring) < n) {
+        self->dropped++;
+        return false;
+    }
+    ringbuf_put_n(&self->ring, record, n);
+    self->last_sample_ms = now;
+    return true;
+}
+
+void common_hal_telemetry_buffer_record_int(telemetry_buffer_obj_t *self, size_t key, mp_int_t value) {
+    buffer_make_room(self);
+    uint32_t now = mp_hal_ticks_ms();
+    telemetry_key_t *state = &self->key_state[key];
+    uint8_t encoded[10];
+    size_t n = put_varint(encoded, zigzag((uint64_t)(int64_t)value - state->last_value));
+    if (buffer_put_sample(self, key, TELEMETRY_INT, encoded, n, now)) {
+        state->last_value = (uint64_t)(int64_t)value;
+    }
+    buffer_poll(self, now);
+}
+
+void common_hal_telemetry_buffer_record_float(telemetry_buffer_obj_t *self, size_t key, mp_float_t value) {
+    buffer_make_room(self);
+    uint32_t now = mp_hal_ticks_ms();
+    // All the supported ports are little endian.
+    float f = value;
+    uint8_t encoded[4];
+    memcpy(encoded, &f, 4);
+    buffer_put_sample(self, key, TELEMETRY_FLOAT, encoded, 4, now);
+    buffer_poll(self, now);
+}
+
+void common_hal_telemetry_buffer_count(telemetry_buffer_obj_t *self, size_t key, mp_int_t n) {
+    telemetry_key_t *state = &self->key_state[key];
+    state->count += n;
+    state->counted = true;
+    telemetry_buffer_poll(self);
+}
+
+void common_hal_telemetry_buffer_observe(telemetry_buffer_obj_t *self, size_t key, mp_int_t value) {
+    if (self->histograms == NULL) {
+        return;
+    }
+    size_t bucket = 0;
+    if (value > 0) {
+        bucket = 64 - __builtin_clzll((unsigned long long)value);
+        if (bucket >= self->n_buckets) {
+            bucket = self->n_buckets - 1;
+        }
+    }
+    self->histograms[key * self->n_buckets + bucket]++;
+    telemetry_buffer_poll(self);
+}
+
+mp_obj_t common_hal_telemetry_buffer_get_stream(telemetry_buffer_obj_t *self) {
+    return self->stream;
+}
+
+void common_hal_telemetry_buffer_set_stream(telemetry_buffer_obj_t *self, mp_obj_t stream) {
+    buffer_set_stream(self, stream);
+}
+
+mp_float_t common_hal_telemetry_buffer_get_interval(telemetry_buffer_obj_t *self) {
+    return self->interval_ms / MICROPY_FLOAT_CONST(1000.0);
+}
+
+void common_hal_telemetry_buffer_set_interval(telemetry_buffer_obj_t *self, uint32_t interval_ms) {
+    self->interval_ms = interval_ms;
+}
+
+mp_obj_t common_hal_telemetry_buffer_get_keys(telemetry_buffer_obj_t *self) {
+    return self->keys;
+}
+
+void common_hal_telemetry_buffer_get_stats(telemetry_buffer_obj_t *self, uint32_t *batches, uint32_t *bytes_sent, uint32_t *dropped, uint32_t *errors) {
+    *batches = self->seq;
+    *bytes_sent = self->bytes_sent;
+    *dropped = self->dropped;
+    *errors = self->errors;
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_TELEMETRY_BUFFER_H
+#define MICROPY_INCLUDED_SHARED_MODULE_TELEMETRY_BUFFER_H
+
+#include "py/obj.h"
+#include "py/objarray.h"
+#include "py/ringbuf.h"
+#include "py/stream.h"
+
+// Wire format. Every integer is an unsigned LEB128 varint and signed ones are
+// zigzag encoded first.
+//
+//   schema frame: 'S' n_keys n_buckets (name_len name)*n_keys
+//   batch frame:  'B' seq base_ms payload_len payload
+//
+// The payload is a sequence of records, each starting with key << 2 | type:
+//
+//   TELEMETRY_INT:       dt_ms zigzag(value - previous value of the key)
+//   TELEMETRY_FLOAT:     dt_ms float32 (little endian)
+//   TELEMETRY_COUNTER:   zigzag(sum of counts since the last batch)
+//   TELEMETRY_HISTOGRAM: first_bucket n_counts count*n_counts
+//
+// dt_ms is the time since the previous sample in the batch, or since base_ms
+// for the first. Deltas start from 0 in every batch so each batch decodes on
+// its own. Histogram bucket 0 counts values <= 0 and bucket b counts values in
+// [2**(b-1), 2**b), with the last bucket taking everything larger.
+#define TELEMETRY_INT (0)
+#define TELEMETRY_FLOAT (1)
+#define TELEMETRY_COUNTER (2)
+#define TELEMETRY_HISTOGRAM (3)
+
+typedef struct {
+    uint64_t last_value;
+    mp_int_t count;
+    bool counted;
+} telemetry_key_t;
+
+typedef struct _telemetry_buffer_obj_t {
+    mp_obj_base_t base;
+    // Next buffer flushed in the background.
+    struct _telemetry_buffer_obj_t *next;
+    // MP_OBJ_NULL once deinited.
+    mp_obj_t stream;
+    // The stream's write(), or NULL to call its send or write method instead.
+    const mp_stream_p_t *stream_p;
+    // A bytearray aliasing the data passed to that method.
+    mp_obj_array_t view;
+    mp_obj_t keys;
+    telemetry_key_t *key_state;
+    // n_keys * n_buckets counts.
+    uint32_t *histograms;
+    // Samples, encoded as they are recorded.
+    ringbuf_t ring;
+    // The frames being written, out[out_start:out_end].
+    uint8_t *out;
+    size_t out_size;
+    size_t out_start;
+    size_t out_end;
+    uint32_t interval_ms;
+    uint32_t last_flush_ms;
+    uint32_t batch_start_ms;
+    uint32_t last_sample_ms;
+    uint32_t seq;
+    uint32_t bytes_sent;
+    uint32_t dropped;
+    uint32_t errors;
+    uint16_t n_keys;
+    uint8_t n_buckets;
+    bool send_schema;
+    // True while the stream is being written to, so a background poll from
+    // inside a blocking write doesn't start another.
+    bool writing;
+} telemetry_buffer_obj_t;
+
+// Writes out pending data, and flushes if the interval has passed. Never
+// raises. A stream that raises or is closed is counted in errors, and the
+// buffer is not polled in the background again until it has a new stream.
+void telemetry_buffer_poll(telemetry_buffer_obj_t *self);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_TELEMETRY_BUFFER_H
@@ -0,0 +1,47 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2020 KMK contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/mpstate.h"
+#include "shared-module/telemetry/__init__.h"
+#include "shared-module/telemetry/Buffer.h"
+
+void telemetry_background(void) {
+    telemetry_buffer_obj_t *buffer = MP_STATE_VM(active_telemetry_buffers);
+    while (buffer != NULL) {
+        // Polling may drop the buffer from the list.
+        telemetry_buffer_obj_t *next = buffer->next;
+        // Streams without the C stream protocol need a Python call, so they
+        // are only flushed from the VM.
+        if (buffer->stream_p != NULL) {
+            telemetry_buffer_poll(buffer);
+        }
+        buffer = next;
+    }
+}
+
+void telemetry_reset(void) {
+    MP_STATE_VM(active_telemetry_buffers) = NULL;
+}
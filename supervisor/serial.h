@@ -44,6 +44,9 @@ void serial_write(const char* text);
 // Only writes up to given length. Does not check for null termination at all.
 void serial_write_substring(const char* text, uint32_t length);
 char serial_read(void);
+// Reads up to len bytes that are already waiting, without blocking, and
+// returns how many were read.
+uint32_t serial_read_into(uint8_t* buf, uint32_t len);
 bool serial_bytes_available(void);
 bool serial_connected(void);
 
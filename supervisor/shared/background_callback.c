@@ -28,6 +28,7 @@
 
 #include "py/gc.h"
 #include "py/mpconfig.h"
+#include "py/mptrace.h"
 #include "supervisor/background_callback.h"
 #include "supervisor/linker.h"
 #include "supervisor/shared/tick.h"
@@ -85,7 +86,9 @@ void PLACE_IN_ITCM(background_callback_run_all)() {
         CALLBACK_CRITICAL_END;
         // Leave the critical section in order to run the callback function
         if (fun) {
+            MP_TRACE_BEGIN(MP_TRACE_EVENT_BACKGROUND_CALLBACK, (uintptr_t)fun);
             fun(data);
+            MP_TRACE_END(MP_TRACE_EVENT_BACKGROUND_CALLBACK, (uintptr_t)fun);
         }
         CALLBACK_CRITICAL_BEGIN;
         cb = next;
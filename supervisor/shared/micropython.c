@@ -43,14 +43,33 @@
 
 int mp_hal_stdin_rx_chr(void) {
     for (;;) {
+        mp_handle_pending();
+        // Only run background tasks once everything waiting has been read,
+        // so a paste isn't slowed down by a USB task run per character.
+        if (serial_bytes_available()) {
+            toggle_rx_led();
+            return serial_read();
+        }
         #ifdef MICROPY_VM_HOOK_LOOP
             MICROPY_VM_HOOK_LOOP
         #endif
+    }
+}
+
+size_t mp_hal_stdin_rx_into(uint8_t *buf, size_t len) {
+    if (len == 0) {
+        return 0;
+    }
+    for (;;) {
         mp_handle_pending();
-        if (serial_bytes_available()) {
+        size_t count = serial_read_into(buf, len);
+        if (count > 0) {
             toggle_rx_led();
-            return serial_read();
+            return count;
         }
+        #ifdef MICROPY_VM_HOOK_LOOP
+            MICROPY_VM_HOOK_LOOP
+        #endif
     }
 }
 
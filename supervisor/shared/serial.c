@@ -89,6 +89,25 @@ char serial_read(void) {
 #endif
 }
 
+uint32_t serial_read_into(uint8_t* buf, uint32_t len) {
+    // Take everything waiting in the CDC FIFO at once rather than a character
+    // at a time.
+    uint32_t count = 0;
+#if defined(DEBUG_UART_TX) && defined(DEBUG_UART_RX)
+    if (tud_cdc_connected()) {
+        count = tud_cdc_read(buf, len);
+    }
+    uint32_t uart_available = common_hal_busio_uart_rx_characters_available(&debug_uart);
+    if (count < len && uart_available > 0) {
+        int uart_errcode;
+        count += common_hal_busio_uart_read(&debug_uart, buf + count, MIN(len - count, uart_available), &uart_errcode);
+    }
+#else
+    count = tud_cdc_read(buf, len);
+#endif
+    return count;
+}
+
 bool serial_bytes_available(void) {
 #if defined(DEBUG_UART_TX) && defined(DEBUG_UART_RX)
     return common_hal_busio_uart_rx_characters_available(&debug_uart) || (tud_cdc_available() > 0);
@@ -109,7 +128,14 @@ void serial_write_substring(const char* text, uint32_t length) {
     uint32_t count = 0;
     while (count < length && tud_cdc_connected()) {
         count += tud_cdc_write(text + count, length - count);
-        usb_background();
+        // Only run the USB task when the FIFO is full. Otherwise start the
+        // transfer and let later writes queue up behind it.
+        if (count < length) {
+            usb_background();
+        }
+    }
+    if (count > 0) {
+        tud_cdc_write_flush();
     }
 
 #if defined(DEBUG_UART_TX) && defined(DEBUG_UART_RX)
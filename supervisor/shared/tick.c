@@ -26,7 +26,10 @@
 
 #include "supervisor/shared/tick.h"
 
+#include "py/mphal.h"
 #include "py/mpstate.h"
+#include "py/mptrace.h"
+#include "py/profiler.h"
 #include "py/runtime.h"
 #include "supervisor/linker.h"
 #include "supervisor/filesystem.h"
@@ -56,6 +59,10 @@
 #include "shared-module/network/__init__.h"
 #endif
 
+#if CIRCUITPY_TELEMETRY
+#include "shared-module/telemetry/__init__.h"
+#endif
+
 #include "shared-bindings/microcontroller/__init__.h"
 
 #if CIRCUITPY_WATCHDOG
@@ -71,18 +78,30 @@ static background_callback_t tick_callback;
 
 volatile uint64_t last_finished_tick = 0;
 
+#if MICROPY_PY_PROFILER
+// Sample every profiler_tick_divisor ticks while the profiler is running.
+static volatile uint16_t profiler_tick_divisor = 0;
+static uint16_t profiler_tick_count;
+#endif
+
 void supervisor_background_tasks(void *unused) {
     port_start_background_task();
 
     assert_heap_ok();
 
     #if CIRCUITPY_DISPLAYIO
+    MP_TRACE_BEGIN(MP_TRACE_EVENT_DISPLAYIO_BACKGROUND, 0);
     displayio_background();
+    MP_TRACE_END(MP_TRACE_EVENT_DISPLAYIO_BACKGROUND, 0);
     #endif
 
     #if CIRCUITPY_NETWORK
     network_module_background();
     #endif
+
+    #if CIRCUITPY_TELEMETRY
+    telemetry_background();
+    #endif
     filesystem_background();
 
     #if CIRCUITPY_BLEIO
@@ -120,9 +139,37 @@ void supervisor_tick(void) {
         #endif
     }
 #endif
+    #if MICROPY_PY_PROFILER
+    if (profiler_tick_divisor != 0 && ++profiler_tick_count >= profiler_tick_divisor) {
+        profiler_tick_count = 0;
+        mp_profiler_sample();
+    }
+    #endif
     background_callback_add(&tick_callback, supervisor_background_tasks, NULL);
 }
 
+#if MICROPY_PY_PROFILER
+// The tick runs at 1024Hz, so that is the highest rate available.
+void mp_profiler_port_start(mp_uint_t rate_hz) {
+    mp_uint_t divisor = 1024 / rate_hz;
+    if (divisor == 0) {
+        divisor = 1;
+    }
+    if (profiler_tick_divisor == 0) {
+        supervisor_enable_tick();
+    }
+    profiler_tick_count = 0;
+    profiler_tick_divisor = divisor > UINT16_MAX ? UINT16_MAX : divisor;
+}
+
+void mp_profiler_port_stop(void) {
+    if (profiler_tick_divisor != 0) {
+        profiler_tick_divisor = 0;
+        supervisor_disable_tick();
+    }
+}
+#endif
+
 uint64_t supervisor_ticks_ms64() {
     uint64_t result;
     result = port_get_raw_ticks(NULL);
@@ -134,6 +181,23 @@ uint32_t supervisor_ticks_ms32() {
     return supervisor_ticks_ms64();
 }
 
+uint32_t supervisor_ticks_subticks32() {
+    uint8_t subticks;
+    uint64_t ticks = port_get_raw_ticks(&subticks);
+    return (uint32_t)(ticks << 5) | subticks;
+}
+
+#if MICROPY_PY_BENCHMARK
+// Ports with a real cycle counter override these.
+MP_WEAK mp_uint_t mp_hal_ticks_cpu(void) {
+    return supervisor_ticks_subticks32();
+}
+
+MP_WEAK mp_uint_t mp_hal_ticks_cpu_hz(void) {
+    return 32768;
+}
+#endif
+
 
 void PLACE_IN_ITCM(supervisor_run_background_tasks_if_tick)() {
     background_callback_run_all();
@@ -51,6 +51,12 @@ extern uint32_t supervisor_ticks_ms32(void);
  * then it may be possible to use supervisor_ticks_ms64 instead.
  */
 extern uint64_t supervisor_ticks_ms64(void);
+/** @brief Get the lower 32 bits of the time in 1/32768 second subticks
+ *
+ * This is the finest resolution the port's tick source offers, and is used to
+ * timestamp trace buffer entries.
+ */
+extern uint32_t supervisor_ticks_subticks32(void);
 /** @brief Run background ticks, but only about every millisecond.
  *
  * Normally, this is not called directly.  Instead use the RUN_BACKGROUND_TASKS
@@ -24,6 +24,7 @@
  * THE SOFTWARE.
  */
 
+#include "py/mptrace.h"
 #include "py/objstr.h"
 #include "shared-bindings/microcontroller/Processor.h"
 #include "shared-module/usb_midi/__init__.h"
@@ -81,10 +82,12 @@ void usb_disconnect(void) {
 
 void usb_background(void) {
     if (usb_enabled()) {
+        MP_TRACE_BEGIN(MP_TRACE_EVENT_USB_BACKGROUND, 0);
         #if CFG_TUSB_OS == OPT_OS_NONE
         tud_task();
         #endif
         tud_cdc_write_flush();
+        MP_TRACE_END(MP_TRACE_EVENT_USB_BACKGROUND, 0);
     }
 }
 
@@ -182,6 +182,9 @@ int32_t tud_msc_write10_cb (uint8_t lun, uint32_t lba, uint32_t offset, uint8_t*
 void tud_msc_write10_complete_cb (uint8_t lun) {
     (void) lun;
 
+    // The host may have added or removed files under us.
+    mp_vfs_import_cache_invalidate();
+
     // This write is complete, start the autoreload clock.
     autoreload_start();
 }
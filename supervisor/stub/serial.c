@@ -42,6 +42,12 @@ char serial_read(void) {
     return 0;
 }
 
+uint32_t serial_read_into(uint8_t* buf, uint32_t len) {
+    (void) buf;
+    (void) len;
+    return 0;
+}
+
 bool serial_bytes_available(void) {
     return false;
 }
@@ -0,0 +1,69 @@
+# test keyword arguments to functions with many parameters, and f(**d)
+
+def f(a=0, b=0, c=0, d=0, e=0, f=0, g=0, h=0, *, i=0, j=0, **kw):
+    return (a, b, c, d, e, f, g, h, i, j, sorted(kw.items()))
+
+# the same call repeatedly, in different orders
+for n in range(3):
+    print(f(h=n, a=1, j=2, e=3))
+    print(f(e=3, j=2, a=1, h=n, z=4))
+
+# closures made from the same def share their parameter names
+def make(base):
+    def g(p, q=0, r=0, s=0, t=0, u=0):
+        return base + p + q * 10 + r * 100 + u * 1000
+    return g
+g1 = make(1)
+g2 = make(2)
+for n in range(2):
+    print(g1(1, u=2, r=3), g2(u=1, p=2, q=3))
+
+# a different function with the same parameter names in other places
+def h(j=0, i=0, h=0, g=0, f=0, e=0, d=0, c=0, b=0, a=0):
+    return (a, b, c, d, e, f, g, h, i, j)
+for n in range(2):
+    print(h(h=n, a=1, j=2, e=3))
+    print(f(h=n, a=1, j=2, e=3))
+
+# errors
+try:
+    f(1, a=2)
+except TypeError:
+    print('TypeError')
+try:
+    h(k=1)
+except TypeError:
+    print('TypeError')
+
+# ** with a dict, mixed with other arguments
+opts = {'b': 2, 'i': 9}
+print(f(**opts))
+print(f(1, c=3, **opts))
+print(f(1, c=3, **{'zz': 1, 'b': 2}))
+try:
+    f(b=1, **opts)
+except TypeError:
+    print('TypeError')
+
+# ** with a dict built at runtime, so its keys aren't interned yet
+k = ''.join(['x', 'y', 'z'])
+print(f(**{k: 1, 'a': 2}))
+
+# ** with more arguments than fit on the stack
+many = {}
+for n in range(20):
+    many['k' + str(n)] = n
+r = f(1, 2, **many)
+print(r[:2], len(r[10]))
+
+# ** passing options through to a method
+class A:
+    def __init__(self, *, x=0, y=0):
+        self.x = x
+        self.y = y
+class B(A):
+    def __init__(self, name, **kw):
+        super().__init__(**kw)
+        self.name = name
+b = B('b', y=2, x=1)
+print(b.name, b.x, b.y)
@@ -0,0 +1,115 @@
+# test values, returns and exceptions passing through a chain of yield from
+
+def leaf(n):
+    for i in range(n):
+        x = yield i
+        if x is not None:
+            print('leaf got', x)
+    return 'leaf'
+
+def bad():
+    yield 'bad'
+    raise ValueError('boom')
+
+def mid(n):
+    r = yield from leaf(n)
+    print('mid', r)
+    try:
+        yield from bad()
+    except ValueError as e:
+        print('caught', e.args)
+    return 'mid'
+
+def top():
+    r = yield from mid(2)
+    print('top', r)
+    r = yield from iter([1, 2])
+    return r
+
+g = top()
+print(next(g))
+print(g.send('hello'))
+for v in g:
+    print('v', v)
+
+# a finished generator stays finished
+print(list(g))
+try:
+    g.send(None)
+except StopIteration:
+    print('StopIteration')
+print(g.close())
+
+# return values up a deep chain
+def deep(n):
+    if n == 0:
+        yield 'bottom'
+        return 0
+    r = yield from deep(n - 1)
+    return r + 1
+
+g = deep(20)
+print(next(g))
+try:
+    next(g)
+except StopIteration as e:
+    print('deep', e.args)
+
+# exception from the bottom of a chain
+def raiser(n):
+    if n == 0:
+        yield 1
+        raise KeyError('k')
+    yield from raiser(n - 1)
+
+try:
+    for x in raiser(5):
+        print(x)
+except KeyError as e:
+    print('KeyError', e.args)
+
+# throw and close through a chain
+def inner():
+    try:
+        yield 1
+        yield 2
+    except RuntimeError:
+        print('inner caught')
+        yield 3
+    finally:
+        print('inner finally')
+
+def outer():
+    yield from inner()
+    yield 4
+
+g = outer()
+print(next(g))
+print(g.throw(RuntimeError))
+print(next(g))
+g.close()
+g = outer()
+next(g)
+g.close()
+
+# a generator can't resume itself through yield from
+def selfref():
+    yield from g
+g = selfref()
+try:
+    next(g)
+except ValueError:
+    print('ValueError')
+
+# many short-lived generators of different sizes
+def small():
+    yield 1
+def large(a, b, c):
+    x = y = z = a
+    yield a + b + c + x + y + z
+total = 0
+for i in range(100):
+    total += sum(small()) + sum(large(i, 1, 2))
+    if i % 7 == 0:
+        g = small()
+print(total, next(g))
@@ -0,0 +1,19 @@
+import bench
+
+class Group:
+    def __init__(self, *, x=0, y=0, scale=1, max_size=None, hidden=False):
+        self.x = x
+        self.y = y
+
+class Label(Group):
+    def __init__(self, font, *, text="", color=0xffffff, background_color=None,
+                 line_spacing=1.25, padding_top=0, padding_bottom=0, padding_left=0,
+                 padding_right=0, anchor_point=None, anchored_position=None, **kwargs):
+        super().__init__(**kwargs)
+        self.text = text
+
+def test(num):
+    for i in iter(range(num // 10)):
+        Label(None, text="hello", color=i, padding_left=2, x=i, y=4, scale=2)
+
+bench.run(test)
@@ -0,0 +1,135 @@
+# Test aesio GCM and CCM authenticated modes.
+
+try:
+    import aesio
+    from binascii import hexlify, unhexlify
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+# GCM test cases 2, 4 and 5 from the GCM specification (McGrew and Viega),
+# then a 16 byte IV
+key = unhexlify("feffe9928665731c6d6a8f9467308308")
+plain = unhexlify(
+    "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+    "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39"
+)
+aad = unhexlify("feedfacedeadbeeffeedfacedeadbeefabaddad2")
+
+cipher = aesio.AES(bytes(16), aesio.MODE_GCM, bytes(12))
+enc = bytearray(16)
+cipher.encrypt_into(bytes(16), enc)
+print(hexlify(enc), hexlify(cipher.digest()))
+
+for iv in (
+    unhexlify("cafebabefacedbaddecaf888"),
+    unhexlify("cafebabefacedbad"),
+    unhexlify("9313225df88406e555909c5aff5269aa"),
+):
+    cipher = aesio.AES(key, aesio.MODE_GCM, iv)
+    cipher.update(aad)
+    enc = bytearray(len(plain))
+    cipher.encrypt_into(plain, enc)
+    tag = cipher.digest()
+    print(hexlify(enc), hexlify(tag))
+
+    # streamed in odd pieces, decrypting in place
+    cipher.rekey(key, iv)
+    cipher.update(aad[:7])
+    cipher.update(aad[7:])
+    buf = bytearray(enc)
+    for i in range(0, len(buf), 13):
+        piece = memoryview(buf)[i : i + 13]
+        cipher.decrypt_into(piece, piece)
+    cipher.verify(tag)
+    print(buf == plain)
+
+# a changed byte of ciphertext, associated data or tag is caught
+iv = unhexlify("cafebabefacedbaddecaf888")
+cipher = aesio.AES(key, aesio.MODE_GCM, iv)
+cipher.update(aad)
+enc = bytearray(len(plain))
+cipher.encrypt_into(plain, enc)
+tag = cipher.digest()
+for bad_enc, bad_aad, bad_tag in (
+    (enc[:-1] + b"\x00", aad, tag),
+    (enc, aad[:-1] + b"\x00", tag),
+    (enc, aad, tag[:-1] + b"\x00"),
+    (enc, aad, tag[:8]),
+):
+    cipher.rekey(key, iv)
+    cipher.update(bad_aad)
+    cipher.decrypt_into(bad_enc, bytearray(len(bad_enc)))
+    try:
+        cipher.verify(bad_tag)
+    except ValueError as er:
+        print("ValueError", er.args)
+
+# a shorter tag
+cipher = aesio.AES(key, aesio.MODE_GCM, iv, mac_len=12)
+cipher.update(aad)
+cipher.encrypt_into(plain, bytearray(len(plain)))
+print(cipher.digest() == tag[:12])
+
+# CCM examples from NIST SP 800-38C and RFC 3610
+for key, nonce, aad, plain, expected, mac_len in (
+    ("404142434445464748494a4b4c4d4e4f", "10111213141516", "0001020304050607", "20212223",
+     "7162015b4dac255d", 4),
+    ("404142434445464748494a4b4c4d4e4f", "1011121314151617", "000102030405060708090a0b0c0d0e0f",
+     "202122232425262728292a2b2c2d2e2f", "d2a1f0e051ea5f62081a7792073d593d1fc64fbfaccd", 6),
+    ("c0c1c2c3c4c5c6c7c8c9cacbcccdcecf", "00000003020100a0a1a2a3a4a5", "0001020304050607",
+     "08090a0b0c0d0e0f101112131415161718191a1b1c1d1e",
+     "588c979a61c663d2f066d0c2c0f989806d5f6b61dac38417e8d12cfdf926e0", 8),
+):
+    key, nonce, aad, plain, expected = [unhexlify(x) for x in (key, nonce, aad, plain, expected)]
+    cipher = aesio.AES(key, aesio.MODE_CCM, nonce, mac_len=mac_len)
+    cipher.update(aad[:3])
+    cipher.update(aad[3:])
+    enc = bytearray(len(plain))
+    cipher.encrypt_into(plain, enc)
+    print(enc + cipher.digest() == expected)
+    cipher.rekey(key, nonce)
+    cipher.update(aad)
+    dec = bytearray(len(plain))
+    cipher.decrypt_into(enc, dec)
+    cipher.verify(expected[len(plain) :])
+    print(dec == plain)
+
+# CCM authenticates the AAD as it was when update() was called
+cipher = aesio.AES(key, aesio.MODE_CCM, nonce, mac_len=mac_len)
+buf = bytearray(aad)
+cipher.update(buf)
+buf[0] ^= 1
+enc = bytearray(len(plain))
+cipher.encrypt_into(plain, enc)
+print(enc + cipher.digest() == expected)
+
+# misuse
+key = bytes(16)
+cipher = aesio.AES(key, aesio.MODE_GCM, bytes(12))
+cipher.encrypt_into(b"abc", bytearray(3))
+for f in (
+    lambda: cipher.update(b"late"),
+    lambda: aesio.AES(key, aesio.MODE_GCM, b""),
+    lambda: aesio.AES(key, aesio.MODE_CCM, bytes(6)),
+    lambda: aesio.AES(key, aesio.MODE_GCM, bytes(12), mac_len=5),
+):
+    try:
+        f()
+    except ValueError as er:
+        print("ValueError", er.args)
+cipher.digest()
+try:
+    cipher.encrypt_into(b"abc", bytearray(3))
+except ValueError as er:
+    print("ValueError", er.args)
+cipher = aesio.AES(key, aesio.MODE_CCM, bytes(13))
+cipher.encrypt_into(b"abc", bytearray(3))
+try:
+    cipher.encrypt_into(b"abc", bytearray(3))
+except ValueError as er:
+    print("ValueError", er.args)
+try:
+    aesio.AES(key, aesio.MODE_CTR).digest()
+except TypeError as er:
+    print("TypeError", er.args)
@@ -0,0 +1,65 @@
+# Test aesio ECB, CBC and CTR modes against NIST SP 800-38A vectors.
+
+try:
+    import aesio
+    from binascii import hexlify, unhexlify
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+plain = unhexlify(
+    "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+    "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710"
+)
+keys = (
+    unhexlify("2b7e151628aed2a6abf7158809cf4f3c"),
+    unhexlify("8e73b0f7da0e6452c810f32b809079e562f8ead2522c6b7b"),
+    unhexlify("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4"),
+)
+
+# ECB, one block at a time, for each key size
+for key in keys:
+    cipher = aesio.AES(key, aesio.MODE_ECB)
+    enc = bytearray(16)
+    dec = bytearray(16)
+    cipher.encrypt_into(plain[:16], enc)
+    cipher.decrypt_into(enc, dec)
+    print(len(key), hexlify(enc), dec == plain[:16])
+
+# CBC
+iv = unhexlify("000102030405060708090a0b0c0d0e0f")
+enc = bytearray(64)
+aesio.AES(keys[0], aesio.MODE_CBC, iv).encrypt_into(plain, enc)
+print(hexlify(enc))
+dec = bytearray(enc)
+aesio.AES(keys[0], aesio.MODE_CBC, iv).decrypt_into(dec, dec)
+print(dec == plain)
+
+# CTR, into a separate buffer, in place, and split at a block boundary
+iv = unhexlify("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff")
+enc = bytearray(64)
+aesio.AES(keys[2], aesio.MODE_CTR, iv).encrypt_into(plain, enc)
+print(hexlify(enc))
+buf = bytearray(plain)
+aesio.AES(keys[2], aesio.MODE_CTR, iv).encrypt_into(buf, buf)
+print(buf == enc)
+cipher = aesio.AES(keys[2], aesio.MODE_CTR, iv)
+part = bytearray(48)
+cipher.encrypt_into(plain[:48], part)
+tail = bytearray(16)
+cipher.encrypt_into(plain[48:], tail)
+print(part + tail == enc)
+
+# CTR takes any length
+dec = bytearray(5)
+aesio.AES(keys[2], aesio.MODE_CTR, iv).decrypt_into(enc[:5], dec)
+print(dec == plain[:5])
+
+# the counter carries across bytes
+cipher = aesio.AES(keys[0], aesio.MODE_CTR, b"\x00" * 12 + b"\xff" * 4)
+enc = bytearray(32)
+cipher.encrypt_into(bytes(32), enc)
+ecb = aesio.AES(keys[0], aesio.MODE_ECB)
+block = bytearray(16)
+ecb.encrypt_into(b"\x00" * 11 + b"\x01" + b"\x00" * 4, block)
+print(enc[16:] == block)
@@ -0,0 +1,178 @@
+try:
+    import _http
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+
+class FakeSocket:
+    # Returns data at most step bytes per recv_into, to split lines and chunks.
+    def __init__(self, data, step=7):
+        self.data = data
+        self.pos = 0
+        self.step = step
+        self.closed = False
+
+    def recv_into(self, buf, nbytes=0):
+        n = min(len(buf), self.step, len(self.data) - self.pos)
+        if nbytes:
+            n = min(n, nbytes)
+        buf[:n] = self.data[self.pos : self.pos + n]
+        self.pos += n
+        return n
+
+    def close(self):
+        self.closed = True
+
+
+def read_body(r, size=5):
+    body = bytearray()
+    chunk = bytearray(size)
+    while True:
+        n = r.readinto(chunk)
+        if not n:
+            return bytes(body)
+        body.extend(chunk[:n])
+
+
+buf = bytearray(64)
+headers = {}
+
+# content-length body
+s = FakeSocket(
+    b"HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 11\r\n"
+    b"X-Dup: a\r\nx-dup: b\r\n\r\nhello world"
+)
+r = _http.Response(s, buf, headers)
+print(r.status_code, r.reason, r.version, r.keep_alive, r.done)
+print(sorted(headers.items()))
+print(read_body(r), r.done, r.readinto(bytearray(4)))
+
+# chunked body with extensions and trailers, reusing the headers dict
+s = FakeSocket(
+    b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+    b"5;ext=1\r\nhello\r\n1A\r\nabcdefghijklmnopqrstuvwxyz\r\n0\r\nTrailer: x\r\n\r\n",
+    step=3,
+)
+r = _http.Response(s, buf, headers)
+print(sorted(headers.items()))
+print(read_body(r), r.keep_alive)
+
+# read until close, and nbytes
+s = FakeSocket(b"HTTP/1.0 200 OK\r\nServer: test\r\n\r\n0123456789")
+r = _http.Response(s, buf)
+print(r.headers, r.version, r.keep_alive)
+b = bytearray(8)
+print(r.readinto(b, 3), b[:3])
+print(read_body(r), r.done)
+
+# HTTP/1.0 keep-alive, interim response, HEAD and 204
+s = FakeSocket(b"HTTP/1.1 100 Continue\r\n\r\nHTTP/1.0 200 OK\r\nConnection: Keep-Alive\r\nContent-Length: 2\r\n\r\nok")
+r = _http.Response(s, buf, headers)
+print(r.status_code, r.keep_alive, read_body(r))
+s = FakeSocket(b"HTTP/1.1 200 OK\r\nContent-Length: 100\r\nConnection: close\r\n\r\n")
+r = _http.Response(s, buf, head=True)
+print(r.done, r.keep_alive, r.readinto(bytearray(4)))
+s = FakeSocket(b"HTTP/1.1 204 No Content\r\n\r\n")
+r = _http.Response(s, buf)
+print(r.status_code, r.reason, r.done)
+
+# 101 returns the upgraded connection as the body
+s = FakeSocket(b"HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n\r\nraw frames")
+r = _http.Response(s, buf, headers)
+print(r.status_code, r.keep_alive, headers["upgrade"], read_body(r))
+
+# matching repeated Content-Length and latin-1 header text
+s = FakeSocket(b"HTTP/1.1 200 OK\r\nContent-Length: 2\r\nContent-Length: 2\r\nX: caf\xe9\r\n\r\nok")
+r = _http.Response(s, buf, headers)
+print(headers["x"], headers["x"] == "caf\u00e9", read_body(r))
+
+# errors
+for data in (
+    b"HTTP/2 200 OK\r\n\r\n",
+    b"HTTP/1.1 2x0 OK\r\n\r\n",
+    b"HTTP/1.1 200 OK\r\nno colon\r\n\r\n",
+    b"HTTP/1.1 200 OK\r\nContent-Length: -1\r\n\r\n",
+    b"HTTP/1.1 200 OK\r\nContent-Length: 5\r\nContent-Length: 2\r\n\r\nhello",
+):
+    try:
+        _http.Response(FakeSocket(data), buf)
+    except ValueError as e:
+        print("ValueError", e)
+try:
+    _http.Response(FakeSocket(b"HTTP/1.1 200 OK\r\nX: " + b"y" * 80 + b"\r\n\r\n"), buf)
+except ValueError as e:
+    print("ValueError", e)
+r = _http.Response(FakeSocket(b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"), buf)
+try:
+    r.readinto(bytearray(4))
+except ValueError as e:
+    print("ValueError", e)
+r = _http.Response(FakeSocket(b"HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nabc"), buf)
+try:
+    read_body(r)
+except OSError as e:
+    print("OSError", e.args[0] == 104)
+try:
+    _http.Response(FakeSocket(b""), buf)
+except OSError as e:
+    print("OSError", e.args[0] == 104)
+try:
+    _http.Response(FakeSocket(b""), buf, [])
+except TypeError:
+    print("TypeError")
+
+
+# connection pool
+class FakeSource:
+    def __init__(self):
+        self.made = 0
+
+    def getaddrinfo(self, host, port):
+        return [(2, 1, 6, "", (host, port))]
+
+    def socket(self, family, type, proto):
+        self.made += 1
+        return FakeConn(self.made)
+
+
+class FakeConn:
+    def __init__(self, n):
+        self.n = n
+        self.closed = False
+
+    def connect(self, addr):
+        self.addr = addr
+
+    def close(self):
+        self.closed = True
+
+
+source = FakeSource()
+pool = _http.ConnectionPool(source, max_idle=2)
+finished = _http.Response(FakeSocket(b"HTTP/1.1 204 No Content\r\n\r\n"), buf)
+unfinished = _http.Response(FakeSocket(b"HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nabc"), buf)
+a = pool.connect("example.com", 80)
+print(a.n, a.addr, pool.idle_count)
+pool.release("example.com", 80, a, finished)
+b = pool.connect("example.com", 80)
+print(b is a, source.made, pool.idle_count)
+c = pool.connect("example.com", 80)
+d = pool.connect("other", 8080)
+print(c.n, d.n, d.addr)
+pool.release("example.com", 80, b, finished)
+pool.release("example.com", 80, c, unfinished)
+pool.release("other", 8080, d, finished)
+print(pool.idle_count, b.closed, c.closed, d.closed)
+e = pool.connect("example.com", 81)
+pool.release("example.com", 81, e, finished)
+print(pool.idle_count, e.closed)
+f = pool.connect("example.com", 82)
+pool.release("example.com", 82, f)
+print(pool.idle_count, f.closed)
+try:
+    pool.release("example.com", 82, f, True)
+except TypeError:
+    print("TypeError")
+pool.close()
+print(pool.idle_count, b.closed, d.closed)
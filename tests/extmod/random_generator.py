@@ -0,0 +1,67 @@
+# test the xoshiro128++ generator behind random and random.Random
+try:
+    import random
+
+    random.Random
+    random.fill
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+try:
+    import array
+except ImportError:
+    array = None
+
+# seeding gives the reference sequence
+random.seed(42)
+print([random.getrandbits(32) for _ in range(4)])
+print([random.getrandbits(8) for _ in range(4)])
+
+# instances have their own state
+a = random.Random(42)
+b = random.Random(42)
+random.seed(1)
+print(a.getrandbits(32), b.getrandbits(32), a.getrandbits(32))
+a.seed(7)
+b.seed(7)
+print([a.randrange(1000) for _ in range(5)] == [b.randrange(1000) for _ in range(5)])
+print(random.Random().getrandbits(1) in (0, 1))
+
+# ranges, including negative steps
+r = random.Random(3)
+print(all(0 <= r.randrange(10) < 10 for _ in range(100)))
+print(all(r.randrange(-5, 5, 3) in (-5, -2, 1, 4) for _ in range(100)))
+print(all(r.randrange(10, 0, -3) in (10, 7, 4, 1) for _ in range(100)))
+print(sorted(set(r.randint(1, 3) for _ in range(100))))
+print(r.choice("abc") in "abc", 2 <= r.uniform(2, 3) < 3, 0 <= r.random() < 1)
+for args in ((0,), (5, 5), (1, 5, 0), (1, 5, -1)):
+    try:
+        r.randrange(*args)
+    except ValueError as e:
+        print(args, e)
+for n in (0, 33):
+    try:
+        r.getrandbits(n)
+    except ValueError:
+        print("ValueError", n)
+
+# bytes and buffers
+r.seed(9)
+x = r.randbytes(7)
+r.seed(9)
+buf = bytearray(7)
+r.fill(buf)
+print(type(x), len(x), x == buf, len(r.randbytes(0)))
+random.fill(bytearray(3))
+print(len(random.randbytes(5)))
+
+# float arrays get floats in [0, 1)
+if array:
+    for typecode in "fd":
+        f = array.array(typecode, [2] * 1000)
+        r.fill(f)
+        print(typecode, all(0 <= v < 1 for v in f), 0.4 < sum(f) / len(f) < 0.6)
+else:
+    print("f True True")
+    print("d True True")
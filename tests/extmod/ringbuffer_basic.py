@@ -0,0 +1,135 @@
+# test ringbuffer.RingBuffer
+
+try:
+    import ringbuffer
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+# byte stream
+rb = ringbuffer.RingBuffer(8)
+print(rb.capacity, rb.record_size, rb.in_waiting)
+print(rb.put_from(b"hello"), rb.in_waiting)
+buf = bytearray(3)
+print(rb.get_into(buf), buf, rb.in_waiting)
+# wraps around the end of the storage
+print(rb.put_from(b"world!"), rb.in_waiting)
+print(rb.put_from(b"x"))
+out = bytearray(16)
+n = rb.get_into(out)
+print(n, out[:n])
+print(rb.get_into(out))
+
+# peek and release in place, across the wrap
+rb.put_from(b"abcdef")
+v = rb.peek()
+print(bytes(v))
+rb.release(2)
+print(len(v), rb.in_waiting)
+v = rb.peek()
+print(bytes(v))
+rb.release()
+v = rb.peek()
+print(bytes(v) if v else v)
+rb.release()
+print(rb.peek())
+try:
+    rb.release()
+except ValueError:
+    print("ValueError")
+
+# reserve and commit in place
+v = rb.reserve(4)
+print(len(v))
+v[0:4] = b"1234"
+rb.commit(3)
+print(len(v), rb.in_waiting)
+n = rb.get_into(out)
+print(out[:n])
+try:
+    rb.commit()
+except ValueError:
+    print("ValueError")
+rb.put_from(b"12345678")
+print(rb.reserve(1))
+rb.clear()
+print(rb.in_waiting, rb.peek())
+
+# records
+rb = ringbuffer.RingBuffer(3, record_size=4)
+print(rb.record_size, rb.in_waiting)
+for r in (b"a", b"bb", b"ccc", b"dddd"):
+    print(rb.put_from(r), rb.in_waiting)
+try:
+    rb.put_from(b"eeeee")
+except ValueError:
+    print("ValueError")
+try:
+    rb.put_from(b"")
+except ValueError:
+    print("ValueError")
+n = rb.get_into(out)
+print(out[:n], rb.in_waiting)
+n = rb.get_into(out)
+print(out[:n], rb.in_waiting)
+# the record is kept if it doesn't fit
+try:
+    rb.get_into(bytearray(2))
+except ValueError:
+    print("ValueError")
+print(bytes(rb.peek()))
+rb.release()
+v = rb.reserve(2)
+v[:] = b"ee"
+try:
+    rb.commit(1)
+except ValueError:
+    print("ValueError")
+rb.commit()
+while True:
+    n = rb.get_into(out)
+    if not n:
+        break
+    print(out[:n])
+try:
+    rb.reserve(5)
+except ValueError:
+    print("ValueError")
+
+# stream protocol
+rb = ringbuffer.RingBuffer(4, record_size=8)
+print(rb.write(b"one"), rb.write(b"three"))
+print(rb.read(8), rb.readinto(out), out[:5])
+print(rb.read(8), rb.readinto(out))
+rb.write(b"four")
+try:
+    rb.readinto(out, 3)
+except OSError:
+    print("OSError")
+print(rb.read())
+try:
+    rb.write(b"123456789")
+except OSError:
+    print("OSError")
+rb = ringbuffer.RingBuffer(4)
+print(rb.write(b"123456"), rb.write(b"7"), rb.read(), rb.read())
+
+# errors
+for args, kw in (((0,), {}), ((4,), {"record_size": -1})):
+    try:
+        ringbuffer.RingBuffer(*args, **kw)
+    except ValueError:
+        print("ValueError")
+
+# a view outlives the buffer it came from
+import gc
+
+rb = ringbuffer.RingBuffer(64)
+rb.put_from(b"0123456789" * 4)
+rb.peek()
+rb.release(30)
+v = rb.peek()
+rb = None
+gc.collect()
+junk = [bytearray(b"\xff" * 64) for i in range(50)]
+print(bytes(v))
@@ -0,0 +1,51 @@
+# test struct.Struct and the format cache behind the module-level functions
+try:
+    import struct
+
+    struct.Struct
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+s = struct.Struct("<BhI")
+print(s.format, s.size)
+print(s.pack(1, -2, 3))
+print(s.unpack(b"\x01\xfe\xff\x03\x00\x00\x00"))
+
+# pack_into and unpack_from with positive and negative offsets
+buf = bytearray(10)
+s.pack_into(buf, 2, 0xFF, 0x1234, 0xDEADBEEF)
+print(buf)
+print(s.unpack_from(buf, 2))
+print(s.unpack_from(buf, offset=-8))
+s.pack_into(buf, -7, 1, 2, 3)
+print(buf)
+
+# repeat counts, strings, padding, and merged runs of the same type
+for fmt in ("<3H", "<HHH", ">2s3xH", "<0sB", "<4B2x", ">qQ", "@bhiq"):
+    s = struct.Struct(fmt)
+    print(fmt, s.size, struct.calcsize(fmt))
+print(struct.Struct(">2s3xH").pack(b"abc", 7))
+print(struct.Struct("<0sB").unpack(b"\x05"))
+
+# HID keyboard report and a sensor frame
+hid = struct.Struct("<BBBBBBBB")
+print(hid.pack(0x02, 0, 4, 5, 6, 0, 0, 0))
+frame = struct.Struct("<IhhhhhhhhhH")
+data = frame.pack(123456, 1, -2, 3, -4, 5, -6, 7, -8, 9, 0xABCD)
+print(len(data), frame.unpack(data))
+
+# iter_unpack walks consecutive records
+for rec in struct.Struct("<hB").iter_unpack(b"\x01\x00\x02\xff\xff\x03"):
+    print(rec)
+print(list(struct.iter_unpack(">H", b"\x00\x01\x00\x02")))
+try:
+    struct.Struct("<H").iter_unpack(b"\x00\x01\x02")
+except Exception:
+    print("Exception")
+
+# more formats than the cache holds, built at runtime so they aren't interned
+for i in range(3):
+    for n in range(1, 9):
+        fmt = "<" + "H" * n
+        print(struct.calcsize(fmt), struct.unpack(fmt, struct.pack(fmt, *range(n))))
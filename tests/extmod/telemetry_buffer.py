@@ -0,0 +1,160 @@
+try:
+    import telemetry
+    import uio as io
+    import ustruct as struct
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def varint(self):
+        v = shift = 0
+        while True:
+            b = self.byte()
+            v |= (b & 0x7F) << shift
+            shift += 7
+            if b < 0x80:
+                return v
+
+    def zigzag(self):
+        v = self.varint()
+        return (v >> 1) ^ -(v & 1)
+
+    def bytes(self, n):
+        self.pos += n
+        return self.data[self.pos - n : self.pos]
+
+
+def decode(data, names=None):
+    r = Reader(data)
+    while r.pos < len(data):
+        kind = r.byte()
+        if kind == ord("S"):
+            n = r.varint()
+            print("schema buckets", r.varint())
+            names = [r.bytes(r.varint()).decode() for _ in range(n)]
+            print(" ", names)
+            continue
+        seq = r.varint()
+        r.varint()
+        end = r.varint() + r.pos
+        print("batch", seq)
+        last = {}
+        while r.pos < end:
+            h = r.varint()
+            key = names[h >> 2]
+            t = h & 3
+            if t == 0:
+                r.varint()
+                last[key] = last.get(key, 0) + r.zigzag()
+                print("  int", key, last[key])
+            elif t == 1:
+                r.varint()
+                print("  float", key, struct.unpack("<f", r.bytes(4))[0])
+            elif t == 2:
+                print("  counter", key, r.zigzag())
+            else:
+                first = r.varint()
+                print("  histogram", key, first, [r.varint() for _ in range(r.varint())])
+    return names
+
+
+stream = io.BytesIO()
+t = telemetry.Buffer(stream, ["keys", "battery", "latency"], interval=0, histogram_buckets=8)
+print(t.keys, t.interval)
+for v in (100, 101, 99, 1000000, -5):
+    t.record(0, v)
+t.record(1, 0.5)
+t.count(0)
+t.count(0, 4)
+for v in (0, 1, 3, 3, 100, 1000):
+    t.observe(2, v)
+print(t.flush(), t.stats[0], t.stats[1] == len(stream.getvalue()), t.stats[2:])
+names = decode(stream.getvalue())
+first = len(stream.getvalue())
+
+# deltas restart in each batch, and an empty batch sends nothing
+t.record(0, 7)
+t.count(0, -2)
+t.flush()
+t.flush()
+decode(stream.getvalue()[first:], names)
+
+# a new stream gets the schema again
+stream2 = io.BytesIO()
+t.stream = stream2
+t.record(2, 1)
+t.flush()
+decode(stream2.getvalue())
+
+
+# objects with send() instead of the stream protocol, which may take part
+class Sink:
+    def __init__(self):
+        self.data = bytearray()
+
+    def send(self, buf):
+        n = min(len(buf), 5)
+        self.data.extend(buf[:n])
+        return n
+
+
+sink = Sink()
+t.stream = sink
+t.record(1, 3)
+t.flush()
+decode(bytes(sink.data))
+
+# a small buffer sends early instead of dropping
+stream3 = io.BytesIO()
+t = telemetry.Buffer(stream3, ("a",), capacity=64, interval=0, histogram_buckets=0)
+for i in range(100):
+    t.record(0, i * 1000)
+t.flush()
+batches, sent, dropped, errors = t.stats
+print(batches > 1, sent == len(stream3.getvalue()), dropped, errors)
+
+# a stream that raises: flush raises it, and recording counts it instead
+closed = io.BytesIO()
+closed.close()
+t.stream = closed
+t.record(0, 1)
+try:
+    t.flush()
+except ValueError:
+    print("ValueError")
+for i in range(100):
+    t.record(0, i * 1000)
+print(t.stats[3] > 1)
+errors = t.stats[3]
+t.stream = stream3
+t.record(0, 1)
+t.flush()
+print(t.stats[3] == errors)
+
+# errors
+for args, kwargs in (((stream, ()), {}), ((stream, ("a",)), {"capacity": 8}), ((stream, (1,)), {})):
+    try:
+        telemetry.Buffer(*args, **kwargs)
+    except (ValueError, TypeError) as e:
+        print(type(e).__name__)
+try:
+    t.record(1, 0)
+except ValueError:
+    print("ValueError")
+with t:
+    pass
+try:
+    t.record(0, 0)
+except ValueError:
+    print("ValueError")
@@ -0,0 +1,133 @@
+# test the .mpy cache for imported modules on a FAT filesystem
+
+import sys
+
+try:
+    import uos
+    uos.VfsFat
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+
+    def readblocks(self, n, buf):
+        for i in range(len(buf)):
+            buf[i] = self.data[n * self.SEC_SIZE + i]
+        return 0
+
+    def writeblocks(self, n, buf):
+        for i in range(len(buf)):
+            self.data[n * self.SEC_SIZE + i] = buf[i]
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(100)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    uos.umount('/')
+except OSError:
+    pass
+for path in uos.listdir('/'):
+    uos.umount('/' + path)
+
+uos.VfsFat.mkfs(bdev)
+uos.mount(bdev, '/')
+uos.chdir('/')
+sys.path[:] = ['']
+
+
+def write(name, data):
+    with open(name, 'wb') as f:
+        f.write(data)
+
+
+def read(name):
+    with open(name, 'rb') as f:
+        return f.read()
+
+
+def load(name):
+    sys.modules.pop(name, None)
+    try:
+        __import__(name)
+    except Exception as e:
+        print(type(e).__name__)
+
+
+def cache_files():
+    return sorted(uos.listdir('/.mpycache'))
+
+
+write('/mod.py', b"print('mod', 'from source', __file__)\n")
+
+# without the cache directory nothing is cached
+load('mod')
+print(uos.listdir('/'))
+
+# the first import after creating it compiles and saves the module
+uos.mkdir('/.mpycache')
+load('mod')
+files = cache_files()
+print(len(files), files[0].endswith('.mpy'), len(files[0]))
+entry = '/.mpycache/' + files[0]
+print(read(entry)[:4])
+
+# later imports load the cached code, not the source
+write(entry, read(entry).replace(b'from source', b'from cache!'))
+load('mod')
+
+# changing the source replaces the entry
+write('/mod.py', b"print('mod', 'edited')\n")
+load('mod')
+print(cache_files() == files)
+load('mod')
+
+# a damaged entry is recompiled
+write(entry, read(entry)[:30])
+load('mod')
+load('mod')
+
+# errors are still raised and nothing is cached for them
+write('/bad.py', b"def f(:\n")
+load('bad')
+print(len(cache_files()))
+
+# saving an entry only drops the cached listing of the cache directory, so
+# the second module doesn't list the root again
+try:
+    import micropython
+    micropython.import_cache_stats
+except (ImportError, AttributeError):
+    micropython = None
+write('/one.py', b"print('one')\n")
+write('/two.py', b"print('two')\n")
+load('one')
+if micropython:
+    dirs = micropython.import_cache_stats()[0]
+load('two')
+print(not micropython or micropython.import_cache_stats()[0] - dirs == 1)
+print(len(cache_files()))
+
+# a read-only filesystem runs modules uncached
+write('/three.py', b"print('three')\n")
+uos.umount('/')
+uos.mount(bdev, '/', readonly=True)
+load('three')
+print(len(cache_files()))
@@ -0,0 +1,140 @@
+# test that imports are resolved from cached directory listings
+
+import sys, uio
+
+try:
+    import micropython, uos
+    uos.mount
+    micropython.import_cache_stats
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+class UserFile(uio.IOBase):
+    def __init__(self, fs, path, data):
+        self.fs = fs
+        self.path = path
+        self.data = data
+        self.pos = 0
+    def readinto(self, buf):
+        n = 0
+        while n < len(buf) and self.pos < len(self.data):
+            buf[n] = self.data[self.pos]
+            n += 1
+            self.pos += 1
+        return n
+    def write(self, buf):
+        self.data += buf
+        self.fs.files[self.path] = self.data
+        return len(buf)
+    def ioctl(self, req, arg):
+        return 0
+
+
+class UserFS:
+    def __init__(self, files):
+        self.files = files
+    def mount(self, readonly, mksfs):
+        pass
+    def umount(self):
+        pass
+    def ilistdir(self, path):
+        print('ilistdir', path)
+        prefix = path.rstrip('/') + '/'
+        names = {}
+        for name in self.files:
+            if name.startswith(prefix):
+                rest = name[len(prefix):].split('/')
+                names[rest[0]] = 0x4000 if len(rest) > 1 else 0x8000
+        if not names and path != '/':
+            raise OSError(2)
+        for name in names:
+            yield (name, names[name], 0)
+    def stat(self, path):
+        print('stat', path)
+        if path in self.files:
+            return (0x8000, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+        raise OSError(2)
+    def open(self, path, mode):
+        if 'w' in mode:
+            self.files[path] = b''
+        return UserFile(self, path, self.files[path])
+
+
+def stats(label, before):
+    now = micropython.import_cache_stats()
+    print(label, 'dirs', now[0] - before[0], 'hits', now[1] - before[1], 'misses', now[2] - before[2])
+    return now
+
+
+user_files = {
+    '/mod1.py': b"print('mod1')",
+    '/mod2.py': b"print('mod2')",
+    '/pkg/__init__.py': b"print('pkg')",
+    '/pkg/sub.py': b"print('pkg.sub')",
+}
+uos.mount(UserFS(user_files), '/userfs')
+saved_path = sys.path[:]
+sys.path[:] = ['/userfs']
+
+s = micropython.import_cache_stats()
+
+# the first probe lists /userfs, later ones are answered from that listing
+import mod1
+import mod2
+s = stats('modules', s)
+
+# a package directory gets its own listing
+import pkg.sub
+s = stats('package', s)
+
+# a missing module is resolved without a stat
+try:
+    import nosuchmodule
+except ImportError:
+    print('ImportError')
+s = stats('missing', s)
+
+# writing a file drops the cache
+f = open('/userfs/mod3.py', 'w')
+f.write(b"print('mod3')")
+import mod3
+s = stats('after write', s)
+
+uos.umount('/userfs')
+sys.path[:] = saved_path
+
+# FAT matches names case-insensitively, and so does the cache there
+try:
+    uos.VfsFat
+except AttributeError:
+    raise SystemExit
+
+
+class RAMBlockDevice:
+    SEC_SIZE = 512
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+    def readblocks(self, n, buf):
+        buf[:] = self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)]
+    def writeblocks(self, n, buf):
+        self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)] = buf
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+bdev = RAMBlockDevice(50)
+uos.VfsFat.mkfs(bdev)
+uos.mount(uos.VfsFat(bdev), '/fatfs')
+with open('/fatfs/CaseMod.py', 'w') as f:
+    f.write("print('CaseMod')")
+sys.path[:] = ['/fatfs']
+import casemod
+import CASEMOD
+print(casemod.__name__, CASEMOD.__name__)
+uos.umount('/fatfs')
+sys.path[:] = saved_path
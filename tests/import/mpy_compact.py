@@ -0,0 +1,81 @@
+# test importing .mpy files with a shared qstr table, plain and compressed
+
+import sys, uio
+
+try:
+    uio.IOBase
+    import uos
+    uos.mount
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+class UserFile(uio.IOBase):
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+    def read(self):
+        return self.data
+    def readinto(self, buf):
+        n = 0
+        while n < len(buf) and self.pos < len(self.data):
+            buf[n] = self.data[self.pos]
+            n += 1
+            self.pos += 1
+        return n
+    def ioctl(self, req, arg):
+        return 0
+
+
+class UserFS:
+    def __init__(self, files):
+        self.files = files
+    def mount(self, readonly, mksfs):
+        pass
+    def umount(self):
+        pass
+    def stat(self, path):
+        if path in self.files:
+            return (32768, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+        raise OSError
+    def open(self, path, mode):
+        return UserFile(self.files[path])
+
+
+# these are the test .mpy files, built by mpy-cross -mcache-lookup-bc from
+#     def f(s):
+#         return s + s + s
+#     print(f("abc"), f("abc") == "abcabcabc")
+# as is and with -mcompress=8
+user_files = {
+    '/mod0.mpy': b'M\x04\x03\x1f\x00\x07\x08<module>\x07modz.py\x01f\x05print\x03abc\tabcabcabc\x01s3\x04\x00\x00\x00\x00\x00\x08\x00\x00\x01\x00F\x00\x00\xff`\x00$\x02\x00\x1b\x03\x00\x00\x1b\x02\x00\x00\x16\x04\x00d\x01\x1b\x02\x00\x00\x16\x04\x00d\x01\x16\x05\x00\xd9d\x022\x11[\x00\x01\x15\x03\x00\x00\x01\x00\x00\x08\x02\x00\x01\x00!\x00\x00\xff\xb0\xb0\xf1\xb0\xf1[\x00\x00\x06',
+    '/mod1.mpy': b'M\x04\x03\x1f\x08\x00\x07\x08<modul\x08e>\x07\x07\x00z.py\x00\x01f\x05print`\x03abc\t\x03\x00\x02\x03\x01\x10s3\x04\x00\x00\x01\x08\x00\x00\x00\x01\x00F\x00\x00\xff`\x00\x00$\x02\x00\x1b\x03\x00\x00\x1b\x00\x02\x00\x00\x16\x04\x00d\x01\x01\x08\x06\x16\x05\x00\xd9d\x022\xa0\x11[\x00\x01\x15 \x00\x015\x00\n\x02\x05\x00!5\x00\xb0\xb0\xf1\xb0\x00\xf1[\x00\x00\x06',
+    '/mod2.mpy': b'M\x04\x03\x1f\x08\x00\x07\x08<modul\x08e>\x07\x07\x00z.py\x00\x01f\x05print`\x03abc\t\x03', # truncated
+    '/mod3.mpy': b'M\x04\x03\x1f\x10', # bad compression window
+}
+
+# create and mount a user filesystem
+uos.mount(UserFS(user_files), '/userfs')
+sys.path.append('/userfs')
+
+# the files only load on ports with the same bytecode options as unix
+try:
+    __import__('mod0')
+except Exception as e:
+    print("SKIP")
+    uos.umount('/userfs')
+    sys.path.pop()
+    raise SystemExit
+
+# import .mpy files from the user filesystem
+for i in range(1, len(user_files)):
+    mod = 'mod%u' % i
+    try:
+        __import__(mod)
+    except Exception as e:
+        print(mod, type(e).__name__, e)
+
+# unmount and undo path addition
+uos.umount('/userfs')
+sys.path.pop()
@@ -0,0 +1,41 @@
+# Function and method call overhead.
+
+
+def f0():
+    pass
+
+
+def f3(a, b, c):
+    pass
+
+
+def fkw(a, b=1, c=2):
+    pass
+
+
+class C:
+    def method(self):
+        pass
+
+
+obj = C()
+
+
+def bench_call_0():
+    f0()
+
+
+def bench_call_3():
+    f3(1, 2, 3)
+
+
+def bench_call_kw():
+    fkw(1, c=3)
+
+
+def bench_call_method():
+    obj.method()
+
+
+def bench_call_builtin():
+    len("abc")
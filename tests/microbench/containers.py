@@ -0,0 +1,28 @@
+# Building and indexing builtin containers.
+
+lst = list(range(16))
+dct = {i: i for i in range(16)}
+
+
+def bench_list_new():
+    [1, 2, 3, 4]
+
+
+def bench_list_index():
+    lst[7]
+
+
+def bench_dict_new():
+    {"a": 1, "b": 2}
+
+
+def bench_dict_lookup():
+    dct[7]
+
+
+def bench_tuple_unpack():
+    a, b, c = 1, 2, 3
+
+
+def bench_bytearray_new():
+    bytearray(64)
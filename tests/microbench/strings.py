@@ -0,0 +1,23 @@
+# String formatting and manipulation.
+
+s = "hello world"
+
+
+def bench_str_concat():
+    s + "!"
+
+
+def bench_str_format():
+    "{} {}".format(1, 2)
+
+
+def bench_str_percent():
+    "%d %s" % (1, "a")
+
+
+def bench_str_split():
+    s.split()
+
+
+def bench_int_to_str():
+    str(12345)
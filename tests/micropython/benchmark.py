@@ -0,0 +1,33 @@
+# test the benchmark module
+
+try:
+    import benchmark
+except ImportError:
+    print('SKIP')
+    raise SystemExit
+
+print(benchmark.frequency() > 0)
+print(isinstance(benchmark.cycles(), int))
+
+r = benchmark.run(lambda: None, 100)
+print(r.iterations)
+print(0 <= r.min <= r.median <= r.p99 <= r.max)
+print(r.min <= r.mean <= r.max)
+print(r.allocs == 0, r.alloc_bytes == 0)
+
+# allocations are averaged per iteration
+r = benchmark.run(lambda: bytearray(100), 10, warmup=0)
+print(r.allocs >= 1, r.alloc_bytes >= 100)
+
+calls = []
+benchmark.run(lambda: calls.append(1), 5, warmup=3)
+print(len(calls))
+
+try:
+    benchmark.run(lambda: None, 0)
+except ValueError:
+    print('ValueError')
+try:
+    benchmark.run(None)
+except TypeError:
+    print('TypeError')
@@ -0,0 +1,100 @@
+# test constant folding of comparisons and bool constants, and that the
+# bytecode peephole pass keeps the semantics of the code it rewrites
+
+from micropython import const
+
+DEBUG = const(False)
+VERBOSE = const(True)
+LEVEL = const(2)
+_HIDDEN = const(True)
+
+print(DEBUG, VERBOSE, _HIDDEN, not LEVEL, not DEBUG)
+print(LEVEL > 1, LEVEL < 1, LEVEL == 2, LEVEL != 2, LEVEL >= 2, LEVEL <= 1)
+print(1 < LEVEL < 3, 1 < LEVEL < 2, 0 < 1 > LEVEL, 1 << 70 > LEVEL)
+
+def f(x):
+    if DEBUG:
+        print('debug')
+    if LEVEL > 1 and VERBOSE:
+        print('level', x)
+    if not VERBOSE or _HIDDEN < 1:
+        print('hidden')
+    return x
+    print('unreachable')
+print(f(1))
+
+# x = x on a parameter is a no-op, on anything else it must still raise
+def g(a, *b):
+    a = a
+    b = b
+    return a, b
+print(g(1, 2))
+
+def h(a):
+    del a
+    a = a
+try:
+    h(1)
+except NameError:
+    print('NameError')
+
+def k():
+    x = x
+try:
+    k()
+except NameError:
+    print('NameError')
+
+# not + conditional jump, and a conditional jump over a jump
+def m(lst):
+    out = []
+    for i in lst:
+        if i not in (2, 4):
+            continue
+        if not i > 3:
+            out.append(i)
+            continue
+        out.append(-i)
+    return out
+print(m(range(6)))
+
+# jump chains through nested loops, try/finally and else clauses
+def n():
+    out = []
+    for i in range(3):
+        while True:
+            try:
+                if i == 1:
+                    break
+                out.append(i)
+            finally:
+                out.append('f')
+            break
+        else:
+            out.append('else')
+    else:
+        out.append('done')
+    return out
+print(n())
+
+# code after return/raise in one branch still runs in the other
+def p(c):
+    if c:
+        return 'a'
+    else:
+        raise ValueError
+    return 'b'
+print(p(1))
+try:
+    p(0)
+except ValueError:
+    print('ValueError')
+
+def q(c):
+    try:
+        if c:
+            return 1
+    except:
+        pass
+    return 2
+print(q(0), q(1))
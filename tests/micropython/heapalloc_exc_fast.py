@@ -0,0 +1,63 @@
+# Test catching StopIteration, KeyError and IndexError raised by the runtime
+# while the heap is locked.
+import micropython
+
+d = {1: 2}
+l = [1]
+finally_count = [0]
+
+
+class It:
+    def __init__(self, n):
+        self.n = n
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        if self.n == 0:
+            raise StopIteration
+        self.n -= 1
+        return self.n
+
+
+def func(it):
+    n = 0
+    micropython.heap_lock()
+    for i in range(2, 10):
+        try:
+            d[i]
+        except KeyError:
+            n += 1
+        try:
+            l[i]
+        except IndexError:
+            n += 10
+        try:
+            try:
+                d[i]
+            finally:
+                finally_count[0] += 1
+        except KeyError:
+            pass
+    for x in it:
+        n += 1000
+    micropython.heap_unlock()
+    return n
+
+
+print(func(It(3)), finally_count)
+
+# the exceptions must still be usable once bound to a name
+try:
+    d[3]
+except KeyError as e:
+    print(repr(e))
+try:
+    l[5]
+except IndexError as e:
+    print(repr(e))
+try:
+    next(It(0))
+except StopIteration as e:
+    print(repr(e))
@@ -0,0 +1,42 @@
+# test the sampling profiler
+
+try:
+    import profiler
+except ImportError:
+    print('SKIP')
+    raise SystemExit
+
+def busy():
+    x = 0
+    for i in range(200000):
+        x += i
+    return x
+
+profiler.start(samples=10000)
+try:
+    profiler.start()
+except RuntimeError:
+    print('RuntimeError')
+while True:
+    busy()
+    result = profiler.dump()
+    if result:
+        break
+print(profiler.stop())
+
+# Each entry is (hits, filename, line, function), most frequent first.
+print(all(result[i][0] >= result[i + 1][0] for i in range(len(result) - 1)))
+print(all(isinstance(filename, str) and line > 0 for hits, filename, line, function in result))
+print('busy' in [function for hits, filename, line, function in result])
+
+# A full buffer counts dropped samples.
+profiler.start(samples=1)
+while profiler.stop() == 0:
+    profiler.start(samples=1)
+    busy()
+print(len(profiler.dump()))
+
+try:
+    profiler.start(samples=0)
+except ValueError:
+    print('ValueError')
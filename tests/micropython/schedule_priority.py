@@ -0,0 +1,36 @@
+# test micropython.schedule() priorities and ordering
+
+import micropython
+
+try:
+    micropython.schedule
+    micropython.sched_stats
+except AttributeError:
+    print('SKIP')
+    raise SystemExit
+
+def callback(arg):
+    global done
+    print(arg)
+    done += 1
+
+# Schedule from within a callback so that the scheduler is locked and all of
+# them are queued before any run.  Callbacks run first-in first-out within a
+# priority level and high priority ones run first.
+
+def schedule_all(arg):
+    for i in range(3):
+        micropython.schedule(callback, i)
+    micropython.schedule(callback, 'high', 1)
+    try:
+        micropython.schedule(callback, None, 2)
+    except ValueError:
+        print('ValueError')
+
+done = 0
+micropython.schedule(schedule_all, None)
+while done != 4:
+    pass
+
+pending, peak, dropped = micropython.sched_stats()
+print(pending, peak >= 4, dropped)
@@ -0,0 +1,51 @@
+# test micropython.trace_dump() binary trace buffer
+
+import micropython
+
+try:
+    micropython.trace_dump
+    import ustruct as struct
+except (AttributeError, ImportError):
+    print('SKIP')
+    raise SystemExit
+
+import gc
+
+def traced_function():
+    return 1
+
+micropython.trace_dump() # discard anything recorded so far
+traced_function()
+gc.collect()
+data = micropython.trace_dump()
+
+magic, version, entry_size, _, hz, n_entries, n_lost = struct.unpack_from('<4sBBHIII', data, 0)
+print(magic, version, entry_size, hz > 0, n_lost)
+entries = []
+for i in range(n_entries):
+    entries.append(struct.unpack_from('<IIHH', data, 20 + i * entry_size))
+offset = 20 + n_entries * entry_size
+n_names = struct.unpack_from('<I', data, offset)[0]
+offset += 4
+names = {}
+for i in range(n_names):
+    q, l = struct.unpack_from('<IH', data, offset)
+    names[q] = str(data[offset + 6:offset + 6 + l], 'utf-8')
+    offset += 6 + l
+print(offset == len(data))
+
+# VM calls and the collection should be recorded as balanced spans.
+calls = [names[arg] for ts, arg, event, phase in entries if event == 5 and phase == ord('B')]
+print('traced_function' in calls)
+gc_phases = [chr(phase) for ts, arg, event, phase in entries if event == 1]
+print(gc_phases)
+
+# Timestamps are monotonic.
+print(all(entries[i][0] <= entries[i + 1][0] for i in range(len(entries) - 1)))
+
+# Disabling recording stops new entries.
+micropython.trace_dump()
+micropython.trace_enable(False)
+traced_function()
+micropython.trace_enable(True)
+print(struct.unpack_from('<I', micropython.trace_dump(), 12)[0] == 0)
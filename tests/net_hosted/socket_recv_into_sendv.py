@@ -0,0 +1,40 @@
+# test zero-copy socket calls over loopback: recv_into, sendv and sendfile
+
+try:
+    import usocket as socket
+except:
+    import socket
+
+server = socket.socket()
+server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+addr = socket.getaddrinfo('127.0.0.1', 8124)[0][-1]
+server.bind(addr)
+server.listen(1)
+client = socket.socket()
+client.connect(addr)
+peer = server.accept()[0]
+
+# gather several buffer types into one send
+print(client.sendv([b'abc', bytearray(b'def'), memoryview(b'..xyz')[2:]]))
+print(client.sendv([]))
+
+# receive into a slice of a larger buffer, limited by nbytes
+buf = bytearray(12)
+mv = memoryview(buf)
+print(peer.recv_into(mv[2:], 4), buf)
+print(peer.recv_into(mv[6:]), buf)
+
+try:
+    peer.recv_into(mv[:2], 3)
+except ValueError:
+    print('ValueError')
+
+# send part of a file, then the rest; the file position follows the data sent
+with open('io/data/file1', 'rb') as f:
+    print(client.sendfile(f, 7, 5), f.tell())
+    print(client.sendfile(f, 13), f.tell())
+print(peer.recv(100))
+
+client.close()
+peer.close()
+server.close()
@@ -0,0 +1,80 @@
+# test independent interpreters and channels
+
+try:
+    import _interp
+except ImportError:
+    print('SKIP')
+    raise SystemExit
+
+import sys
+
+# echo messages back upper-cased until the channel is closed
+src = """
+import _interp
+requests, replies = _interp.channels()
+while True:
+    msg = requests.recv()
+    if msg is None:
+        break
+    replies.send(msg.upper())
+replies.close()
+"""
+requests = _interp.Channel()
+replies = _interp.Channel()
+it = _interp.Interpreter(src, (requests, replies))
+for msg in (b'abc', bytearray(b'def'), b''):
+    requests.send(msg)
+requests.close()
+while True:
+    msg = replies.recv()
+    if msg is None:
+        break
+    print(msg)
+print(it.join())
+
+# can't send on a closed channel
+try:
+    requests.send(b'x')
+except OSError:
+    print('OSError')
+
+# the main interpreter wasn't started with any channels
+print(_interp.channels())
+
+# each interpreter has its own globals, modules and sys state
+x = 1
+sys.modules['parent_only'] = sys
+out = _interp.Channel()
+src = """
+import _interp, sys
+(out,) = _interp.channels()
+out.send(repr([globals().get('x'), 'parent_only' in sys.modules, sys.argv, len(sys.path) > 0]))
+sys.argv.append('child')
+"""
+print(_interp.Interpreter(src, (out,)).join(), out.recv())
+print('child' in sys.argv, 'parent_only' in sys.modules)
+del sys.modules['parent_only']
+
+# exit status
+print(_interp.Interpreter('raise SystemExit(3)').join())
+print(_interp.Interpreter('import sys; sys.exit()').join())
+
+# independent interpreters in parallel
+out = _interp.Channel()
+src = """
+import _interp
+(out,) = _interp.channels()
+out.send(b'%d' % sum(i * i for i in range(1000)))
+"""
+its = [_interp.Interpreter(src, (out,), heap_size=32 * 1024) for _ in range(4)]
+print([it.join() for it in its], [out.recv() for _ in its])
+
+# bad arguments
+try:
+    _interp.Interpreter('', (1,))
+except TypeError:
+    print('TypeError')
+try:
+    _interp.Interpreter('', heap_size=16)
+except ValueError:
+    print('ValueError')
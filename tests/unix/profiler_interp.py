@@ -0,0 +1,36 @@
+# test that another interpreter doesn't stop or take over the profiler
+
+try:
+    import profiler
+    import _interp
+except ImportError:
+    print('SKIP')
+    raise SystemExit
+
+src = """
+import profiler
+try:
+    profiler.start()
+except RuntimeError:
+    print('RuntimeError')
+profiler.stop()
+"""
+
+
+def busy():
+    x = 0
+    for i in range(200000):
+        x += i
+    return x
+
+
+profiler.start(samples=10000)
+print(_interp.Interpreter(src).join())
+while True:
+    busy()
+    if profiler.dump():
+        break
+print(profiler.stop())
+
+# once stopped, another interpreter may profile
+print(_interp.Interpreter("import profiler\nprofiler.start()\nprofiler.stop()").join())
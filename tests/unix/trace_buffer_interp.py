@@ -0,0 +1,52 @@
+# test that the trace buffer doesn't carry qstrs between interpreters
+
+import micropython
+
+try:
+    micropython.trace_dump
+    import _interp
+    import ustruct as struct
+except (AttributeError, ImportError):
+    print('SKIP')
+    raise SystemExit
+
+
+def call_names(data):
+    n_entries = struct.unpack_from('<I', data, 12)[0]
+    offset = 20 + n_entries * 12
+    names = {}
+    for i in range(struct.unpack_from('<I', data, offset)[0]):
+        q, l = struct.unpack_from('<IH', data, offset + 4)
+        names[q] = str(data[offset + 10:offset + 10 + l], 'utf-8')
+        offset += 6 + l
+    calls = []
+    for i in range(n_entries):
+        ts, arg, event, phase = struct.unpack_from('<IIHH', data, 20 + i * 12)
+        if event == 5 and phase == ord('B'):
+            calls.append(names.get(arg))
+    return calls
+
+
+def before_interp():
+    pass
+
+
+def after_interp():
+    pass
+
+
+# the child's function names are qstrs in its own pool, beyond the parent's
+src = """
+def child_function_with_a_long_name():
+    pass
+for i in range(10):
+    child_function_with_a_long_name()
+"""
+
+micropython.trace_dump()
+before_interp()
+print(_interp.Interpreter(src).join())
+after_interp()
+calls = call_names(micropython.trace_dump())
+print('before_interp' in calls, 'after_interp' in calls)
+print(None in calls, 'child_function_with_a_long_name' in calls)
@@ -22,6 +22,7 @@ else:
     is_int_type = lambda o: type(o) is int
 # end compatibility code
 
+import io
 import sys
 import struct
 from collections import namedtuple
@@ -38,7 +39,7 @@ class FreezeError(Exception):
         return 'error while freezing %s: %s' % (self.rawcode.source_file, self.msg)
 
 class Config:
-    MPY_VERSION = 3
+    MPY_VERSION = 4
     MICROPY_LONGINT_IMPL_NONE = 0
     MICROPY_LONGINT_IMPL_LONGLONG = 1
     MICROPY_LONGINT_IMPL_MPZ = 2
@@ -434,35 +435,57 @@ def read_obj(f):
         else:
             assert 0
 
-def read_qstr_and_pack(f, bytecode, ip):
-    qst = read_qstr(f)
+def read_qstr_and_pack(qstr_table, bytecode, ip):
+    qst = qstr_table[bytecode[ip] | bytecode[ip + 1] << 8]
     bytecode[ip] = qst & 0xff
     bytecode[ip + 1] = qst >> 8
 
-def read_bytecode_qstrs(file, bytecode, ip):
+def read_bytecode_qstrs(qstr_table, bytecode, ip):
     while ip < len(bytecode):
         f, sz = mp_opcode_format(bytecode, ip)
         if f == 1:
-            read_qstr_and_pack(file, bytecode, ip + 1)
+            read_qstr_and_pack(qstr_table, bytecode, ip + 1)
         ip += sz
 
-def read_raw_code(f):
+def read_raw_code(f, qstr_table):
     bc_len = read_uint(f)
     bytecode = bytearray(f.read(bc_len))
     ip, ip2, prelude = extract_prelude(bytecode)
-    read_qstr_and_pack(f, bytecode, ip2) # simple_name
-    read_qstr_and_pack(f, bytecode, ip2 + 2) # source_file
-    read_bytecode_qstrs(f, bytecode, ip)
+    read_qstr_and_pack(qstr_table, bytecode, ip2) # simple_name
+    read_qstr_and_pack(qstr_table, bytecode, ip2 + 2) # source_file
+    read_bytecode_qstrs(qstr_table, bytecode, ip)
     n_obj = read_uint(f)
     n_raw_code = read_uint(f)
-    qstrs = [read_qstr(f) for _ in range(prelude[3] + prelude[4])]
+    qstrs = [qstr_table[read_uint(f)] for _ in range(prelude[3] + prelude[4])]
     objs = [read_obj(f) for _ in range(n_obj)]
-    raw_codes = [read_raw_code(f) for _ in range(n_raw_code)]
+    raw_codes = [read_raw_code(f, qstr_table) for _ in range(n_raw_code)]
     return RawCode(bytecode, qstrs, objs, raw_codes)
 
+# Inverse of lzss_compress in py/persistentcode.c.
+def lzss_decompress(data, window_bits):
+    len_bits = 16 - window_bits
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        flags = data[i]
+        i += 1
+        for bit in range(8):
+            if i >= len(data):
+                break
+            if flags & (1 << bit):
+                code = data[i] << 8 | data[i + 1]
+                i += 2
+                dist = (code >> len_bits) + 1
+                for _ in range((code & ((1 << len_bits) - 1)) + 3):
+                    out.append(out[-dist])
+            else:
+                out.append(data[i])
+                i += 1
+    return bytes(out)
+
 def read_mpy(filename):
     with open(filename, 'rb') as f:
-        header = bytes_cons(f.read(4))
+        header = bytes_cons(f.read(5))
         if header[0] != ord('M'):
             raise Exception('not a valid .mpy file')
         if header[1] != config.MPY_VERSION:
@@ -471,7 +494,10 @@ def read_mpy(filename):
         config.MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE = (feature_flags & 1) != 0
         config.MICROPY_PY_BUILTINS_STR_UNICODE = (feature_flags & 2) != 0
         config.mp_small_int_bits = header[3]
-        return read_raw_code(f)
+        if header[4]:
+            f = io.BytesIO(lzss_decompress(bytes_cons(f.read()), header[4]))
+        qstr_table = [read_qstr(f) for _ in range(read_uint(f))]
+        return read_raw_code(f, qstr_table)
 
 def dump_mpy(raw_codes):
     for rc in raw_codes:
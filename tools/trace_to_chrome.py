@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2020 KMK contributors
+#
+# SPDX-License-Identifier: MIT
+
+"""Convert a trace buffer dump to Chrome trace JSON.
+
+Build the firmware (or the unix port) with MICROPY_TRACE_BUFFER enabled, e.g.
+
+    make CFLAGS_EXTRA=-DMICROPY_TRACE_BUFFER=1
+
+then save a dump from Python:
+
+    import micropython
+    with open("trace.bin", "wb") as f:
+        f.write(micropython.trace_dump())
+
+and convert it:
+
+    python3 tools/trace_to_chrome.py trace.bin -o trace.json
+
+Load the result in chrome://tracing or https://ui.perfetto.dev.  The dump layout
+is documented in py/mptrace.c.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+HEADER = struct.Struct("<4sBBHIII")
+ENTRY = struct.Struct("<IIHH")
+
+# Must match mp_trace_event_t in py/mptrace.h.
+EVENTS = {
+    1: ("gc_collect", "gc"),
+    2: ("background_callback", "background"),
+    3: ("displayio_background", "background"),
+    4: ("usb_background", "background"),
+    5: ("call", "vm"),
+    6: ("sched_schedule", "sched"),
+    7: ("sched_run", "sched"),
+}
+
+EVENT_VM_CALL = 5
+EVENT_BACKGROUND_CALLBACK = 2
+
+
+def parse_dump(data):
+    magic, version, entry_size, _, hz, n_entries, n_lost = HEADER.unpack_from(data, 0)
+    if magic != b"MPTR":
+        raise ValueError("not a trace dump")
+    if version != 1 or entry_size != ENTRY.size:
+        raise ValueError("unsupported trace dump version {} (entry size {})".format(version, entry_size))
+    offset = HEADER.size
+    entries = []
+    for _ in range(n_entries):
+        entries.append(ENTRY.unpack_from(data, offset))
+        offset += ENTRY.size
+    names = {}
+    if offset < len(data):
+        (n_names,) = struct.unpack_from("<I", data, offset)
+        offset += 4
+        for _ in range(n_names):
+            qstr, length = struct.unpack_from("<IH", data, offset)
+            offset += 6
+            names[qstr] = data[offset : offset + length].decode("utf-8", "replace") or "<native>"
+            offset += length
+    return hz, n_lost, entries, names
+
+
+def event_name(event, arg, names):
+    name, category = EVENTS.get(event, ("event_{}".format(event), "unknown"))
+    if event == EVENT_VM_CALL:
+        name = names.get(arg, "qstr_{}".format(arg))
+    elif event == EVENT_BACKGROUND_CALLBACK:
+        name = "{} 0x{:08x}".format(name, arg)
+    return name, category
+
+
+def to_chrome(hz, entries, names, pid=0, tid=0):
+    events = []
+    # Entries are ordered but the 32-bit timestamps wrap, so unwrap them.
+    wraps = 0
+    last = None
+    # Stack of open (name, category) spans.  The oldest entries of a full ring
+    # may have lost their begin events, so unmatched ends are dropped.
+    stack = []
+    ts = 0.0
+    for timestamp, arg, event, phase in entries:
+        if last is not None and timestamp < last:
+            wraps += 1
+        last = timestamp
+        ts = ((wraps << 32) + timestamp) * 1e6 / hz
+        phase = chr(phase)
+        if phase == "E":
+            if not stack:
+                continue
+            name, category = stack.pop()
+            events.append({"name": name, "cat": category, "ph": "E", "ts": ts, "pid": pid, "tid": tid})
+            continue
+        name, category = event_name(event, arg, names)
+        record = {"name": name, "cat": category, "ph": phase, "ts": ts, "pid": pid, "tid": tid}
+        if phase == "B":
+            stack.append((name, category))
+        elif phase == "i":
+            record["s"] = "t"
+            record["args"] = {"arg": arg}
+        events.append(record)
+    # Close spans still open when the dump was taken.
+    while stack:
+        name, category = stack.pop()
+        events.append({"name": name, "cat": category, "ph": "E", "ts": ts, "pid": pid, "tid": tid})
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("dump", help="binary dump from micropython.trace_dump()")
+    parser.add_argument("-o", "--output", help="output JSON file (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        hz, n_lost, entries, names = parse_dump(f.read())
+    if n_lost:
+        print("{} older entries were overwritten".format(n_lost), file=sys.stderr)
+
+    trace = {"traceEvents": to_chrome(hz, entries, names), "displayTimeUnit": "ms"}
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()